@@ -4,8 +4,17 @@
 #define LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB                   64             /* FLASH sector size in KB */
 #define FLASH_CONFIG_SECTOR_SIZE_THERSHOLD_KB                50             /* FLASH sector thershold for preparing the next sector for writing (earase sector) */    
 #define LOGGER_CONFIG_DOUBLE_BUFFER_SIZE_BYTES               1024           /* double buffer size in bytes */
+#define LOGGER_CONFIG_PRIORITY_BUFFER_SIZE_BYTES             512            /* RX buffer size in bytes reserved for ERROR and CRITICAL records (at least LOGGER_CONFIG_MAX_RX_MESSAGE_SIZE_BYTES) */
+#define LOGGER_CONFIG_RX_RECORD_FIFO_SIZE                    32             /* the number of record boundaries kept per RX buffer (new records join the newest entry when full) */
+#define LOGGER_CONFIG_OVERRUN_BLOCK_TIMEOUT_MS               200            /* the maximum time a printing task is blocked on RX buffer overrun (LOGGER_ATTR_OVERRUN_BLOCK) */
+#define LOGGER_CONFIG_OVERRUN_BLOCK_POLL_MS                  1              /* the RX buffer free space polling interval of a blocked printing task */
+#define LOGGER_CONFIG_SINK_MAX_LAG_BYTES                     512            /* an optional sink (RS232) that lags more than this behind the writer is dropped to the slowest required sink */
 #define LOGGER_CONFIG_NVR_ADDRESS                            0x7F60         /* the address to read\write NVR parmeters */
-#define LOGGER_CONFIG_NVR_SIZE_BYTES                         16             /* the size of internal logger NVR DB */
+#define LOGGER_CONFIG_NVR_SIZE_BYTES                         20             /* the size of internal logger NVR DB */
+#define LOGGER_CONFIG_NVR_UPLOAD_CURSOR_ADDRESS              0x7F78         /* the address to read\write the log upload cursor in NVR */
+#define LOGGER_CONFIG_NVR_UPLOAD_CURSOR_SIZE_BYTES           8              /* the size of the log upload cursor in NVR */
+#define LOGGER_CONFIG_NVR_UPLOAD_JOB_ADDRESS                 0x7F80         /* the address to read\write the log upload job progress in NVR */
+#define LOGGER_CONFIG_NVR_UPLOAD_JOB_SIZE_BYTES              44             /* the size of the log upload job progress in NVR */
 #define LOGGER_CONFIG_MAX_RX_MESSAGE_SIZE_BYTES              256            /* maximum logger message RX packet in bytes */
 #define LOGGER_CONFIG_MAX_TX_MESSAGE_SIZE_BYTES              256            /* maximum logger message TX packet in bytes */
 #define LOGGER_CONFIG_FLASH_START_ADDRESS                    0x000A0000     /* the flash start address of debug messages */
@@ -15,8 +24,38 @@
 #define LOGGER_CONFIG_FLASH_MAX_SEGMENT_SIZE_KB              256            /* the maximum size of flash debug log file allowed */
 #define LOGGER_CONFIG_LOW_RESOLUTION_MS                      10             /* the low (regular) logger TX resolution in ms */
 #define LOGGER_CONFIG_HIGH_RESOLUTION_MS                     1              /* the high logger TX resolution in ms */
+#define LOGGER_CONFIG_DRAIN_WATERMARK_PERCENT                50             /* RX buffer occupancy above which the logger TX switches to the high resolution */
+#define LOGGER_CONFIG_DRAIN_BUDGET_BYTES                     1024           /* the maximum RX buffer bytes the drain task sends on a single wake up */
+#define LOGGER_CONFIG_DRAIN_BUDGET_US                        2000           /* the maximum time the drain task sends on a single wake up in us (needs GetTimeUsCb) */
+#define LOGGER_CONFIG_PANIC_MAX_BYTES                        1024           /* the maximum bytes the panic flush writes to every sink with the interrupts disabled */
+#define LOGGER_CONFIG_FLASH_CRASH_ADDRESS                    (LOGGER_CONFIG_FLASH_START_ADDRESS + (LOGGER_CONFIG_FLASH_MAX_SEGMENT_SIZE_KB<<10)) /* the FLASH sector reserved for the crash capture, right after the log file */
+#define LOGGER_CONFIG_CRASH_STACK_DUMP_BYTES                 256            /* the maximum raw stack bytes of the faulting task kept in the crash capture */
+#define LOGGER_CONFIG_CRASH_RX_SNAPSHOT_BYTES                512            /* the maximum bytes of the last log messages (RX buffer) kept in the crash capture */
+#define LOGGER_CONFIG_CRASH_PRINT_TIMEOUT_MS                 2000           /* the maximum total time the crash capture print waits for the sinks to free the RX buffer */
+#define LOGGER_CONFIG_PERSISTENT_CMD_TASK                    FALSE          /* keep the logger task alive between commands, instead of deleting it after every command */
+#define LOGGER_CONFIG_CMD_POOL_SIZE                          4              /* the number of static command payload slots. a command that finds no free slot falls back to the heap */
+#define LOGGER_CONFIG_RECONFIG_DRAIN_TIMEOUT_MS              500            /* the maximum time a destination change waits for the old sinks to send the RX buffers */
+#define LOGGER_CONFIG_OCCUPANCY_SERIES_SIZE                  32             /* the number of seconds kept in the RX buffer occupancy time series (needs GetTimeUsCb) */
+#define LOGGER_CONFIG_TELEMETRY_INTERVAL_SEC                 60             /* the default interval of the telemetry record to the server in seconds, 0 to disable */
+#define LOGGER_CONFIG_TELEMETRY_FULL_EVERY                   16             /* every this number of telemetry records one is sent with the full counters (a power of 2) */
+#define LOGGER_CONFIG_CALL_SITE_STATS                        TRUE           /* count the messages and bytes of every Logger_printf call site (format string) */
+#define LOGGER_CONFIG_CALL_SITES_BITS                        6              /* the call sites table has 2^LOGGER_CONFIG_CALL_SITES_BITS entries */
+#define LOGGER_CONFIG_LATENCY_PROBES                         TRUE           /* record the printf, TX interrupt and sinks latencies histograms (needs GetCyclesCb) */
+#ifdef __ICCARM__
+#define LOGGER_CONFIG_NO_INIT                                __no_init      /* the RX buffers and their header are kept in RAM that is not initialized on reset */
+#else
+#define LOGGER_CONFIG_NO_INIT                                               /* no-init RAM is not supported, the RX buffers are lost on reset */
+#endif
 #define LOGGER_CONFIG_MAX_SECTOR_ERASE_TIMEOUT_MS            3000           /* the maximum timeout for sector erase in ms */
-#define LOGGER_CONFIG_FTP_FILE_NAME_LEN                      25             /* the length of FTP log file name */
+#define LOGGER_CONFIG_FLASH_SECTOR_SUMMARY_SIZE_BYTES        256            /* the size reserved at the end of every FLASH sector for the sector summary record (page aligned) */
+#define LOGGER_CONFIG_SUMMARY_BLOCK_SIZE_BYTES               4096           /* the sector summary keeps the time of the first record of every block of this size */
+#define LOGGER_CONFIG_SUMMARY_TIME_FIFO_SIZE                 8              /* the number of record times kept for the log messages that were not written to FLASH yet */
+#define LOGGER_CONFIG_FTP_FILE_NAME_LEN                      28             /* the length of FTP log file name */
+#define LOGGER_CONFIG_UPLOAD_PART_SIZE_KB                    16             /* the log file is uploaded in part files of this FLASH range size */
+#define LOGGER_CONFIG_DUMP_CHUNK_SIZE_BYTES                  256            /* the size of a single FLASH read chunk while dumping the debug log */
+#define LOGGER_CONFIG_DUMP_NUM_OF_CHUNKS                     2              /* the number of chunk buffers used to read ahead from FLASH while the sink transmits */
+#define LOGGER_CONFIG_DUMP_BUSY_BACKOFF_MS                   2              /* the time to back off when the dump sink is busy and there is nothing to read ahead */
+#define LOGGER_CONFIG_DUMP_SINK_TIMEOUT_MS                   3000           /* the maximum time the dump waits for a busy sink before aborting */
 /* Socket configuration */
 #define LOGGER_CONFIG_SOCKET_MAX_IP_LEN                      64             /* the maximum length of ip or domain name allowed */
 
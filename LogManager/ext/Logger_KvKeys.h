@@ -0,0 +1,24 @@
+/* ---------------------------  Logger structured records keys and events ---------------------------------*/
+/* the keys and events of the structured records (Logger_kv). a key ID is its position in LOGGER_KV_KEYS (ID 0 ends the 
+   fields list), and an event ID is its position in LOGGER_KV_EVENTS, so new keys and events are only appended. the 
+   record holds the IDs only, the names are used by the text rendering and by tools/logger_kv.py, which reads this file.
+   a key type is INT (int), UINT (uint32) or STR (a null terminated string) */
+#ifndef __LOGGER_KV_KEYS_H
+#define __LOGGER_KV_KEYS_H
+
+/*                    name                  type    text                */
+#define LOGGER_KV_KEYS \
+    LOGGER_KV_KEY(   ID,                    UINT,   "id"                ) \
+    LOGGER_KV_KEY(   STATUS,                INT,    "status"            ) \
+    LOGGER_KV_KEY(   DURATION_MS,           UINT,   "duration_ms"       ) \
+    LOGGER_KV_KEY(   COUNT,                 UINT,   "count"             ) \
+    LOGGER_KV_KEY(   SIZE_BYTES,            UINT,   "size_bytes"        ) \
+    LOGGER_KV_KEY(   NAME,                  STR,    "name"              )
+
+/*                    name                  text                */
+#define LOGGER_KV_EVENTS \
+    LOGGER_KV_EVENT( HOST_DEMO,             "host_demo"         ) \
+    LOGGER_KV_EVENT( HOST_DEMO_DONE,        "host_demo_done"    ) \
+    LOGGER_KV_EVENT( HOST_POWER_LOSS,       "host_power_loss"   )
+
+#endif //__LOGGER_KV_KEYS_H
@@ -10,6 +10,24 @@
 #include "I2C_API.h"
 #include "FtpPutManager_API.h"
 #include "EEPROM_Api.h"
+#include <intrinsics.h>
+
+#define WER_LOGGER_FLASH_READ_TIMEOUT_MS        5000    /* the maximum time to poll on a synchronous FLASH read */
+#define WER_LOGGER_FLASH_POLL_INTERVAL_MS       1       /* the interval to poll on a synchronous FLASH read status */
+#define WER_LOGGER_FLASH_ERASE_POLL_INTERVAL_MS 10      /* the interval to poll on a synchronous FLASH erase status */
+#define WER_LOGGER_CPU_CLOCK_MHZ                100     /* the core clock, the DWT cycle counter ticks in */
+
+/* Cortex-M DWT cycle counter registers */
+#define WER_LOGGER_DEMCR                        (*(volatile uint32 *)0xE000EDFC)
+#define WER_LOGGER_DEMCR_TRCENA                 (1<<24)
+#define WER_LOGGER_DWT_CTRL                     (*(volatile uint32 *)0xE0001000)
+#define WER_LOGGER_DWT_CTRL_CYCCNTENA           1
+#define WER_LOGGER_DWT_CYCCNT                   (*(volatile uint32 *)0xE0001004)
+
+/* the asynchronous FLASH command context. the logger queues a single asynchronous FLASH command at a time */
+static volatile uint32 gWeRFlashCmdStatus;
+static LoggerFlashDoneCb_t gpWeRFlashDoneCb;
+static LOGGER_STATUS gWeRFlashErrorStatus;
 
 
 static LOGGER_STATUS WeRLogger_SendUartDataCb(char *pStr, uint16 StrLen)
@@ -84,7 +102,7 @@ static LOGGER_STATUS WeRLogger_SendFlashDataCb(uint32 Address, char *pStr, uint1
         DataToWrite = (*pStrLen) - DataWriten;
     }
     
-    DataWriten += FLASH_WriteFromInt( SSP1, (uint8 *)pStr + DataWriten, DataToWrite, Address);
+    DataWriten += FLASH_WriteFromInt( SSP1, (uint8 *)pStr + DataWriten, DataToWrite, Address + DataWriten);
     
     if(DataWriten != *pStrLen)
     {
@@ -114,10 +132,10 @@ static LOGGER_STATUS WeRLogger_EraseFlashSectorCb(uint32 StartAddress, uint8 Num
         /* TODO: need to fix the attributes - pass it as an argument to the cb function */
         Ret = FLASH_SectorErase(SSP1, 0, StartAddress, 0, (uint32*)&Status, NULL);
         StartAddress += (LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB<<10);
-        /* poll shortly on FLASH status erase command, we should poll relative to the maximum timeout the erase sector takes */
-        for(uint8 j = 0; Status != OSAL_STATUS_OK && j < 3; j++)
+        /* poll shortly on FLASH status erase command, up to the maximum timeout the erase sector takes */
+        for(uint16 j = 0; Status != OSAL_STATUS_OK && j < LOGGER_CONFIG_MAX_SECTOR_ERASE_TIMEOUT_MS/WER_LOGGER_FLASH_ERASE_POLL_INTERVAL_MS; j++)
         {
-            OSAL_SuspendTask(LOGGER_CONFIG_MAX_SECTOR_ERASE_TIMEOUT_MS/3);
+            OSAL_SuspendTask(WER_LOGGER_FLASH_ERASE_POLL_INTERVAL_MS);
         }
     }
         /* sanity check */
@@ -216,11 +234,10 @@ static LOGGER_STATUS WeRLogger_ReadFlashDataCb(uint32 Address, char *pStr, uint1
         OSAL_ASSERT(0);
     }
     
-    OSAL_SuspendTask(10);
-    
-    for(uint8 i=0; Status != OSAL_STATUS_OK && i<100; i++)
+    /* a read usually completes within the first poll interval */
+    for(uint16 i=0; Status != OSAL_STATUS_OK && i<WER_LOGGER_FLASH_READ_TIMEOUT_MS/WER_LOGGER_FLASH_POLL_INTERVAL_MS; i++)
     {
-        OSAL_SuspendTask(50);        
+        OSAL_SuspendTask(WER_LOGGER_FLASH_POLL_INTERVAL_MS);        
     }
     if(Status == OSAL_STATUS_OK)
     {
@@ -229,6 +246,104 @@ static LOGGER_STATUS WeRLogger_ReadFlashDataCb(uint32 Address, char *pStr, uint1
     return LOGGER_STATUS_FLASH_READ_ERROR;
 }
 
+/**
+ * <pre>
+ * static void WeRLogger_FlashDoneCb(uint32 Status)
+ * </pre>
+ *  
+ * this function is the FLASH driver completion routine of asynchronous logger commands. it forwards the completion to the logger
+ *
+ * @param   Status       [in]       The FLASH driver command status
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void WeRLogger_FlashDoneCb(uint32 Status)
+{
+    LoggerFlashDoneCb_t pDoneCb = gpWeRFlashDoneCb;
+    
+    gpWeRFlashDoneCb = NULL;
+    
+    if(pDoneCb != NULL)
+    {
+        pDoneCb(Status == OSAL_STATUS_OK ? LOGGER_STATUS_OK : gWeRFlashErrorStatus);
+    }
+}
+
+/**
+ * <pre>
+ * static LOGGER_STATUS WeRLogger_FlashCmdClaim(LoggerFlashDoneCb_t pDoneCb, LOGGER_STATUS ErrorStatus)
+ * </pre>
+ *  
+ * this function claims the single asynchronous FLASH command context. the check and the claim are done with the interrupts
+ * disabled, so a completion that ends at the same time can not be lost or overwritten
+ *
+ * @param   pDoneCb      [in]       The logger completion routine
+ * @param   ErrorStatus  [in]       The status to report if the FLASH driver command fails
+ *
+ * @return LOGGER_STATUS_OK or LOGGER_STATUS_BUSY if an asynchronous command is already pending
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static LOGGER_STATUS WeRLogger_FlashCmdClaim(LoggerFlashDoneCb_t pDoneCb, LOGGER_STATUS ErrorStatus)
+{
+    __istate_t IntState = __get_interrupt_state();
+    
+    __disable_interrupt();
+    
+    if(gpWeRFlashDoneCb != NULL)
+    {
+        __set_interrupt_state(IntState);
+        return LOGGER_STATUS_BUSY;
+    }
+    gpWeRFlashDoneCb = pDoneCb;
+    gWeRFlashErrorStatus = ErrorStatus;
+    __set_interrupt_state(IntState);
+    
+    return LOGGER_STATUS_OK;
+}
+
+static LOGGER_STATUS WeRLogger_ReadFlashDataAsyncCb(uint32 Address, char *pStr, uint16 StrLen, LoggerFlashDoneCb_t pDoneCb)
+{
+    /* only one asynchronous command at a time, a second request is rejected until the pending one completes */
+    if(WeRLogger_FlashCmdClaim(pDoneCb, LOGGER_STATUS_FLASH_READ_ERROR) != LOGGER_STATUS_OK)
+    {
+        return LOGGER_STATUS_BUSY;
+    }
+    
+    if(FLASH_Read(SSP1, (uint8*)pStr, StrLen, 0, Address, 0, (uint32*)&gWeRFlashCmdStatus, WeRLogger_FlashDoneCb) != OSAL_STATUS_OK)
+    {
+        gpWeRFlashDoneCb = NULL;
+        return LOGGER_STATUS_FLASH_READ_ERROR;
+    }
+    return LOGGER_STATUS_OK;
+}
+
+static LOGGER_STATUS WeRLogger_EraseFlashSectorAsyncCb(uint32 Address, uint16 FlashSize, LoggerFlashDoneCb_t pDoneCb)
+{
+    /* sanity check make sure we don't exit the allowed flash bounderies */
+    if(Address < LOGGER_CONFIG_FLASH_START_ADDRESS || Address >= LOGGER_DEF_FLASH_END_ADDRESS(LOGGER_CONFIG_FLASH_START_ADDRESS, FlashSize))
+    {
+        OSAL_ASSERT(FALSE);
+        return LOGGER_STATUS_ERROR_PARAM;
+    }
+    /* only one asynchronous command at a time, a second request is rejected until the pending one completes */
+    if(WeRLogger_FlashCmdClaim(pDoneCb, LOGGER_STATUS_FLASH_ERASE_ERROR) != LOGGER_STATUS_OK)
+    {
+        return LOGGER_STATUS_BUSY;
+    }
+    
+    if(FLASH_SectorErase(SSP1, 0, Address, 0, (uint32*)&gWeRFlashCmdStatus, WeRLogger_FlashDoneCb) != OSAL_STATUS_OK)
+    {
+        gpWeRFlashDoneCb = NULL;
+        return LOGGER_STATUS_FLASH_ERASE_ERROR;
+    }
+    return LOGGER_STATUS_OK;
+}
+
 static LOGGER_STATUS WeRLogger_SaveNVRParamsCb(uint32 Address, void *pBuff, uint8 SizeBytes)
 {
     /* sanity check */
@@ -245,14 +360,121 @@ static LOGGER_STATUS WeRLogger_SaveNVRParamsCb(uint32 Address, void *pBuff, uint
     return LOGGER_STATUS_OK;
 }
 
-static LOGGER_STATUS WeRLogger_SendSocketDataCb(uint8 *pBuff, uint16 Len, uint8 Mode)
+/**
+ * <pre>
+ * static uint32 WeRLogger_GetTimeUsCb(void)
+ * </pre>
+ *  
+ * this function returns a free running us counter, based on the core DWT cycle counter (enabled on the first call).
+ * NOTE: the cycle counter wraps around every ~42 seconds, so calls further apart than that lose the wrapped time
+ *
+ * @return the time in us
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static uint32 WeRLogger_GetTimeUsCb(void)
+{
+    static uint32 gWeRLastCycleCnt = 0;
+    static uint32 gWeRCycleRemainder = 0;
+    static uint32 gWeRTimeUs = 0;
+    __istate_t IntState = __get_interrupt_state();
+    uint32 CycleCnt;
+    uint32 TimeUs;
+    
+    /* called from the logger TX timer interrupt and from the drain task */
+    __disable_interrupt();
+    
+    if(!(WER_LOGGER_DWT_CTRL & WER_LOGGER_DWT_CTRL_CYCCNTENA))
+    {
+        WER_LOGGER_DEMCR |= WER_LOGGER_DEMCR_TRCENA;
+        WER_LOGGER_DWT_CYCCNT = 0;
+        WER_LOGGER_DWT_CTRL |= WER_LOGGER_DWT_CTRL_CYCCNTENA;
+    }
+    CycleCnt = WER_LOGGER_DWT_CYCCNT;
+    
+    gWeRCycleRemainder += CycleCnt - gWeRLastCycleCnt;
+    gWeRLastCycleCnt = CycleCnt;
+    gWeRTimeUs += gWeRCycleRemainder / WER_LOGGER_CPU_CLOCK_MHZ;
+    gWeRCycleRemainder %= WER_LOGGER_CPU_CLOCK_MHZ;
+    TimeUs = gWeRTimeUs;
+    
+    __set_interrupt_state(IntState);
+    
+    return TimeUs;
+}
+
+/**
+ * <pre>
+ * static uint32 WeRLogger_GetCyclesCb(void)
+ * </pre>
+ *  
+ * this function returns the core DWT cycle counter (enabled on the first call), for the logger latency probes.
+ * it is called on every probe sample so it only reads the counter, the interrupts are not disabled
+ *
+ * @return the cycle counter
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static uint32 WeRLogger_GetCyclesCb(void)
+{
+    if(!(WER_LOGGER_DWT_CTRL & WER_LOGGER_DWT_CTRL_CYCCNTENA))
+    {
+        WER_LOGGER_DEMCR |= WER_LOGGER_DEMCR_TRCENA;
+        WER_LOGGER_DWT_CTRL |= WER_LOGGER_DWT_CTRL_CYCCNTENA;
+    }
+    return WER_LOGGER_DWT_CYCCNT;
+}
+
+/**
+ * <pre>
+ * static uint32 WeRLogger_DisableInterruptsCb(void)
+ * </pre>
+ *  
+ * this function disables the interrupts for the logger panic flush
+ *
+ * @return the previous interrupts state
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static uint32 WeRLogger_DisableInterruptsCb(void)
+{
+    __istate_t IntState = __get_interrupt_state();
+    
+    __disable_interrupt();
+    
+    return (uint32)IntState;
+}
+
+/**
+ * <pre>
+ * static void WeRLogger_RestoreInterruptsCb(uint32 IntState)
+ * </pre>
+ *  
+ * this function restores the interrupts state after the logger panic flush
+ *
+ * @param   IntState     [in]       The interrupts state returned by WeRLogger_DisableInterruptsCb
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void WeRLogger_RestoreInterruptsCb(uint32 IntState)
+{
+    __set_interrupt_state((__istate_t)IntState);
+}
+
+static LOGGER_STATUS WeRLogger_SendSocketDataCb(uint8 *pBuff, uint16 Len, uint8 Mode, uint8 Priority)
 {
     uint16 RetVal;
     
     if(CoM_IsSessionActive_API( COM_MANAGER_SESSION_TYPE_DEBUG ))
     {
             RetVal = CoM_SendMsgDataFromInt_API(pBuff, Len, 0, COM_ATTR_DONT_FREE_BUFFER|COM_ATTR_DONT_SEND_COMPLETION_MSG|COM_ATTR_DONT_ALLOW_SEND_NACK_MSG|COM_ATTR_DONT_FREE_BUFFER_ON_FAILURE,
-                        COM_MANAGER_SESSION_TYPE_DEBUG, COM_SEND_DATA_LOW_PRIORITY, 0);
+                        COM_MANAGER_SESSION_TYPE_DEBUG, (Priority == LOGGER_SOCKET_PRIORITY_HIGH)? COM_SEND_DATA_HIGH_PRIORITY: COM_SEND_DATA_LOW_PRIORITY, 0);
             
         if(RetVal != COM_MANAGER_FUNC_ERR_OK)
         {
@@ -591,4 +813,11 @@ LoggerCB_t gLoggerCbList = {
     WeRLogger_GetPanelIdCb,
     WerLogger_ReadConfigCb,
     WerLogger_WriteConfigCb,
+    WeRLogger_ReadFlashDataAsyncCb,
+    WeRLogger_EraseFlashSectorAsyncCb,
+    WeRLogger_GetTimeUsCb,
+    NULL,                                   /* no polled UART driver, the panic flush writes the FLASH only */
+    WeRLogger_DisableInterruptsCb,
+    WeRLogger_RestoreInterruptsCb,
+    WeRLogger_GetCyclesCb,
 };
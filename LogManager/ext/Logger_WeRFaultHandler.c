@@ -1,5 +1,8 @@
 #include "osal.h"
+#include "Logger_Defs.h"
+#include "Logger_Api.h"
 #include "Logger_Utils.h"
+#include "Logger_Crash.h"
 #include "Logger_WeRFaultHandler.h"
 #include "DebugTask.h"
 #include "RTC_API.h"
@@ -13,7 +16,9 @@
  *  
  * This function handles hard fault handler. it captures the current stack registers, date and time, task name, ID and current command executing.
  * The information is writen to a special location in the RAM that is not initialized on reset, thus allow it to be saved in none volatile memory
- * after reset.
+ * after reset. The full exception frame, the fault status registers, a raw dump of the faulting task stack and the last log messages
+ * are written to the FLASH crash area (crash capture). The pending log messages are then written synchronously (panic flush), 
+ * so the last messages before the crash are kept.
  *
  * @param   pHardFaultArgs [in]    the current registers value.
  *
@@ -25,6 +30,11 @@
 
 extern "C" void HardFaultHandler(uint32 *pHardFaultArgs)
 {   
+    LoggerCrashHeader_t Crash;
+    RTC_Time_t *pTimeAndDate = (RTC_Time_t *)&TIME_AND_DATE_ADDRESS;
+    uint32 StackAddr = (uint32)(pHardFaultArgs + e_LOGGER_CRASH_REG_MAX);
+    uint8 Idx;
+    
     MAGIC_ADDRESS = MAGIC_NUM;
     R0_REG_ADDRESS = pHardFaultArgs[0];
     R1_REG_ADDRESS = pHardFaultArgs[1];
@@ -35,6 +45,44 @@ extern "C" void HardFaultHandler(uint32 *pHardFaultArgs)
     OSAL_GetRunningTaskName(DBG_TASK_NAME_ADDRESS);
     Dbg_GetFaultTask((uint16*)&DBG_TASK_CMD_ADDRESS, (uint8*)&DBG_TASK_ID_ADDRESS);
     RTC_GetTimeAndDate((RTC_Time_t*)&TIME_AND_DATE_ADDRESS);
+    
+    /* the crash capture keeps the whole exception frame */
+    for(Idx = 0; Idx < e_LOGGER_CRASH_REG_MAX; Idx++)
+    {
+        Crash.Frame[Idx] = pHardFaultArgs[Idx];
+    }
+    if(Crash.Frame[e_LOGGER_CRASH_REG_XPSR] & FAULT_XPSR_STACK_ALIGN)
+    {
+        StackAddr += sizeof(uint32);
+    }
+    Crash.StackAddr = StackAddr;
+    Crash.Cfsr = FAULT_SCB_CFSR;
+    Crash.Hfsr = FAULT_SCB_HFSR;
+    Crash.Mmfar = FAULT_SCB_MMFAR;
+    Crash.Bfar = FAULT_SCB_BFAR;
+    Crash.Time.Year = pTimeAndDate->Year % 100;
+    Crash.Time.Month = pTimeAndDate->Month;
+    Crash.Time.Day = pTimeAndDate->DayOfMonth;
+    Crash.Time.Hour = pTimeAndDate->Hour;
+    Crash.Time.Minute = pTimeAndDate->Minute;
+    Crash.Time.Second = pTimeAndDate->Second;
+    for(Idx = 0; Idx < LOGGER_DEF_CRASH_TASK_NAME_LEN; Idx++)
+    {
+        Crash.TaskName[Idx] = (Idx < DBG_TASK_NAME_LEN)? DBG_TASK_NAME_ADDRESS[Idx]: 0;
+    }
+    Crash.TaskCmd = DBG_TASK_CMD_ADDRESS;
+    Crash.TaskId = DBG_TASK_ID_ADDRESS;
+    
+    /* a corrupted stack pointer gets no stack dump */
+    if(StackAddr >= FAULT_RAM_START_ADDRESS && StackAddr < LAST_HEAP_ADDRESS)
+    {
+        Logger_CrashCaptureApi(&Crash, (uint8*)StackAddr, (uint16)LOGGER_DEF_MIN(LAST_HEAP_ADDRESS - StackAddr, 0xFFFF));
+    }
+    else
+    {
+        Logger_CrashCaptureApi(&Crash, NULL, 0);
+    }
+    Logger_PanicFlushApi();
     while(1);    
 }
 
@@ -45,6 +93,7 @@ extern "C" void HardFaultHandler(uint32 *pHardFaultArgs)
  * </pre>
  *  
  * This function prints (to FLASH, RS232 or socket) the latest crash dump availalble in memory, using the logger module.
+ * The crash capture kept in the FLASH crash area is printed after it (see Logger_CrashPrint).
  *
  * @return none
  *
@@ -74,6 +123,8 @@ void Logger_PrintFaultHandler(void)
         LOG_PRINT(LEVEL_ERROR, "Cmd = 0x%x\r\n", DBG_TASK_CMD_ADDRESS);
     }
     LOG_PRINT(LEVEL_ERROR, "\r\n#########################################\r\n");
+    
+    Logger_CrashPrint();
 }
 
 /**
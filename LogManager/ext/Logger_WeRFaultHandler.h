@@ -13,6 +13,15 @@
 #define DBG_TASK_CMD_ADDRESS        ((unsigned short*)LAST_HEAP_ADDRESS)[16]
 #define DBG_TASK_ID_ADDRESS         ((unsigned char*)LAST_HEAP_ADDRESS)[34]
 #define TIME_AND_DATE_ADDRESS       ((unsigned char*)LAST_HEAP_ADDRESS)[35]
+#define DBG_TASK_NAME_LEN           4           /* the room for the task name in the RAM fault record */
+
+/* the crash capture (see Logger_CrashCaptureApi) */
+#define FAULT_RAM_START_ADDRESS     0x20000000  /* the stack dump is taken only from RAM, below the RAM fault record */
+#define FAULT_XPSR_STACK_ALIGN      (1<<9)      /* the CPU padded the stack to 8 bytes alignment before it pushed the exception frame */
+#define FAULT_SCB_CFSR              (*(volatile unsigned long*)0xE000ED28)
+#define FAULT_SCB_HFSR              (*(volatile unsigned long*)0xE000ED2C)
+#define FAULT_SCB_MMFAR             (*(volatile unsigned long*)0xE000ED34)
+#define FAULT_SCB_BFAR              (*(volatile unsigned long*)0xE000ED38)
 
 #define IS_FAULT_HANDLER()          (MAGIC_ADDRESS == MAGIC_NUM)
 #define RESET_FAULT_HANDLER()       MAGIC_ADDRESS = 0
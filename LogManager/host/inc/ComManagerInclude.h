@@ -0,0 +1,9 @@
+#ifndef __HOST_COM_MANAGER_INCLUDE_H
+#define __HOST_COM_MANAGER_INCLUDE_H
+
+#define COM_MANAGER_SESSION_TYPE_DEBUG          3           /* the debug session (the logger socket) */
+#define COM_MANAGER_OPEN_SOCKET                 1           /* the open socket reply command */
+#define COM_MANAGER_CLOSE_SOCKET                2           /* the close socket reply command */
+#define COM_MANAGER_FUNC_ERR_OK                 0
+
+#endif // __HOST_COM_MANAGER_INCLUDE_H
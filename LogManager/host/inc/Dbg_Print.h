@@ -0,0 +1,7 @@
+#ifndef __HOST_DBG_PRINT_H
+#define __HOST_DBG_PRINT_H
+
+void Dbg_SetTestPoint(uint8 TaskId, uint16 Cmd, uint16 TestPoint, uint32 Param);
+void Dbg_GetFaultTask(uint16 *pCmd, uint8 *pTaskId);
+
+#endif // __HOST_DBG_PRINT_H
@@ -0,0 +1 @@
+#include "Dbg_Print.h"
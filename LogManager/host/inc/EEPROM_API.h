@@ -0,0 +1,11 @@
+/* the host EEPROM model, kept in a file so the NVR parameters survive a restart of the host process */
+#ifndef __HOST_EEPROM_API_H
+#define __HOST_EEPROM_API_H
+
+#define EEPROM_SIZE_BYTES                       0x8000      /* the EEPROM model size */
+
+BOOL EepromReadPoll(uint32 Address, uint8 *pBuff, uint16 Len, uint8 Attr, uint16 PollMS, uint16 TimeoutMS);
+BOOL EepromWritePoll(uint32 Address, uint8 *pBuff, uint16 Len, uint8 Attr, uint16 PollMS, uint16 TimeoutMS);
+BOOL EEPROM_WriteFromInt(uint8 *pBuff, uint16 Len, uint32 Address);
+
+#endif // __HOST_EEPROM_API_H
@@ -0,0 +1,17 @@
+/* the host SPI FLASH model. a RAM array with NOR FLASH semantics: an erase sets a sector to 0xFF and a write can only clear bits */
+#ifndef __HOST_FLASH_API_H
+#define __HOST_FLASH_API_H
+
+#define SSP1                                    0           /* the SPI port of the FLASH */
+#define FLASH_ATTR_USED_FROM_INTERRUPT          (1<<0)      /* the command is queued from an interrupt */
+#define FLASH_TRANSMISSION_QUEUE_FULL           5           /* the FLASH command queue is full */
+
+#define FLASH_SIZE_BYTES                        (1<<20)     /* the FLASH model size */
+#define FLASH_SECTOR_SIZE_BYTES                 (64<<10)    /* the FLASH model sector size */
+#define FLASH_PAGE_SIZE_BYTES                   256         /* a single write does not cross a page, it wraps to the page start */
+
+uint32 FLASH_SectorErase(uint8 Port, uint8 Attr, uint32 Address, uint32 CmdAttr, uint32 *pStatus, void (*pDoneCb)(uint32 Status));
+uint16 FLASH_WriteFromInt(uint8 Port, uint8 *pBuff, uint16 Len, uint32 Address);
+uint32 FLASH_Read(uint8 Port, uint8 *pBuff, uint16 Len, uint8 Attr, uint32 Address, uint32 CmdAttr, uint32 *pStatus, void (*pDoneCb)(uint32 Status));
+
+#endif // __HOST_FLASH_API_H
@@ -0,0 +1,11 @@
+/* the host HW timers. every timer runs on its own thread, its handler is called as an interrupt (see OSAL_HostDisableInterrupts) */
+#ifndef __HOST_HW_TIMER_API_H
+#define __HOST_HW_TIMER_API_H
+
+#define HW_TIMER_MAX_TIMERS                     4           /* the number of HW timers */
+
+void HW_TIMER_Init(uint8 TimerNum, uint32 TickUs, void (*pHandler)(void));
+void HW_TIMER_Start(uint8 TimerNum, uint32 PeriodMS, BOOL IsPeriodic);
+void HW_TIMER_Stop(uint8 TimerNum);
+
+#endif // __HOST_HW_TIMER_API_H
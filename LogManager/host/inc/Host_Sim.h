@@ -0,0 +1,91 @@
+/*--------------------------------------------------------------------------------------
+ * Description: the host simulated peripherals: the SPI FLASH model, the EEPROM file,
+ *              the power loss fault injection, the loopback UDP sink and the RS232 output
+ * -------------------------------------------------------------------------------------*/
+#ifndef __HOST_SIM_H
+#define __HOST_SIM_H
+
+#include <stdio.h>
+#include "Logger_Defs.h"
+
+#define HOST_SIM_DEFAULT_EEPROM_FILE            "logger_eeprom.bin"     /* the default EEPROM file */
+#define HOST_SIM_DEFAULT_UDP_SINK_PORT          LOGGER_CONFIG_DEFAULT_REMOTE_SERVER_PORT
+#define HOST_SIM_DEFAULT_ERASE_TIME_MS          20                      /* the default FLASH sector erase time (shortened, so the logger init is fast) */
+#define HOST_SIM_DEFAULT_PAGE_PROGRAM_US        700                     /* the default FLASH page program time (a typical SPI NOR) */
+#define HOST_SIM_DEFAULT_QUEUE_SIZE             8                       /* the default FLASH command queue depth */
+#define HOST_SIM_LOOPBACK_IP                    "127.0.0.1"
+#define HOST_POWER_OFF_EXIT_CODE                0x50                    /* the exit code of a process that lost its power */
+
+typedef struct {
+    uint32 ReadCnt;                         /* the number of read commands */
+    uint32 ReadBytes;
+    uint32 WriteCnt;                        /* the number of write commands */
+    uint32 WriteBytes;
+    uint32 EraseCnt;                        /* the number of sector erases */
+    uint32 QueueFullCnt;                    /* the commands rejected on a full command queue */
+    uint32 DirtyWriteCnt;                   /* the writes that tried to set programmed bits (written without an erase) */
+    uint32 PartialWriteCnt;                 /* the writes that returned after a part of the data (busy FLASH or injected) */
+}HostFlashStats_t;
+
+/* the FLASH model timing and fault injection */
+typedef struct {
+    uint32 PageProgramUs;                   /* the page program time, every write takes it (a write programs a single page) */
+    uint32 EraseTimeMS;                     /* the sector erase time. a write while an erase is in progress is rejected (0 bytes written) */
+    uint8 QueueSize;                        /* the command queue depth (up to 16) */
+    uint8 PartialWritePercent;              /* the share of the writes that return after a random part of the data */
+    uint8 QueueFullPercent;                 /* the share of the queued commands rejected with FLASH_TRANSMISSION_QUEUE_FULL */
+    uint32 Seed;                            /* the fault injection random seed */
+}HostFlashModel_t;
+
+typedef enum {
+    e_HOST_POWER_OP_NONE,                   /* the power was not lost */
+    e_HOST_POWER_OP_PROGRAM,                /* a FLASH page program */
+    e_HOST_POWER_OP_ERASE,                  /* a FLASH sector erase */
+    e_HOST_POWER_OP_EEPROM,                 /* an EEPROM (NVR parameters) write */
+    e_HOST_POWER_OP_MAX,
+}HostPowerOp_e;
+
+/* where the power was lost */
+typedef struct {
+    uint8 Op;                               /* the interrupted operation (HostPowerOp_e) */
+    uint32 Address;                         /* the operation address */
+    uint32 Len;                             /* the operation length in bytes */
+    uint32 Done;                            /* the bytes the operation completed before the power was lost */
+}HostPowerLoss_t;
+
+typedef struct {
+    uint32 Datagrams;                       /* the number of datagrams the sink received */
+    uint32 Bytes;
+}HostUdpSinkStats_t;
+
+/* SPI FLASH model */
+void HostFlash_GetDefaultModel(HostFlashModel_t *pModel);
+BOOL HostFlash_Init(const HostFlashModel_t *pModel, const char *pImageFile);
+void HostFlash_GetStats(HostFlashStats_t *pStats);
+
+/* power loss fault injection */
+void HostPower_Arm(uint32 OpsLeft, uint32 Seed, HostPowerLoss_t *pReport);
+BOOL HostPower_Consume(uint8 Op, uint32 Address, uint32 Len, uint32 *pDone);
+void HostPower_Off(void);
+
+/* EEPROM file */
+BOOL HostEeprom_Open(const char *pFileName);
+
+/* loopback UDP sink (the debug server) and the logger socket */
+BOOL HostUdp_SinkStart(uint16 Port, FILE *pOutput);
+void HostUdp_SinkGetStats(HostUdpSinkStats_t *pStats);
+BOOL HostUdp_Open(const char *pIp, uint16 Port);
+void HostUdp_Close(void);
+BOOL HostUdp_IsOpened(void);
+BOOL HostUdp_Send(const uint8 *pBuff, uint16 Len);
+
+/* RS232 output */
+void HostUart_SetOutput(FILE *pOutput);
+void HostUart_Write(const char *pStr, uint16 Len);
+
+/* logger start up (the peripherals, the logger tasks and the logger init) */
+BOOL HostLogger_InitPlatform(uint8 MainTaskId, const HostFlashModel_t *pFlashModel, const char *pFlashFile, const char *pEepromFile);
+LoggerConfig_t *HostLogger_NewConfig(uint8 DestType, uint8 Mode);
+BOOL HostLogger_Start(LoggerConfig_t *pConfig, uint8 Attr, uint32 ReadyTimeoutMS);
+
+#endif // __HOST_SIM_H
@@ -0,0 +1,16 @@
+/* the host fault record. the target keeps it in RAM that is not initialized on reset (see ext/Logger_WeRFaultHandler.h),
+   the host keeps it in a static array, so only the crash capture in the FLASH model is printed */
+#ifndef __HOST_FAULT_HANDLER_H
+#define __HOST_FAULT_HANDLER_H
+
+#define MAGIC_NUM                   0x06041978
+#define MAGIC_ADDRESS               gHostFaultRecord[0]
+
+#define IS_FAULT_HANDLER()          (MAGIC_ADDRESS == MAGIC_NUM)
+#define RESET_FAULT_HANDLER()       MAGIC_ADDRESS = 0
+
+extern unsigned long gHostFaultRecord[];
+
+void Logger_PrintFaultHandler(void);
+
+#endif // __HOST_FAULT_HANDLER_H
@@ -0,0 +1,6 @@
+#ifndef __HOST_MESSAGE_MANAGER_API_H
+#define __HOST_MESSAGE_MANAGER_API_H
+
+void OMM_SendMsg(uint8 TaskId, uint16 MsgType, U_CODE_ARGUMENT *pCodeArgs, DEV_TYPE_t DevType, uint8 Dest, uint8 DevTypeId, uint8 Attr);
+
+#endif // __HOST_MESSAGE_MANAGER_API_H
@@ -0,0 +1,15 @@
+#ifndef __HOST_RTC_API_H
+#define __HOST_RTC_API_H
+
+typedef struct {
+    uint16 Year;
+    uint8 Month;
+    uint8 DayOfMonth;
+    uint8 Hour;
+    uint8 Minute;
+    uint8 Second;
+}RTC_Time_t;
+
+void RTC_GetTimeAndDate(RTC_Time_t *pTime);
+
+#endif // __HOST_RTC_API_H
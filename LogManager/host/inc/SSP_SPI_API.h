@@ -0,0 +1 @@
+/* the FLASH SPI port is modeled by FLASH_API.h */
@@ -0,0 +1,7 @@
+#ifndef __HOST_UTIL_H
+#define __HOST_UTIL_H
+
+uint8 num2decstr(uint32 Num, uint8 *pStr, uint8 NumOfDigits);
+char hex2ascii(uint8 Nibble);
+
+#endif // __HOST_UTIL_H
@@ -0,0 +1,6 @@
+#ifndef __HOST_CLOCK_H
+#define __HOST_CLOCK_H
+
+#define CLOCK_BASE_YEAR                         2000
+
+#endif // __HOST_CLOCK_H
@@ -0,0 +1,85 @@
+/* the server messages the logger sends (see MessageManager_Api.h) */
+#ifndef __HOST_MSME_H
+#define __HOST_MSME_H
+
+#define CONTROL_PANEL_TYPE                      1
+#define CONTROL_PANEL_TYPE_ID                   1
+#define MSME_LOGGER_CONFIGURATION_EVENT_MSG     1
+#define MSME_LOGGER_STATUS_EVENT_MSG            2
+#define MSME_LOGGER_TASK_STATS_EVENT_MSG        3
+#define MSME_LOGGER_TOP_SITES_EVENT_MSG         4
+#define MSME_LOGGER_MAX_TOP_SITES               8
+#define MSME_LOGGER_TELEMETRY_EVENT_MSG         5
+#define MSME_MSG_2_SPECIFIC_USER                0
+#define OMM_DONT_SEND_COMPLETION_AFTER_SERVER_ACK   0
+
+typedef struct {
+    uint8 DomainLen;
+    char *pDomainName;
+    uint16 RemotePort;
+}MsmeLoggerSocketConf_t;
+
+typedef union {
+    struct {
+        uint8 VerMajor;
+        uint8 VerMinor;
+        uint8 ConfType;
+        struct {
+            uint8 IsEnabled;
+            uint8 LogLevel;
+            uint32 ModuleMask;
+            uint8 Mode;
+            uint16 FlashSize;
+            uint8 Attributes;
+        }GenConfig;
+        MsmeLoggerSocketConf_t SocketConfig;
+        struct {
+            MsmeLoggerSocketConf_t SocketConf;
+            uint8 UsernameLen;
+            char *pUserName;
+            uint8 PasswordLen;
+            char *pPassword;
+            uint8 PathnameLen;
+            char *pPathname;
+            uint16 FileSize;
+            uint8 Attributes;
+        }FtpConfig;
+    }LoggerCurrConfMsg;
+    struct {
+        uint8 VerMajor;
+        uint8 VerMinor;
+        uint8 Command;
+        uint8 Status;
+        uint8 Description;
+    }LoggerStatusMsg;
+    struct {
+        uint8 VerMajor;
+        uint8 VerMinor;
+        uint8 NumOfTasks;
+        uint32 *pTaskStats;         /* NumOfTasks records of accepted messages, accepted bytes, filtered messages, overrun messages */
+    }LoggerTaskStatsMsg;
+    struct {
+        uint8 VerMajor;
+        uint8 VerMinor;
+        uint8 NumOfSites;
+        uint32 WindowMS;
+        struct {
+            uint32 Hits;
+            uint32 Bytes;
+            uint8 FmtLen;
+            char *pFmt;
+        }Site[MSME_LOGGER_MAX_TOP_SITES];
+    }LoggerTopSitesMsg;
+    struct {
+        uint8 VerMajor;
+        uint8 VerMinor;
+        uint8 Len;
+        uint8 *pRecord;             /* the delta encoded telemetry record (see Logger_SendTelemetryToSrv) */
+    }LoggerTelemetryMsg;
+}U_CODE_ARGUMENT;
+
+typedef struct {
+    uint8 s;
+}DEV_TYPE_t;
+
+#endif // __HOST_MSME_H
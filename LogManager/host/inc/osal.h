@@ -0,0 +1,127 @@
+/*--------------------------------------------------------------------------------------
+ * Description: the host (Linux) OSAL shim. it implements the OSAL services the logger
+ *              uses on top of pthreads: tasks, messages, heap, mutexes and timers
+ * -------------------------------------------------------------------------------------*/
+#ifndef __HOST_OSAL_H
+#define __HOST_OSAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned char       uint8;
+typedef unsigned short      uint16;
+typedef unsigned int        uint32;
+typedef signed char         int8;
+typedef signed short        int16;
+typedef signed int          int32;
+typedef unsigned char       UINT8;
+typedef unsigned char       BOOL;
+
+#ifndef TRUE
+#define TRUE                                    1
+#define FALSE                                   0
+#endif
+
+#define OSAL_STATUS_OK                          0
+#define OSAL_STATUS_ERROR                       1
+
+#define OSAL_MSG_FREE_BY_TARGET                 (1<<0)      /* the target task frees the message input buffer */
+#define OSAL_TIMER_MNG_TIMER_EXPIRE_CMD         0xFF00      /* the OSAL timer expiration command, the timer ID is in the user tag */
+
+#define OSAL_MAX_TASKS                          16          /* the number of task IDs */
+#define OSAL_MAX_TIMERS                         16          /* the number of OSAL timers running at the same time (of all tasks) */
+#define OSAL_TASK_NAME_LEN                      8           /* the task name length including null terminator */
+
+#define OSAL_TASK_EXTRACT_TASK_ID(pTaskId)      ((uint8)(uintptr_t)(pTaskId))
+
+#define OSAL_ASSERT(Cond)                       do { if(!(Cond)) OSAL_AssertFailed(__FILE__, __LINE__); } while(0)
+
+typedef void OSAL_TASK;
+typedef void OSAL_ERROR_HANDLER;
+typedef void *OSAL_MUTEX_HANDLE;
+typedef OSAL_TASK (*OSAL_TaskEntry_t)(void *pTaskId);
+
+/* the task IDs, the logger tasks and the tasks the logger refers to */
+enum {
+    TASK_APP_NONE_ID,
+    TASK_APP_LOGGER_MANAGER_ID,
+    TASK_APP_LOGGER_DRAIN_ID,
+    TASK_APP_COM_MANAGER_ID,
+    TASK_APP_FTP_PUT_MANAGER_ID,
+    TASK_MDL_COMM_STM_RX_MNG_ID,
+    TASK_MDL_ETH_MANAGER_ID,
+    TASK_APP_TEST_MANAGER_ID,
+    TASK_APP_LD1_ID,
+    TASK_APP_LD2_ID,
+    TASK_APP_LD3_ID,
+    TASK_APP_HOST_MAIN_ID,
+    TASK_APP_HOST_APP1_ID,
+    TASK_APP_HOST_APP2_ID,
+    TASK_APP_HOST_APP3_ID,
+    TASK_APP_HOST_APP4_ID,
+};
+
+typedef struct {
+    uint16 cmd;                     /* the command */
+    uint8 src;                      /* the source task ID */
+    uint8 origSrc;                  /* the original source task ID */
+    uint8 dst;                      /* the destination task ID */
+    BOOL reply;                     /* a reply message is sent back to the source task */
+    uint32 status;                  /* the reply status */
+    void *pDataIn;                  /* the input buffer */
+    uint16 DataInLen;               /* the input buffer length */
+    uint8 CntrlBits;                /* OSAL_MSG_XXX control bits */
+    void *pDataOut;                 /* the output buffer */
+    uint16 DataOutLen;              /* the output buffer length */
+    uint32 userTag;                 /* a command parameter */
+}OSAL_Msg;
+
+/* messages */
+OSAL_Msg *OSAL_MsgNew(void);
+void OSAL_MsgFree(OSAL_Msg *pMsg);
+void OSAL_SendMessageToTask(OSAL_Msg *pMsg);
+OSAL_Msg *OSAL_WaitOnMessage(uint8 TaskId);
+
+/* tasks */
+uint8 OSAL_GetSelfTaskId(void);
+void OSAL_GetRunningTaskName(char *pName);
+void OSAL_SuspendTask(uint32 TimeMS);
+void OSAL_TaskDelete(uint8 TaskId);
+uint32 OSAL_GetTickCount(void);
+
+/* heap and strings */
+void *OSAL_HeapAllocBuffer(uint8 TaskId, uint32 Size);
+void OSAL_HeapFreeBuff(uint32 **ppBuff);
+void *OSAL_MemCopy(void *pDst, const void *pSrc, uint32 Len);
+void OSAL_MemSet(void *pDst, uint8 Val, uint32 Len);
+char *OSAL_StrCopy(char *pDst, const char *pSrc, uint32 MaxLen);
+uint32 OSAL_StrLen(const char *pStr, uint32 MaxLen);
+uint8 OSAL_num2decstr(uint32 Num, uint8 *pStr, uint8 NumOfDigits);
+
+/* timers */
+void OSAL_StartTimer(uint16 TimerId, uint32 TimeMS, BOOL IsPeriodic);
+void OSAL_StopTimer(uint16 TimerId);
+
+/* mutexes */
+void OSAL_PortMutexCreate(OSAL_MUTEX_HANDLE *pMutex);
+void OSAL_PortMutexDelete(OSAL_MUTEX_HANDLE Mutex);
+void OSAL_PortMutexCapture(OSAL_MUTEX_HANDLE Mutex);
+void OSAL_PortMutexRelease(OSAL_MUTEX_HANDLE Mutex);
+
+void Printf(const char *pFmt, ...);
+void OSAL_AssertFailed(const char *pFile, int Line);
+
+/* host only services */
+void OSAL_HostInit(void);
+void OSAL_HostTaskRegister(uint8 TaskId, OSAL_TaskEntry_t pEntry, const char *pName);
+void OSAL_HostTaskAttach(uint8 TaskId, const char *pName);
+uint32 OSAL_HostDisableInterrupts(void);
+void OSAL_HostRestoreInterrupts(uint32 IntState);
+void OSAL_HostRunIsr(void (*pHandler)(void));
+uint32 OSAL_HostGetTimeUs(void);
+void OSAL_HostSkipTimeUs(uint32 TimeUs);
+uint32 OSAL_HostGetTimeNs(void);
+
+#include "Logger_Utils.h"
+
+#endif // __HOST_OSAL_H
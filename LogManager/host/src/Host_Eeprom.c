@@ -0,0 +1,108 @@
+/*--------------------------------------------------------------------------------------
+ * Description: the host EEPROM model. the EEPROM is kept in a file, so the logger NVR
+ *              parameters and configuration survive a restart of the host process.
+ *              a new file is blank (0xFF). the writes take part in the power loss
+ *              fault injection.
+ * -------------------------------------------------------------------------------------*/
+#include <string.h>
+#include <pthread.h>
+#include "osal.h"
+#include "EEPROM_API.h"
+#include "Host_Sim.h"
+
+static FILE *gpHostEepromFile;
+static pthread_mutex_t gHostEepromLock = PTHREAD_MUTEX_INITIALIZER;
+
+                /* ========================================== *
+                 *     P R I V A T E     F U N C T I O N S    *
+                 * ========================================== */
+
+static BOOL HostEeprom_Access(uint32 Address, uint8 *pBuff, uint16 Len, BOOL IsWrite)
+{
+    BOOL IsLost = FALSE;
+    uint32 Done;
+    BOOL IsOk;
+
+    if(gpHostEepromFile == NULL || Address + Len > EEPROM_SIZE_BYTES)
+    {
+        OSAL_ASSERT(0);
+        return FALSE;
+    }
+
+    pthread_mutex_lock(&gHostEepromLock);
+    IsOk = (fseek(gpHostEepromFile, Address, SEEK_SET) == 0);
+    if(IsOk && IsWrite)
+    {
+        /* a write interrupted by a power loss writes a part of the data */
+        IsLost = HostPower_Consume(e_HOST_POWER_OP_EEPROM, Address, Len, &Done);
+        IsOk = (fwrite(pBuff, 1, Done, gpHostEepromFile) == Done && fflush(gpHostEepromFile) == 0);
+    }
+    else if(IsOk)
+    {
+        IsOk = (fread(pBuff, 1, Len, gpHostEepromFile) == Len);
+    }
+    if(IsLost)
+    {
+        HostPower_Off();
+    }
+    pthread_mutex_unlock(&gHostEepromLock);
+
+    return IsOk;
+}
+
+                /* ========================================== *
+                 *     P U B L I C     F U N C T I O N S      *
+                 * ========================================== */
+
+/**
+ * <pre>
+ * BOOL HostEeprom_Open(const char *pFileName)
+ * </pre>
+ *
+ * this function opens the EEPROM file. a missing (or short) file is created blank
+ *
+ * @param   pFileName       [in]    the EEPROM file name
+ *
+ * @return TRUE on success or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+BOOL HostEeprom_Open(const char *pFileName)
+{
+    uint8 Blank[256];
+    long Size;
+
+    gpHostEepromFile = fopen(pFileName, "r+b");
+    if(gpHostEepromFile == NULL)
+    {
+        gpHostEepromFile = fopen(pFileName, "w+b");
+    }
+    if(gpHostEepromFile == NULL)
+    {
+        return FALSE;
+    }
+
+    memset(Blank, 0xFF, sizeof(Blank));
+    fseek(gpHostEepromFile, 0, SEEK_END);
+    for(Size = ftell(gpHostEepromFile); Size < EEPROM_SIZE_BYTES; Size += sizeof(Blank))
+    {
+        fwrite(Blank, 1, sizeof(Blank), gpHostEepromFile);
+    }
+    return (fflush(gpHostEepromFile) == 0);
+}
+
+BOOL EepromReadPoll(uint32 Address, uint8 *pBuff, uint16 Len, uint8 Attr, uint16 PollMS, uint16 TimeoutMS)
+{
+    return HostEeprom_Access(Address, pBuff, Len, FALSE);
+}
+
+BOOL EepromWritePoll(uint32 Address, uint8 *pBuff, uint16 Len, uint8 Attr, uint16 PollMS, uint16 TimeoutMS)
+{
+    return HostEeprom_Access(Address, pBuff, Len, TRUE);
+}
+
+BOOL EEPROM_WriteFromInt(uint8 *pBuff, uint16 Len, uint32 Address)
+{
+    return HostEeprom_Access(Address, pBuff, Len, TRUE);
+}
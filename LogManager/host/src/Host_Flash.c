@@ -0,0 +1,418 @@
+/*--------------------------------------------------------------------------------------
+ * Description: the host SPI FLASH model. the FLASH is a RAM array (or a mapped FLASH image
+ *              file, so it survives the process) with NOR FLASH semantics: an erase sets a
+ *              whole sector to 0xFF, a write can only clear bits and wraps at the page end.
+ *              the timing model: a write takes the page program time, the erases and the
+ *              reads with a completion routine are queued to the FLASH thread (the erase
+ *              takes the sector erase time), and the FLASH rejects writes while it erases.
+ *              the fault injection: partial writes, a full command queue and power loss
+ *              (see Host_Power.c).
+ * -------------------------------------------------------------------------------------*/
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <pthread.h>
+#include "osal.h"
+#include "FLASH_API.h"
+#include "Host_Sim.h"
+
+#define HOST_FLASH_MAX_QUEUE_SIZE       16          /* the maximum FLASH command queue depth */
+#define HOST_FLASH_STATUS_PENDING       0xFFFFFFFF  /* the command status until it completes */
+
+typedef enum {
+    e_HOST_FLASH_CMD_READ,
+    e_HOST_FLASH_CMD_ERASE,
+}HostFlashCmd_e;
+
+typedef struct {
+    HostFlashCmd_e Cmd;
+    uint32 Address;
+    uint8 *pBuff;
+    uint16 Len;
+    uint32 *pStatus;
+    void (*pDoneCb)(uint32 Status);
+}HostFlashCmd_t;
+
+typedef struct {
+    uint8 *pMem;                            /* the FLASH array */
+    HostFlashModel_t Model;                 /* the timing and fault injection model */
+    HostFlashCmd_t Queue[HOST_FLASH_MAX_QUEUE_SIZE];
+    uint8 QueueHead;
+    uint8 QueueCnt;
+    BOOL IsErasing;                         /* the FLASH thread is erasing a sector */
+    unsigned int Seed;                      /* the fault injection random state */
+    HostFlashStats_t Stats;
+    pthread_mutex_t Lock;
+    pthread_cond_t Cond;
+    BOOL IsInit;
+}HostFlash_t;
+
+static HostFlash_t gHostFlash = { NULL, {0}, {}, 0, 0, FALSE, 0, {0}, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, FALSE };
+
+                /* ========================================== *
+                 *     P R I V A T E     F U N C T I O N S    *
+                 * ========================================== */
+
+/* returns TRUE for the given share of the calls. it is called with the FLASH lock taken */
+static BOOL HostFlash_Inject(uint8 Percent)
+{
+    return (Percent != 0 && (uint32)rand_r(&gHostFlash.Seed) % 100 < Percent);
+}
+
+static void HostFlash_Read(uint32 Address, uint8 *pBuff, uint16 Len)
+{
+    memcpy(pBuff, &gHostFlash.pMem[Address], Len);
+    gHostFlash.Stats.ReadCnt++;
+    gHostFlash.Stats.ReadBytes += Len;
+}
+
+/**
+ * <pre>
+ * static uint8 *HostFlash_MapImage(const char *pFileName)
+ * </pre>
+ *
+ * this function maps the FLASH image file, so every write reaches the file even if the process loses its power.
+ * a missing (or short) file is created blank
+ *
+ * @param   pFileName       [in]    the FLASH image file name
+ *
+ * @return the FLASH array or NULL on failure
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static uint8 *HostFlash_MapImage(const char *pFileName)
+{
+    uint8 Blank[FLASH_PAGE_SIZE_BYTES];
+    void *pMem;
+    off_t Size;
+    int Fd;
+
+    Fd = open(pFileName, O_RDWR | O_CREAT, 0644);
+    if(Fd < 0)
+    {
+        return NULL;
+    }
+    memset(Blank, 0xFF, sizeof(Blank));
+    for(Size = lseek(Fd, 0, SEEK_END); Size < FLASH_SIZE_BYTES; Size += sizeof(Blank))
+    {
+        if(write(Fd, Blank, sizeof(Blank)) != sizeof(Blank))
+        {
+            close(Fd);
+            return NULL;
+        }
+    }
+    pMem = mmap(NULL, FLASH_SIZE_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+    close(Fd);
+
+    return (pMem != MAP_FAILED)? (uint8 *)pMem: NULL;
+}
+
+static uint32 HostFlash_Queue(HostFlashCmd_e Cmd, uint32 Address, uint8 *pBuff, uint16 Len, uint32 *pStatus, void (*pDoneCb)(uint32 Status))
+{
+    HostFlashCmd_t *pCmd;
+
+    pthread_mutex_lock(&gHostFlash.Lock);
+    if(gHostFlash.QueueCnt == gHostFlash.Model.QueueSize || HostFlash_Inject(gHostFlash.Model.QueueFullPercent))
+    {
+        gHostFlash.Stats.QueueFullCnt++;
+        pthread_mutex_unlock(&gHostFlash.Lock);
+        return FLASH_TRANSMISSION_QUEUE_FULL;
+    }
+    pCmd = &gHostFlash.Queue[(gHostFlash.QueueHead + gHostFlash.QueueCnt++) % HOST_FLASH_MAX_QUEUE_SIZE];
+    pCmd->Cmd = Cmd;
+    pCmd->Address = Address;
+    pCmd->pBuff = pBuff;
+    pCmd->Len = Len;
+    pCmd->pStatus = pStatus;
+    pCmd->pDoneCb = pDoneCb;
+    if(pStatus != NULL)
+    {
+        *pStatus = HOST_FLASH_STATUS_PENDING;
+    }
+    pthread_cond_signal(&gHostFlash.Cond);
+    pthread_mutex_unlock(&gHostFlash.Lock);
+
+    return OSAL_STATUS_OK;
+}
+
+/**
+ * <pre>
+ * static void HostFlash_Erase(uint32 Address)
+ * </pre>
+ *
+ * this function erases a sector, it is called by the FLASH thread with the FLASH lock taken. the FLASH is busy 
+ * for the erase time. an erase interrupted by a power loss erases a part of the sector, the rest is left as it was
+ *
+ * @param   Address     [in]    the sector address
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void HostFlash_Erase(uint32 Address)
+{
+    uint32 Done;
+    BOOL IsLost;
+
+    gHostFlash.IsErasing = TRUE;
+    pthread_mutex_unlock(&gHostFlash.Lock);
+    OSAL_SuspendTask(gHostFlash.Model.EraseTimeMS);
+    pthread_mutex_lock(&gHostFlash.Lock);
+
+    IsLost = HostPower_Consume(e_HOST_POWER_OP_ERASE, Address, FLASH_SECTOR_SIZE_BYTES, &Done);
+    memset(&gHostFlash.pMem[Address], 0xFF, Done);
+    if(IsLost)
+    {
+        HostPower_Off();
+    }
+    gHostFlash.IsErasing = FALSE;
+    gHostFlash.Stats.EraseCnt++;
+}
+
+/**
+ * <pre>
+ * static void *HostFlash_Thread(void *pArg)
+ * </pre>
+ *
+ * this function is the FLASH thread. it executes the queued commands in order and calls their completion routines
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void *HostFlash_Thread(void *pArg)
+{
+    HostFlashCmd_t Cmd;
+
+    pthread_mutex_lock(&gHostFlash.Lock);
+    while(TRUE)
+    {
+        while(gHostFlash.QueueCnt == 0)
+        {
+            pthread_cond_wait(&gHostFlash.Cond, &gHostFlash.Lock);
+        }
+        Cmd = gHostFlash.Queue[gHostFlash.QueueHead];
+
+        if(Cmd.Cmd == e_HOST_FLASH_CMD_ERASE)
+        {
+            HostFlash_Erase(Cmd.Address);
+        }
+        else
+        {
+            HostFlash_Read(Cmd.Address, Cmd.pBuff, Cmd.Len);
+        }
+        gHostFlash.QueueHead = (gHostFlash.QueueHead + 1) % HOST_FLASH_MAX_QUEUE_SIZE;
+        gHostFlash.QueueCnt--;
+        if(Cmd.pStatus != NULL)
+        {
+            *Cmd.pStatus = OSAL_STATUS_OK;
+        }
+
+        if(Cmd.pDoneCb != NULL)
+        {
+            pthread_mutex_unlock(&gHostFlash.Lock);
+            Cmd.pDoneCb(OSAL_STATUS_OK);
+            pthread_mutex_lock(&gHostFlash.Lock);
+        }
+    }
+    return NULL;
+}
+
+                /* ========================================== *
+                 *     P U B L I C     F U N C T I O N S      *
+                 * ========================================== */
+
+/**
+ * <pre>
+ * void HostFlash_GetDefaultModel(HostFlashModel_t *pModel)
+ * </pre>
+ *
+ * this function gets the default FLASH model: the default timing, no fault injection
+ *
+ * @param   pModel      [out]   the FLASH model
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void HostFlash_GetDefaultModel(HostFlashModel_t *pModel)
+{
+    pModel->PageProgramUs = HOST_SIM_DEFAULT_PAGE_PROGRAM_US;
+    pModel->EraseTimeMS = HOST_SIM_DEFAULT_ERASE_TIME_MS;
+    pModel->QueueSize = HOST_SIM_DEFAULT_QUEUE_SIZE;
+    pModel->PartialWritePercent = 0;
+    pModel->QueueFullPercent = 0;
+    pModel->Seed = 1;
+}
+
+/**
+ * <pre>
+ * BOOL HostFlash_Init(const HostFlashModel_t *pModel, const char *pImageFile)
+ * </pre>
+ *
+ * this function initializes the FLASH model. without an image file the whole FLASH is erased
+ *
+ * @param   pModel          [in]    Optional. the timing and fault injection model, NULL for the default model
+ * @param   pImageFile      [in]    Optional. the FLASH image file, NULL to keep the FLASH in RAM
+ *
+ * @return TRUE on success or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+BOOL HostFlash_Init(const HostFlashModel_t *pModel, const char *pImageFile)
+{
+    pthread_t Thread;
+
+    if(pModel != NULL)
+    {
+        gHostFlash.Model = *pModel;
+    }
+    else
+    {
+        HostFlash_GetDefaultModel(&gHostFlash.Model);
+    }
+    if(gHostFlash.Model.QueueSize == 0 || gHostFlash.Model.QueueSize > HOST_FLASH_MAX_QUEUE_SIZE)
+    {
+        gHostFlash.Model.QueueSize = HOST_FLASH_MAX_QUEUE_SIZE;
+    }
+    gHostFlash.Seed = gHostFlash.Model.Seed;
+
+    if(gHostFlash.pMem == NULL && pImageFile != NULL)
+    {
+        gHostFlash.pMem = HostFlash_MapImage(pImageFile);
+    }
+    else if(gHostFlash.pMem == NULL)
+    {
+        gHostFlash.pMem = (uint8 *)malloc(FLASH_SIZE_BYTES);
+        if(gHostFlash.pMem != NULL)
+        {
+            memset(gHostFlash.pMem, 0xFF, FLASH_SIZE_BYTES);
+        }
+    }
+    if(gHostFlash.pMem == NULL)
+    {
+        return FALSE;
+    }
+    if(!gHostFlash.IsInit)
+    {
+        pthread_create(&Thread, NULL, HostFlash_Thread, NULL);
+        pthread_detach(Thread);
+        gHostFlash.IsInit = TRUE;
+    }
+    return TRUE;
+}
+
+void HostFlash_GetStats(HostFlashStats_t *pStats)
+{
+    pthread_mutex_lock(&gHostFlash.Lock);
+    *pStats = gHostFlash.Stats;
+    pthread_mutex_unlock(&gHostFlash.Lock);
+}
+
+uint32 FLASH_SectorErase(uint8 Port, uint8 Attr, uint32 Address, uint32 CmdAttr, uint32 *pStatus, void (*pDoneCb)(uint32 Status))
+{
+    if(Address >= FLASH_SIZE_BYTES)
+    {
+        OSAL_ASSERT(0);
+        return OSAL_STATUS_ERROR;
+    }
+    return HostFlash_Queue(e_HOST_FLASH_CMD_ERASE, Address & ~(FLASH_SECTOR_SIZE_BYTES - 1), NULL, 0, pStatus, pDoneCb);
+}
+
+/**
+ * <pre>
+ * uint16 FLASH_WriteFromInt(uint8 Port, uint8 *pBuff, uint16 Len, uint32 Address)
+ * </pre>
+ *
+ * this function programs the FLASH. like a SPI FLASH page program, a write that crosses a page end wraps to the page start.
+ * the write returns after the page program time. it writes nothing while a sector is erased, and a part of the data
+ * on an injected partial write
+ *
+ * @return the number of bytes written
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+uint16 FLASH_WriteFromInt(uint8 Port, uint8 *pBuff, uint16 Len, uint32 Address)
+{
+    uint32 PageAddr = Address & ~(FLASH_PAGE_SIZE_BYTES - 1);
+    uint16 Offset = Address & (FLASH_PAGE_SIZE_BYTES - 1);
+    uint32 Done;
+    uint16 Idx;
+    uint8 *pByte;
+    BOOL IsLost;
+
+    if(Address + Len > FLASH_SIZE_BYTES)
+    {
+        OSAL_ASSERT(0);
+        return 0;
+    }
+
+    pthread_mutex_lock(&gHostFlash.Lock);
+    if(gHostFlash.IsErasing || (Len > 0 && HostFlash_Inject(gHostFlash.Model.PartialWritePercent)))
+    {
+        Len = gHostFlash.IsErasing? 0: (uint32)rand_r(&gHostFlash.Seed) % Len;
+        gHostFlash.Stats.PartialWriteCnt++;
+    }
+    IsLost = HostPower_Consume(e_HOST_POWER_OP_PROGRAM, Address, Len, &Done);
+    for(Idx = 0; Idx < Done; Idx++)
+    {
+        pByte = &gHostFlash.pMem[PageAddr + (Offset + Idx) % FLASH_PAGE_SIZE_BYTES];
+        if((*pByte & pBuff[Idx]) != pBuff[Idx])
+        {
+            gHostFlash.Stats.DirtyWriteCnt++;
+        }
+        *pByte &= pBuff[Idx];
+    }
+    if(IsLost)
+    {
+        HostPower_Off();
+    }
+    gHostFlash.Stats.WriteCnt++;
+    gHostFlash.Stats.WriteBytes += Len;
+    pthread_mutex_unlock(&gHostFlash.Lock);
+
+    if(Len > 0)
+    {
+        usleep(gHostFlash.Model.PageProgramUs);
+    }
+    return Len;
+}
+
+/**
+ * <pre>
+ * uint32 FLASH_Read(uint8 Port, uint8 *pBuff, uint16 Len, uint8 Attr, uint32 Address, uint32 CmdAttr, uint32 *pStatus, void (*pDoneCb)(uint32 Status))
+ * </pre>
+ *
+ * this function reads the FLASH. a read with a completion routine is queued behind the pending erases,
+ * a polled read completes right away
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+uint32 FLASH_Read(uint8 Port, uint8 *pBuff, uint16 Len, uint8 Attr, uint32 Address, uint32 CmdAttr, uint32 *pStatus, void (*pDoneCb)(uint32 Status))
+{
+    if(Address + Len > FLASH_SIZE_BYTES)
+    {
+        OSAL_ASSERT(0);
+        return OSAL_STATUS_ERROR;
+    }
+    if(pDoneCb != NULL)
+    {
+        return HostFlash_Queue(e_HOST_FLASH_CMD_READ, Address, pBuff, Len, pStatus, pDoneCb);
+    }
+
+    pthread_mutex_lock(&gHostFlash.Lock);
+    HostFlash_Read(Address, pBuff, Len);
+    pthread_mutex_unlock(&gHostFlash.Lock);
+    if(pStatus != NULL)
+    {
+        *pStatus = OSAL_STATUS_OK;
+    }
+    return OSAL_STATUS_OK;
+}
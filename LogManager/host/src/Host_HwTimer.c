@@ -0,0 +1,155 @@
+/*--------------------------------------------------------------------------------------
+ * Description: the host HW timers. every timer runs on its own thread and calls its
+ *              handler as an interrupt (with the modeled interrupts disabled)
+ * -------------------------------------------------------------------------------------*/
+#include <time.h>
+#include <pthread.h>
+#include "osal.h"
+#include "HW_TIMER_API.h"
+
+typedef struct {
+    void (*pHandler)(void);                 /* the interrupt handler */
+    pthread_t Thread;
+    pthread_cond_t Cond;                    /* signaled when the timer is started or stopped */
+    BOOL IsInit;
+    BOOL IsRunning;
+    BOOL IsPeriodic;
+    uint32 PeriodUs;
+    uint64_t NextUs;                        /* the next expiration time (monotonic clock) */
+}HostHwTimer_t;
+
+static pthread_mutex_t gHostHwTimerLock = PTHREAD_MUTEX_INITIALIZER;
+static HostHwTimer_t gHostHwTimer[HW_TIMER_MAX_TIMERS];
+
+                /* ========================================== *
+                 *     P R I V A T E     F U N C T I O N S    *
+                 * ========================================== */
+
+static uint64_t Host_HwTimerNowUs(void)
+{
+    struct timespec Now;
+
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+    return (uint64_t)Now.tv_sec * 1000000 + Now.tv_nsec / 1000;
+}
+
+/**
+ * <pre>
+ * static void *Host_HwTimerThread(void *pArg)
+ * </pre>
+ *
+ * this function is the HW timer thread. a late expiration is not made up for, the next period starts from now
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void *Host_HwTimerThread(void *pArg)
+{
+    HostHwTimer_t *pTimer = &gHostHwTimer[(uintptr_t)pArg];
+    struct timespec Deadline;
+    uint64_t NowUs;
+
+    pthread_mutex_lock(&gHostHwTimerLock);
+    while(TRUE)
+    {
+        if(!pTimer->IsRunning)
+        {
+            pthread_cond_wait(&pTimer->Cond, &gHostHwTimerLock);
+            continue;
+        }
+        NowUs = Host_HwTimerNowUs();
+        if(NowUs < pTimer->NextUs)
+        {
+            Deadline.tv_sec = pTimer->NextUs / 1000000;
+            Deadline.tv_nsec = (pTimer->NextUs % 1000000) * 1000;
+            pthread_cond_timedwait(&pTimer->Cond, &gHostHwTimerLock, &Deadline);
+            continue;
+        }
+
+        if(pTimer->IsPeriodic)
+        {
+            pTimer->NextUs += pTimer->PeriodUs;
+            if(pTimer->NextUs <= NowUs)
+            {
+                pTimer->NextUs = NowUs + pTimer->PeriodUs;
+            }
+        }
+        else
+        {
+            pTimer->IsRunning = FALSE;
+        }
+        /* the handler may start or stop the timer */
+        pthread_mutex_unlock(&gHostHwTimerLock);
+        OSAL_HostRunIsr(pTimer->pHandler);
+        pthread_mutex_lock(&gHostHwTimerLock);
+    }
+    return NULL;
+}
+
+                /* ========================================== *
+                 *     P U B L I C     F U N C T I O N S      *
+                 * ========================================== */
+
+/**
+ * <pre>
+ * void HW_TIMER_Init(uint8 TimerNum, uint32 TickUs, void (*pHandler)(void))
+ * </pre>
+ *
+ * this function initializes a HW timer and its interrupt handler. the timer is stopped
+ *
+ * @param   TimerNum    [in]    the timer number
+ * @param   TickUs      [in]    the timer tick in us (the host timers count in us)
+ * @param   pHandler    [in]    the interrupt handler
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void HW_TIMER_Init(uint8 TimerNum, uint32 TickUs, void (*pHandler)(void))
+{
+    HostHwTimer_t *pTimer = &gHostHwTimer[TimerNum];
+    pthread_condattr_t Attr;
+
+    OSAL_ASSERT(TimerNum < HW_TIMER_MAX_TIMERS);
+
+    pthread_mutex_lock(&gHostHwTimerLock);
+    pTimer->pHandler = pHandler;
+    pTimer->IsRunning = FALSE;
+    if(!pTimer->IsInit)
+    {
+        pthread_condattr_init(&Attr);
+        pthread_condattr_setclock(&Attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&pTimer->Cond, &Attr);
+        pthread_condattr_destroy(&Attr);
+        pthread_create(&pTimer->Thread, NULL, Host_HwTimerThread, (void *)(uintptr_t)TimerNum);
+        pthread_detach(pTimer->Thread);
+        pTimer->IsInit = TRUE;
+    }
+    pthread_mutex_unlock(&gHostHwTimerLock);
+}
+
+void HW_TIMER_Start(uint8 TimerNum, uint32 PeriodMS, BOOL IsPeriodic)
+{
+    HostHwTimer_t *pTimer = &gHostHwTimer[TimerNum];
+
+    OSAL_ASSERT(TimerNum < HW_TIMER_MAX_TIMERS && pTimer->IsInit);
+
+    pthread_mutex_lock(&gHostHwTimerLock);
+    pTimer->PeriodUs = PeriodMS * 1000;
+    pTimer->IsPeriodic = IsPeriodic;
+    pTimer->NextUs = Host_HwTimerNowUs() + pTimer->PeriodUs;
+    pTimer->IsRunning = TRUE;
+    pthread_cond_signal(&pTimer->Cond);
+    pthread_mutex_unlock(&gHostHwTimerLock);
+}
+
+void HW_TIMER_Stop(uint8 TimerNum)
+{
+    HostHwTimer_t *pTimer = &gHostHwTimer[TimerNum];
+
+    pthread_mutex_lock(&gHostHwTimerLock);
+    pTimer->IsRunning = FALSE;
+    pthread_cond_signal(&pTimer->Cond);
+    pthread_mutex_unlock(&gHostHwTimerLock);
+}
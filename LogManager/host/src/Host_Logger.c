@@ -0,0 +1,127 @@
+/*--------------------------------------------------------------------------------------
+ * Description: the host logger start up, shared by the host programs (the demo, the
+ *              benchmark and the power loss test): it starts the simulated peripherals
+ *              and the logger tasks and initializes the logger.
+ * -------------------------------------------------------------------------------------*/
+#include "Logger_Defs.h"
+#include "Logger_Api.h"
+#include "Host_Sim.h"
+
+OSAL_TASK LogManagerTask( void * pTaskId );
+OSAL_TASK LogDrainTask( void * pTaskId );
+
+                /* ========================================== *
+                 *     P U B L I C     F U N C T I O N S      *
+                 * ========================================== */
+
+/**
+ * <pre>
+ * BOOL HostLogger_InitPlatform(uint8 MainTaskId, const HostFlashModel_t *pFlashModel, const char *pFlashFile, const char *pEepromFile)
+ * </pre>
+ *  
+ * this function starts the simulated peripherals (and the loopback UDP sink) and the logger tasks, and attaches 
+ * the calling thread to an OSAL task ID
+ *
+ * @param   MainTaskId      [in]    the task ID of the calling thread (the log messages it prints are tagged with it)
+ * @param   pFlashModel     [in]    Optional. the FLASH timing and fault injection model, NULL for the default model
+ * @param   pFlashFile      [in]    Optional. the FLASH image file, NULL to keep the FLASH in RAM
+ * @param   pEepromFile     [in]    the EEPROM file
+ *
+ * @return TRUE on success or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+BOOL HostLogger_InitPlatform(uint8 MainTaskId, const HostFlashModel_t *pFlashModel, const char *pFlashFile, const char *pEepromFile)
+{
+    OSAL_HostInit();
+    if(!HostFlash_Init(pFlashModel, pFlashFile) || !HostEeprom_Open(pEepromFile) || 
+       !HostUdp_SinkStart(HOST_SIM_DEFAULT_UDP_SINK_PORT, NULL))
+    {
+        Printf("host peripherals init failed\n");
+        return FALSE;
+    }
+
+    OSAL_HostTaskRegister(TASK_APP_LOGGER_MANAGER_ID, LogManagerTask, "LOGGER");
+    OSAL_HostTaskRegister(TASK_APP_LOGGER_DRAIN_ID, LogDrainTask, "DRAIN");
+    OSAL_HostTaskAttach(MainTaskId, "MAIN");
+    return TRUE;
+}
+
+/**
+ * <pre>
+ * LoggerConfig_t *HostLogger_NewConfig(uint8 DestType, uint8 Mode)
+ * </pre>
+ *  
+ * this function allocates the host logger configuration: the loopback UDP sink is the remote server, no RS232 printout.
+ * the logger task frees it
+ *
+ * @param   DestType    [in]    the logger destination (LOGGER_DEST_TYPE_XXX)
+ * @param   Mode        [in]    the logger mode (LOGGER_MODE_TYPE_XXX)
+ *
+ * @return the logger configuration
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+LoggerConfig_t *HostLogger_NewConfig(uint8 DestType, uint8 Mode)
+{
+    LoggerConfig_t *pConfig = (LoggerConfig_t *)OSAL_HeapAllocBuffer(OSAL_GetSelfTaskId(), sizeof(LoggerConfig_t));
+
+    OSAL_MemSet(pConfig, 0, sizeof(LoggerConfig_t));
+    pConfig->General.IsEnabled = TRUE;
+    pConfig->General.IsPrintoutEnabled = FALSE;
+    pConfig->General.Attributes = LOGGER_CONFIG_DEFAULT_ATTRIBUTES;
+    pConfig->General.DestType = DestType;
+    pConfig->General.Mode = Mode;
+    pConfig->General.LogLevel = LEVEL_FLOW;
+    pConfig->General.ResolutionMS = LOGGER_CONFIG_DEFAULT_RESOLUTION_MS;
+    pConfig->General.FlashSize = LOGGER_CONFIG_DEFAULT_FLASH_SIZE;
+    pConfig->General.ModuleMask = LOGGER_MASK_NO_TASK;
+
+    OSAL_StrCopy(pConfig->Socket.DomainNameIp, HOST_SIM_LOOPBACK_IP, LOGGER_CONFIG_SOCKET_MAX_IP_LEN);
+    pConfig->Socket.DomainNameLen = OSAL_StrLen(HOST_SIM_LOOPBACK_IP, LOGGER_CONFIG_SOCKET_MAX_IP_LEN);
+    pConfig->Socket.RemotePort = HOST_SIM_DEFAULT_UDP_SINK_PORT;
+    pConfig->Socket.LocalPort = LOGGER_CONFIG_DEFAULT_LOCAL_PORT;
+    pConfig->Socket.SocketType = LOGGER_SOCKET_TYPE_UDP;
+
+    OSAL_StrCopy(pConfig->Ftp.Username, LOGGER_CONFIG_DEFAULT_FTP_USERNAME, LOGGER_CONFIG_FTP_MAX_USER_NAME_LEN);
+    OSAL_StrCopy(pConfig->Ftp.Password, LOGGER_CONFIG_DEFAULT_FTP_PASSWORD, LOGGER_CONFIG_FTP_MAX_PASSWORD_LEN);
+    OSAL_StrCopy(pConfig->Ftp.Path, LOGGER_CONFIG_DEFAULT_FTP_PATH, LOGGER_CONFIG_FTP_MAX_PATH_LEN);
+    pConfig->Ftp.FileSize = LOGGER_CONFIG_DEFAULT_FILE_SIZE_KB;
+
+    return pConfig;
+}
+
+/**
+ * <pre>
+ * BOOL HostLogger_Start(LoggerConfig_t *pConfig, uint8 Attr, uint32 ReadyTimeoutMS)
+ * </pre>
+ *  
+ * this function initializes the logger and waits for the logger to get ready
+ *
+ * @param   pConfig         [in]    the logger configuration (see HostLogger_NewConfig), the logger task frees it
+ * @param   Attr            [in]    the logger init attributes (e.g. LOGGER_ATTR_ERASE_FLASH_NOW)
+ * @param   ReadyTimeoutMS  [in]    the maximum time to wait for the logger init
+ *
+ * @return TRUE once the logger is ready or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+BOOL HostLogger_Start(LoggerConfig_t *pConfig, uint8 Attr, uint32 ReadyTimeoutMS)
+{
+    uint32 Idx;
+
+    Logger_InitApi(pConfig, Attr);
+    for(Idx = 0; !Logger_IsReady() && Idx < ReadyTimeoutMS; Idx++)
+    {
+        OSAL_SuspendTask(1);
+    }
+    if(!Logger_IsReady())
+    {
+        Printf("logger init timeout\n");
+        return FALSE;
+    }
+    return TRUE;
+}
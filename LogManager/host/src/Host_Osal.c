@@ -0,0 +1,690 @@
+/*--------------------------------------------------------------------------------------
+ * Description: the host (Linux) OSAL shim on top of pthreads.
+ *              every task runs on its own thread, it is started by the first message sent to it
+ *              (like the target OSAL) and ends with OSAL_TaskDelete. threads that are not OSAL
+ *              tasks (the host main) are attached to a task ID with OSAL_HostTaskAttach.
+ *              the interrupts are modeled by a single recursive lock: an interrupt handler
+ *              (see Host_HwTimer.c) runs with the lock taken, and disabling the interrupts takes it.
+ * -------------------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "osal.h"
+
+#define HOST_OSAL_ISR_TASK_NAME         "ISR"
+#define HOST_OSAL_NO_TASK_NAME          "HOST"
+
+/* the OSAL message and its task queue link */
+typedef struct HostMsg_s {
+    OSAL_Msg Msg;
+    struct HostMsg_s *pNext;
+}HostMsg_t;
+
+typedef struct {
+    OSAL_TaskEntry_t pEntry;                /* the task entry (NULL for an attached thread) */
+    char Name[OSAL_TASK_NAME_LEN];          /* the task name */
+    HostMsg_t *pHead;                       /* the task message queue */
+    HostMsg_t *pTail;
+    pthread_cond_t Cond;                    /* signaled on a new message */
+    BOOL IsRunning;                         /* a thread runs the task */
+    BOOL IsAttached;                        /* the task runs on a thread that is not an OSAL task */
+}HostTask_t;
+
+typedef struct {
+    uint8 TaskId;                           /* the task the expiration message is sent to */
+    uint16 TimerId;                         /* the timer ID, sent in the message user tag */
+    BOOL IsUsed;
+    uint32 PeriodMS;                        /* the period of a periodic timer, 0 for a single shot timer */
+    uint64_t ExpiryUs;                      /* the expiration time (OSAL_HostTimeUs) */
+}HostTimer_t;
+
+static pthread_mutex_t gHostOsalLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t gHostIntLock;
+static pthread_cond_t gHostTimerCond;
+static HostTask_t gHostTask[OSAL_MAX_TASKS];
+static HostTimer_t gHostTimer[OSAL_MAX_TIMERS];
+static uint64_t gHostStartUs;
+static volatile uint32 gHostSkippedUs;      /* the simulated time added to OSAL_HostGetTimeUs (OSAL_HostSkipTimeUs) */
+static __thread uint8 gHostSelfTaskId;
+static __thread BOOL gHostIsIsr;
+
+                /* ========================================== *
+                 *     P R I V A T E     F U N C T I O N S    *
+                 * ========================================== */
+
+static uint64_t Host_MonotonicUs(void)
+{
+    struct timespec Now;
+
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+    return (uint64_t)Now.tv_sec * 1000000 + Now.tv_nsec / 1000;
+}
+
+static void Host_UsToTimespec(uint64_t Us, struct timespec *pTime)
+{
+    pTime->tv_sec = Us / 1000000;
+    pTime->tv_nsec = (Us % 1000000) * 1000;
+}
+
+static void Host_CondInit(pthread_cond_t *pCond)
+{
+    pthread_condattr_t Attr;
+
+    pthread_condattr_init(&Attr);
+    pthread_condattr_setclock(&Attr, CLOCK_MONOTONIC);
+    pthread_cond_init(pCond, &Attr);
+    pthread_condattr_destroy(&Attr);
+}
+
+static void *Host_TaskThread(void *pArg)
+{
+    uint8 TaskId = (uint8)(uintptr_t)pArg;
+
+    gHostSelfTaskId = TaskId;
+    gHostTask[TaskId].pEntry(pArg);
+
+    /* the task entry returned without deleting the task */
+    OSAL_TaskDelete(TaskId);
+    return NULL;
+}
+
+/**
+ * <pre>
+ * static void Host_TaskStart(uint8 TaskId)
+ * </pre>
+ *
+ * this function starts a task thread. it is called with the OSAL lock taken
+ *
+ * @param   TaskId      [in]    the task ID
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Host_TaskStart(uint8 TaskId)
+{
+    pthread_t Thread;
+    pthread_attr_t Attr;
+
+    pthread_attr_init(&Attr);
+    pthread_attr_setdetachstate(&Attr, PTHREAD_CREATE_DETACHED);
+    if(pthread_create(&Thread, &Attr, Host_TaskThread, (void *)(uintptr_t)TaskId) == 0)
+    {
+        gHostTask[TaskId].IsRunning = TRUE;
+    }
+    pthread_attr_destroy(&Attr);
+}
+
+/**
+ * <pre>
+ * static void *Host_TimerThread(void *pArg)
+ * </pre>
+ *
+ * this function is the OSAL timer manager thread. it sends the expiration messages of the OSAL timers
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void *Host_TimerThread(void *pArg)
+{
+    struct timespec Deadline;
+    HostTimer_t *pNext;
+    OSAL_Msg *pMsg;
+    uint64_t NowUs;
+    uint8 Idx;
+
+    pthread_mutex_lock(&gHostOsalLock);
+    while(TRUE)
+    {
+        pNext = NULL;
+        for(Idx = 0; Idx < OSAL_MAX_TIMERS; Idx++)
+        {
+            if(gHostTimer[Idx].IsUsed && (pNext == NULL || gHostTimer[Idx].ExpiryUs < pNext->ExpiryUs))
+            {
+                pNext = &gHostTimer[Idx];
+            }
+        }
+        if(pNext == NULL)
+        {
+            pthread_cond_wait(&gHostTimerCond, &gHostOsalLock);
+            continue;
+        }
+        NowUs = Host_MonotonicUs() - gHostStartUs;
+        if(NowUs < pNext->ExpiryUs)
+        {
+            Host_UsToTimespec(gHostStartUs + pNext->ExpiryUs, &Deadline);
+            pthread_cond_timedwait(&gHostTimerCond, &gHostOsalLock, &Deadline);
+            continue;
+        }
+
+        pMsg = OSAL_MsgNew();
+        pMsg->cmd = OSAL_TIMER_MNG_TIMER_EXPIRE_CMD;
+        pMsg->src = pMsg->origSrc = pMsg->dst = pNext->TaskId;
+        pMsg->userTag = pNext->TimerId;
+        if(pNext->PeriodMS)
+        {
+            pNext->ExpiryUs += (uint64_t)pNext->PeriodMS * 1000;
+        }
+        else
+        {
+            pNext->IsUsed = FALSE;
+        }
+        pthread_mutex_unlock(&gHostOsalLock);
+        OSAL_SendMessageToTask(pMsg);
+        pthread_mutex_lock(&gHostOsalLock);
+    }
+    return NULL;
+}
+
+                /* ========================================== *
+                 *     P U B L I C     F U N C T I O N S      *
+                 * ========================================== */
+
+/**
+ * <pre>
+ * void OSAL_HostInit(void)
+ * </pre>
+ *
+ * this function initializes the host OSAL. it should be called once, before any other OSAL service
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void OSAL_HostInit(void)
+{
+    pthread_mutexattr_t Attr;
+    pthread_t Thread;
+    uint8 Idx;
+
+    gHostStartUs = Host_MonotonicUs();
+
+    pthread_mutexattr_init(&Attr);
+    pthread_mutexattr_settype(&Attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&gHostIntLock, &Attr);
+    pthread_mutexattr_destroy(&Attr);
+
+    for(Idx = 0; Idx < OSAL_MAX_TASKS; Idx++)
+    {
+        Host_CondInit(&gHostTask[Idx].Cond);
+    }
+    Host_CondInit(&gHostTimerCond);
+
+    pthread_create(&Thread, NULL, Host_TimerThread, NULL);
+    pthread_detach(Thread);
+}
+
+/**
+ * <pre>
+ * void OSAL_HostTaskRegister(uint8 TaskId, OSAL_TaskEntry_t pEntry, const char *pName)
+ * </pre>
+ *
+ * this function registers a task entry. the task thread is started by the first message sent to the task
+ *
+ * @param   TaskId      [in]    the task ID
+ * @param   pEntry      [in]    the task entry
+ * @param   pName       [in]    the task name
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void OSAL_HostTaskRegister(uint8 TaskId, OSAL_TaskEntry_t pEntry, const char *pName)
+{
+    OSAL_ASSERT(TaskId < OSAL_MAX_TASKS);
+
+    pthread_mutex_lock(&gHostOsalLock);
+    gHostTask[TaskId].pEntry = pEntry;
+    strncpy(gHostTask[TaskId].Name, pName, OSAL_TASK_NAME_LEN - 1);
+    pthread_mutex_unlock(&gHostOsalLock);
+}
+
+/**
+ * <pre>
+ * void OSAL_HostTaskAttach(uint8 TaskId, const char *pName)
+ * </pre>
+ *
+ * this function attaches the calling thread to a task ID, so it can send (and wait on) OSAL messages and print logs
+ *
+ * @param   TaskId      [in]    the task ID
+ * @param   pName       [in]    the task name
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void OSAL_HostTaskAttach(uint8 TaskId, const char *pName)
+{
+    OSAL_ASSERT(TaskId < OSAL_MAX_TASKS);
+
+    pthread_mutex_lock(&gHostOsalLock);
+    gHostTask[TaskId].IsAttached = gHostTask[TaskId].IsRunning = TRUE;
+    strncpy(gHostTask[TaskId].Name, pName, OSAL_TASK_NAME_LEN - 1);
+    pthread_mutex_unlock(&gHostOsalLock);
+    gHostSelfTaskId = TaskId;
+}
+
+/**
+ * <pre>
+ * uint32 OSAL_HostDisableInterrupts(void)
+ * </pre>
+ *
+ * this function disables the (modeled) interrupts. the host interrupt handlers do not run until they are restored
+ *
+ * @return the previous interrupts state
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+uint32 OSAL_HostDisableInterrupts(void)
+{
+    pthread_mutex_lock(&gHostIntLock);
+    return 0;
+}
+
+void OSAL_HostRestoreInterrupts(uint32 IntState)
+{
+    pthread_mutex_unlock(&gHostIntLock);
+}
+
+/**
+ * <pre>
+ * void OSAL_HostRunIsr(void (*pHandler)(void))
+ * </pre>
+ *
+ * this function runs an interrupt handler with the interrupts disabled
+ *
+ * @param   pHandler    [in]    the interrupt handler
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void OSAL_HostRunIsr(void (*pHandler)(void))
+{
+    gHostIsIsr = TRUE;
+    pthread_mutex_lock(&gHostIntLock);
+    pHandler();
+    pthread_mutex_unlock(&gHostIntLock);
+}
+
+uint32 OSAL_HostGetTimeUs(void)
+{
+    return (uint32)(Host_MonotonicUs() - gHostStartUs) + gHostSkippedUs;
+}
+
+/**
+ * <pre>
+ * void OSAL_HostSkipTimeUs(uint32 TimeUs)
+ * </pre>
+ *
+ * this function moves the time returned by OSAL_HostGetTimeUs forward, to simulate a long idle period without 
+ * waiting for it. the OSAL timers, the HW timers and the task sleeps keep running on the real time
+ *
+ * @param   TimeUs      [in]    the simulated time to add in us
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void OSAL_HostSkipTimeUs(uint32 TimeUs)
+{
+    gHostSkippedUs += TimeUs;
+}
+
+/* a free running ns counter, it wraps around every ~4 seconds */
+uint32 OSAL_HostGetTimeNs(void)
+{
+    struct timespec Now;
+
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+    return (uint32)((uint64_t)Now.tv_sec * 1000000000 + Now.tv_nsec);
+}
+
+OSAL_Msg *OSAL_MsgNew(void)
+{
+    HostMsg_t *pHostMsg = (HostMsg_t *)calloc(1, sizeof(HostMsg_t));
+
+    OSAL_ASSERT(pHostMsg != NULL);
+    return &pHostMsg->Msg;
+}
+
+void OSAL_MsgFree(OSAL_Msg *pMsg)
+{
+    free((HostMsg_t *)pMsg);
+}
+
+/**
+ * <pre>
+ * void OSAL_SendMessageToTask(OSAL_Msg *pMsg)
+ * </pre>
+ *
+ * this function queues a message to its task (a reply is queued back to the source task), and starts the task
+ * if it is not running. a message to a task that was not registered nor attached is dropped
+ *
+ * @param   pMsg        [in]    the message
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void OSAL_SendMessageToTask(OSAL_Msg *pMsg)
+{
+    HostMsg_t *pHostMsg = (HostMsg_t *)pMsg;
+    uint8 TaskId = pMsg->reply? pMsg->src: pMsg->dst;
+    HostTask_t *pTask;
+
+    if(TaskId >= OSAL_MAX_TASKS || (gHostTask[TaskId].pEntry == NULL && !gHostTask[TaskId].IsAttached))
+    {
+        Printf("OSAL: no task %d, message 0x%x dropped\n", TaskId, pMsg->cmd);
+        OSAL_MsgFree(pMsg);
+        return;
+    }
+    pTask = &gHostTask[TaskId];
+    pHostMsg->pNext = NULL;
+
+    pthread_mutex_lock(&gHostOsalLock);
+    if(pTask->pTail != NULL)
+    {
+        pTask->pTail->pNext = pHostMsg;
+    }
+    else
+    {
+        pTask->pHead = pHostMsg;
+    }
+    pTask->pTail = pHostMsg;
+
+    if(!pTask->IsRunning)
+    {
+        Host_TaskStart(TaskId);
+    }
+    pthread_cond_signal(&pTask->Cond);
+    pthread_mutex_unlock(&gHostOsalLock);
+}
+
+OSAL_Msg *OSAL_WaitOnMessage(uint8 TaskId)
+{
+    HostTask_t *pTask = &gHostTask[TaskId];
+    HostMsg_t *pHostMsg;
+
+    pthread_mutex_lock(&gHostOsalLock);
+    while(pTask->pHead == NULL)
+    {
+        pthread_cond_wait(&pTask->Cond, &gHostOsalLock);
+    }
+    pHostMsg = pTask->pHead;
+    pTask->pHead = pHostMsg->pNext;
+    if(pTask->pHead == NULL)
+    {
+        pTask->pTail = NULL;
+    }
+    pthread_mutex_unlock(&gHostOsalLock);
+
+    return &pHostMsg->Msg;
+}
+
+uint8 OSAL_GetSelfTaskId(void)
+{
+    return gHostSelfTaskId;
+}
+
+void OSAL_GetRunningTaskName(char *pName)
+{
+    if(gHostIsIsr)
+    {
+        strcpy(pName, HOST_OSAL_ISR_TASK_NAME);
+    }
+    else if(gHostSelfTaskId != TASK_APP_NONE_ID)
+    {
+        strcpy(pName, gHostTask[gHostSelfTaskId].Name);
+    }
+    else
+    {
+        strcpy(pName, HOST_OSAL_NO_TASK_NAME);
+    }
+}
+
+void OSAL_SuspendTask(uint32 TimeMS)
+{
+    struct timespec Time;
+
+    Host_UsToTimespec((uint64_t)TimeMS * 1000, &Time);
+    nanosleep(&Time, NULL);
+}
+
+/**
+ * <pre>
+ * void OSAL_TaskDelete(uint8 TaskId)
+ * </pre>
+ *
+ * this function ends the calling task thread. the task is started again by its next message
+ * (right away if messages were queued while it was ending). only a task can delete itself
+ *
+ * @param   TaskId      [in]    the task ID
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void OSAL_TaskDelete(uint8 TaskId)
+{
+    OSAL_ASSERT(TaskId == gHostSelfTaskId);
+
+    pthread_mutex_lock(&gHostOsalLock);
+    gHostTask[TaskId].IsRunning = FALSE;
+    if(gHostTask[TaskId].pHead != NULL)
+    {
+        Host_TaskStart(TaskId);
+    }
+    pthread_mutex_unlock(&gHostOsalLock);
+    pthread_exit(NULL);
+}
+
+uint32 OSAL_GetTickCount(void)
+{
+    return (uint32)((Host_MonotonicUs() - gHostStartUs) / 1000);
+}
+
+void *OSAL_HeapAllocBuffer(uint8 TaskId, uint32 Size)
+{
+    return malloc(Size);
+}
+
+void OSAL_HeapFreeBuff(uint32 **ppBuff)
+{
+    free(*ppBuff);
+    *ppBuff = NULL;
+}
+
+/* returns the end of the copy, the logger writes on from there (see Logger_ParseAndWriteBinBuff) */
+void *OSAL_MemCopy(void *pDst, const void *pSrc, uint32 Len)
+{
+    return (uint8 *)memcpy(pDst, pSrc, Len) + Len;
+}
+
+void OSAL_MemSet(void *pDst, uint8 Val, uint32 Len)
+{
+    memset(pDst, Val, Len);
+}
+
+/**
+ * <pre>
+ * char *OSAL_StrCopy(char *pDst, const char *pSrc, uint32 MaxLen)
+ * </pre>
+ *
+ * this function copies a string up to its null terminator (included) or up to MaxLen characters
+ *
+ * @return a pointer right after the last copied character
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+char *OSAL_StrCopy(char *pDst, const char *pSrc, uint32 MaxLen)
+{
+    while(MaxLen--)
+    {
+        if((*pDst++ = *pSrc++) == '\0')
+        {
+            break;
+        }
+    }
+    return pDst;
+}
+
+uint32 OSAL_StrLen(const char *pStr, uint32 MaxLen)
+{
+    uint32 Len = 0;
+
+    while(Len < MaxLen && pStr[Len] != '\0')
+    {
+        Len++;
+    }
+    return Len;
+}
+
+/**
+ * <pre>
+ * uint8 OSAL_num2decstr(uint32 Num, uint8 *pStr, uint8 NumOfDigits)
+ * </pre>
+ *
+ * this function writes the NumOfDigits low decimal digits of a number, padded with zeros (no null terminator)
+ *
+ * @return the number of characters written
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+uint8 OSAL_num2decstr(uint32 Num, uint8 *pStr, uint8 NumOfDigits)
+{
+    uint8 Idx;
+
+    for(Idx = NumOfDigits; Idx > 0; Idx--)
+    {
+        pStr[Idx - 1] = '0' + Num % 10;
+        Num /= 10;
+    }
+    return NumOfDigits;
+}
+
+/**
+ * <pre>
+ * void OSAL_StartTimer(uint16 TimerId, uint32 TimeMS, BOOL IsPeriodic)
+ * </pre>
+ *
+ * this function starts (or restarts) a timer of the calling task. on expiration the task gets
+ * an OSAL_TIMER_MNG_TIMER_EXPIRE_CMD message with the timer ID in the user tag
+ *
+ * @param   TimerId     [in]    the timer ID
+ * @param   TimeMS      [in]    the expiration time in ms
+ * @param   IsPeriodic  [in]    TRUE for a periodic timer
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void OSAL_StartTimer(uint16 TimerId, uint32 TimeMS, BOOL IsPeriodic)
+{
+    HostTimer_t *pTimer = NULL;
+    uint8 Idx;
+
+    pthread_mutex_lock(&gHostOsalLock);
+    for(Idx = 0; Idx < OSAL_MAX_TIMERS; Idx++)
+    {
+        if(gHostTimer[Idx].IsUsed && gHostTimer[Idx].TaskId == gHostSelfTaskId && gHostTimer[Idx].TimerId == TimerId)
+        {
+            pTimer = &gHostTimer[Idx];
+            break;
+        }
+        if(!gHostTimer[Idx].IsUsed && pTimer == NULL)
+        {
+            pTimer = &gHostTimer[Idx];
+        }
+    }
+    OSAL_ASSERT(pTimer != NULL);
+    if(pTimer != NULL)
+    {
+        pTimer->TaskId = gHostSelfTaskId;
+        pTimer->TimerId = TimerId;
+        pTimer->PeriodMS = IsPeriodic? TimeMS: 0;
+        pTimer->ExpiryUs = Host_MonotonicUs() - gHostStartUs + (uint64_t)TimeMS * 1000;
+        pTimer->IsUsed = TRUE;
+        pthread_cond_signal(&gHostTimerCond);
+    }
+    pthread_mutex_unlock(&gHostOsalLock);
+}
+
+void OSAL_StopTimer(uint16 TimerId)
+{
+    uint8 Idx;
+
+    pthread_mutex_lock(&gHostOsalLock);
+    for(Idx = 0; Idx < OSAL_MAX_TIMERS; Idx++)
+    {
+        if(gHostTimer[Idx].IsUsed && gHostTimer[Idx].TaskId == gHostSelfTaskId && gHostTimer[Idx].TimerId == TimerId)
+        {
+            gHostTimer[Idx].IsUsed = FALSE;
+        }
+    }
+    pthread_mutex_unlock(&gHostOsalLock);
+}
+
+void OSAL_PortMutexCreate(OSAL_MUTEX_HANDLE *pMutex)
+{
+    pthread_mutex_t *pHostMutex = (pthread_mutex_t *)malloc(sizeof(pthread_mutex_t));
+
+    pthread_mutex_init(pHostMutex, NULL);
+    *pMutex = pHostMutex;
+}
+
+void OSAL_PortMutexDelete(OSAL_MUTEX_HANDLE Mutex)
+{
+    pthread_mutex_destroy((pthread_mutex_t *)Mutex);
+    free(Mutex);
+}
+
+void OSAL_PortMutexCapture(OSAL_MUTEX_HANDLE Mutex)
+{
+    pthread_mutex_lock((pthread_mutex_t *)Mutex);
+}
+
+void OSAL_PortMutexRelease(OSAL_MUTEX_HANDLE Mutex)
+{
+    pthread_mutex_unlock((pthread_mutex_t *)Mutex);
+}
+
+void Printf(const char *pFmt, ...)
+{
+    va_list Args;
+
+    va_start(Args, pFmt);
+    vprintf(pFmt, Args);
+    va_end(Args);
+    fflush(stdout);
+}
+
+/**
+ * <pre>
+ * void OSAL_AssertFailed(const char *pFile, int Line)
+ * </pre>
+ *
+ * this function reports a failed assertion. the host keeps running, so a stress test reports all the assertions it hits
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void OSAL_AssertFailed(const char *pFile, int Line)
+{
+    fprintf(stderr, "OSAL_ASSERT %s:%d (task %d)\n", pFile, Line, gHostSelfTaskId);
+}
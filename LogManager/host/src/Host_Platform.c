@@ -0,0 +1,167 @@
+/*--------------------------------------------------------------------------------------
+ * Description: the host platform services the logger refers to: the RS232 output, the RTC,
+ *              the server message manager, the debug test points and the fault record
+ * -------------------------------------------------------------------------------------*/
+#include <time.h>
+#include <pthread.h>
+#include <string.h>
+#include "osal.h"
+#include "Logger_Defs.h"
+#include "Logger_Crash.h"
+#include "RTC_API.h"
+#include "msme.h"
+#include "MessageManager_Api.h"
+#include "Util.h"
+#include "Dbg_Print.h"
+#include "Logger_WeRFaultHandler.h"
+#include "Host_Sim.h"
+
+#define HOST_FAULT_RECORD_SIZE          16
+
+unsigned long gHostFaultRecord[HOST_FAULT_RECORD_SIZE];
+
+static FILE *gpHostUartOutput;
+static pthread_mutex_t gHostUartLock = PTHREAD_MUTEX_INITIALIZER;
+
+                /* ========================================== *
+                 *     P U B L I C     F U N C T I O N S      *
+                 * ========================================== */
+
+/**
+ * <pre>
+ * void HostUart_SetOutput(FILE *pOutput)
+ * </pre>
+ *
+ * this function sets the RS232 output. by default the RS232 is written to the standard output
+ *
+ * @param   pOutput     [in]    the RS232 output file, NULL to discard the RS232 data
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void HostUart_SetOutput(FILE *pOutput)
+{
+    gpHostUartOutput = pOutput;
+}
+
+void HostUart_Write(const char *pStr, uint16 Len)
+{
+    FILE *pOutput = (gpHostUartOutput != NULL)? gpHostUartOutput: stdout;
+
+    pthread_mutex_lock(&gHostUartLock);
+    fwrite(pStr, 1, Len, pOutput);
+    fflush(pOutput);
+    pthread_mutex_unlock(&gHostUartLock);
+}
+
+void RTC_GetTimeAndDate(RTC_Time_t *pTime)
+{
+    time_t Now = time(NULL);
+    struct tm Tm;
+
+    localtime_r(&Now, &Tm);
+    pTime->Year = Tm.tm_year + 1900;
+    pTime->Month = Tm.tm_mon + 1;
+    pTime->DayOfMonth = Tm.tm_mday;
+    pTime->Hour = Tm.tm_hour;
+    pTime->Minute = Tm.tm_min;
+    pTime->Second = Tm.tm_sec;
+}
+
+/**
+ * <pre>
+ * void OMM_SendMsg(uint8 TaskId, uint16 MsgType, U_CODE_ARGUMENT *pCodeArgs, DEV_TYPE_t DevType, uint8 Dest, uint8 DevTypeId, uint8 Attr)
+ * </pre>
+ *
+ * this function sends a message to the server. the host has no server connection, the logger status messages are printed
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void OMM_SendMsg(uint8 TaskId, uint16 MsgType, U_CODE_ARGUMENT *pCodeArgs, DEV_TYPE_t DevType, uint8 Dest, uint8 DevTypeId, uint8 Attr)
+{
+    uint32 *pStats;
+    size_t FmtLen;
+    uint8 Idx;
+
+    if(MsgType == MSME_LOGGER_STATUS_EVENT_MSG)
+    {
+        Printf("OMM: logger status Command(%d) Status(%d) Description(%d)\n", pCodeArgs->LoggerStatusMsg.Command,
+               pCodeArgs->LoggerStatusMsg.Status, pCodeArgs->LoggerStatusMsg.Description);
+    }
+    else if(MsgType == MSME_LOGGER_TASK_STATS_EVENT_MSG)
+    {
+        for(Idx = 0; Idx < pCodeArgs->LoggerTaskStatsMsg.NumOfTasks; Idx++)
+        {
+            pStats = pCodeArgs->LoggerTaskStatsMsg.pTaskStats + Idx * 4;
+            if(pStats[0] != 0 || pStats[2] != 0 || pStats[3] != 0)
+            {
+                Printf("OMM: logger task %d Msgs(%d) Bytes(%d) Filtered(%d) Overrun(%d)\n", Idx, pStats[0], pStats[1], pStats[2], pStats[3]);
+            }
+        }
+    }
+    else if(MsgType == MSME_LOGGER_TELEMETRY_EVENT_MSG)
+    {
+        Printf("OMM: logger telemetry ");
+        for(Idx = 0; Idx < pCodeArgs->LoggerTelemetryMsg.Len; Idx++)
+        {
+            Printf("%02x", pCodeArgs->LoggerTelemetryMsg.pRecord[Idx]);
+        }
+        Printf("\n");
+    }
+    else if(MsgType == MSME_LOGGER_TOP_SITES_EVENT_MSG)
+    {
+        Printf("OMM: logger top sites in %d ms\n", pCodeArgs->LoggerTopSitesMsg.WindowMS);
+        for(Idx = 0; Idx < pCodeArgs->LoggerTopSitesMsg.NumOfSites; Idx++)
+        {
+            /* the format string is printed without its line end */
+            FmtLen = strcspn(pCodeArgs->LoggerTopSitesMsg.Site[Idx].pFmt, "\r\n");
+            if(FmtLen > pCodeArgs->LoggerTopSitesMsg.Site[Idx].FmtLen)
+            {
+                FmtLen = pCodeArgs->LoggerTopSitesMsg.Site[Idx].FmtLen;
+            }
+            Printf("OMM: logger site Hits(%d) Bytes(%d) \"%.*s\"\n", pCodeArgs->LoggerTopSitesMsg.Site[Idx].Hits, 
+                   pCodeArgs->LoggerTopSitesMsg.Site[Idx].Bytes, (int)FmtLen, pCodeArgs->LoggerTopSitesMsg.Site[Idx].pFmt);
+        }
+    }
+}
+
+void Dbg_SetTestPoint(uint8 TaskId, uint16 Cmd, uint16 TestPoint, uint32 Param)
+{
+}
+
+void Dbg_GetFaultTask(uint16 *pCmd, uint8 *pTaskId)
+{
+    *pCmd = 0;
+    *pTaskId = OSAL_GetSelfTaskId();
+}
+
+uint8 num2decstr(uint32 Num, uint8 *pStr, uint8 NumOfDigits)
+{
+    return OSAL_num2decstr(Num, pStr, NumOfDigits);
+}
+
+char hex2ascii(uint8 Nibble)
+{
+    return (Nibble < 10)? '0' + Nibble: 'A' + Nibble - 10;
+}
+
+/**
+ * <pre>
+ * void Logger_PrintFaultHandler(void)
+ * </pre>
+ *
+ * This function prints the crash capture kept in the FLASH crash area (see Logger_CrashPrint).
+ * the host has no RAM fault record to print.
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_PrintFaultHandler(void)
+{
+    Logger_CrashPrint();
+}
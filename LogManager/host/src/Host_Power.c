@@ -0,0 +1,119 @@
+/*--------------------------------------------------------------------------------------
+ * Description: the host power loss fault injection. once armed, the power is lost during
+ *              one of the next FLASH programs, FLASH erases or EEPROM writes: the operation
+ *              completes a random part of its bytes and the process exits right away, like
+ *              a board that lost its power. the FLASH image and the EEPROM file keep what was
+ *              written up to that point, so the next process boots from them.
+ * -------------------------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "osal.h"
+#include "Host_Sim.h"
+
+typedef struct {
+    BOOL IsArmed;
+    uint32 OpsLeft;                         /* the operations that complete before the power is lost */
+    unsigned int Seed;                      /* the torn operation random seed */
+    HostPowerLoss_t *pReport;               /* Optional. where the power loss is reported to (e.g. memory shared with a parent process) */
+    pthread_mutex_t Lock;
+}HostPower_t;
+
+static HostPower_t gHostPower = { FALSE, 0, 0, NULL, PTHREAD_MUTEX_INITIALIZER };
+
+                /* ========================================== *
+                 *     P U B L I C     F U N C T I O N S      *
+                 * ========================================== */
+
+/**
+ * <pre>
+ * void HostPower_Arm(uint32 OpsLeft, uint32 Seed, HostPowerLoss_t *pReport)
+ * </pre>
+ *
+ * this function arms the power loss. the power is lost during the operation that follows OpsLeft FLASH programs,
+ * FLASH erases and EEPROM writes
+ *
+ * @param   OpsLeft     [in]    the number of operations that complete before the power is lost
+ * @param   Seed        [in]    the random seed of the part of the interrupted operation that completes
+ * @param   pReport     [out]   Optional. where the interrupted operation is reported to, NULL if not needed
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void HostPower_Arm(uint32 OpsLeft, uint32 Seed, HostPowerLoss_t *pReport)
+{
+    pthread_mutex_lock(&gHostPower.Lock);
+    gHostPower.IsArmed = TRUE;
+    gHostPower.OpsLeft = OpsLeft;
+    gHostPower.Seed = Seed;
+    gHostPower.pReport = pReport;
+    if(pReport != NULL)
+    {
+        pReport->Op = e_HOST_POWER_OP_NONE;
+    }
+    pthread_mutex_unlock(&gHostPower.Lock);
+}
+
+/**
+ * <pre>
+ * BOOL HostPower_Consume(uint8 Op, uint32 Address, uint32 Len, uint32 *pDone)
+ * </pre>
+ *
+ * this function is called by the simulated peripherals before every program, erase or write. if the power is lost
+ * during the operation, it returns the part of the operation that completes. the caller applies that part and then
+ * calls HostPower_Off
+ *
+ * @param   Op          [in]    the operation (HostPowerOp_e)
+ * @param   Address     [in]    the operation address
+ * @param   Len         [in]    the operation length in bytes
+ * @param   pDone       [out]   the bytes the operation completes (Len unless the power is lost)
+ *
+ * @return TRUE if the power is lost during the operation or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+BOOL HostPower_Consume(uint8 Op, uint32 Address, uint32 Len, uint32 *pDone)
+{
+    BOOL IsLost = FALSE;
+
+    *pDone = Len;
+
+    pthread_mutex_lock(&gHostPower.Lock);
+    if(gHostPower.IsArmed && gHostPower.OpsLeft-- == 0)
+    {
+        gHostPower.IsArmed = FALSE;
+        IsLost = TRUE;
+        *pDone = (Len > 0)? rand_r(&gHostPower.Seed) % Len: 0;
+        if(gHostPower.pReport != NULL)
+        {
+            gHostPower.pReport->Op = Op;
+            gHostPower.pReport->Address = Address;
+            gHostPower.pReport->Len = Len;
+            gHostPower.pReport->Done = *pDone;
+        }
+    }
+    pthread_mutex_unlock(&gHostPower.Lock);
+
+    return IsLost;
+}
+
+/**
+ * <pre>
+ * void HostPower_Off(void)
+ * </pre>
+ *
+ * this function loses the power: the process exits right away, without running any exit handler.
+ * the RAM (the logger RX buffers and the no-init RAM) is lost with it
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void HostPower_Off(void)
+{
+    _exit(HOST_POWER_OFF_EXIT_CODE);
+}
@@ -0,0 +1,166 @@
+/*--------------------------------------------------------------------------------------
+ * Description: the host loopback UDP sink. the sink thread plays the debug server: it
+ *              receives the logger datagrams on a local port, counts them and optionally
+ *              writes them to a file. the logger socket sends to it over the loopback.
+ * -------------------------------------------------------------------------------------*/
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "osal.h"
+#include "Host_Sim.h"
+
+#define HOST_UDP_MAX_DATAGRAM_BYTES     2048
+
+typedef struct {
+    int SinkFd;                             /* the sink (server) socket */
+    FILE *pOutput;                          /* the sink output, NULL to count only */
+    HostUdpSinkStats_t Stats;
+    int Fd;                                 /* the logger socket, -1 if closed */
+    pthread_mutex_t Lock;
+}HostUdp_t;
+
+static HostUdp_t gHostUdp = { -1, NULL, {0, 0}, -1, PTHREAD_MUTEX_INITIALIZER };
+
+                /* ========================================== *
+                 *     P R I V A T E     F U N C T I O N S    *
+                 * ========================================== */
+
+static void *HostUdp_SinkThread(void *pArg)
+{
+    char Datagram[HOST_UDP_MAX_DATAGRAM_BYTES];
+    ssize_t Len;
+
+    while(TRUE)
+    {
+        Len = recv(gHostUdp.SinkFd, Datagram, sizeof(Datagram), 0);
+        if(Len < 0)
+        {
+            continue;
+        }
+        pthread_mutex_lock(&gHostUdp.Lock);
+        gHostUdp.Stats.Datagrams++;
+        gHostUdp.Stats.Bytes += Len;
+        if(gHostUdp.pOutput != NULL)
+        {
+            fwrite(Datagram, 1, Len, gHostUdp.pOutput);
+            fflush(gHostUdp.pOutput);
+        }
+        pthread_mutex_unlock(&gHostUdp.Lock);
+    }
+    return NULL;
+}
+
+                /* ========================================== *
+                 *     P U B L I C     F U N C T I O N S      *
+                 * ========================================== */
+
+/**
+ * <pre>
+ * BOOL HostUdp_SinkStart(uint16 Port, FILE *pOutput)
+ * </pre>
+ *
+ * this function starts the loopback UDP sink
+ *
+ * @param   Port        [in]    the local port the sink listens on
+ * @param   pOutput     [in]    Optional. the file the received data is written to (NULL to count only)
+ *
+ * @return TRUE on success or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+BOOL HostUdp_SinkStart(uint16 Port, FILE *pOutput)
+{
+    struct sockaddr_in Addr;
+    pthread_t Thread;
+
+    gHostUdp.pOutput = pOutput;
+    gHostUdp.SinkFd = socket(AF_INET, SOCK_DGRAM, 0);
+    if(gHostUdp.SinkFd < 0)
+    {
+        return FALSE;
+    }
+    memset(&Addr, 0, sizeof(Addr));
+    Addr.sin_family = AF_INET;
+    Addr.sin_port = htons(Port);
+    Addr.sin_addr.s_addr = inet_addr(HOST_SIM_LOOPBACK_IP);
+    if(bind(gHostUdp.SinkFd, (struct sockaddr *)&Addr, sizeof(Addr)) != 0)
+    {
+        close(gHostUdp.SinkFd);
+        gHostUdp.SinkFd = -1;
+        return FALSE;
+    }
+    pthread_create(&Thread, NULL, HostUdp_SinkThread, NULL);
+    pthread_detach(Thread);
+    return TRUE;
+}
+
+void HostUdp_SinkGetStats(HostUdpSinkStats_t *pStats)
+{
+    pthread_mutex_lock(&gHostUdp.Lock);
+    *pStats = gHostUdp.Stats;
+    pthread_mutex_unlock(&gHostUdp.Lock);
+}
+
+/**
+ * <pre>
+ * BOOL HostUdp_Open(const char *pIp, uint16 Port)
+ * </pre>
+ *
+ * this function opens the logger UDP socket to a remote server (the loopback sink)
+ *
+ * @param   pIp         [in]    the remote server IP
+ * @param   Port        [in]    the remote server port
+ *
+ * @return TRUE on success or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+BOOL HostUdp_Open(const char *pIp, uint16 Port)
+{
+    struct sockaddr_in Addr;
+    int Fd;
+
+    memset(&Addr, 0, sizeof(Addr));
+    Addr.sin_family = AF_INET;
+    Addr.sin_port = htons(Port);
+    if(inet_pton(AF_INET, pIp, &Addr.sin_addr) != 1)
+    {
+        return FALSE;
+    }
+    Fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if(Fd < 0 || connect(Fd, (struct sockaddr *)&Addr, sizeof(Addr)) != 0)
+    {
+        if(Fd >= 0)
+        {
+            close(Fd);
+        }
+        return FALSE;
+    }
+    HostUdp_Close();
+    gHostUdp.Fd = Fd;
+    return TRUE;
+}
+
+void HostUdp_Close(void)
+{
+    if(gHostUdp.Fd >= 0)
+    {
+        close(gHostUdp.Fd);
+        gHostUdp.Fd = -1;
+    }
+}
+
+BOOL HostUdp_IsOpened(void)
+{
+    return (gHostUdp.Fd >= 0);
+}
+
+BOOL HostUdp_Send(const uint8 *pBuff, uint16 Len)
+{
+    return (gHostUdp.Fd >= 0 && send(gHostUdp.Fd, pBuff, Len, MSG_DONTWAIT) == Len);
+}
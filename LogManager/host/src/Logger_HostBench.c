@@ -0,0 +1,459 @@
+/*--------------------------------------------------------------------------------------
+ * Description: the host logger benchmark. it sweeps the message size, the format mix,
+ *              the number of producer tasks and the producer rate, and measures every
+ *              Logger_printf call. every run reports the p50/p99/p99.9/max write latency,
+ *              the sustained accepted throughput, the drop counters and the drain task CPU
+ *              share, against the README targets (0.1 ms per write, 50 Kbps).
+ *              the results are written as JSON, so firmware versions can be compared
+ *              (see tools/logger_bench.py).
+ *              usage: logger_host_bench [JSON output file] [messages per producer]
+ * -------------------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Logger_Defs.h"
+#include "Logger_Manager.h"
+#include "Logger_Release.h"
+#include "Host_Sim.h"
+
+#define HOST_BENCH_USAGE                        "usage: logger_host_bench [JSON output file] [messages per producer]\n"
+#define HOST_BENCH_DEFAULT_OUTPUT_FILE          "logger_bench.json"
+#define HOST_BENCH_DEFAULT_NUM_OF_MSGS          1000    /* the messages every producer prints on a run */
+#define HOST_BENCH_READY_TIMEOUT_MS             5000    /* the maximum time to wait for the logger init */
+#define HOST_BENCH_SETTLE_TIMEOUT_MS            2000    /* the maximum time to wait for the sinks to send the RX buffers */
+#define HOST_BENCH_MAX_PRODUCERS                4       /* the producer tasks (TASK_APP_HOST_APP1_ID and on) */
+#define HOST_BENCH_MAX_PAYLOAD_BYTES            240     /* the maximum %s and %b payload */
+#define HOST_BENCH_TARGET_WRITE_US              100     /* README: the logger path is at most 0.1 ms per write */
+#define HOST_BENCH_TARGET_KBPS                  50      /* README: the logger is designed for at most 50 Kbps sustained */
+
+#define HOST_BENCH_CMD_START                    0x100   /* start printing (the producer descriptor is in pDataIn) */
+#define HOST_BENCH_CMD_DONE                     0x101   /* a producer is done printing */
+
+typedef enum {
+    e_HOST_BENCH_FMT_DEC,                       /* %d */
+    e_HOST_BENCH_FMT_STR,                       /* %s of the payload */
+    e_HOST_BENCH_FMT_HEX,                       /* %x */
+    e_HOST_BENCH_FMT_BIN,                       /* %b of the payload */
+    e_HOST_BENCH_FMT_TIME,                      /* %T */
+    e_HOST_BENCH_FMT_MIX,                       /* %T %s %d %x */
+    e_HOST_BENCH_FMT_MAX,
+}HostBenchFormat_e;
+
+/* a benchmark run */
+typedef struct {
+    const char *pName;
+    uint8 Format;                               /* HostBenchFormat_e */
+    uint8 PayloadLen;                           /* the %s and %b payload size in bytes */
+    uint8 NumOfProducers;                       /* the number of tasks printing at the same time */
+    uint32 RatePerSec;                          /* the messages every producer prints per second, 0 for as fast as possible */
+}HostBenchScenario_t;
+
+/* a producer task descriptor of the current run */
+typedef struct {
+    const HostBenchScenario_t *pScenario;
+    uint32 NumOfMsgs;
+    uint32 *pLatencyNs;                         /* the latency of every Logger_printf call in ns */
+    uint64_t StartNs;                           /* the producer run start and end time */
+    uint64_t EndNs;
+}HostBenchProducer_t;
+
+/* the logger and the sinks counters, sampled before and after a run */
+typedef struct {
+    uint32 RxCnt;
+    uint32 LostMsgCnt;
+    uint32 LostBytesCnt;
+    uint32 RunOverCnt;
+    uint32 LowMemCnt;
+    uint32 BusyCnt;
+    uint32 SinkDropCnt;
+    uint32 DrainBusyUs;
+    uint32 FlashBytes;
+    uint32 SocketBytes;
+}HostBenchCounters_t;
+
+extern LoggerManager_t gLoggerManager;
+
+static const char * const gHostBenchFormatName[e_HOST_BENCH_FMT_MAX] = { "%d", "%s", "%x", "%b", "%T", "mix" };
+
+static const HostBenchScenario_t gHostBenchScenarios[] = {
+    /* message size */
+    { "size_16",        e_HOST_BENCH_FMT_STR,   16,     1,  1000 },
+    { "size_64",        e_HOST_BENCH_FMT_STR,   64,     1,  1000 },
+    { "size_128",       e_HOST_BENCH_FMT_STR,   128,    1,  1000 },
+    { "size_240",       e_HOST_BENCH_FMT_STR,   240,    1,  1000 },
+    /* format mix */
+    { "format_dec",     e_HOST_BENCH_FMT_DEC,   0,      1,  1000 },
+    { "format_hex",     e_HOST_BENCH_FMT_HEX,   0,      1,  1000 },
+    { "format_bin",     e_HOST_BENCH_FMT_BIN,   32,     1,  1000 },
+    { "format_time",    e_HOST_BENCH_FMT_TIME,  0,      1,  1000 },
+    { "format_mix",     e_HOST_BENCH_FMT_MIX,   32,     1,  1000 },
+    /* producer tasks contention */
+    { "producers_2",    e_HOST_BENCH_FMT_MIX,   32,     2,  1000 },
+    { "producers_3",    e_HOST_BENCH_FMT_MIX,   32,     3,  1000 },
+    { "producers_4",    e_HOST_BENCH_FMT_MIX,   32,     4,  1000 },
+    /* producer rate */
+    { "rate_5k",        e_HOST_BENCH_FMT_MIX,   32,     1,  5000 },
+    { "rate_20k",       e_HOST_BENCH_FMT_MIX,   32,     1,  20000 },
+    { "rate_flood",     e_HOST_BENCH_FMT_MIX,   32,     1,  0 },
+};
+
+static char gHostBenchPayload[HOST_BENCH_MAX_PAYLOAD_BYTES + 1];
+static HostBenchProducer_t gHostBenchProducer[HOST_BENCH_MAX_PRODUCERS];
+
+                /* ========================================== *
+                 *     P R I V A T E     F U N C T I O N S    *
+                 * ========================================== */
+
+static uint64_t HostBench_NowNs(void)
+{
+    struct timespec Now;
+
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+    return (uint64_t)Now.tv_sec * 1000000000ULL + Now.tv_nsec;
+}
+
+static void HostBench_SleepUntil(uint64_t DueNs)
+{
+    struct timespec Due;
+
+    Due.tv_sec = DueNs / 1000000000ULL;
+    Due.tv_nsec = DueNs % 1000000000ULL;
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &Due, NULL) != 0);
+}
+
+static int HostBench_CompareLatency(const void *pA, const void *pB)
+{
+    uint32 A = *(const uint32 *)pA, B = *(const uint32 *)pB;
+
+    return (A > B) - (A < B);
+}
+
+/* the RX buffer bytes a sink did not send yet */
+static uint32 HostBench_RxPending(RXBuffer_t *pRxBuffer, char *pSinkRead)
+{
+    uint32 Size = (uint32)(pRxBuffer->pTail - pRxBuffer->pHead);
+
+    return (uint32)(pRxBuffer->pWrite - pSinkRead + Size) % Size;
+}
+
+static void HostBench_SendMsg(uint16 Cmd, uint8 SrcTaskId, uint8 DstTaskId, void *pDataIn)
+{
+    OSAL_Msg *pMsg = OSAL_MsgNew();
+
+    pMsg->cmd = Cmd;
+    pMsg->src = pMsg->origSrc = SrcTaskId;
+    pMsg->dst = DstTaskId;
+    pMsg->reply = FALSE;
+    pMsg->pDataIn = pDataIn;
+    OSAL_SendMessageToTask(pMsg);
+}
+
+/**
+ * <pre>
+ * static void HostBench_Print(uint8 Format, uint8 PayloadLen, uint32 MsgNum)
+ * </pre>
+ *  
+ * this function prints a single log message of the given format
+ *
+ * @param   Format      [in]    The message format (HostBenchFormat_e)
+ * @param   PayloadLen  [in]    The %s and %b payload size in bytes
+ * @param   MsgNum      [in]    The message number
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void HostBench_Print(uint8 Format, uint8 PayloadLen, uint32 MsgNum)
+{
+    switch(Format)
+    {
+        case e_HOST_BENCH_FMT_DEC:
+            Logger_printf(LEVEL_INFO, "bench %d %d %d %d\n", MsgNum, -(int)MsgNum, MsgNum * 7, MsgNum * 1000003);
+        break;
+        case e_HOST_BENCH_FMT_STR:
+            Logger_printf(LEVEL_INFO, "bench %s\n", gHostBenchPayload + HOST_BENCH_MAX_PAYLOAD_BYTES - PayloadLen);
+        break;
+        case e_HOST_BENCH_FMT_HEX:
+            Logger_printf(LEVEL_INFO, "bench %x %x %x %x\n", MsgNum, ~MsgNum, MsgNum * 7, MsgNum * 1000003);
+        break;
+        case e_HOST_BENCH_FMT_BIN:
+            Logger_printf(LEVEL_INFO, "bench %b\n", gHostBenchPayload, (short)PayloadLen);
+        break;
+        case e_HOST_BENCH_FMT_TIME:
+            Logger_printf(LEVEL_INFO, "bench %T %d\n", MsgNum);
+        break;
+        default:
+            Logger_printf(LEVEL_INFO, "bench %T %s %d %x\n", gHostBenchPayload + HOST_BENCH_MAX_PAYLOAD_BYTES - PayloadLen, 
+                          MsgNum, MsgNum);
+        break;
+    }
+}
+
+/**
+ * <pre>
+ * static void HostBench_Produce(HostBenchProducer_t *pProducer)
+ * </pre>
+ *  
+ * this function prints the producer messages at the run rate and measures every Logger_printf call
+ *
+ * @param   pProducer   [inout]     The producer descriptor
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void HostBench_Produce(HostBenchProducer_t *pProducer)
+{
+    const HostBenchScenario_t *pScenario = pProducer->pScenario;
+    uint64_t StartNs;
+    uint32 Idx;
+
+    pProducer->StartNs = HostBench_NowNs();
+    for(Idx = 0; Idx < pProducer->NumOfMsgs; Idx++)
+    {
+        if(pScenario->RatePerSec != 0)
+        {
+            HostBench_SleepUntil(pProducer->StartNs + (uint64_t)Idx * 1000000000ULL / pScenario->RatePerSec);
+        }
+        StartNs = HostBench_NowNs();
+        HostBench_Print(pScenario->Format, pScenario->PayloadLen, Idx);
+        pProducer->pLatencyNs[Idx] = (uint32)(HostBench_NowNs() - StartNs);
+    }
+    pProducer->EndNs = HostBench_NowNs();
+}
+
+static OSAL_TASK HostBench_ProducerTask( void * pTaskId )
+{
+    uint8 TaskId = OSAL_TASK_EXTRACT_TASK_ID( pTaskId );
+    OSAL_Msg *pRxMsg;
+
+    while(TRUE)
+    {
+        pRxMsg = OSAL_WaitOnMessage(TaskId);
+        if(pRxMsg->cmd == HOST_BENCH_CMD_START)
+        {
+            HostBench_Produce((HostBenchProducer_t *)pRxMsg->pDataIn);
+            HostBench_SendMsg(HOST_BENCH_CMD_DONE, TaskId, TASK_APP_HOST_MAIN_ID, pRxMsg->pDataIn);
+        }
+        OSAL_MsgFree(pRxMsg);
+    }
+}
+
+/**
+ * <pre>
+ * static void HostBench_Settle(void)
+ * </pre>
+ *  
+ * this function waits for the socket sink to send the RX buffers, so the counters of a run include the records it printed only.
+ * the FLASH sink writes whole pages, so up to a FLASH page of the RX buffer (on the RX buffer wrap around, up to the next record) 
+ * may be left for the next run
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void HostBench_Settle(void)
+{
+    RXBuffer_t *pRxBuffer = &gLoggerManager.RxBuffer;
+    RXBuffer_t *pPriorityBuffer = &gLoggerManager.PriorityBuffer;
+    uint32 Idx;
+
+    for(Idx = 0; Idx < HOST_BENCH_SETTLE_TIMEOUT_MS; Idx++)
+    {
+        if(HostBench_RxPending(pRxBuffer, pRxBuffer->pSinkRead[e_LOGGER_SINK_SOCKET]) == 0 &&
+           HostBench_RxPending(pPriorityBuffer, pPriorityBuffer->pRead) == 0)
+        {
+            return;
+        }
+        OSAL_SuspendTask(1);
+    }
+    Printf("bench: the RX buffers were not sent in %d ms\n", HOST_BENCH_SETTLE_TIMEOUT_MS);
+}
+
+static void HostBench_GetCounters(HostBenchCounters_t *pCounters)
+{
+    RXBuffer_t *pRxBuffer = &gLoggerManager.RxBuffer;
+    HostFlashStats_t FlashStats;
+    HostUdpSinkStats_t SinkStats;
+    uint8 Sink;
+
+    HostFlash_GetStats(&FlashStats);
+    HostUdp_SinkGetStats(&SinkStats);
+
+    pCounters->RxCnt = pRxBuffer->RxCounter;
+    pCounters->LostMsgCnt = pRxBuffer->LostMsgCnt;
+    pCounters->LostBytesCnt = pRxBuffer->LostBytesCnt;
+    pCounters->RunOverCnt = pRxBuffer->RunOverCnt;
+    pCounters->LowMemCnt = pRxBuffer->LowMemoryCnt;
+    pCounters->BusyCnt = pRxBuffer->BusyCnt;
+    pCounters->SinkDropCnt = 0;
+    for(Sink = 0; Sink < e_LOGGER_SINK_MAX; Sink++)
+    {
+        pCounters->SinkDropCnt += pRxBuffer->SinkDropCnt[Sink];
+    }
+    pCounters->DrainBusyUs = gLoggerManager.DrainMng.DrainBusyUs;
+    pCounters->FlashBytes = FlashStats.WriteBytes;
+    pCounters->SocketBytes = SinkStats.Bytes;
+}
+
+/**
+ * <pre>
+ * static BOOL HostBench_Run(FILE *pOutput, const HostBenchScenario_t *pScenario, uint32 NumOfMsgs, BOOL IsFirst)
+ * </pre>
+ *  
+ * this function runs a single benchmark scenario, prints its table row and writes its JSON result. the accepted bytes 
+ * are the bytes the socket sink (a required sink) sent, over the time the producers were printing
+ *
+ * @param   pOutput     [in]    The JSON output file
+ * @param   pScenario   [in]    The scenario to run
+ * @param   NumOfMsgs   [in]    The messages every producer prints
+ * @param   IsFirst     [in]    Is it the first run in the results array
+ *
+ * @return TRUE if the run met the write and the throughput targets, FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static BOOL HostBench_Run(FILE *pOutput, const HostBenchScenario_t *pScenario, uint32 NumOfMsgs, BOOL IsFirst)
+{
+    HostBenchCounters_t Before, After;
+    uint32 *pLatencyNs = (uint32 *)malloc(sizeof(uint32) * NumOfMsgs * pScenario->NumOfProducers);
+    uint32 Count = NumOfMsgs * pScenario->NumOfProducers;
+    uint64_t StartNs = 0, EndNs = 0, SettleNs;
+    uint32 P50, P99, P999, Max, AcceptedBytes, LostMsgs;
+    double DurationUs, AcceptedKbps, DrainCpuPct;
+    BOOL IsWriteOk, IsThroughputOk;
+    OSAL_Msg *pRxMsg;
+    uint8 Idx;
+
+    HostBench_Settle();
+    HostBench_GetCounters(&Before);
+
+    for(Idx = 0; Idx < pScenario->NumOfProducers; Idx++)
+    {
+        gHostBenchProducer[Idx].pScenario = pScenario;
+        gHostBenchProducer[Idx].NumOfMsgs = NumOfMsgs;
+        gHostBenchProducer[Idx].pLatencyNs = pLatencyNs + Idx * NumOfMsgs;
+        HostBench_SendMsg(HOST_BENCH_CMD_START, TASK_APP_HOST_MAIN_ID, TASK_APP_HOST_APP1_ID + Idx, &gHostBenchProducer[Idx]);
+    }
+    for(Idx = 0; Idx < pScenario->NumOfProducers; )
+    {
+        pRxMsg = OSAL_WaitOnMessage(TASK_APP_HOST_MAIN_ID);
+        Idx += (pRxMsg->cmd == HOST_BENCH_CMD_DONE);
+        OSAL_MsgFree(pRxMsg);
+    }
+    for(Idx = 0; Idx < pScenario->NumOfProducers; Idx++)
+    {
+        StartNs = (Idx == 0 || gHostBenchProducer[Idx].StartNs < StartNs)? gHostBenchProducer[Idx].StartNs: StartNs;
+        EndNs = (gHostBenchProducer[Idx].EndNs > EndNs)? gHostBenchProducer[Idx].EndNs: EndNs;
+    }
+
+    HostBench_Settle();
+    SettleNs = HostBench_NowNs();
+    HostBench_GetCounters(&After);
+
+    qsort(pLatencyNs, Count, sizeof(uint32), HostBench_CompareLatency);
+    P50 = pLatencyNs[(uint64_t)(Count - 1) * 5000 / 10000];
+    P99 = pLatencyNs[(uint64_t)(Count - 1) * 9900 / 10000];
+    P999 = pLatencyNs[(uint64_t)(Count - 1) * 9990 / 10000];
+    Max = pLatencyNs[Count - 1];
+    free(pLatencyNs);
+
+    DurationUs = (EndNs - StartNs) / 1000.0 + 1;
+    AcceptedBytes = After.SocketBytes - Before.SocketBytes;
+    AcceptedKbps = AcceptedBytes * 8 * 1000.0 / DurationUs;
+    LostMsgs = After.LostMsgCnt - Before.LostMsgCnt;
+    DrainCpuPct = (After.DrainBusyUs - Before.DrainBusyUs) * 100.0 / ((SettleNs - StartNs) / 1000.0 + 1);
+    
+    /* the write target is met by 99.9% of the writes. the throughput target: nothing is lost within the design load */
+    IsWriteOk = (P999 <= HOST_BENCH_TARGET_WRITE_US * 1000);
+    IsThroughputOk = (LostMsgs == 0 || AcceptedKbps > HOST_BENCH_TARGET_KBPS);
+
+    Printf("%-14s %4s %4d %2d %6d | %7.1f %7.1f %7.1f %8.1f us | %7.1f Kbps | lost %5d | drain %6.2f%% | %5s %5s\n", 
+           pScenario->pName, gHostBenchFormatName[pScenario->Format], pScenario->PayloadLen, pScenario->NumOfProducers, 
+           pScenario->RatePerSec, P50 / 1000.0, P99 / 1000.0, P999 / 1000.0, Max / 1000.0, AcceptedKbps, LostMsgs, DrainCpuPct,
+           IsWriteOk? "ok": "MISS", IsThroughputOk? "ok": "MISS");
+
+    fprintf(pOutput, "%s\n    {\"name\": \"%s\", \"format\": \"%s\", \"payload_bytes\": %d, \"producers\": %d, \"rate_per_sec\": %d, "
+            "\"msgs\": %d, \"duration_us\": %.0f,\n", IsFirst? "": ",", pScenario->pName, gHostBenchFormatName[pScenario->Format], 
+            pScenario->PayloadLen, pScenario->NumOfProducers, pScenario->RatePerSec, After.RxCnt - Before.RxCnt, DurationUs);
+    fprintf(pOutput, "     \"latency_ns\": {\"p50\": %d, \"p99\": %d, \"p99_9\": %d, \"max\": %d},\n", P50, P99, P999, Max);
+    fprintf(pOutput, "     \"accepted_bytes\": %d, \"accepted_kbps\": %.1f, \"flash_bytes\": %d,\n", 
+            AcceptedBytes, AcceptedKbps, After.FlashBytes - Before.FlashBytes);
+    fprintf(pOutput, "     \"drops\": {\"lost_msgs\": %d, \"lost_bytes\": %d, \"run_over\": %d, \"low_mem\": %d, \"busy\": %d, \"sink_drops\": %d},\n",
+            LostMsgs, After.LostBytesCnt - Before.LostBytesCnt, After.RunOverCnt - Before.RunOverCnt, 
+            After.LowMemCnt - Before.LowMemCnt, After.BusyCnt - Before.BusyCnt, After.SinkDropCnt - Before.SinkDropCnt);
+    fprintf(pOutput, "     \"drain_busy_us\": %d, \"drain_cpu_pct\": %.2f, \"write_target_ok\": %s, \"throughput_target_ok\": %s}",
+            After.DrainBusyUs - Before.DrainBusyUs, DrainCpuPct, IsWriteOk? "true": "false", IsThroughputOk? "true": "false");
+    
+    return (IsWriteOk && IsThroughputOk);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *pFileName = (argc > 1)? argv[1]: HOST_BENCH_DEFAULT_OUTPUT_FILE;
+    uint32 NumOfMsgs = HOST_BENCH_DEFAULT_NUM_OF_MSGS;
+    char *pEnd = NULL;
+    FILE *pOutput;
+    uint32 NumOfMisses = 0;
+    uint32 Idx;
+
+    /* the arguments are positional, an option is only asked for the usage */
+    for(Idx = 1; Idx < (uint32)argc; Idx++)
+    {
+        if(argv[Idx][0] != '-')
+        {
+            continue;
+        }
+        if(strcmp(argv[Idx], "-h") == 0 || strcmp(argv[Idx], "--help") == 0)
+        {
+            Printf(HOST_BENCH_USAGE);
+            return 0;
+        }
+        Printf("unknown option %s\n" HOST_BENCH_USAGE, argv[Idx]);
+        return 1;
+    }
+    if(argc > 2)
+    {
+        NumOfMsgs = strtoul(argv[2], &pEnd, 0);
+    }
+    if(argc > 3 || NumOfMsgs == 0 || (pEnd != NULL && *pEnd != '\0') || (pOutput = fopen(pFileName, "w")) == NULL)
+    {
+        Printf(HOST_BENCH_USAGE);
+        return 1;
+    }
+    for(Idx = 0; Idx < HOST_BENCH_MAX_PAYLOAD_BYTES; Idx++)
+    {
+        gHostBenchPayload[Idx] = 'a' + Idx % 26;
+    }
+
+    if(!HostLogger_InitPlatform(TASK_APP_HOST_MAIN_ID, NULL, NULL, HOST_SIM_DEFAULT_EEPROM_FILE) ||
+       !HostLogger_Start(HostLogger_NewConfig(LOGGER_DEST_TYPE_FLASH_AND_SOCKET, LOGGER_MODE_TYPE_PUSH_PULL), LOGGER_ATTR_ERASE_FLASH_NOW, HOST_BENCH_READY_TIMEOUT_MS))
+    {
+        return 1;
+    }
+    for(Idx = 0; Idx < HOST_BENCH_MAX_PRODUCERS; Idx++)
+    {
+        OSAL_HostTaskRegister(TASK_APP_HOST_APP1_ID + Idx, HostBench_ProducerTask, "BENCH");
+    }
+
+    fprintf(pOutput, "{\n  \"logger_version\": \"%s\", \"msgs_per_producer\": %d,\n", LOGGER_VERSION, NumOfMsgs);
+    fprintf(pOutput, "  \"targets\": {\"write_us\": %d, \"kbps\": %d},\n  \"runs\": [", HOST_BENCH_TARGET_WRITE_US, HOST_BENCH_TARGET_KBPS);
+    Printf("%-14s %4s %4s %2s %6s | %7s %7s %7s %8s    | %12s | %10s | %13s | %5s %5s\n", "run", "fmt", "len", "P", "rate", 
+           "p50", "p99", "p99.9", "max", "accepted", "lost", "drain", "write", "kbps");
+    for(Idx = 0; Idx < sizeof(gHostBenchScenarios) / sizeof(gHostBenchScenarios[0]); Idx++)
+    {
+        NumOfMisses += !HostBench_Run(pOutput, &gHostBenchScenarios[Idx], NumOfMsgs, Idx == 0);
+    }
+    fprintf(pOutput, "\n  ]\n}\n");
+    fclose(pOutput);
+    Printf("%d of %d runs missed a target (write: p99.9 <= %d us, kbps: no loss below %d Kbps)\n", NumOfMisses, 
+           (int)(sizeof(gHostBenchScenarios) / sizeof(gHostBenchScenarios[0])), HOST_BENCH_TARGET_WRITE_US, HOST_BENCH_TARGET_KBPS);
+    Printf("results written to %s\n", pFileName);
+
+    return 0;
+}
@@ -0,0 +1,479 @@
+/*--------------------------------------------------------------------------------------
+ * Description: the logger callbacks of the host (Linux) platform, on top of the host
+ *              simulated peripherals (see Host_Sim.h). it follows ext/Logger_WeRCallbacks.c
+ * -------------------------------------------------------------------------------------*/
+#include "Logger_Defs.h"
+#include "FLASH_API.h"
+#include "EEPROM_API.h"
+#include "RTC_API.h"
+#include "clock.h"
+#include "Util.h"
+#include "ComManagerInclude.h"
+#include "Host_Sim.h"
+
+#define HOST_LOGGER_FLASH_READ_TIMEOUT_MS           5000    /* the maximum time to poll on a synchronous FLASH read */
+#define HOST_LOGGER_FLASH_POLL_INTERVAL_MS          1       /* the interval to poll on a synchronous FLASH read status */
+#define HOST_LOGGER_FLASH_ERASE_POLL_INTERVAL_MS    10      /* the interval to poll on a synchronous FLASH erase status */
+#define HOST_LOGGER_FLASH_QUEUE_RETRY_MS            50      /* the maximum time to retry an asynchronous FLASH command on a full command queue */
+#define HOST_LOGGER_PANEL_ID                        "00000001"
+#define HOST_LOGGER_FTP_COPY_CHUNK_BYTES            256     /* the FLASH read size of the FTP file copy */
+
+/* the logger configuration is kept in the EEPROM, every configuration type is preceded by a valid mark */
+#define HOST_LOGGER_EEPROM_CONFIG_ADDRESS           0x7000
+#define HOST_LOGGER_EEPROM_CONFIG_SIZE_BYTES        0x100   /* the EEPROM room of a single configuration type */
+#define HOST_LOGGER_EEPROM_CONFIG_VALID             0xA5
+
+/* the asynchronous FLASH command context. the logger queues a single asynchronous FLASH command at a time */
+static volatile uint32 gHostFlashCmdStatus;
+static LoggerFlashDoneCb_t gpHostFlashDoneCb;
+static LOGGER_STATUS gHostFlashErrorStatus;
+
+/**
+ * <pre>
+ * static void HostLogger_SendReply(uint8 SrcTaskId, uint16 Cmd, uint32 Status, uint32 UserTag)
+ * </pre>
+ *
+ * this function sends the logger task a reply message, the way the communication and the FTP tasks reply to the logger requests
+ *
+ * @param   SrcTaskId    [in]       The replying task ID (the message destination)
+ * @param   Cmd          [in]       The reply command
+ * @param   Status       [in]       The reply status
+ * @param   UserTag      [in]       The reply user tag
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void HostLogger_SendReply(uint8 SrcTaskId, uint16 Cmd, uint32 Status, uint32 UserTag)
+{
+    OSAL_Msg *pMessage = OSAL_MsgNew();
+
+    pMessage->cmd          = Cmd;
+    pMessage->src          = TASK_APP_LOGGER_MANAGER_ID;
+    pMessage->origSrc      = TASK_APP_LOGGER_MANAGER_ID;
+    pMessage->dst          = SrcTaskId;
+    pMessage->reply        = TRUE;
+    pMessage->status       = Status;
+    pMessage->userTag      = UserTag;
+
+    OSAL_SendMessageToTask(pMessage);
+}
+
+static LOGGER_STATUS HostLogger_OpenSocketCb(LoggerSocketConfig_t *pSocketConfig)
+{
+    /* only UDP is supported, the socket is opened to the loopback UDP sink */
+    if(pSocketConfig->SocketType != LOGGER_SOCKET_TYPE_UDP || !HostUdp_Open(pSocketConfig->DomainNameIp, pSocketConfig->RemotePort))
+    {
+        return LOGGER_STATUS_OPEN_SOCKET_FAILED;
+    }
+    HostLogger_SendReply(TASK_APP_COM_MANAGER_ID, COM_MANAGER_OPEN_SOCKET, COM_MANAGER_FUNC_ERR_OK, COM_MANAGER_SESSION_TYPE_DEBUG);
+    return LOGGER_STATUS_OK;
+}
+
+static LOGGER_STATUS HostLogger_SendSocketDataCb(uint8 *pBuff, uint16 Len, uint8 Mode, uint8 Priority)
+{
+    if(!HostUdp_IsOpened())
+    {
+        return LOGGER_STATUS_SOCKET_SEND_ERROR;
+    }
+    /* the socket send buffer is full */
+    if(!HostUdp_Send(pBuff, Len))
+    {
+        return LOGGER_STATUS_BUSY;
+    }
+    return LOGGER_STATUS_OK;
+}
+
+static LOGGER_STATUS HostLogger_SendUartDataCb(char *pStr, uint16 StrLen)
+{
+    HostUart_Write(pStr, StrLen);
+    return LOGGER_STATUS_OK;
+}
+
+/**
+ * <pre>
+ * static LOGGER_STATUS HostLogger_SendFlashDataCb(uint32 Address, char *pStr, uint16* pStrLen)
+ * </pre>
+ *
+ * this function writes a log message to the FLASH, split to FLASH pages
+ *
+ * @param   Address      [in]       The input address in FLASH to write to
+ * @param   pStr         [in]       a pointer to input string buffer
+ * @param   pStrLen      [inout]    a pointer string buffer length, set to the length written
+ *
+ * @return LOGGER_STATUS_OK on success or LOGGER_STATUS_BUSY if only a part was written
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static LOGGER_STATUS HostLogger_SendFlashDataCb(uint32 Address, char *pStr, uint16* pStrLen)
+{
+    uint16 DataWriten = 0;
+    uint16 DataToWrite;
+    uint16 Written;
+
+    while(DataWriten < *pStrLen)
+    {
+        DataToWrite = LOGGER_DEF_MIN(*pStrLen - DataWriten, FLASH_PAGE_SIZE_BYTES - ((Address + DataWriten) & (FLASH_PAGE_SIZE_BYTES - 1)));
+        Written = FLASH_WriteFromInt(SSP1, (uint8 *)pStr + DataWriten, DataToWrite, Address + DataWriten);
+        DataWriten += Written;
+        if(Written != DataToWrite)
+        {
+            *pStrLen = DataWriten;
+            return LOGGER_STATUS_BUSY;
+        }
+    }
+    return LOGGER_STATUS_OK;
+}
+
+static LOGGER_STATUS HostLogger_ReadFlashDataCb(uint32 Address, char *pStr, uint16 StrLen)
+{
+    volatile uint32 Status = (uint32)-1;
+
+    if(FLASH_Read(SSP1, (uint8*)pStr, StrLen, 0, Address, 0, (uint32*)&Status, NULL) != OSAL_STATUS_OK)
+    {
+        return LOGGER_STATUS_FLASH_READ_ERROR;
+    }
+    for(uint16 i=0; Status != OSAL_STATUS_OK && i<HOST_LOGGER_FLASH_READ_TIMEOUT_MS/HOST_LOGGER_FLASH_POLL_INTERVAL_MS; i++)
+    {
+        OSAL_SuspendTask(HOST_LOGGER_FLASH_POLL_INTERVAL_MS);
+    }
+    if(Status == OSAL_STATUS_OK)
+    {
+        return LOGGER_STATUS_OK;
+    }
+    return LOGGER_STATUS_FLASH_READ_ERROR;
+}
+
+static LOGGER_STATUS HostLogger_EraseFlashSectorCb(uint32 StartAddress, uint8 NumOfSectors, uint16 FlashSize)
+{
+    volatile uint32 Status = OSAL_STATUS_OK;
+    uint32 Ret = OSAL_STATUS_OK;
+
+    /* sanity check make sure we don't exit the allowed flash bounderies */
+    if(StartAddress < LOGGER_CONFIG_FLASH_START_ADDRESS || NumOfSectors > LOGGER_DEF_FLASH_NUM_OF_DEBUG_SECTORS(FlashSize))
+    {
+        OSAL_ASSERT(FALSE);
+        return LOGGER_STATUS_ERROR_PARAM;
+    }
+    for(uint8 i = 0; i < NumOfSectors && Ret == OSAL_STATUS_OK; i++)
+    {
+        Ret = FLASH_SectorErase(SSP1, 0, StartAddress, 0, (uint32*)&Status, NULL);
+        /* the erase is synchronous, a full FLASH command queue is retried up to the maximum timeout the erase sector takes */
+        for(uint16 j = 0; Ret == FLASH_TRANSMISSION_QUEUE_FULL && j < LOGGER_CONFIG_MAX_SECTOR_ERASE_TIMEOUT_MS/HOST_LOGGER_FLASH_ERASE_POLL_INTERVAL_MS; j++)
+        {
+            OSAL_SuspendTask(HOST_LOGGER_FLASH_ERASE_POLL_INTERVAL_MS);
+            Ret = FLASH_SectorErase(SSP1, 0, StartAddress, 0, (uint32*)&Status, NULL);
+        }
+        StartAddress += (LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB<<10);
+        /* poll on FLASH status erase command, up to the maximum timeout the erase sector takes */
+        for(uint16 j = 0; Ret == OSAL_STATUS_OK && Status != OSAL_STATUS_OK && j < LOGGER_CONFIG_MAX_SECTOR_ERASE_TIMEOUT_MS/HOST_LOGGER_FLASH_ERASE_POLL_INTERVAL_MS; j++)
+        {
+            OSAL_SuspendTask(HOST_LOGGER_FLASH_ERASE_POLL_INTERVAL_MS);
+        }
+    }
+    if(Ret == FLASH_TRANSMISSION_QUEUE_FULL)
+    {
+        return LOGGER_STATUS_BUSY;
+    }
+    if(Ret != OSAL_STATUS_OK || Status != OSAL_STATUS_OK)
+    {
+        return LOGGER_STATUS_FLASH_ERASE_ERROR;
+    }
+    return LOGGER_STATUS_OK;
+}
+
+static void HostLogger_FlashDoneCb(uint32 Status)
+{
+    LoggerFlashDoneCb_t pDoneCb = gpHostFlashDoneCb;
+
+    gpHostFlashDoneCb = NULL;
+
+    if(pDoneCb != NULL)
+    {
+        pDoneCb(Status == OSAL_STATUS_OK ? LOGGER_STATUS_OK : gHostFlashErrorStatus);
+    }
+}
+
+/**
+ * <pre>
+ * static LOGGER_STATUS HostLogger_FlashCmdClaim(LoggerFlashDoneCb_t pDoneCb, LOGGER_STATUS ErrorStatus)
+ * </pre>
+ *  
+ * this function claims the single asynchronous FLASH command context. the check and the claim are done with the interrupts
+ * disabled, so a completion that ends at the same time can not be lost or overwritten
+ *
+ * @param   pDoneCb      [in]       The logger completion routine
+ * @param   ErrorStatus  [in]       The status to report if the FLASH driver command fails
+ *
+ * @return LOGGER_STATUS_OK or LOGGER_STATUS_BUSY if an asynchronous command is already pending
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static LOGGER_STATUS HostLogger_FlashCmdClaim(LoggerFlashDoneCb_t pDoneCb, LOGGER_STATUS ErrorStatus)
+{
+    uint32 IntState = OSAL_HostDisableInterrupts();
+
+
+    if(gpHostFlashDoneCb != NULL)
+    {
+        OSAL_HostRestoreInterrupts(IntState);
+        return LOGGER_STATUS_BUSY;
+    }
+    gpHostFlashDoneCb = pDoneCb;
+    gHostFlashErrorStatus = ErrorStatus;
+    OSAL_HostRestoreInterrupts(IntState);
+
+    return LOGGER_STATUS_OK;
+}
+
+static LOGGER_STATUS HostLogger_ReadFlashDataAsyncCb(uint32 Address, char *pStr, uint16 StrLen, LoggerFlashDoneCb_t pDoneCb)
+{
+    uint32 Ret;
+
+    /* only one asynchronous command at a time, a second request is rejected until the pending one completes */
+    if(HostLogger_FlashCmdClaim(pDoneCb, LOGGER_STATUS_FLASH_READ_ERROR) != LOGGER_STATUS_OK)
+    {
+        return LOGGER_STATUS_BUSY;
+    }
+
+    Ret = FLASH_Read(SSP1, (uint8*)pStr, StrLen, 0, Address, 0, (uint32*)&gHostFlashCmdStatus, HostLogger_FlashDoneCb);
+    /* the FLASH command queue is shared with the other FLASH users, a full queue is retried for a short while */
+    for(uint16 i = 0; Ret == FLASH_TRANSMISSION_QUEUE_FULL && i < HOST_LOGGER_FLASH_QUEUE_RETRY_MS/HOST_LOGGER_FLASH_POLL_INTERVAL_MS; i++)
+    {
+        OSAL_SuspendTask(HOST_LOGGER_FLASH_POLL_INTERVAL_MS);
+        Ret = FLASH_Read(SSP1, (uint8*)pStr, StrLen, 0, Address, 0, (uint32*)&gHostFlashCmdStatus, HostLogger_FlashDoneCb);
+    }
+    if(Ret != OSAL_STATUS_OK)
+    {
+        gpHostFlashDoneCb = NULL;
+        return LOGGER_STATUS_FLASH_READ_ERROR;
+    }
+    return LOGGER_STATUS_OK;
+}
+
+static LOGGER_STATUS HostLogger_EraseFlashSectorAsyncCb(uint32 Address, uint16 FlashSize, LoggerFlashDoneCb_t pDoneCb)
+{
+    uint32 Ret;
+
+    /* sanity check make sure we don't exit the allowed flash bounderies */
+    if(Address < LOGGER_CONFIG_FLASH_START_ADDRESS || Address >= LOGGER_DEF_FLASH_END_ADDRESS(LOGGER_CONFIG_FLASH_START_ADDRESS, FlashSize))
+    {
+        OSAL_ASSERT(FALSE);
+        return LOGGER_STATUS_ERROR_PARAM;
+    }
+    /* only one asynchronous command at a time, a second request is rejected until the pending one completes */
+    if(HostLogger_FlashCmdClaim(pDoneCb, LOGGER_STATUS_FLASH_ERASE_ERROR) != LOGGER_STATUS_OK)
+    {
+        return LOGGER_STATUS_BUSY;
+    }
+
+    Ret = FLASH_SectorErase(SSP1, 0, Address, 0, (uint32*)&gHostFlashCmdStatus, HostLogger_FlashDoneCb);
+    for(uint16 i = 0; Ret == FLASH_TRANSMISSION_QUEUE_FULL && i < HOST_LOGGER_FLASH_QUEUE_RETRY_MS/HOST_LOGGER_FLASH_POLL_INTERVAL_MS; i++)
+    {
+        OSAL_SuspendTask(HOST_LOGGER_FLASH_POLL_INTERVAL_MS);
+        Ret = FLASH_SectorErase(SSP1, 0, Address, 0, (uint32*)&gHostFlashCmdStatus, HostLogger_FlashDoneCb);
+    }
+    if(Ret != OSAL_STATUS_OK)
+    {
+        gpHostFlashDoneCb = NULL;
+        return LOGGER_STATUS_FLASH_ERASE_ERROR;
+    }
+    return LOGGER_STATUS_OK;
+}
+
+/**
+ * <pre>
+ * static LOGGER_STATUS HostLogger_SendFtpFileCb(LoggerSocketConfig_t *pSocketConfig, LoggerFtpConfig_t *pFtpConfig, uint32 Address,
+ *                                               int FileSize, char FileName[], uint8 FileNameLen)
+ * </pre>
+ *
+ * this function uploads a log file. the host FTP server is the current directory: the FLASH range is copied to a local file
+ * and the FTP task reply is sent to the logger task
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static LOGGER_STATUS HostLogger_SendFtpFileCb(LoggerSocketConfig_t *pSocketConfig, LoggerFtpConfig_t *pFtpConfig, uint32 Address,
+                                              int FileSize, char FileName[], uint8 FileNameLen)
+{
+    char Chunk[HOST_LOGGER_FTP_COPY_CHUNK_BYTES];
+    char LocalName[LOGGER_CONFIG_FTP_FILE_NAME_LEN + 1];
+    uint32 Status = OSAL_STATUS_OK;
+    uint16 ChunkLen;
+    FILE *pFile;
+
+    OSAL_StrCopy(LocalName, FileName, LOGGER_DEF_MIN(FileNameLen, LOGGER_CONFIG_FTP_FILE_NAME_LEN));
+    LocalName[LOGGER_DEF_MIN(FileNameLen, LOGGER_CONFIG_FTP_FILE_NAME_LEN)] = '\0';
+    pFile = fopen(LocalName, "wb");
+    if(pFile == NULL)
+    {
+        return LOGGER_STATUS_SEND_LOG_FILE_FAILED;
+    }
+    while(FileSize > 0 && Status == OSAL_STATUS_OK)
+    {
+        ChunkLen = LOGGER_DEF_MIN(FileSize, (int)sizeof(Chunk));
+        if(HostLogger_ReadFlashDataCb(Address, Chunk, ChunkLen) != LOGGER_STATUS_OK || fwrite(Chunk, 1, ChunkLen, pFile) != ChunkLen)
+        {
+            Status = OSAL_STATUS_ERROR;
+        }
+        Address += ChunkLen;
+        FileSize -= ChunkLen;
+    }
+    fclose(pFile);
+
+    HostLogger_SendReply(TASK_APP_FTP_PUT_MANAGER_ID, 0, Status, 0);
+    return LOGGER_STATUS_OK;
+}
+
+static LOGGER_STATUS HostLogger_GetDateAndTimeCb(LoggerDateAndTime_t *pDateAndTime)
+{
+    RTC_Time_t Time;
+
+    RTC_GetTimeAndDate(&Time);
+    pDateAndTime->Year = Time.Year - CLOCK_BASE_YEAR;
+    pDateAndTime->Month = Time.Month;
+    pDateAndTime->Day = Time.DayOfMonth;
+    pDateAndTime->Hour = Time.Hour;
+    pDateAndTime->Minute = Time.Minute;
+    pDateAndTime->Second = Time.Second;
+    return LOGGER_STATUS_OK;
+}
+
+static LOGGER_STATUS HostLogger_SaveNVRParamsCb(uint32 Address, void *pBuff, uint8 SizeBytes)
+{
+    if(EEPROM_WriteFromInt((uint8 *)pBuff, SizeBytes, Address) == FALSE)
+    {
+        return LOGGER_STATUS_EEPROM_WRITE_ERROR;
+    }
+    return LOGGER_STATUS_OK;
+}
+
+static LOGGER_STATUS HostLogger_ReadNVRParamsCb(uint32 Address, void *pBuff, uint8 SizeBytes)
+{
+    if(EepromReadPoll(Address, (uint8*)pBuff, SizeBytes, 0, 10, 500) != TRUE)
+    {
+        return LOGGER_STATUS_NVR_READ_ERROR;
+    }
+    return LOGGER_STATUS_OK;
+}
+
+static LOGGER_STATUS HostLogger_GetPanelIdCb(char PanelIdStr[LOGGER_CONFIG_PANEL_ID_SIZE_BYTES])
+{
+    OSAL_StrCopy(PanelIdStr, HOST_LOGGER_PANEL_ID, LOGGER_CONFIG_PANEL_ID_SIZE_BYTES);
+    return LOGGER_STATUS_OK;
+}
+
+static uint16 HostLogger_ConfigSize(LoggerConfigType_e ConfigType)
+{
+    switch(ConfigType)
+    {
+        case e_LOGGER_CONF_TYPE_GENERAL:
+            return sizeof(LoggerGenConfig_t);
+        case e_LOGGER_CONF_TYPE_SOCKET:
+            return sizeof(LoggerSocketConfig_t);
+        case e_LOGGER_CONF_TYPE_FTP:
+            return sizeof(LoggerFtpConfig_t);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * <pre>
+ * static LOGGER_STATUS HostLogger_ReadConfigCb(LoggerConfigType_e ConfigType, void *pConfig)
+ * </pre>
+ *
+ * this function reads a logger configuration type from the EEPROM
+ *
+ * @return LOGGER_STATUS_OK on success, or LOGGER_STATUS_NVR_READ_ERROR if the configuration was never written (the logger takes its default)
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static LOGGER_STATUS HostLogger_ReadConfigCb(LoggerConfigType_e ConfigType, void *pConfig)
+{
+    uint32 Address = HOST_LOGGER_EEPROM_CONFIG_ADDRESS + ConfigType * HOST_LOGGER_EEPROM_CONFIG_SIZE_BYTES;
+    uint16 Size = HostLogger_ConfigSize(ConfigType);
+    uint8 Valid;
+
+    if(Size == 0)
+    {
+        OSAL_ASSERT(0);
+        return LOGGER_STATUS_INVALID_PARAM;
+    }
+    if(EepromReadPoll(Address, &Valid, 1, 0, 10, 500) != TRUE || Valid != HOST_LOGGER_EEPROM_CONFIG_VALID ||
+       EepromReadPoll(Address + 1, (uint8*)pConfig, Size, 0, 10, 500) != TRUE)
+    {
+        return LOGGER_STATUS_NVR_READ_ERROR;
+    }
+    return LOGGER_STATUS_OK;
+}
+
+static LOGGER_STATUS HostLogger_WriteConfigCb(LoggerConfigType_e ConfigType, void *pConfig)
+{
+    uint32 Address = HOST_LOGGER_EEPROM_CONFIG_ADDRESS + ConfigType * HOST_LOGGER_EEPROM_CONFIG_SIZE_BYTES;
+    uint16 Size = HostLogger_ConfigSize(ConfigType);
+    uint8 Valid = HOST_LOGGER_EEPROM_CONFIG_VALID;
+
+    if(Size == 0)
+    {
+        OSAL_ASSERT(0);
+        return LOGGER_STATUS_INVALID_PARAM;
+    }
+    if(EepromWritePoll(Address + 1, (uint8*)pConfig, Size, 0, 10, 500) != TRUE ||
+       EepromWritePoll(Address, &Valid, 1, 0, 10, 500) != TRUE)
+    {
+        return LOGGER_STATUS_EEPROM_WRITE_ERROR;
+    }
+    return LOGGER_STATUS_OK;
+}
+
+static uint32 HostLogger_GetTimeUsCb(void)
+{
+    return OSAL_HostGetTimeUs();
+}
+
+/* the host has no cycle counter, the latency probes count ns */
+static uint32 HostLogger_GetCyclesCb(void)
+{
+    return OSAL_HostGetTimeNs();
+}
+
+static uint32 HostLogger_DisableInterruptsCb(void)
+{
+    return OSAL_HostDisableInterrupts();
+}
+
+static void HostLogger_RestoreInterruptsCb(uint32 IntState)
+{
+    OSAL_HostRestoreInterrupts(IntState);
+}
+
+/* below is the logger callback function. every platform needs to fill in its own implementation to every callback so the feature can work */
+
+LoggerCB_t gLoggerCbList = {
+    HostLogger_OpenSocketCb,
+    NULL,
+    HostLogger_SendSocketDataCb,
+    HostLogger_SendUartDataCb,
+    HostLogger_SendFlashDataCb,
+    HostLogger_ReadFlashDataCb,
+    HostLogger_EraseFlashSectorCb,
+    HostLogger_SendFtpFileCb,
+    HostLogger_GetDateAndTimeCb,
+    HostLogger_SaveNVRParamsCb,
+    HostLogger_ReadNVRParamsCb,
+    HostLogger_GetPanelIdCb,
+    HostLogger_ReadConfigCb,
+    HostLogger_WriteConfigCb,
+    HostLogger_ReadFlashDataAsyncCb,
+    HostLogger_EraseFlashSectorAsyncCb,
+    HostLogger_GetTimeUsCb,
+    HostLogger_SendUartDataCb,              /* the host RS232 output is polled */
+    HostLogger_DisableInterruptsCb,
+    HostLogger_RestoreInterruptsCb,
+    HostLogger_GetCyclesCb,
+};
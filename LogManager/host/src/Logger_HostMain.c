@@ -0,0 +1,123 @@
+/*--------------------------------------------------------------------------------------
+ * Description: the host logger demo. it starts the simulated peripherals and the logger
+ *              tasks, prints log messages and structured records to the FLASH and to the 
+ *              loopback UDP sink and prints the logger statistics. the FLASH image can be
+ *              kept in a file, for tools/logger_kv.py. at the end it checks the RX buffer occupancy
+ *              series after a simulated idle period longer than the series
+ *              usage: logger_host [number of messages] [FLASH image file]
+ * -------------------------------------------------------------------------------------*/
+#include <stdlib.h>
+#include "Logger_Defs.h"
+#include "Logger_Api.h"
+#include "Logger_Debug.h"
+#include "Host_Sim.h"
+
+#define HOST_MAIN_DEFAULT_NUM_OF_MSGS           1000
+#define HOST_MAIN_READY_TIMEOUT_MS              5000    /* the maximum time to wait for the logger init */
+#define HOST_MAIN_DRAIN_TIME_MS                 500     /* the time given to the logger to send the last messages */
+#define HOST_MAIN_TELEMETRY_INTERVAL_SEC        1       /* the demo runs for a few seconds */
+#define HOST_MAIN_CMD_TASK_END_MS               1000    /* the logger task ends (500 ms) between the two server queries */
+#define HOST_MAIN_BURST_NUM_OF_MSGS             8       /* the messages printed between two yields, so the drain keeps up */
+#define HOST_MAIN_KV_EVERY_NUM_OF_MSGS          100     /* a structured record is printed every this number of messages */
+#define HOST_MAIN_IDLE_GAP_SEC                  (LOGGER_CONFIG_OCCUPANCY_SERIES_SIZE + 8) /* the simulated idle period */
+#define HOST_MAIN_IDLE_SAMPLE_MS                100     /* the time given to the drain task to sample the occupancy after the idle period */
+#define HOST_MAIN_IDLE_POLL_MS                  20      /* the idle time is polled at this interval until the logger is idle */
+#define HOST_MAIN_IDLE_WAIT_MS                  5000    /* the maximum time to wait for the logger to send the RX buffers */
+
+/**
+ * <pre>
+ * static BOOL HostMain_CheckIdleGap(void)
+ * </pre>
+ *
+ * this function flushes the RX buffers (the FLASH sink keeps the last partial page for a full page otherwise), waits 
+ * for the TX timer to stop (the idle time grows), skips the logger time over an idle 
+ * period longer than the occupancy series, prints a message so the drain task samples the occupancy, and checks that 
+ * the series holds the empty seconds of the idle period (a second may end while the message is sampled) and that the 
+ * idle time counts the period
+ *
+ * @return TRUE if the occupancy series and the idle time cover the idle period, FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static BOOL HostMain_CheckIdleGap(void)
+{
+    LoggerOccupancy_t Before, After;
+    uint32 WaitMS = 0;
+    uint8 NumOfEmpty = 0;
+    uint8 Idx;
+
+    Logger_PanicFlushApi();
+    Logger_GetOccupancyApi(&Before);
+    do
+    {
+        OSAL_SuspendTask(HOST_MAIN_IDLE_POLL_MS);
+        WaitMS += HOST_MAIN_IDLE_POLL_MS;
+        After = Before;
+        Logger_GetOccupancyApi(&Before);
+    }while(Before.IdleMS == After.IdleMS && WaitMS < HOST_MAIN_IDLE_WAIT_MS);
+
+    OSAL_HostSkipTimeUs(HOST_MAIN_IDLE_GAP_SEC * 1000000);
+    LOG_PRINT(LEVEL_INFO, "host log message after %d idle seconds\n", HOST_MAIN_IDLE_GAP_SEC);
+    OSAL_SuspendTask(HOST_MAIN_IDLE_SAMPLE_MS);
+    Logger_GetOccupancyApi(&After);
+
+    for(Idx = 0; Idx < After.NumOfSeconds; Idx++)
+    {
+        NumOfEmpty += (After.Series[Idx].MaxUsed == 0);
+    }
+    Printf("idle gap: %d of %d seconds empty, IdleMS %d -> %d\n", NumOfEmpty, After.NumOfSeconds, Before.IdleMS, After.IdleMS);
+
+    return (After.NumOfSeconds == LOGGER_CONFIG_OCCUPANCY_SERIES_SIZE && NumOfEmpty >= LOGGER_CONFIG_OCCUPANCY_SERIES_SIZE - 1 &&
+            After.IdleMS - Before.IdleMS >= HOST_MAIN_IDLE_GAP_SEC * 1000);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32 NumOfMsgs = (argc > 1)? strtoul(argv[1], NULL, 0): HOST_MAIN_DEFAULT_NUM_OF_MSGS;
+    HostFlashStats_t FlashStats;
+    HostUdpSinkStats_t SinkStats;
+    uint32 Idx;
+
+    if(!HostLogger_InitPlatform(TASK_APP_HOST_MAIN_ID, NULL, (argc > 2)? argv[2]: NULL, HOST_SIM_DEFAULT_EEPROM_FILE) ||
+       !HostLogger_Start(HostLogger_NewConfig(LOGGER_DEST_TYPE_FLASH_AND_SOCKET, LOGGER_MODE_TYPE_PUSH_PULL), LOGGER_ATTR_ERASE_FLASH_NOW, HOST_MAIN_READY_TIMEOUT_MS))
+    {
+        return 1;
+    }
+    Logger_SetTelemetryIntervalApi(HOST_MAIN_TELEMETRY_INTERVAL_SEC);
+
+    for(Idx = 0; Idx < NumOfMsgs; Idx++)
+    {
+        LOG_PRINT(LEVEL_INFO, "host log message %d of %d\n", Idx, NumOfMsgs);
+        if((Idx % HOST_MAIN_KV_EVERY_NUM_OF_MSGS) == 0)
+        {
+            LOG_KV(LEVEL_INFO, e_LOGGER_KV_EVENT_HOST_DEMO, e_LOGGER_KV_KEY_ID, Idx, e_LOGGER_KV_KEY_STATUS, -(int)(Idx % 3),
+                   e_LOGGER_KV_KEY_NAME, "burst");
+        }
+        if((Idx % HOST_MAIN_BURST_NUM_OF_MSGS) == (HOST_MAIN_BURST_NUM_OF_MSGS - 1))
+        {
+            OSAL_SuspendTask(1);
+        }
+    }
+    LOG_KV(LEVEL_INFO, e_LOGGER_KV_EVENT_HOST_DEMO_DONE, e_LOGGER_KV_KEY_COUNT, NumOfMsgs);
+
+    /* the server query is answered by the logger task while the messages are sent */
+    Logger_SendTaskStatsToSrvApi();
+    Logger_SendTopSitesToSrvApi(LOGGER_DEF_MAX_TOP_SITES, FALSE);
+    OSAL_SuspendTask(HOST_MAIN_DRAIN_TIME_MS + HOST_MAIN_CMD_TASK_END_MS);
+
+    if(!HostMain_CheckIdleGap())
+    {
+        Printf("the occupancy series does not cover the idle period\n"); LoggerDebug_PrintRAMstatus();
+        return 1;
+    }
+
+    LoggerDebug_PrintRAMstatus();
+    HostFlash_GetStats(&FlashStats);
+    HostUdp_SinkGetStats(&SinkStats);
+    Printf("\nFLASH: WriteCnt: %d WriteBytes: %d ReadCnt: %d EraseCnt: %d QueueFullCnt: %d DirtyWriteCnt: %d\n",
+           FlashStats.WriteCnt, FlashStats.WriteBytes, FlashStats.ReadCnt, FlashStats.EraseCnt, FlashStats.QueueFullCnt, FlashStats.DirtyWriteCnt);
+    Printf("UDP sink: Datagrams: %d Bytes: %d\n", SinkStats.Datagrams, SinkStats.Bytes);
+
+    return 0;
+}
@@ -0,0 +1,395 @@
+/*--------------------------------------------------------------------------------------
+ * Description: the host FLASH power loss test. every run boots the logger twice, each
+ *              boot in its own process, on a FLASH image file and an EEPROM file:
+ *              boot A erases the log file and prints records in PULL mode (FLASH only),
+ *              with a binary (%b of blank bytes) and a structured record every few records,
+ *              until the power is lost at a random FLASH program, FLASH erase or EEPROM
+ *              write. boot B recovers the log file from the NVR parameters (Logger_InitFlash),
+ *              prints a marker record and exits. the test then scans the FLASH image: the
+ *              records boot A printed must be found in order up to the power loss (the tail
+ *              that was still in RAM is lost), none corrupted, and the marker must be found.
+ *              the FLASH model also injects partial writes and full command queues.
+ *              the summary is written as JSON to the standard output.
+ *              usage: logger_host_powerloss [runs] [seed] [partial write %] [queue full %]
+ * -------------------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "Logger_Defs.h"
+#include "Logger_Manager.h"
+#include "Logger_Release.h"
+#include "FLASH_API.h"
+#include "Host_Sim.h"
+
+#define HOST_PL_FLASH_FILE                      "logger_powerloss_flash.bin"
+#define HOST_PL_EEPROM_FILE                     "logger_powerloss_eeprom.bin"
+#define HOST_PL_DEFAULT_NUM_OF_RUNS             100
+#define HOST_PL_DEFAULT_SEED                    1
+#define HOST_PL_READY_TIMEOUT_MS                5000    /* the maximum time to wait for the logger init */
+#define HOST_PL_WRITE_TIMEOUT_MS                2000    /* the maximum time boot B waits for the marker to be written */
+#define HOST_PL_BOOT_TIMEOUT_SEC                30      /* a boot that takes longer is killed (and counted as a failure) */
+#define HOST_PL_PRINT_INTERVAL_MS               1       /* the record interval of boot A */
+#define HOST_PL_MAX_OPS                         600     /* the power is lost within this number of FLASH and EEPROM operations */
+#define HOST_PL_MAX_RECORDS                     4000    /* the maximum records boot A prints (the power is lost well before) */
+#define HOST_PL_PAYLOAD_LEN                     32      /* a record: "PL<run> <seq> <payload>\n", 47 bytes + the logger header */
+#define HOST_PL_TAG_LEN                         7       /* "PL<run>" */
+#define HOST_PL_RECORD_LEN                      (HOST_PL_TAG_LEN + 7 + HOST_PL_PAYLOAD_LEN + 1)
+#define HOST_PL_MARKER                          " RECOVERED\n"
+#define HOST_PL_BIN_EVERY_NUM_OF_RECORDS        8       /* a binary and a structured record are printed every this number of records */
+#define HOST_PL_BLANK_LEN                       64      /* the blank (0xFF) bytes of the binary record */
+#define HOST_PL_EXIT_INIT_FAILED                0x51
+
+/* the log file is written in the sector data areas, the sector summary record is at every sector tail */
+#define HOST_PL_SECTOR_DATA_BYTES               ((LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB<<10) - LOGGER_CONFIG_FLASH_SECTOR_SUMMARY_SIZE_BYTES)
+#define HOST_PL_NUM_OF_SECTORS                  (LOGGER_CONFIG_DEFAULT_FLASH_SIZE / LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB)
+
+/* the run state shared by the test process and the boots */
+typedef struct {
+    HostPowerLoss_t Loss;                       /* where boot A lost its power */
+    int32 LastSeq;                              /* the last record boot A printed, -1 if none */
+    uint32 DirtyWriteCnt;                       /* the boot B writes that tried to set programmed FLASH bits */
+    BOOL IsMarkerWritten;                       /* boot B has written the marker record */
+}HostPlShared_t;
+
+/* the FLASH image scan result of a run */
+typedef struct {
+    uint32 Printed;                             /* the records boot A printed */
+    uint32 Found;                               /* the records found intact */
+    uint32 TailLost;                            /* the lost records after the last record found (the RX buffer lost with the RAM) */
+    uint32 Holes;                               /* the lost records before the last record found */
+    uint32 Corrupted;                           /* the records found with a damaged body */
+    uint32 Torn;                                /* the record torn by the power loss (at most one, the first record lost) */
+    BOOL IsMarkerFound;
+}HostPlResult_t;
+
+/* the totals of all the runs */
+typedef struct {
+    uint32 Runs;
+    uint32 Failures;                            /* the runs that did not recover correctly */
+    uint32 BootFailures;                        /* the runs with a boot that failed, crashed or hung */
+    uint32 LossOps[e_HOST_POWER_OP_MAX];        /* the runs per interrupted operation */
+    uint32 Printed;
+    uint32 Found;
+    uint32 TailLost;
+    uint32 Holes;
+    uint32 Corrupted;
+    uint32 Torn;
+    uint32 MarkersMissing;
+    uint32 DirtyWriteRuns;
+    uint64_t LostBytes;
+    uint32 MaxLostBytes;
+}HostPlTotals_t;
+
+extern LoggerManager_t gLoggerManager;
+
+static const char * const gHostPlOpName[e_HOST_POWER_OP_MAX] = { "none", "program", "erase", "eeprom" };
+
+static HostFlashModel_t gHostPlFlashModel;
+static uint8 gHostPlImage[HOST_PL_NUM_OF_SECTORS * HOST_PL_SECTOR_DATA_BYTES];
+static uint8 gHostPlFound[HOST_PL_MAX_RECORDS];
+
+                /* ========================================== *
+                 *     P R I V A T E     F U N C T I O N S    *
+                 * ========================================== */
+
+/* the record text of a record sequence number, the payload changes with every record */
+static void HostPl_Record(uint32 Run, uint32 Seq, char *pRecord)
+{
+    uint32 Idx;
+    uint32 Len = sprintf(pRecord, "PL%05u %05u ", Run % 100000, Seq);
+
+    for(Idx = 0; Idx < HOST_PL_PAYLOAD_LEN; Idx++)
+    {
+        pRecord[Len++] = 'A' + (Seq + Idx) % 26;
+    }
+    pRecord[Len++] = '\n';
+    pRecord[Len] = '\0';
+}
+
+/**
+ * <pre>
+ * static void HostPl_Boot(HostPlShared_t *pShared, uint32 Run, uint32 Seed, BOOL IsRecovery)
+ * </pre>
+ *  
+ * this function is the boot process body, it never returns. boot A erases the log file, arms the power loss and prints
+ * records until the power is lost. boot B continues the log file from the NVR parameters and writes the marker record
+ *
+ * @param   pShared         [inout] the run state shared with the test process
+ * @param   Run             [in]    the run number
+ * @param   Seed            [in]    the run random seed
+ * @param   IsRecovery      [in]    TRUE for boot B, FALSE for boot A
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void HostPl_Boot(HostPlShared_t *pShared, uint32 Run, uint32 Seed, BOOL IsRecovery)
+{
+    RXBuffer_t *pPriorityBuffer = &gLoggerManager.PriorityBuffer;
+    LoggerConfig_t *pConfig;
+    char Record[HOST_PL_RECORD_LEN + 1];
+    uint8 Blank[HOST_PL_BLANK_LEN];
+    unsigned int RunSeed = Seed;
+    HostFlashStats_t Stats;
+    uint32 Idx;
+
+    /* the logger status messages are not part of the summary */
+    freopen("/dev/null", "w", stdout);
+    alarm(HOST_PL_BOOT_TIMEOUT_SEC);
+
+    gHostPlFlashModel.Seed = Seed + IsRecovery;
+    if(!HostLogger_InitPlatform(TASK_APP_HOST_MAIN_ID, &gHostPlFlashModel, HOST_PL_FLASH_FILE, HOST_PL_EEPROM_FILE))
+    {
+        _exit(HOST_PL_EXIT_INIT_FAILED);
+    }
+    /* every record printed must reach the FLASH, the printing waits for the drain task while a sector is erased */
+    pConfig = HostLogger_NewConfig(LOGGER_DEST_TYPE_FLASH, LOGGER_MODE_TYPE_PULL);
+    pConfig->General.Attributes |= LOGGER_ATTR_OVERRUN_BLOCK;
+    if(!HostLogger_Start(pConfig, IsRecovery? LOGGER_ATTR_NONE: LOGGER_ATTR_ERASE_FLASH_NOW, HOST_PL_READY_TIMEOUT_MS))
+    {
+        _exit(HOST_PL_EXIT_INIT_FAILED);
+    }
+
+    if(!IsRecovery)
+    {
+        memset(Blank, 0xFF, sizeof(Blank));
+        HostPower_Arm(rand_r(&RunSeed) % HOST_PL_MAX_OPS, rand_r(&RunSeed), &pShared->Loss);
+        for(Idx = 0; Idx < HOST_PL_MAX_RECORDS; Idx++)
+        {
+            /* blank bytes and line ends in the log file, the recovery must not take them for the log file end */
+            if((Idx % HOST_PL_BIN_EVERY_NUM_OF_RECORDS) == 0)
+            {
+                LOG_PRINT(LEVEL_INFO, "%b", Blank, sizeof(Blank));
+                LOG_KV(LEVEL_INFO, e_LOGGER_KV_EVENT_HOST_POWER_LOSS, e_LOGGER_KV_KEY_ID, Idx, e_LOGGER_KV_KEY_COUNT, 0xFFFFFFFF,
+                       e_LOGGER_KV_KEY_NAME, "\n\xFF\n");
+            }
+            HostPl_Record(Run, Idx, Record);
+            LOG_PRINT(LEVEL_INFO, "%s", Record);
+            pShared->LastSeq = Idx;
+            OSAL_SuspendTask(HOST_PL_PRINT_INTERVAL_MS);
+        }
+        _exit(0);
+    }
+
+    /* the marker is an ERROR record, it is written without waiting for a full FLASH page */
+    sprintf(Record, "PL%05u" HOST_PL_MARKER, Run % 100000);
+    LOG_PRINT(LEVEL_ERROR, "%s", Record);
+    for(Idx = 0; Idx < HOST_PL_WRITE_TIMEOUT_MS && pPriorityBuffer->pSinkRead[e_LOGGER_SINK_FLASH] != pPriorityBuffer->pWrite; Idx++)
+    {
+        OSAL_SuspendTask(1);
+    }
+    HostFlash_GetStats(&Stats);
+    pShared->DirtyWriteCnt = Stats.DirtyWriteCnt;
+    pShared->IsMarkerWritten = (Idx < HOST_PL_WRITE_TIMEOUT_MS);
+    _exit(0);
+}
+
+/* runs a boot process and returns its exit code, or -1 if it was killed */
+static int HostPl_RunBoot(HostPlShared_t *pShared, uint32 Run, uint32 Seed, BOOL IsRecovery)
+{
+    int Status;
+    pid_t Pid;
+
+    fflush(stdout);
+    Pid = fork();
+    if(Pid == 0)
+    {
+        HostPl_Boot(pShared, Run, Seed, IsRecovery);
+    }
+    if(Pid < 0 || waitpid(Pid, &Status, 0) != Pid)
+    {
+        return -1;
+    }
+    return WIFEXITED(Status)? WEXITSTATUS(Status): -1;
+}
+
+/**
+ * <pre>
+ * static BOOL HostPl_Scan(uint32 Run, const HostPlShared_t *pShared, HostPlResult_t *pResult)
+ * </pre>
+ *  
+ * this function scans the log file in the FLASH image for the run records and the marker record
+ *
+ * @param   Run             [in]    the run number
+ * @param   pShared         [in]    the run state
+ * @param   pResult         [out]   the scan result
+ *
+ * @return TRUE if the FLASH image was read or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static BOOL HostPl_Scan(uint32 Run, const HostPlShared_t *pShared, HostPlResult_t *pResult)
+{
+    char Tag[HOST_PL_TAG_LEN + 1];
+    char Record[HOST_PL_RECORD_LEN + 1];
+    uint32 Size = sizeof(gHostPlImage);
+    int32 MaxFound = -1;
+    uint32 Idx;
+    uint32 Seq;
+    FILE *pImage;
+    BOOL IsOk = TRUE;
+
+    /* the log file (erased by boot A) starts at the first sector, the sector data areas are concatenated */
+    pImage = fopen(HOST_PL_FLASH_FILE, "rb");
+    for(Idx = 0; pImage != NULL && IsOk && Idx < HOST_PL_NUM_OF_SECTORS; Idx++)
+    {
+        IsOk = (fseek(pImage, LOGGER_CONFIG_FLASH_START_ADDRESS + Idx * (LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB<<10), SEEK_SET) == 0 &&
+                fread(&gHostPlImage[Idx * HOST_PL_SECTOR_DATA_BYTES], 1, HOST_PL_SECTOR_DATA_BYTES, pImage) == HOST_PL_SECTOR_DATA_BYTES);
+    }
+    if(pImage == NULL || !IsOk)
+    {
+        if(pImage != NULL)
+        {
+            fclose(pImage);
+        }
+        return FALSE;
+    }
+    fclose(pImage);
+
+    memset(pResult, 0, sizeof(HostPlResult_t));
+    memset(gHostPlFound, 0, sizeof(gHostPlFound));
+    pResult->Printed = pShared->LastSeq + 1;
+    sprintf(Tag, "PL%05u", Run % 100000);
+
+    for(Idx = 0; Idx + HOST_PL_TAG_LEN <= Size; Idx++)
+    {
+        if(memcmp(&gHostPlImage[Idx], Tag, HOST_PL_TAG_LEN) != 0)
+        {
+            continue;
+        }
+        if(Idx + HOST_PL_TAG_LEN + sizeof(HOST_PL_MARKER) - 1 <= Size && 
+           memcmp(&gHostPlImage[Idx + HOST_PL_TAG_LEN], HOST_PL_MARKER, sizeof(HOST_PL_MARKER) - 1) == 0)
+        {
+            pResult->IsMarkerFound = TRUE;
+            continue;
+        }
+        /* a record body is compared to the record of its sequence number */
+        Seq = strtoul((const char *)&gHostPlImage[Idx + HOST_PL_TAG_LEN + 1], NULL, 10);
+        if(Seq < HOST_PL_MAX_RECORDS && Idx + HOST_PL_RECORD_LEN <= Size)
+        {
+            HostPl_Record(Run, Seq, Record);
+            if(memcmp(&gHostPlImage[Idx], Record, HOST_PL_RECORD_LEN) == 0)
+            {
+                gHostPlFound[Seq] = 1;
+                continue;
+            }
+        }
+        pResult->Corrupted++;
+    }
+
+    for(Idx = 0; Idx < pResult->Printed && Idx < HOST_PL_MAX_RECORDS; Idx++)
+    {
+        if(gHostPlFound[Idx])
+        {
+            pResult->Found++;
+            MaxFound = Idx;
+        }
+    }
+    pResult->TailLost = pResult->Printed - (MaxFound + 1);
+    pResult->Holes = (MaxFound + 1) - pResult->Found;
+    /* the first lost record may be torn: cut by the interrupted page program, or by the end of the last FLASH write (the rest of it was in RAM) */
+    if(pResult->Corrupted > 0 && pResult->TailLost > 0)
+    {
+        pResult->Corrupted--;
+        pResult->Torn = 1;
+    }
+    return TRUE;
+}
+
+static void HostPl_PrintSummary(const HostPlTotals_t *pTotals, uint32 Seed)
+{
+    uint32 Idx;
+
+    printf("{\n  \"logger_version\": \"%s\", \"runs\": %d, \"seed\": %d,\n", LOGGER_VERSION, pTotals->Runs, Seed);
+    printf("  \"flash_model\": {\"page_program_us\": %d, \"erase_time_ms\": %d, \"queue_size\": %d, \"partial_write_pct\": %d, \"queue_full_pct\": %d},\n",
+           gHostPlFlashModel.PageProgramUs, gHostPlFlashModel.EraseTimeMS, gHostPlFlashModel.QueueSize, 
+           gHostPlFlashModel.PartialWritePercent, gHostPlFlashModel.QueueFullPercent);
+    printf("  \"power_loss_ops\": {");
+    for(Idx = 0; Idx < e_HOST_POWER_OP_MAX; Idx++)
+    {
+        printf("%s\"%s\": %d", (Idx > 0)? ", ": "", gHostPlOpName[Idx], pTotals->LossOps[Idx]);
+    }
+    printf("},\n");
+    printf("  \"recovery_failures\": %d, \"boot_failures\": %d, \"markers_missing\": %d, \"dirty_write_runs\": %d,\n",
+           pTotals->Failures, pTotals->BootFailures, pTotals->MarkersMissing, pTotals->DirtyWriteRuns);
+    printf("  \"records_printed\": %d, \"records_found\": %d, \"tail_lost_records\": %d, \"hole_records\": %d, \"corrupted_records\": %d, \"torn_records\": %d,\n",
+           pTotals->Printed, pTotals->Found, pTotals->TailLost, pTotals->Holes, pTotals->Corrupted, pTotals->Torn);
+    printf("  \"lost_bytes_mean\": %.1f, \"lost_bytes_max\": %d\n}\n", 
+           (pTotals->Runs > 0)? (double)pTotals->LostBytes / pTotals->Runs: 0.0, pTotals->MaxLostBytes);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32 NumOfRuns = (argc > 1)? strtoul(argv[1], NULL, 0): HOST_PL_DEFAULT_NUM_OF_RUNS;
+    uint32 Seed = (argc > 2)? strtoul(argv[2], NULL, 0): HOST_PL_DEFAULT_SEED;
+    HostPlShared_t *pShared;
+    HostPlResult_t Result;
+    HostPlTotals_t Totals;
+    uint32 LostBytes;
+    uint32 Run;
+    int ExitA;
+    int ExitB;
+    BOOL IsFailed;
+
+    HostFlash_GetDefaultModel(&gHostPlFlashModel);
+    gHostPlFlashModel.PartialWritePercent = (argc > 3)? strtoul(argv[3], NULL, 0): 0;
+    gHostPlFlashModel.QueueFullPercent = (argc > 4)? strtoul(argv[4], NULL, 0): 0;
+    pShared = (HostPlShared_t *)mmap(NULL, sizeof(HostPlShared_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(NumOfRuns == 0 || pShared == MAP_FAILED)
+    {
+        fprintf(stderr, "usage: logger_host_powerloss [runs] [seed] [partial write %%] [queue full %%]\n");
+        return 1;
+    }
+
+    /* every run starts from a blank EEPROM, the FLASH image is erased by boot A */
+    unlink(HOST_PL_EEPROM_FILE);
+    memset(&Totals, 0, sizeof(Totals));
+    for(Run = 0; Run < NumOfRuns; Run++)
+    {
+        memset(pShared, 0, sizeof(HostPlShared_t));
+        pShared->LastSeq = -1;
+
+        ExitA = HostPl_RunBoot(pShared, Run, Seed + Run, FALSE);
+        ExitB = HostPl_RunBoot(pShared, Run, Seed + Run, TRUE);
+        Totals.Runs++;
+        if((ExitA != HOST_POWER_OFF_EXIT_CODE && ExitA != 0) || ExitB != 0 || !HostPl_Scan(Run, pShared, &Result))
+        {
+            fprintf(stderr, "run %d (seed %d): boot failed, boot A exit %d, boot B exit %d\n", Run, Seed + Run, ExitA, ExitB);
+            Totals.BootFailures++;
+            Totals.Failures++;
+            continue;
+        }
+
+        LostBytes = (Result.Printed - Result.Found) * HOST_PL_RECORD_LEN;
+        IsFailed = (Result.Holes > 0 || Result.Corrupted > 0 || !Result.IsMarkerFound || pShared->DirtyWriteCnt > 0);
+        Totals.LossOps[pShared->Loss.Op]++;
+        Totals.Printed += Result.Printed;
+        Totals.Found += Result.Found;
+        Totals.TailLost += Result.TailLost;
+        Totals.Holes += Result.Holes;
+        Totals.Corrupted += Result.Corrupted;
+        Totals.Torn += Result.Torn;
+        Totals.MarkersMissing += !Result.IsMarkerFound;
+        Totals.DirtyWriteRuns += (pShared->DirtyWriteCnt > 0);
+        Totals.LostBytes += LostBytes;
+        if(LostBytes > Totals.MaxLostBytes)
+        {
+            Totals.MaxLostBytes = LostBytes;
+        }
+        if(IsFailed)
+        {
+            Totals.Failures++;
+            fprintf(stderr, "run %d (seed %d): power lost on %s 0x%x (%d of %d bytes), printed %d found %d holes %d corrupted %d marker %s (%s) dirty writes %d\n",
+                    Run, Seed + Run, gHostPlOpName[pShared->Loss.Op], pShared->Loss.Address, pShared->Loss.Done, pShared->Loss.Len,
+                    Result.Printed, Result.Found, Result.Holes, Result.Corrupted, Result.IsMarkerFound? "found": "missing", 
+                    pShared->IsMarkerWritten? "written": "not written", pShared->DirtyWriteCnt);
+        }
+    }
+    HostPl_PrintSummary(&Totals, Seed);
+
+    return (Totals.Failures == 0)? 0: 2;
+}
@@ -64,6 +64,21 @@ void Logger_SetLogLevelApi(uint8 LogLevel);
  * \ingroup LogManager
 */
 void Logger_SetModuleMaskApi(uint32 ModuleMask);
+/**
+ * <pre>
+ * void Logger_SetBatchApi(LoggerBatchCmd_t *pBatch)
+ * </pre>
+ *  
+ * This api sets several logger run time parameters (log level, module mask and destination type) with a single command.
+ *
+ * @param   pBatch             [in]    a pointer to the batch command. only the parameters of its Fields bits 
+ *                                     (LOGGER_BATCH_LOG_LEVEL, LOGGER_BATCH_MODULE_MASK, LOGGER_BATCH_DEST_TYPE) are set
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SetBatchApi(LoggerBatchCmd_t *pBatch);
 /**
  * <pre>
  * void Logger_SetModeApi(uint8 Mode)
@@ -74,6 +89,7 @@ void Logger_SetModuleMaskApi(uint32 ModuleMask);
  * @param   Mode  [in]    the logger mode to set. currently the possible modes are:
  *                        LOGGER_MODE_TYPE_PUSH - each log message is sent directly over a socket. (currently not supported)
  *                        LOGGER_MODE_TYPE_PULL - each log message is writen to the log file in the panel and sent by command over FTP    
+ *                        LOGGER_MODE_TYPE_PUSH_PULL - each log message is sent over a socket and writen to the log file simultaneously
  *
  * @return none
  *
@@ -93,6 +109,7 @@ void Logger_SetModeApi(uint8 Mode);
  *                        LOGGER_DEST_TYPE_NONE - no destination type
  *                        LOGGER_DEST_TYPE_FLASH - Logs are sent to flash
  *                        LOGGER_DEST_TYPE_SOCKET - Logs are sent to socket
+ *                        LOGGER_DEST_TYPE_FLASH_AND_SOCKET - Logs are sent to flash and socket
  *
  * @return none
  *
@@ -160,21 +177,24 @@ void Logger_SwitchOnOffApi(uint8 IsOn);
 void Logger_SetFlashSegmentSizeApi(uint16 FlashSizeKB);
 /**
  * <pre>
- * void Logger_DumpDebugLogApi(uint16 FlashSizeKB)
+ * void Logger_DumpDebugLogApi(uint16 FlashSizeKB, LoggerLogFilter_t *pFilter)
  * </pre>
  *  
  * This api dump the last FlashSizeKB size of log file to the RS232 (for debug)
  *
- * @param   FlashSizeKB  [in]       The last file size in KB to dump.
+ * @param   FlashSizeKB  [in]       The last file size in KB to dump (LOGGER_DEF_GET_NEW_FLASH_SIZE_KB dumps the log written since
+ *                                  the last successful upload).
+ * @param   pFilter      [in]       Optional. a pointer to log level, task and time filter. only the FLASH sectors that may 
+ *                                  match the filter are dumped (NULL to dump all). a filter time range replaces FlashSizeKB
  * @return none
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-void Logger_DumpDebugLogApi(uint16 FlashSizeKB);
+void Logger_DumpDebugLogApi(uint16 FlashSizeKB, LoggerLogFilter_t *pFilter);
 /**
  * <pre>
- * void Logger_UploadLogFileApi(LoggerFtpConfig_t *pFtpConfig,  LoggerSocketConfig_t *pLoggerSocketConfig)
+ * void Logger_UploadLogFileApi(LoggerFtpConfig_t *pFtpConfig,  LoggerSocketConfig_t *pLoggerSocketConfig, LoggerLogFilter_t *pFilter)
  * </pre>
  *  
  * This api upload a log file to the server. 
@@ -182,12 +202,49 @@ void Logger_DumpDebugLogApi(uint16 FlashSizeKB);
  * @param   pFtpConfig           [in]       a pointer to Logger ftp server to upload the file to.
  * @param   pLoggerSocketConfig  [in]       a pointer to Logger socket releated to the FTP.
  * NOTE: in case both paramters are NULL the logger will use the default hard coded FTP server configured (see Logger_Config.h) 
+ * NOTE: FTP file size LOGGER_DEF_GET_NEW_FLASH_SIZE_KB uploads only the log written since the last successful upload
+ * @param   pFilter              [in]       Optional. a pointer to log level, task and time filter. only the FLASH sectors that may 
+ *                                          match the filter are uploaded (NULL to upload the whole log file). a filter time range
+ *                                          replaces the FTP file size
  * @return none
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-void Logger_UploadLogFileApi(LoggerFtpConfig_t *pFtpConfig,  LoggerSocketConfig_t *pLoggerSocketConfig);
+void Logger_UploadLogFileApi(LoggerFtpConfig_t *pFtpConfig,  LoggerSocketConfig_t *pLoggerSocketConfig, LoggerLogFilter_t *pFilter);
+/**
+ * <pre>
+ * void Logger_DumpTimeRangeApi(LoggerDateAndTime_t *pStartTime, LoggerDateAndTime_t *pEndTime)
+ * </pre>
+ *  
+ * This api dump the log records of a time range to the RS232 (for debug)
+ *
+ * @param   pStartTime   [in]       Optional. a pointer to the range start time (NULL to dump from the oldest record)
+ * @param   pEndTime     [in]       Optional. a pointer to the range end time (NULL to dump up to the newest record)
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_DumpTimeRangeApi(LoggerDateAndTime_t *pStartTime, LoggerDateAndTime_t *pEndTime);
+/**
+ * <pre>
+ * void Logger_UploadTimeRangeApi(LoggerFtpConfig_t *pFtpConfig,  LoggerSocketConfig_t *pLoggerSocketConfig, LoggerDateAndTime_t *pStartTime, LoggerDateAndTime_t *pEndTime)
+ * </pre>
+ *  
+ * This api upload the log records of a time range to the server. 
+ *
+ * @param   pFtpConfig           [in]       a pointer to Logger ftp server to upload the file to.
+ * @param   pLoggerSocketConfig  [in]       a pointer to Logger socket releated to the FTP.
+ * NOTE: in case both paramters are NULL the logger will use the default hard coded FTP server configured (see Logger_Config.h) 
+ * @param   pStartTime           [in]       Optional. a pointer to the range start time (NULL to upload from the oldest record)
+ * @param   pEndTime             [in]       Optional. a pointer to the range end time (NULL to upload up to the newest record)
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_UploadTimeRangeApi(LoggerFtpConfig_t *pFtpConfig,  LoggerSocketConfig_t *pLoggerSocketConfig, LoggerDateAndTime_t *pStartTime, LoggerDateAndTime_t *pEndTime);
 /**
  * <pre>
  * void Logger_SendConfigToSrvApi(uint8 ConfigType)
@@ -205,6 +262,54 @@ void Logger_UploadLogFileApi(LoggerFtpConfig_t *pFtpConfig,  LoggerSocketConfig_
  * \ingroup LogManager
 */
 void Logger_SendConfigToSrvApi(uint8 EventType);
+/**
+ * <pre>
+ * void Logger_SendTaskStatsToSrvApi(void)
+ * </pre>
+ *  
+ * This api sends the per task statistics to the server (MSME_LOGGER_TASK_STATS_EVENT_MSG): for every task, the messages
+ * and bytes it wrote to the RX buffers, its messages that were filtered out and its messages that found the RX buffer full.
+ * the statistics are counted since the logger init
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SendTaskStatsToSrvApi(void);
+/**
+ * <pre>
+ * void Logger_SendTopSitesToSrvApi(uint8 NumOfSites, BOOL IsNewWindow)
+ * </pre>
+ *  
+ * This api sends the top talkers report to the server (MSME_LOGGER_TOP_SITES_EVENT_MSG): the Logger_printf call sites 
+ * (format strings) that wrote the most bytes to the RX buffers since the window start, with their messages and bytes.
+ * the first window starts on the logger init
+ *
+ * @param   NumOfSites  [in]       The number of call sites to send (up to LOGGER_DEF_MAX_TOP_SITES)
+ * @param   IsNewWindow [in]       Start a new window once the report was built
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SendTopSitesToSrvApi(uint8 NumOfSites, BOOL IsNewWindow);
+/**
+ * <pre>
+ * void Logger_SetTelemetryIntervalApi(uint16 IntervalSec)
+ * </pre>
+ *  
+ * This api sets the interval of the periodic telemetry record to the server (MSME_LOGGER_TELEMETRY_EVENT_MSG): the 
+ * logger counters deltas, the RX buffer peak and the FLASH usage (see Logger_SendTelemetryToSrv). the logger init 
+ * sets it to LOGGER_CONFIG_TELEMETRY_INTERVAL_SEC. the next record is a full record
+ *
+ * @param   IntervalSec [in]       The record interval in seconds, 0 stops the telemetry records
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SetTelemetryIntervalApi(uint16 IntervalSec);
 /**
  * <pre>
  * void Logger_SetConfigFromSrvApi(uint8 ConfigType, void* pConfig)
@@ -224,4 +329,111 @@ void Logger_SendConfigToSrvApi(uint8 EventType);
  * \ingroup LogManager
 */
 void Logger_SetConfigFromSrvApi(uint8 configType, void* pConfig);
+/**
+ * <pre>
+ * void Logger_FlashCompletionApi(LOGGER_STATUS Status)
+ * </pre>
+ *  
+ * This api signals the logger task that an asynchronous FLASH operation has ended.
+ * It is passed as the completion routine to ReadFlashDataAsyncCb and EraseFlashSectorAsyncCb. 
+ * It may be called from the FLASH driver completion context, an interrupt or a task: it only queues a message to the
+ * logger task, like the TX timer interrupt wakes up the drain task, and does not use the caller task ID. 
+ *
+ * @param   Status  [in]       The FLASH operation status. LOGGER_STATUS_OK on success or negative value otherwise
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_FlashCompletionApi(LOGGER_STATUS Status);
+/**
+ * <pre>
+ * void Logger_PanicFlushApi(void)
+ * </pre>
+ *  
+ * This api synchronously writes the pending log messages to the FLASH and to the polled RS232 (PanicUartWriteCb) with the 
+ * interrupts disabled, so the last log messages are kept before a reset or a hang. It does not go through the logger task,
+ * so it can be called from the hard fault handler and from the assert handler. 
+ * The worst case time is bounded by LOGGER_CONFIG_PANIC_MAX_BYTES per sink.
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_PanicFlushApi(void);
+/**
+ * <pre>
+ * LOGGER_STATUS Logger_CrashCaptureApi(LoggerCrashHeader_t *pHeader, uint8 *pStack, uint16 StackLen)
+ * </pre>
+ *  
+ * This api writes a crash capture to the FLASH crash area (LOGGER_CONFIG_FLASH_CRASH_ADDRESS) with polled writes and the 
+ * interrupts disabled: the header, up to LOGGER_CONFIG_CRASH_STACK_DUMP_BYTES of raw stack and the last 
+ * LOGGER_CONFIG_CRASH_RX_SNAPSHOT_BYTES of the RX buffer. It can be called from the hard fault handler, before the panic flush.
+ * The capture is printed on the next init (lines starting with "CRASH") and the crash area is erased. 
+ * Only the first crash after the crash area was erased is captured.
+ *
+ * @param   pHeader     [inout]    the crash capture header filled by the platform (exception frame, fault status, task and time).
+ *                                 the logger sets its boot ID, lengths and CRC
+ * @param   pStack      [in]       the faulting task stack pointer (NULL for no stack dump)
+ * @param   StackLen    [in]       the stack bytes that may be read from pStack
+ * @return LOGGER_STATUS_OK on success or negative value otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+LOGGER_STATUS Logger_CrashCaptureApi(LoggerCrashHeader_t *pHeader, uint8 *pStack, uint16 StackLen);
+/**
+ * <pre>
+ * void Logger_ResetProbesApi(void)
+ * </pre>
+ *  
+ * This api clears the latency probes histograms (Logger_printf, the RX buffer mutex wait, the message parsing, the TX timer 
+ * interrupt and every sink callback), so a measurement starts from now. The histograms are printed by LoggerDebug_PrintProbes.
+ * It does not go through the logger task, it can be called from any task.
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_ResetProbesApi(void);
+/**
+ * <pre>
+ * void Logger_GetOccupancyApi(LoggerOccupancy_t *pOccupancy)
+ * </pre>
+ *  
+ * This api returns the RX buffers occupancy statistics, for sizing LOGGER_CONFIG_DOUBLE_BUFFER_SIZE_BYTES and 
+ * LOGGER_CONFIG_PRIORITY_BUFFER_SIZE_BYTES: every RX buffer peak occupancy since the init and since the last call, the time 
+ * it had low memory, the time the TX timer ran at the high resolution and the per second min/avg/max occupancy of the RX 
+ * double buffer in the last LOGGER_CONFIG_OCCUPANCY_SERIES_SIZE seconds. It does not go through the logger task.
+ *
+ * @param   pOccupancy  [out]   the RX buffers occupancy statistics
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_GetOccupancyApi(LoggerOccupancy_t *pOccupancy);
+/**
+ * <pre>
+ * uint8 Logger_GetTopSitesApi(LoggerCallSite_t *pTop, uint8 NumOfSites, BOOL IsNewWindow, uint32 *pWindowMS)
+ * </pre>
+ *  
+ * This api returns the top talkers: the Logger_printf call sites that wrote the most bytes to the RX buffers since the 
+ * window start, the most bytes first. a call site is keyed by its format string address, the call sites that found no 
+ * entry in the call sites table (LOGGER_CONFIG_CALL_SITES_BITS) are not returned. It does not go through the logger task.
+ *
+ * @param   pTop        [out]   the top call sites
+ * @param   NumOfSites  [in]    the maximum number of call sites to return
+ * @param   IsNewWindow [in]    start a new window once the call sites were returned
+ * @param   pWindowMS   [out]   Optional. the window length in ms
+ *
+ * @return the number of call sites returned
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+uint8 Logger_GetTopSitesApi(LoggerCallSite_t *pTop, uint8 NumOfSites, BOOL IsNewWindow, uint32 *pWindowMS);
 #endif //__LOGGER_API_H
\ No newline at end of file
@@ -0,0 +1,8 @@
+#ifndef __LOGGER_CRASH_H
+#define __LOGGER_CRASH_H
+
+LOGGER_STATUS Logger_CrashCapture(LoggerCrashHeader_t *pHeader, uint8 *pStack, uint16 StackLen);
+BOOL Logger_CrashPrint(void);
+void Logger_CrashInit(void);
+
+#endif //__LOGGER_CRASH_H
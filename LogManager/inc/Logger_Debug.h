@@ -5,5 +5,9 @@ enum {
 };
 
 void LoggerDebug_PrintRAMstatus(void);
+void LoggerDebug_PrintProbes(void);
+void LoggerDebug_PrintOccupancy(void);
+void LoggerDebug_PrintTaskStats(void);
+void LoggerDebug_PrintTopSites(void);
 void LoggerDebug_PrintConfig(void);
 void LoggerDebug_TestStartStop(uint8 IsStart, uint16 Timeout, uint8 NumOfTasks);
@@ -15,31 +15,52 @@
 #define LOGGER_SOCKET_TYPE_UDP                              1
 #define LOGGER_SOCKET_TYPE_FTP                              2
 
+/* socket send priority definitions */
+#define LOGGER_SOCKET_PRIORITY_LOW                          0       /* the data is queued with the regular debug data */
+#define LOGGER_SOCKET_PRIORITY_HIGH                         1       /* the data is queued ahead of the regular debug data (ERROR and CRITICAL records) */
+
 /* logger destination type */
 #define LOGGER_DEST_TYPE_NONE                               0       /* no destination type (RS232 can be still enabled) */
 #define LOGGER_DEST_TYPE_FLASH                              1       /* destination type is flash (log file in PULL mode) */
 #define LOGGER_DEST_TYPE_SOCKET                             2       /* destination type is socket (in PUSH mode) */
 #define LOGGER_DEST_TYPE_RS232                              3       /* destination type is RS232 */
+#define LOGGER_DEST_TYPE_FLASH_AND_SOCKET                   4       /* destination type is both flash and socket (in PUSH_PULL mode) */
+#define LOGGER_DEST_TYPE_MAX_VALUE                          LOGGER_DEST_TYPE_FLASH_AND_SOCKET
+
+#define LOGGER_DEF_IS_DEST_FLASH(DEST_TYPE)                 ((DEST_TYPE) == LOGGER_DEST_TYPE_FLASH || (DEST_TYPE) == LOGGER_DEST_TYPE_FLASH_AND_SOCKET)
+#define LOGGER_DEF_IS_DEST_SOCKET(DEST_TYPE)                ((DEST_TYPE) == LOGGER_DEST_TYPE_SOCKET || (DEST_TYPE) == LOGGER_DEST_TYPE_FLASH_AND_SOCKET)
+
+/* logger batch command fields (see Logger_SetBatchApi) */
+#define LOGGER_BATCH_LOG_LEVEL                              1           /* the batch sets the log level */
+#define LOGGER_BATCH_MODULE_MASK                            (1<<1)      /* the batch sets the module mask */
+#define LOGGER_BATCH_DEST_TYPE                              (1<<2)      /* the batch sets the destination type */
 
 /* logger mode types */
 #define LOGGER_MODE_TYPE_PUSH                               0       /* in this mode the logger sends all logs to UDP socket */
 #define LOGGER_MODE_TYPE_PULL                               1       /* in this mode the logger store all logs in FLASH */
 #define LOGGER_MODE_TYPE_TEST                               2       /* in this mode the logger prints only production logs */
 #define LOGGER_MODE_TYPE_NONE                               3       /* in this mode the logger doesnt push or pull (used for prints debug) */ 
-#define LOGGER_MODE_MAX_VALUE                               LOGGER_MODE_TYPE_NONE
+#define LOGGER_MODE_TYPE_PUSH_PULL                          4       /* in this mode the logger sends all logs to UDP socket and store them in FLASH */
+#define LOGGER_MODE_MAX_VALUE                               LOGGER_MODE_TYPE_PUSH_PULL
 
 /* logger TX resolution */ 
 #define LOGGER_RESOLUTION_TYPE_LOW                          0
 #define LOGGER_RESOLUTION_TYPE_HIGH                         1
+#define LOGGER_RESOLUTION_TYPE_IDLE                         2       /* the TX timer is stopped while the RX buffers are empty */
 
 #define LOGGER_ATTR_NONE                                    0           /* Logger attribute - None */
 #define LOOGER_ATTR_ERASE_FLASH_ON_RESET                    1           /* Logger attribute - Erase logger flash after reset (currently not implemented) */
 #define LOGGER_ATTR_ERASE_FLASH_NOW                         (1<<1)      /* Logger attribute - Erase logger flash now */
 #define LOGGER_ATTR_ERASE_FLASH_ON_SENDING                  (1<<2)      /* Logger attribute - Erase logger flash after sending log file (currenlty not implemented) */
-#define LOGGER_ATTR_MAX_VALUE                               LOGGER_ATTR_ERASE_FLASH_ON_SENDING
+#define LOGGER_ATTR_OVERRUN_DROP_NEWEST                     (1<<3)      /* Logger attribute - on RX buffer overrun drop the new record (by default the oldest records are overwritten) */
+#define LOGGER_ATTR_OVERRUN_BLOCK                           (1<<4)      /* Logger attribute - on RX buffer overrun block the printing task up to a timeout (for lossless test runs) */
+#define LOGGER_ATTR_KV_TEXT                                 (1<<5)      /* Logger attribute - render the structured records as key=value text (by default they are written in binary) */
+#define LOGGER_ATTR_MAX_VALUE                               LOGGER_ATTR_KV_TEXT
 
 /* logger timers definitions */
 #define LOGGER_TIMER_OPEN_SOCKET_ID                         0    /* logger open socket timer expiration command */
+#define LOGGER_TIMER_DUMP_RETRY_ID                          1    /* logger dump retry on busy sink timer expiration command */
+#define LOGGER_TIMER_TELEMETRY_ID                           2    /* logger periodic telemetry record timer expiration command */
 
 
 /* Logger FLASH definitions */
@@ -52,6 +73,12 @@
     P_CURRENT_SECTOR, SECTOR_SIZE_KB)                                               (P_CURRENT_SECTOR - LOGGER_CONFIG_FLASH_START_ADDRESS)>>10 >= \
                                                                                     FLASH_DEBUG_SIZE_KB - SECTOR_SIZE_KB? LOGGER_CONFIG_FLASH_START_ADDRESS: (P_CURRENT_SECTOR + (SECTOR_SIZE_KB<<10))
 #define LOGGER_DEF_FLASH_END_ADDRESS(FLASH_START_ADDRESS, FLASH_SIZE_KB)            (FLASH_START_ADDRESS +  (FLASH_SIZE_KB<<10))
+#define LOGGER_DEF_FLASH_MAX_NUM_OF_SECTORS                                         (LOGGER_CONFIG_FLASH_MAX_SEGMENT_SIZE_KB/LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB)
+#define LOGGER_DEF_FLASH_ALL_SECTORS_MASK                                           ((1<<LOGGER_DEF_FLASH_MAX_NUM_OF_SECTORS) - 1)
+#define LOGGER_DEF_FLASH_SECTOR_INDEX(ADDRESS)                                      (((ADDRESS) - LOGGER_CONFIG_FLASH_START_ADDRESS)/(LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB<<10))
+#define LOGGER_DEF_FLASH_SECTOR_START_ADDRESS(ADDRESS)                              ((ADDRESS) - (((ADDRESS) - LOGGER_CONFIG_FLASH_START_ADDRESS)%(LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB<<10)))
+#define LOGGER_DEF_FLASH_SUMMARY_ADDRESS(P_SECTOR)                                  ((P_SECTOR) + (LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB<<10) - LOGGER_CONFIG_FLASH_SECTOR_SUMMARY_SIZE_BYTES)
+#define LOGGER_DEF_FLASH_RECOVER_CHUNK_SIZE                                         32      /* the FLASH read size while looking for the log file end on init */
 //#define LOGGER_DEF_IS_ADDRESS_ALIGNED(ADDR, SIZE_KB)    ADDR & (SIZE_KB<<10)-1
 //#if (LOGGER_DEF_FLASH_NUM_OF_DEBUG_SECTORS == 1)
 //#error num of debug secotrs must be at least 2
@@ -59,12 +86,17 @@
 
 #define LOGGER_DEF_MIN(X,Y)            (X)<(Y)?(X):(Y)    
 #define LOGGER_DEF_MIN3VARS(A, B, C)   (A)<(B)?LOGGER_DEF_MIN(A,C):LOGGER_DEF_MIN(B,C)
+/* compile time check, e.g. that a structure saved in NVR fits its NVR slot */
+#define LOGGER_DEF_STATIC_ASSERT(Name, Cond)    typedef char Name[(Cond)? 1: -1]
 
 #define LOGGER_DEF_GET_ALL_FLASH_SIZE_KB            0xFFFF          
+#define LOGGER_DEF_GET_NEW_FLASH_SIZE_KB            0xFFFE          /* get the log written since the last successful upload */
+#define LOGGER_DEF_UPLOAD_FILE_TIME_LEN             10              /* the length of the upload file name time stamp (DDMMYYHHMM) */
 
 #define LOGGER_DEF_GEN_CONFIG           gLoggerManager.Config.General
 #define LOGGER_DEF_SOCKET_CONFIG        gLoggerManager.Config.Socket
 #define LOGGER_DEF_FTP_CONFIG           gLoggerManager.Config.Ftp
+#define LOGGER_DEF_FILTER               (*gLoggerManager.FilterMng.pActive)
 
 #define LOGGER_DEF_SET_CONFIG(VAL, IN_VAL, NO_VAL, DEF_VAL)      VAL = IN_VAL == NO_VAL?DEF_VAL:IN_VAL
 
@@ -89,10 +121,76 @@ typedef int8 LOGGER_STATUS;
 #define LOGGER_STATUS_ERROR                 -1     /* logger general error */
 #define LOGGER_STATUS_OK                     0     /* logger command executed successfuly */
 #define LOGGER_STATUS_BUSY                   1     /* logger command could not be executed for now */
+#define LOGGER_STATUS_PENDING                2     /* logger command was queued, its completion will be signaled later */
+
+/* the maximum length of the "N messages lost" record written to the RX buffer after an overrun */
+#define LOGGER_DEF_LOSS_MARKER_MAX_LEN      32
+
+/* the number of log2 ms buckets of the RX buffer drain latency histogram (the last bucket holds all the longer latencies) */
+#define LOGGER_DEF_DRAIN_LATENCY_BUCKETS    8
+
+/* the number of task IDs the module mask filters, the per task statistics of the higher task IDs are kept in the last entry */
+#define LOGGER_DEF_MAX_TASKS                32
+#define LOGGER_DEF_TASK_STATS_IDX(TASK_ID)  (((TASK_ID) < LOGGER_DEF_MAX_TASKS)? (TASK_ID): LOGGER_DEF_MAX_TASKS - 1)
+
+/* the structured binary record: the marker, the length of the rest of the record (without the line end), the level, 
+   the event ID (little endian), the fields and a line end. a field is its key ID and its value (see LoggerKvType_e).
+   after the marker every line end, erased FLASH (0xFF), marker and escape byte is written as the escape byte and the 
+   byte XOR LOGGER_DEF_KV_ESCAPE_XOR, so the line based readers and the FLASH log end scan never stop inside a record. 
+   the length counts the unescaped bytes */
+#define LOGGER_DEF_KV_MARKER                0x1E        /* ASCII record separator, not used by the text records */
+#define LOGGER_DEF_KV_ESCAPE                0x1B        /* ASCII escape */
+#define LOGGER_DEF_KV_ESCAPE_XOR            0x20
+#define LOGGER_DEF_KV_IS_ESCAPED(BYTE)      ((BYTE) == '\n' || (BYTE) == 0xFF || (BYTE) == LOGGER_DEF_KV_MARKER || (BYTE) == LOGGER_DEF_KV_ESCAPE)
+#define LOGGER_DEF_KV_ESCAPED_LEN(BYTE)     (LOGGER_DEF_KV_IS_ESCAPED(BYTE)? 2: 1)
+#define LOGGER_DEF_KV_MAX_NUM_TEXT_LEN      12          /* the longest number in the key=value text, "0x" and 8 digits or a sign and 10 digits */
+#define LOGGER_DEF_KV_MAX_LEN               (LOGGER_DEF_MIN(LOGGER_CONFIG_MAX_RX_MESSAGE_SIZE_BYTES - 1, 0xFF + 2))
+
+/* the telemetry record: the format and full record flag, the sequence number, the changed counters bitmap (16 bits), 
+   a varint of every changed counter, a varint of the time since the last record in ms, the RX buffer and FLASH usage percent */
+#define LOGGER_DEF_TELEMETRY_FORMAT         1
+#define LOGGER_DEF_TELEMETRY_FULL_FLAG      0x80
+#define LOGGER_DEF_TELEMETRY_HEADER_LEN     4
+#define LOGGER_DEF_TELEMETRY_MAX_LEN        (LOGGER_DEF_TELEMETRY_HEADER_LEN + (16 + 1) * 5 + 2)
+
+/* the call sites table size, a call site is looked up at most LOGGER_DEF_CALL_SITE_MAX_PROBES entries from its hash entry */
+#define LOGGER_DEF_CALL_SITES_SIZE          (1 << LOGGER_CONFIG_CALL_SITES_BITS)
+#define LOGGER_DEF_CALL_SITE_MAX_PROBES     8
+
+/* the maximum number of call sites in the top talkers report, and the length of their format string in the report */
+#define LOGGER_DEF_MAX_TOP_SITES            8
+#define LOGGER_DEF_TOP_SITE_FMT_LEN         40
+
+/* the number of log2 cycles buckets of every latency probe histogram (the last bucket holds all the longer latencies) */
+#define LOGGER_DEF_PROBE_BUCKETS            24
+
+/* the maximum length of the "recovered log of boot N" record written before the RX buffer contents that survived a reset */
+#define LOGGER_DEF_RECOVERY_MARKER_MAX_LEN  48
+
+/* logger no-init RAM RX buffers header magic number */
+#define LOGGER_DEF_NOINIT_MAGIC             0x494E4F4C      /* "LONI" */
+
+/* logger CRC-32 (reflected 0xEDB88320) initial value, see Logger_Crc32 */
+#define LOGGER_DEF_CRC32_INIT               0xFFFFFFFF
+
+/* logger FLASH crash capture definitions */
+#define LOGGER_DEF_CRASH_MAGIC              0x5352434C      /* "LCRS" */
+#define LOGGER_DEF_CRASH_TASK_NAME_LEN      8               /* the task name length kept in the crash capture including null terminator */
+#define LOGGER_DEF_CRASH_WRITE_CHUNK_SIZE   256             /* the crash capture is written in FLASH page chunks */
+#define LOGGER_DEF_CRASH_WRITE_RETRIES      100             /* the maximum number of busy polled FLASH writes before the crash capture is given up */
+#define LOGGER_DEF_CRASH_PRINT_CHUNK_SIZE   32              /* the stack dump bytes per printed line (and the RX buffer bytes per printed record is twice that) */
 
 /* logger blank 4 bytes eeprom paramters */
 #define LOGGER_DEF_BLANK_NVR_PARAM_32       0xFFFFFFFF
 
+/* the NVR flash manager layout version. the 16 bytes layout (no sector sequence) left the padding byte 0, or blank 0xFF */
+#define LOGGER_DEF_NVR_LAYOUT_VERSION       2
+
+/* logger FLASH sector summary record definitions */
+#define LOGGER_DEF_SUMMARY_MAGIC            0x4D55534C      /* "LSUM" */
+#define LOGGER_DEF_SUMMARY_NO_TIME          0xFFFFFFFF      /* packed time value of an empty summary */
+#define LOGGER_DEF_SUMMARY_NUM_OF_BLOCKS    ((LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB<<10)/LOGGER_CONFIG_SUMMARY_BLOCK_SIZE_BYTES)
+
 typedef enum {
     e_LOGGER_CONF_TYPE_GENERAL              =0,
     e_LOGGER_CONF_TYPE_SOCKET               =1,
@@ -102,6 +200,7 @@ typedef enum {
 typedef enum {
     e_LOGGER_MSG_STATUS_OK,
     e_LOGGER_MSG_STATUS_FAIL,
+    e_LOGGER_MSG_STATUS_IN_PROGRESS,                /* the description holds the upload progress in percents */
 }LoggerMsgStatus_e;
 typedef enum {
     e_LOGGER_MSG_ERROR_DES_OK,
@@ -152,11 +251,102 @@ typedef struct {
     uint8   Second;                 /* Seconds 0-59 */
 }LoggerDateAndTime_t;
 
+/* logger FLASH log filter. a FLASH sector is sent only if its summary may match all the filter conditions */
+typedef struct {
+    uint8 MaxLevel;                         /* the highest log level to match (see LoggerLogLevel_e) */
+    uint32 TaskMask;                        /* the task IDs to match, bit per task ID (LOGGER_MASK_NO_TASK for all tasks) */
+    LoggerDateAndTime_t StartTime;          /* the start of the time range to match. all zeros for no lower limit */
+    LoggerDateAndTime_t EndTime;            /* the end of the time range to match. all zeros for no upper limit */
+}LoggerLogFilter_t;
+
+/* logger batch command. sets several run time parameters with a single logger task command */
+typedef struct {
+    uint8 Fields;                           /* the parameters to set (LOGGER_BATCH_XXX bits) */
+    uint8 LogLevel;                         /* the log level to set (see LoggerLogLevel_e) */
+    uint8 DestType;                         /* the destination type to set (LOGGER_DEST_TYPE_XXX) */
+    uint32 ModuleMask;                      /* the module mask to set */
+}LoggerBatchCmd_t;
+
+/* logger per task statistics, counted by Logger_printf of the task (Logger_SendTaskStatsToSrvApi) */
+typedef struct {
+    uint32 AcceptedMsgs;                    /* the messages written to the RX buffers */
+    uint32 AcceptedBytes;                   /* the bytes written to the RX buffers */
+    uint32 FilteredMsgs;                    /* the messages filtered out by the log level, the module mask or the logger switch */
+    uint32 OverrunMsgs;                     /* the messages that found the RX buffer full: dropped, or written over the oldest records */
+}LoggerTaskStats_t;
+
+/* logger call site statistics. a call site is keyed by its format string address */
+typedef struct {
+    const char *pFmt;                       /* the call site format string, NULL for a free entry */
+    uint32 Hits;                            /* the messages the call site wrote to the RX buffers since the window start */
+    uint32 Bytes;                           /* the bytes the call site wrote to the RX buffers since the window start */
+}LoggerCallSite_t;
+
+/* RX buffer occupancy of a single second in bytes, sampled on every drain task wake up */
+typedef struct {
+    uint16 MinUsed;                         /* the lowest sampled occupancy */
+    uint16 AvgUsed;                         /* the average sampled occupancy */
+    uint16 MaxUsed;                         /* the highest sampled occupancy */
+}LoggerOccupancySample_t;
+
+/* RX buffer occupancy statistics */
+typedef struct {
+    uint16 SizeBytes;                       /* the RX buffer size */
+    uint16 PeakUsed;                        /* the peak occupancy since the logger init */
+    uint16 ReadPeakUsed;                    /* the peak occupancy since the last occupancy read (Logger_GetOccupancyApi) */
+    uint32 LowMemoryMS;                     /* the total time the RX buffer had low memory (needs GetTimeUsCb) */
+}LoggerBuffOccupancy_t;
+
+/* logger RX buffers occupancy statistics (Logger_GetOccupancyApi) */
+typedef struct {
+    LoggerBuffOccupancy_t Main;             /* the RX double buffer */
+    LoggerBuffOccupancy_t Priority;         /* the ERROR and CRITICAL records RX buffer */
+    uint32 HighResolutionMS;                /* the total time the TX timer ran at the high resolution (needs GetTimeUsCb) */
+    uint32 IdleMS;                          /* the total time the TX timer was stopped with empty RX buffers (needs GetTimeUsCb) */
+    uint8 NumOfSeconds;                     /* the number of seconds in Series */
+    LoggerOccupancySample_t Series[LOGGER_CONFIG_OCCUPANCY_SERIES_SIZE]; /* the RX double buffer occupancy of the last seconds, oldest first */
+}LoggerOccupancy_t;
+
+/* the exception frame registers, in the order the CPU pushes them */
+typedef enum {
+    e_LOGGER_CRASH_REG_R0,
+    e_LOGGER_CRASH_REG_R1,
+    e_LOGGER_CRASH_REG_R2,
+    e_LOGGER_CRASH_REG_R3,
+    e_LOGGER_CRASH_REG_R12,
+    e_LOGGER_CRASH_REG_LR,
+    e_LOGGER_CRASH_REG_PC,
+    e_LOGGER_CRASH_REG_XPSR,
+    e_LOGGER_CRASH_REG_MAX,
+}LoggerCrashReg_e;
+
+/* logger crash capture header. written to the FLASH crash area followed by the stack dump and the RX buffer bytes */
+typedef struct {
+    uint32 Magic;                           /* the crash capture magic number (LOGGER_DEF_CRASH_MAGIC) */
+    uint32 Frame[e_LOGGER_CRASH_REG_MAX];   /* the exception frame (see LoggerCrashReg_e) */
+    uint32 StackAddr;                       /* the faulting task stack pointer before the exception frame was pushed */
+    uint32 Cfsr;                            /* configurable fault status register */
+    uint32 Hfsr;                            /* hard fault status register */
+    uint32 Mmfar;                           /* memory management fault address register */
+    uint32 Bfar;                            /* bus fault address register */
+    uint32 BootId;                          /* the boot the crash happened on (set by the logger) */
+    LoggerDateAndTime_t Time;               /* the crash date and time */
+    char TaskName[LOGGER_DEF_CRASH_TASK_NAME_LEN]; /* the running task name */
+    uint16 TaskCmd;                         /* the command the running task was executing */
+    uint8 TaskId;                           /* the running task ID (0xFF if unknown) */
+    uint16 StackLen;                        /* the number of stack dump bytes following the header (set by the logger) */
+    uint16 RxLen;                           /* the number of RX buffer bytes following the stack dump (set by the logger) */
+    uint32 Crc;                             /* CRC-32 of the fields above, the stack dump and the RX buffer bytes (set by the logger) */
+}LoggerCrashHeader_t;
+
+/* asynchronous FLASH operation completion routine. the platform calls it once the FLASH operation has ended */
+typedef void (*LoggerFlashDoneCb_t)(LOGGER_STATUS Status);
+
 /* logger CB data structure */
 typedef struct {
     LOGGER_STATUS (*OpenSocketCb)(LoggerSocketConfig_t *pSocketConfig);                         /* open TCP\UDP socket callback */
     LOGGER_STATUS (*CloseSocketCb)(void);                                                       /* close TCP\UDP socket callback */
-    LOGGER_STATUS (*SendSocketDataCb)(uint8 *pBuff, uint16 Len, uint8 Mode);                    /* send TCP\UDP socket callback */
+    LOGGER_STATUS (*SendSocketDataCb)(uint8 *pBuff, uint16 Len, uint8 Mode, uint8 Priority);    /* send TCP\UDP socket callback */
     LOGGER_STATUS (*SendUartDataCb)(char *pStr, uint16 StrLen);                                 /* send UART data callback */
     LOGGER_STATUS (*SendFlashDataCb)(uint32 Address, char *pStr, uint16 *pStrLen);              /* send FLASH data callback */
     LOGGER_STATUS (*ReadFlashDataCb)(uint32 Adrdress, char *pStr, uint16 StrLen);               /* read FLASH data callback */
@@ -170,6 +360,15 @@ typedef struct {
     LOGGER_STATUS (*GetPanelIdCb)(char PanelIdStr[LOGGER_CONFIG_PANEL_ID_SIZE_BYTES]);          /* get the panel ID value in string */
     LOGGER_STATUS (*ReadConfigCb)(LoggerConfigType_e ConfigType, void *pConfig);
     LOGGER_STATUS (*WriteConfigCb)(LoggerConfigType_e ConfigType, void *pConfig);
+    LOGGER_STATUS (*ReadFlashDataAsyncCb)(uint32 Address, char *pStr, uint16 StrLen, 
+                                          LoggerFlashDoneCb_t pDoneCb);                         /* (optional) queue FLASH read, pDoneCb is called on completion */
+    LOGGER_STATUS (*EraseFlashSectorAsyncCb)(uint32 Address, uint16 FlashSize, 
+                                             LoggerFlashDoneCb_t pDoneCb);                      /* (optional) queue a single FLASH sector erase, pDoneCb is called on completion */
+    uint32 (*GetTimeUsCb)(void);                                                                /* (optional) free running us counter, for the drain time budget and statistics */
+    LOGGER_STATUS (*PanicUartWriteCb)(char *pStr, uint16 StrLen);                               /* (optional) polled UART write, works with the interrupts disabled */
+    uint32 (*DisableInterruptsCb)(void);                                                        /* (optional) disable the interrupts for the panic flush, returns the previous state */
+    void (*RestoreInterruptsCb)(uint32 IntState);                                               /* restore the interrupts state returned by DisableInterruptsCb */
+    uint32 (*GetCyclesCb)(void);                                                                /* (optional) free running CPU cycle counter, for the latency probes histograms */
 }LoggerCB_t;
 
 
@@ -8,31 +8,51 @@
 
 void Logger_Init(IN LoggerConfig_t *pLoggerConfig, IN uint8 Attr);
 void Logger_UnInit(void);
+void Logger_PublishFilter(void);
 void Logger_SetLogLevel(uint8 LogLevel);
 void Logger_SetModuleMask(uint32 ModuleMask);
 void Logger_SwitchOnOff(BOOL IsOn, BOOL IsSaveDB);
 void Logger_SetMode(uint8 Mode);
 void Logger_SetPrintoutEnDis(BOOL IsEnabled);
 void Logger_SetSocketConfig(LoggerSocketConfig_t *pSocketConfig);
-void Logger_printf(uint8 level, char *fmt, ...);
+void Logger_printf(uint8 level, const char *fmt, ...);
 BOOL Logger_SetConfig(LoggerConfig_t *pLoggerConfig);
 void Logger_SetDefaultSocketConfig(void);
 void Logger_SetTxResolution(uint8 Resolution);
+void Logger_ModeTimeUpdate(INOUT LoggerModeTime_t *pMode, IN BOOL IsActive);
+void Logger_OccupancySample(IN uint16 Used);
+void Logger_GetOccupancy(OUT LoggerOccupancy_t *pOccupancy);
 void Logger_HandleSocketReply(uint16 cmd, uint32 status, uint16 SessionType);
 void Logger_HandleTimerExpr(uint16 TimerType);
 void Logger_SendConfigToSrv(IN uint8 ConfigType);
+void Logger_SendTaskStatsToSrv(void);
+uint8 Logger_GetTopSites(OUT LoggerCallSite_t *pTop, IN uint8 NumOfSites, IN BOOL IsNewWindow, OUT uint32 *pWindowMS);
+void Logger_SendTopSitesToSrv(IN uint8 NumOfSites, IN BOOL IsNewWindow);
+uint8 Logger_PutVarint(OUT uint8 *pData, IN uint32 Value);
+void Logger_SetTelemetryInterval(IN uint16 IntervalSec);
+void Logger_SendTelemetryToSrv(void);
 void Logger_HandleServerCmd(void* pDataIn, uint8 Len, uint8 CmdType);
-BOOL Logger_SendLogFileToServer(LoggerFtpConfig_t *pLoggerFtpConfig, LoggerSocketConfig_t *pLoggerSocketConfig);
+BOOL Logger_SendLogFileToServer(LoggerFtpConfig_t *pLoggerFtpConfig, LoggerSocketConfig_t *pLoggerSocketConfig, LoggerLogFilter_t *pFilter);
 void Logger_HandleFtpPutReply(uint8 Status, uint8 Desc);
 BOOL Logger_SetRAMGeneralConfig(LoggerGenConfig_t *pGeneralConfig);
 void Logger_FlushRxBuffer(void);
+void Logger_NoInitUpdate(void);
+uint32 Logger_Crc32(uint32 Crc, void *pBuff, uint16 Len);
 BOOL Logger_GetModeOnOff(void);
 void Logger_SetTaskState(uint8 State);
 void Logger_PrintStartMessage();
 BOOL Logger_ValidateGenConfig(LoggerGenConfig_t *pLoggerGenConfig);
+BOOL Logger_ValidateBatchCmd(LoggerBatchCmd_t *pBatch);
 BOOL Logger_ValidateTcpConfig(LoggerSocketConfig_t *pLoggerSocketConfig);
 BOOL Logger_ValidateFtpConfig(LoggerFtpConfig_t *pLoggerFtpConfig);
-BOOL Logger_SendDebugLog(uint16 SizeKB, uint8 DestType);
+BOOL Logger_SendDebugLog(uint16 SizeKB, LoggerLogFilter_t *pFilter, uint8 DestType);
+BOOL Logger_SendUploadLog(uint16 SizeKB);
 void Logger_SetDestinationType(uint8 DestType);
+void Logger_HandleFlashCompletion(LOGGER_STATUS Status);
+BOOL Logger_IsFlashOpActive(void);
+void *Logger_CmdBuffAlloc(uint16 Len);
+void Logger_CmdBuffFree(INOUT void **ppBuff);
+void Logger_CmdDone(OSAL_Msg *pMsg);
+void Logger_HandleBatchCmd(LoggerBatchCmd_t *pBatch);
 
 #endif //__LOGGER_FUNC_H
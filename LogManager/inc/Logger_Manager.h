@@ -17,6 +17,12 @@ typedef enum {
     e_LOGGER_CMD_DUMP_DEBUG_LOG,                /* logger dump debug file command */
     e_LOGGER_CMD_SET_CONFIG,                    /* logger set configuration command */
     e_LOGGER_CMD_SEND_CONF_TO_SRV,              /* logger send current configuration command */
+    e_LOGGER_CMD_FLASH_COMPLETION,              /* logger asynchronous FLASH operation completion command */
+    e_LOGGER_CMD_DRAIN,                         /* logger drain task - send the RX buffers to the sinks */
+    e_LOGGER_CMD_BATCH,                         /* logger set several run time parameters command */
+    e_LOGGER_CMD_SEND_TASK_STATS_TO_SRV,        /* logger send the per task statistics command */
+    e_LOGGER_CMD_SEND_TOP_SITES_TO_SRV,         /* logger send the top talkers call sites command */
+    e_LOGGER_CMD_SET_TELEMETRY_INTERVAL,        /* logger set the telemetry record interval command */
 }LoggerCmd_e;
 
 typedef enum {
@@ -29,6 +35,7 @@ typedef enum {
 
 typedef struct {
     uint8 IsNextSectorErased   :1;      /* does flash erase needed */
+    uint8 IsSummaryWritten     :1;      /* was the current sector summary written (the sector is closed) */
 }LoggerFlashFlags_t;
 
 /* logger flash manager handle */
@@ -37,38 +44,394 @@ typedef struct {
     uint32 WriteAddr;                   /* address to flash write location */
     uint32 ReadAddr;                    /* address to flash read location */
     LoggerFlashFlags_t Flags;           /* Flash flags */
+    uint8 LayoutVer;                    /* the NVR layout version (LOGGER_DEF_NVR_LAYOUT_VERSION), it takes the padding after the flags */
+    uint32 SectorSeq;                   /* the sequence number of the current sector (grows on every move to the next sector) */
     uint32  CmdStatus;                  /* Flash command status */    
 }LoggerFLASHManager_t;
 
+/* the NVR record is the flash manager without the command status (the last member) */
+LOGGER_DEF_STATIC_ASSERT(LoggerFlashMngNvrSizeCheck_t, sizeof(LoggerFLASHManager_t) - sizeof(uint32) == LOGGER_CONFIG_NVR_SIZE_BYTES);
+
+/* logger log upload cursor (saved in NVR), the end of the log the server already has */
+typedef struct {
+    uint32 SectorSeq;                   /* the sequence number of the cursor sector */
+    uint32 Addr;                        /* the cursor FLASH address */
+}LoggerUploadCursor_t;
+
+typedef struct {
+    uint8 IsActive             :1;      /* is the FLASH operation in progress */
+    uint8 IsAsync              :1;      /* is the FLASH operation driven by asynchronous completions */
+    uint8 IsPending            :1;      /* is an asynchronous FLASH command waiting for its completion */
+}LoggerFlashOpFlags_t;
+
+typedef enum {
+    e_LOGGER_ERASE_OWNER_INIT_DEFAULT,          /* erase all the log file sectors on init */
+    e_LOGGER_ERASE_OWNER_INIT_NEXT_SECTOR,      /* erase the next sector on init from NVR parameters */
+}LoggerEraseOwner_e;
+
+/* logger FLASH erase state machine handle */
+typedef struct {
+    uint32 NextAddr;                    /* the address of the next sector to erase */
+    uint8 SectorsLeft;                  /* the number of sectors left to erase */
+    uint8 Owner;                        /* the flow to continue when erase is done (see LoggerEraseOwner_e) */
+    LoggerFlashOpFlags_t Flags;         /* erase operation flags */
+}LoggerEraseMng_t;
+
+/* logger FLASH dump state machine handle */
+typedef struct {
+    char *pBuff;                                            /* the chunk buffers */
+    uint32 Iter;                                            /* the next FLASH address to read */
+    uint32 EndAddress;                                      /* the FLASH log file end address */
+    int ReadSizeBytes;                                      /* the size left to read from FLASH in bytes */
+    uint16 ChunkLen[LOGGER_CONFIG_DUMP_NUM_OF_CHUNKS];      /* the length of every chunk waiting to be sent */
+    uint16 BusyTimeMS;                                      /* the accumulated time we have been waiting on a busy sink */
+    uint8 DestType;                                         /* the dump destination type */
+    uint8 SendIdx;                                          /* the chunk to send next */
+    uint8 ReadIdx;                                          /* the chunk to read into next */
+    uint8 NumOfReadyChunks;                                 /* the number of chunks waiting to be sent */
+    uint8 SectorMask;                                       /* the sectors to send, bit per sector. other sectors are skipped */
+    LoggerFlashOpFlags_t Flags;                             /* dump operation flags */
+}LoggerDumpMng_t;
+
+typedef struct {
+    uint8 IsPartial            :1;      /* the sector holds records that were not counted (e.g. written before reset), it may match any filter */
+}LoggerSummaryFlags_t;
+
+/* logger FLASH sector summary. kept in RAM for every sector and written to the sector tail when the sector is closed */
+typedef struct {
+    uint32 Magic;                       /* the summary record magic number (LOGGER_DEF_SUMMARY_MAGIC) */
+    uint32 StartTime;                   /* the packed time of the first record in the sector */
+    uint32 EndTime;                     /* the packed time of the last record in the sector */
+    uint32 TaskMask;                    /* the task IDs that have records in the sector, bit per task ID */
+    uint16 LevelCnt[LEVEL_MAX_NUM];     /* the number of records in the sector per log level */
+    uint32 BlockTime[LOGGER_DEF_SUMMARY_NUM_OF_BLOCKS]; /* the packed time of the first record of every block in the sector */
+    LoggerSummaryFlags_t Flags;         /* summary flags */
+    uint8 CheckSum;                     /* the summary record checksum */
+}LoggerSectorSummary_t;
+
+typedef struct {
+    char *pEnd;                         /* the RX buffer position after the last record of the entry */
+    uint32 Time;                        /* the packed time of the first record of the entry */
+}LoggerRecordTime_t;
+
+/* logger record times of the log messages in the RX buffer. filled by Logger_printf and released by the drain task */
+typedef struct {
+    LoggerRecordTime_t Entry[LOGGER_CONFIG_SUMMARY_TIME_FIFO_SIZE];
+    uint8 Head;                         /* the oldest entry */
+    uint8 Tail;                         /* the next entry to fill */
+}LoggerRecordTimeFifo_t;
+
+typedef struct {
+    uint8 IsSet                :1;      /* is the upload range set */
+}LoggerFlashRangeFlags_t;
+
+/* logger FLASH log file range to upload */
+typedef struct {
+    uint32 StartAddr;                   /* the FLASH address to start sending from */
+    int SizeBytes;                      /* the size of the range in bytes */
+    uint8 SectorMask;                   /* the sectors to send, bit per sector */
+    LoggerFlashRangeFlags_t Flags;      /* range flags */
+}LoggerFlashRange_t;
+
+typedef struct {
+    uint8 IsActive             :1;      /* is an upload job in progress (the server has not stored all its parts yet) */
+    uint8 IsIncremental        :1;      /* advance the upload cursor once the job is done */
+}LoggerUploadJobFlags_t;
+
+/* logger upload job progress (saved in NVR). the log file is uploaded in numbered part files, 
+   so an upload that was cut continues from the last part the server has stored */
+typedef struct {
+    LoggerUploadCursor_t Next;          /* the FLASH start of the next part */
+    LoggerUploadCursor_t EndCursor;     /* the upload cursor once the job is done */
+    int SizeBytes;                      /* the FLASH range size left to upload */
+    int TotalSizeBytes;                 /* the job FLASH range size */
+    uint8 SectorMask;                   /* the sectors to send, bit per sector */
+    uint8 PartIdx;                      /* the number of the next part file */
+    LoggerUploadJobFlags_t Flags;       /* job flags */
+    char FileTime[LOGGER_DEF_UPLOAD_FILE_TIME_LEN]; /* the job time stamp (DDMMYYHHMM) all the part file names share */
+    uint32 ParamsCrc;                   /* CRC-32 of the job request parameters (file size and filter), a request with other parameters restarts the job */
+}LoggerUploadProgress_t;
+
+/* the job progress fills its NVR slot */
+LOGGER_DEF_STATIC_ASSERT(LoggerUploadProgressNvrSizeCheck_t, sizeof(LoggerUploadProgress_t) == LOGGER_CONFIG_NVR_UPLOAD_JOB_SIZE_BYTES);
+
+/* logger upload job handle */
+typedef struct {
+    LoggerUploadProgress_t Progress;    /* the job progress */
+    LoggerFtpConfig_t Ftp;              /* the FTP server of the current attempt */
+    LoggerSocketConfig_t Socket;        /* the socket of the current attempt */
+    int PartSizeBytes;                  /* the FLASH range size of the part being uploaded */
+}LoggerUploadJob_t;
+
+/* logger upload log file command input buffer */
+typedef struct {
+    LoggerFtpConfig_t Ftp;              /* the FTP server to upload to */
+    LoggerLogFilter_t Filter;           /* the log filter */
+    BOOL IsFiltered;                    /* should the filter be applied */
+}LoggerUploadCmd_t;
+
+/* logger command input buffer. every command payload fits in a command pool slot */
+typedef union {
+    LoggerUploadCmd_t Upload;           /* upload log file command */
+    LoggerSocketConfig_t Socket;        /* set debug server command and upload log file command socket */
+    LoggerGenConfig_t General;          /* set general configuration command */
+    LoggerFtpConfig_t Ftp;              /* set FTP configuration command */
+    LoggerLogFilter_t Filter;           /* dump log file command filter */
+    LoggerBatchCmd_t Batch;             /* batch command */
+}LoggerCmdPayload_u;
+
+/* logger command pool slot. the payload is copied in place, instead of allocating a heap buffer for every command */
+typedef struct {
+    LoggerCmdPayload_u Payload;         /* the command input buffer */
+    uint32 SendUs;                      /* the time the command was sent in us (needs GetTimeUsCb) */
+    uint8 IsUsed;                       /* is the slot allocated */
+}LoggerCmdSlot_t;
+
+/* logger command pool and the command handling statistics */
+typedef struct {
+    LoggerCmdSlot_t Slot[LOGGER_CONFIG_CMD_POOL_SIZE]; /* the command payload slots */
+    uint8 NextSlot;                     /* the slot to start the next free slot search from */
+    uint8 UsedCnt;                      /* the number of allocated slots */
+    uint8 MaxUsedCnt;                   /* the maximum number of slots allocated at once */
+    uint32 CmdCnt;                      /* the total number of handled commands */
+    uint32 TaskStartCnt;                /* the number of times the logger task was started */
+    uint32 PoolAllocCnt;                /* the number of command payloads allocated from the pool */
+    uint32 HeapAllocCnt;                /* the number of command payloads allocated from the heap (pool is full or not ready) */
+    uint32 LatencyCnt;                  /* the number of commands whose latency was measured */
+    uint32 LatencyMaxUs;                /* the longest command send to handle end latency in us (needs GetTimeUsCb) */
+    uint32 LatencyTotalUs;              /* the sum of the measured command latencies in us */
+}LoggerCmdMng_t;
+
+typedef enum {
+    e_LOGGER_SINK_FLASH,                        /* FLASH log file sink (required) */
+    e_LOGGER_SINK_SOCKET,                       /* remote debug server socket sink (required) */
+    e_LOGGER_SINK_UART,                         /* RS232 printout sink (optional, may lag or drop) */
+    e_LOGGER_SINK_MAX,
+}LoggerSink_e;
+
+/* latency probes. the sink probes follow the LoggerSink_e order */
+typedef enum {
+    e_LOGGER_PROBE_PRINTF,                      /* Logger_printf, from the filter check to the mutex release */
+    e_LOGGER_PROBE_MUTEX_WAIT,                  /* the RX buffer mutex capture of Logger_printf */
+    e_LOGGER_PROBE_PARSE,                       /* Logger_ParseAndWriteRxMessage */
+    e_LOGGER_PROBE_TX_ISR,                      /* Logger_SendPacketFromInt (the TX timer interrupt) */
+    e_LOGGER_PROBE_SINK_FLASH,                  /* the FLASH sink send callback */
+    e_LOGGER_PROBE_SINK_SOCKET,                 /* the socket sink send callback */
+    e_LOGGER_PROBE_SINK_UART,                   /* the RS232 sink send callback */
+    e_LOGGER_PROBE_MAX,
+}LoggerProbe_e;
+
+/* latency probes histograms (needs GetCyclesCb). a sample is not locked, concurrent samples of the same probe may lose a count */
+typedef struct {
+    uint32 Hist[e_LOGGER_PROBE_MAX][LOGGER_DEF_PROBE_BUCKETS]; /* bucket i counts latencies below 2^i cycles */
+    uint32 MaxCycles[e_LOGGER_PROBE_MAX];       /* every probe longest latency in cycles */
+    uint32 ResetCnt;                            /* the number of times the histograms were reset */
+}LoggerProbeMng_t;
+
+/* logger telemetry record counters, in their changed counters bitmap order (up to 16) */
+typedef enum {
+    e_LOGGER_TELEMETRY_RX_MSGS,                 /* RX buffer messages */
+    e_LOGGER_TELEMETRY_TX_PACKETS,              /* RX buffer TX packets */
+    e_LOGGER_TELEMETRY_LOST_MSGS,               /* RX buffer overwritten or dropped messages */
+    e_LOGGER_TELEMETRY_LOST_BYTES,              /* RX buffer overwritten or dropped bytes */
+    e_LOGGER_TELEMETRY_BUSY,                    /* RX buffer busy (mutex held) messages */
+    e_LOGGER_TELEMETRY_LOW_MEMORY,              /* RX buffer low memory messages */
+    e_LOGGER_TELEMETRY_RUN_OVER,                /* RX buffer run over messages */
+    e_LOGGER_TELEMETRY_FLASH_DROPS,             /* FLASH sink dropped packets */
+    e_LOGGER_TELEMETRY_SOCKET_DROPS,            /* socket sink dropped packets */
+    e_LOGGER_TELEMETRY_UART_DROPS,              /* RS232 sink dropped packets */
+    e_LOGGER_TELEMETRY_PRIORITY_RX_MSGS,        /* priority buffer messages */
+    e_LOGGER_TELEMETRY_PRIORITY_LOST_MSGS,      /* priority buffer lost messages */
+    e_LOGGER_TELEMETRY_DRAIN_WAKEUPS,           /* TX timer interrupts */
+    e_LOGGER_TELEMETRY_DRAIN_BUSY_US,           /* drain task busy time in us (needs GetTimeUsCb) */
+    e_LOGGER_TELEMETRY_MAX
+}LoggerTelemetryCounter_e;
+
+/* logger periodic telemetry record state */
+typedef struct {
+    uint32 Last[e_LOGGER_TELEMETRY_MAX]; /* the counters sent in the last record */
+    uint32 LastUs;                      /* the time of the last record (needs GetTimeUsCb) */
+    uint16 IntervalSec;                 /* the record interval in seconds, 0 when disabled */
+    uint16 PeakUsed;                    /* the RX double buffer peak occupancy since the last record, sampled by the drain task */
+    uint8 Seq;                          /* the next record sequence number */
+    uint8 IsReset;                      /* the counters were reset since the last record, the next record is a full record */
+}LoggerTelemetryMng_t;
+
+/* logger call sites table, an open addressing hash table keyed by the format string address. 
+   it is updated under the RX buffer mutex, the entries are freed only when a new window starts */
+typedef struct {
+    LoggerCallSite_t Site[LOGGER_DEF_CALL_SITES_SIZE]; /* the call sites counters */
+    uint32 OtherHits;                   /* the messages of the call sites that found no free entry */
+    uint32 OtherBytes;                  /* the bytes of the call sites that found no free entry */
+    uint32 WindowStartUs;               /* the time the current window started (needs GetTimeUsCb) */
+}LoggerCallSiteMng_t;
+
+/* logger RX buffer sink (consumer) descriptor */
+typedef struct {
+    BOOL (*IsEnabledCb)(void);                              /* is the sink configured to get the log messages */
+    LOGGER_STATUS (*SendCb)(char *pStr, uint16 *pStrLen, BOOL IsPriority); /* send a buffer, returns in pStrLen the size that was consumed */
+    uint8 MaxChunks;                                        /* the maximum number of RX buffer chunks sent on every drain pass */
+    uint8 IsRequired;                                       /* RX buffer space is reclaimed only once all required sinks consumed it */
+}LoggerSink_t;
+
 typedef struct {
     uint8 IsLowMemory          :1;      /* is Rx buffer has low memory */
     uint8 IsUrgent             :1;      /* is the pritout urgent */
+    uint8 IsFlashCut           :1;      /* the last FLASH write ended inside a record, the other RX buffer is not written to FLASH before the record end */
 }LoggerRxBuffFlags_t;
 
+/* RX buffer record boundary, an entry may hold several records once the FIFO is full */
+typedef struct {
+    char *pEnd;                         /* the RX buffer position after the entry records */
+    uint16 NumOfRecords;                /* the number of records that end up to pEnd */
+}LoggerRxRecord_t;
+
+typedef struct {
+    LoggerRxRecord_t Entry[LOGGER_CONFIG_RX_RECORD_FIFO_SIZE]; /* the records in the RX buffer, oldest first */
+    uint8 Head;                         /* the oldest entry index */
+    uint8 Tail;                         /* the next free entry index */
+}LoggerRxRecordFifo_t;
+
 typedef struct {
     uint8 IsSocketOpened       :1;      /* is socket opened */
+    uint8 IsPanic              :1;      /* is the panic flush in progress (the interrupts are disabled) */
+    uint8 IsRecovered          :1;      /* do the RX buffers hold log messages that survived the last reset */
+    uint8 IsCrashAreaReady     :1;      /* is the FLASH crash area erased, so a crash can be captured */
 }LoggerFlags_t;
 
+typedef enum {
+    e_LOGGER_RX_BUFF_MAIN,                      /* the RX double buffer */
+    e_LOGGER_RX_BUFF_PRIORITY,                  /* the ERROR and CRITICAL records RX buffer */
+    e_LOGGER_RX_BUFF_MAX,
+}LoggerRxBuff_e;
+
+/* logger RX buffers header. kept in no-init RAM with the RX buffers, so the log messages that were not sent survive a reset */
+typedef struct {
+    uint32 Magic;                                   /* the header magic number (LOGGER_DEF_NOINIT_MAGIC) */
+    uint32 BootId;                                  /* the number of resets the RX buffers survived since power up */
+    uint16 ReadOffset[e_LOGGER_RX_BUFF_MAX];        /* every RX buffer read offset (the slowest required sink) */
+    uint16 WriteOffset[e_LOGGER_RX_BUFF_MAX];       /* every RX buffer write offset */
+    uint32 Crc;                                     /* CRC-32 of the header fields above */
+}LoggerNoInitHeader_t;
+
+/* logger hot path filter snapshot. the printing tasks and the sinks read it instead of the general configuration.
+   a published snapshot is never modified, a new one is built aside and published with a single pointer write */
+typedef struct {
+    uint32 ModuleMask;                 /* the task ID participating in debug logs */
+    BOOL IsEnabled;                    /* is logger feature enabled */
+    BOOL IsPrintoutEnabled;            /* Is RS232 printout enabled */
+    uint8 LogLevel;                    /* the current log level for printing debug messages */
+    uint8 DestType;                    /* FLASH or Socket */
+    uint8 Attributes;                  /* feature attributes */
+}LoggerFilterSnapshot_t;
+
+/* logger filter snapshots manager. it is updated by the logger task only */
+typedef struct {
+    LoggerFilterSnapshot_t Snapshot[2];                     /* the published snapshot and the one that is built for the next publish */
+    const LoggerFilterSnapshot_t * volatile pActive;        /* the published snapshot (NULL before the logger init) */
+    uint32 PublishCnt;                 /* the number of published snapshots */
+    uint32 SinkReconfigCnt;            /* the number of general configurations that switched the sinks */
+    uint32 DrainTimeoutCnt;            /* the number of destination changes the old sinks did not send the RX buffers in time, the new sinks send the rest */
+}LoggerFilterMng_t;
+
+/* the total time spent in a logger mode (needs GetTimeUsCb) */
+typedef struct {
+    uint32 TotalMS;                    /* the total time in the mode in ms, up to the last mode exit */
+    uint32 EnterUs;                    /* the time the mode was entered in us */
+    uint16 RemainderUs;                /* the total time remainder below 1 ms */
+    uint8 IsActive;                    /* is the logger in the mode now */
+}LoggerModeTime_t;
+
+/* RX double buffer occupancy time series, sampled by the drain task (needs GetTimeUsCb) */
+typedef struct {
+    LoggerOccupancySample_t Series[LOGGER_CONFIG_OCCUPANCY_SERIES_SIZE]; /* the last seconds occupancy, a cyclic array */
+    uint8 Head;                        /* the oldest second index */
+    uint8 NumOfSeconds;                /* the number of seconds in the series */
+    uint16 CurMin;                     /* the current second lowest occupancy */
+    uint16 CurMax;                     /* the current second highest occupancy */
+    uint16 CurCnt;                     /* the current second number of samples */
+    uint32 CurSum;                     /* the current second sum of the samples */
+    uint32 SecondStartUs;              /* the time the current second started */
+    LoggerModeTime_t HighResolution;   /* the time the TX timer runs at the high resolution */
+    LoggerModeTime_t Idle;             /* the time the TX timer is stopped, the RX buffers are empty */
+}LoggerOccupancyMng_t;
+
+/* RX buffers drain scheduler. the TX timer interrupt only wakes up the drain task, which does the sinks I/O */
+typedef struct {
+    uint8 Resolution;                  /* the current TX timer resolution (LOGGER_RESOLUTION_TYPE_XXX) */
+    volatile uint8 IsSignaled;         /* the drain task was woken up and did not start draining yet */
+    volatile uint8 InFlightMask;       /* the sinks the drain task is sending to without the RX buffer mutex, bit per sink (LoggerSink_e) */
+    uint16 PendingAgeMS;               /* the age of the oldest unsent RX buffer byte, measured in TX timer periods */
+    uint32 WakeupCnt;                  /* the total number of TX timer interrupts */
+    uint32 IdleWakeupCnt;              /* the number of drain task wake ups that had nothing to send */
+    uint32 BudgetCnt;                  /* the number of drain task wake ups that ran out of their byte or time budget */
+    uint32 PanicCnt;                   /* the number of synchronous panic flushes */
+    uint32 LatencyHist[LOGGER_DEF_DRAIN_LATENCY_BUCKETS]; /* log to sink latency histogram, bucket i counts latencies below 2^i ms */
+    uint32 IsrMaxUs;                   /* the TX timer interrupt worst case execution time in us (needs GetTimeUsCb) */
+    uint32 DrainMaxUs;                 /* the drain task longest wake up in us (needs GetTimeUsCb) */
+    uint32 DrainBusyUs;                /* the drain task total busy time in us, since DrainStartUs (needs GetTimeUsCb) */
+    uint32 DrainStartUs;               /* the time the drain task CPU share is measured from */
+}LoggerDrainMng_t;
+
 typedef struct {
     char *pHead;                       /* a pointer to double buffer head */
     char *pTail;                       /* a pointer to double buffer tail */
-    char *pRead;                       /* a pointer to read from double buffer */
+    char *pRead;                       /* a pointer to read from double buffer (the slowest sink read pointer) */
     char *pWrite;                      /* a pointer to write to double buffer */
+    char *pSinkRead[e_LOGGER_SINK_MAX]; /* every sink read pointer */
+    char *pDrainHold;                  /* the start of the range the drain task is sending without the mutex (NULL otherwise), the writers do not overwrite it */
     OSAL_MUTEX_HANDLE pMutex;          /* a pointer to mutex to lock on write operations */
     uint32 RxCounter;                  /* the total number of RX debug messages */
     uint32 LowMemoryCnt;               /* how many times the Rx buffer got low memory */
     uint32 TxCounter;                  /* the total number of TX packets */
     uint32 BusyCnt;                    /* counter for error\busy in the low level for debug */
     uint32 RunOverCnt;                 /* counter for buffer run over */ 
+    uint32 SinkDropCnt[e_LOGGER_SINK_MAX]; /* how many times an optional sink was dropped to the slowest required sink */
+    uint32 LostMsgCnt;                 /* the total number of records lost on buffer run over */
+    uint32 LostBytesCnt;               /* the total number of bytes lost on buffer run over */
+    uint32 PendingLostMsgs;            /* the number of records lost since the last loss marker record */
+    uint16 PeakUsed;                   /* the peak occupancy in bytes since the RX buffer init */
+    uint16 ReadPeakUsed;               /* the peak occupancy in bytes since the last occupancy read */
+    LoggerModeTime_t LowMemoryTime;    /* the time the RX buffer has low memory */
+    LoggerRxRecordFifo_t Records;      /* the records boundaries, the oldest records are overwritten on whole record boundaries */
     LoggerRxBuffFlags_t Flags;         /* Rx buffer flags */
 }RXBuffer_t;
 
+/* a record being written by Logger_printf or Logger_kv (see Logger_RecordStart) */
+typedef struct {
+    const LoggerFilterSnapshot_t *pFilter; /* the filter snapshot the record passed */
+    RXBuffer_t *pRxBuffer;             /* the RX buffer of the record */
+    LoggerTaskStats_t *pTaskStats;     /* the printing task statistics */
+    uint32 RecordTime;                 /* the record time kept by the FLASH sector summary */
+    uint32 StartCycles;                /* the record start time of the latency probe */
+    uint8 TaskId;                      /* the printing task ID */
+    uint8 Level;                       /* the record log level */
+}LoggerRecordCtx_t;
+
 /* logger manager handle */
 typedef struct {
     RXBuffer_t RxBuffer;               /* Logger RX double buffer manager */
+    RXBuffer_t PriorityBuffer;         /* Logger RX buffer manager reserved for ERROR and CRITICAL records */
+    LoggerDrainMng_t DrainMng;         /* Logger RX buffers drain scheduler */
+    LoggerNoInitHeader_t *pNoInit;     /* Logger RX buffers no-init RAM header */
+    LoggerCmdMng_t CmdMng;             /* Logger command pool */
+    LoggerFilterMng_t FilterMng;       /* Logger hot path filter snapshot */
+    LoggerProbeMng_t ProbeMng;         /* Logger latency probes histograms */
+    LoggerOccupancyMng_t OccupancyMng; /* Logger RX buffer occupancy time series */
+    LoggerTaskStats_t TaskStats[LOGGER_DEF_MAX_TASKS]; /* Logger per task statistics, every entry is updated by its task only */
+    LoggerCallSiteMng_t CallSiteMng;   /* Logger call sites table */
+    LoggerTelemetryMng_t TelemetryMng; /* Logger periodic telemetry record */
     LoggerCB_t *pCbList;               /* Logger callback list */
     LoggerConfig_t Config;             /* logger user configuration */
     LoggerFLASHManager_t FlashMng;     /* logger Flash read and write adresses */
+    LoggerEraseMng_t EraseMng;         /* logger Flash erase state machine */
+    LoggerDumpMng_t DumpMng;           /* logger Flash dump state machine */
+    LoggerSectorSummary_t SectorSummary[LOGGER_DEF_FLASH_MAX_NUM_OF_SECTORS]; /* logger Flash sectors summaries */
+    LoggerSectorSummary_t PendingSummary; /* summary of the records that were not written to Flash yet */
+    LoggerRecordTimeFifo_t RecordTimeFifo; /* times of the records that were not written to Flash yet */
+    LoggerFlashRange_t UploadRange;    /* logger Flash range of the log file upload in progress */
+    LoggerUploadCursor_t UploadCursor; /* logger Flash log upload cursor */
+    LoggerUploadJob_t UploadJob;       /* logger log file upload job */
     uint8 State;                       /* logger manager task state */
     LoggerFlags_t Flags;               /* logger flags */ 
 }LoggerManager_t;
@@ -2,8 +2,8 @@
  * Author: Joshua Levi
  * Date: 17/01/2021
  * Description: Logger Release notes
- * -------------------------------------------------------------------------------------
- 
+ * -------------------------------------------------------------------------------------*/
+
 #define LOGGER_VERSION  "1.11"
 
 /*==========================================================================
@@ -56,5 +56,9 @@ Known issus:
 
 1. when working in pull mode and stressing the log file (send 60 bytes message every 10 msec), sometimes some of the logs are not writen to the flash correctly
    I suspecet this is due to the FLASH driver poor realtime performance, as I didnt see such problem when working with RS232 or UDP
+   reproduced on the host FLASH model (logger_host_powerloss): a partial write of a busy FLASH was dropped from the RX buffer without
+   moving the FLASH write pointer (fixed), and after a reset the NVR write address could be behind the log file end (fixed).
+   a priority record could be written in the middle of a RX buffer record that a busy FLASH has cut (fixed, the other RX buffer
+   waits for the end of the cut record)
 */
 
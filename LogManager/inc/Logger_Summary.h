@@ -0,0 +1,16 @@
+#ifndef __LOGGER_SUMMARY_H
+#define __LOGGER_SUMMARY_H
+
+uint32 Logger_PackDateAndTime(LoggerDateAndTime_t *pDateAndTime);
+void Logger_SummaryInit(void);
+uint32 Logger_SummaryAddRecord(uint8 Level, uint8 TaskId);
+void Logger_SummaryAddRecordEnd(uint32 Time, char *pEnd);
+void Logger_SummaryRecordsWritten(uint32 Address, char *pRead, uint16 Size);
+void Logger_SummaryRecordsSkipped(char *pRead, char *pWrite);
+void Logger_SummaryMergePending(uint32 SectorAddr);
+LOGGER_STATUS Logger_SummaryClose(uint32 SectorAddr);
+void Logger_SummaryOpen(uint32 SectorAddr);
+uint8 Logger_SummaryGetSectorMask(LoggerLogFilter_t *pFilter);
+BOOL Logger_SummaryFindTimeRange(LoggerLogFilter_t *pFilter, uint32 *pStartAddr, int *pSizeBytes);
+
+#endif //__LOGGER_SUMMARY_H
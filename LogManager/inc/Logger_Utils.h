@@ -1,15 +1,43 @@
 #ifndef _LOGGER_UTILS_H_
 #define _LOGGER_UTILS_H_
 
+#include "Logger_KvKeys.h"
+
 #ifdef ENABLE_LOG_PRINT
 #define LOG_PRINT(LEVEL, ...)   Logger_printf(LEVEL, __VA_ARGS__)
+#define LOG_KV(LEVEL, EVENT, ...) Logger_kv(LEVEL, EVENT, __VA_ARGS__, e_LOGGER_KV_KEY_END)
 #define LOG_ENTRY()             Logger_printf(LEVEL_FLOW, "%s >>\n", __FUNCTION__)
 #define LOG_LINE()              Logger_printf(LEVEL_FLOW, "%s %d", __FUNCTION__, __LINE__)
 #define LOG_EXIT()              Logger_printf(LEVEL_FLOW, "%s %d <<\n", __FUNCTION__, __LINE__)
 #else
 #define LOG_PRINT(LEVEL, ...)
+#define LOG_KV(LEVEL, EVENT, ...)
 #endif
 
+/* the structured records fields types */
+typedef enum {
+    e_LOGGER_KV_TYPE_INT,           /* int, a zigzag varint in the binary record */
+    e_LOGGER_KV_TYPE_UINT,          /* uint32, a varint in the binary record */
+    e_LOGGER_KV_TYPE_STR            /* a null terminated string, its length and characters in the binary record */
+}LoggerKvType_e;
+
+/* the structured records keys IDs (see Logger_KvKeys.h) */
+#define LOGGER_KV_KEY(NAME, TYPE, STR)      e_LOGGER_KV_KEY_##NAME,
+typedef enum {
+    e_LOGGER_KV_KEY_END,            /* the fields list end */
+    LOGGER_KV_KEYS
+    e_LOGGER_KV_KEY_MAX
+}LoggerKvKey_e;
+#undef LOGGER_KV_KEY
+
+/* the structured records events IDs (see Logger_KvKeys.h) */
+#define LOGGER_KV_EVENT(NAME, STR)          e_LOGGER_KV_EVENT_##NAME,
+typedef enum {
+    LOGGER_KV_EVENTS
+    e_LOGGER_KV_EVENT_MAX
+}LoggerKvEvent_e;
+#undef LOGGER_KV_EVENT
+
 /* debug prints levels the sevirity is from low to high */
 typedef enum {
     LEVEL_NONE,                     /* all prints are carried out, always, and from all tassk */
@@ -22,8 +50,17 @@ typedef enum {
     LEVEL_MAX_NUM                   /* maximum number of level prints */
 }LoggerLogLevel_e;
 
-void Logger_printf(uint8 level, char *fmt, ...);
+void Logger_printf(uint8 level, const char *fmt, ...);
+void Logger_kv(uint8 level, uint16 EventId, ...);
 void Logger_SendPacketFromInt(void);
+void Logger_DrainRxBuffers(void);
+uint8 Logger_GetSinksMask(void);
+void Logger_SwitchRxBuffersSinks(uint8 PrevSinksMask);
+void Logger_ScheduleDrain(void);
+void Logger_PanicFlush(void);
+BOOL Logger_FlashSinkLock(void);
+void Logger_FlashSinkUnlock(BOOL IsLocked);
+void Logger_ResetProbes(void);
 BOOL Logger_IsLoopBack(uint8 TaskId);
 uint16 Logger_GetMaxBuffSize(void);
 BOOL Logger_IsReady(void);
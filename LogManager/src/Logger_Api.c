@@ -1,6 +1,8 @@
 
 #include "Logger_Defs.h"
 #include "Logger_Manager.h"
+#include "Logger_Func.h"
+#include "Logger_Crash.h"
 
 
                 /* ========================================== *
@@ -50,6 +52,70 @@ static void Logger_SendGeneralCmd(void *pInputBuff, uint16 BufLen, LoggerCmd_e C
 
 }
 
+/**
+ * <pre>
+ * static void Logger_SendIsrCmd(LoggerCmd_e Cmd, uint16 Param)
+ * </pre>
+ *  
+ * This function sends a command without a buffer to the logger task from an interrupt context.
+ * It does not ask the OSAL for the running task, the message source is the logger task itself
+ *
+ * @param   Cmd            [in]    the logger command enum
+ * @param   Param          [in]    additional input parameter
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_SendIsrCmd(LoggerCmd_e Cmd, uint16 Param)
+{
+    OSAL_Msg *pMessage;
+        
+    /* build message */
+    pMessage               = OSAL_MsgNew();
+    pMessage->cmd          = Cmd;
+    pMessage->src          = TASK_APP_LOGGER_MANAGER_ID;
+    pMessage->origSrc      = TASK_APP_LOGGER_MANAGER_ID;
+    pMessage->dst          = TASK_APP_LOGGER_MANAGER_ID;
+    pMessage->reply        = FALSE;
+    pMessage->status       = 0;
+    pMessage->pDataIn      = NULL;
+    pMessage->DataInLen    = 0;
+    pMessage-> CntrlBits   = 0;
+    pMessage-> pDataOut    = NULL ;
+    pMessage-> DataOutLen  = 0 ;
+    pMessage-> userTag     = Param;
+  
+    /* send message */
+    OSAL_SendMessageToTask(pMessage);
+}
+
+/**
+ * <pre>
+ * static void Logger_SetTimeRangeFilter(LoggerLogFilter_t *pFilter, LoggerDateAndTime_t *pStartTime, LoggerDateAndTime_t *pEndTime)
+ * </pre>
+ *  
+ * This function sets a log filter that passes all the records of a time range
+ *
+ * @param   pFilter      [out]      a pointer to the filter to set
+ * @param   pStartTime   [in]       Optional. a pointer to the range start time
+ * @param   pEndTime     [in]       Optional. a pointer to the range end time
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_SetTimeRangeFilter(LoggerLogFilter_t *pFilter, LoggerDateAndTime_t *pStartTime, LoggerDateAndTime_t *pEndTime)
+{
+    LoggerDateAndTime_t NoTime = {0};
+    
+    pFilter->MaxLevel = LEVEL_MAX_NUM - 1;
+    pFilter->TaskMask = 0xFFFFFFFF;
+    OSAL_MemCopy(&pFilter->StartTime, pStartTime? pStartTime: &NoTime, sizeof(LoggerDateAndTime_t));
+    OSAL_MemCopy(&pFilter->EndTime, pEndTime? pEndTime: &NoTime, sizeof(LoggerDateAndTime_t));
+}
+
                 /* ========================================== *
                  *     A P I     F U N C T I O N S            *
                  * ========================================== */
@@ -173,6 +239,41 @@ void Logger_SetModuleMaskApi(uint32 ModuleMask)
     OSAL_SendMessageToTask(pMessage);
 }
 
+/**
+ * <pre>
+ * void Logger_SetBatchApi(LoggerBatchCmd_t *pBatch)
+ * </pre>
+ *  
+ * This api sets several logger run time parameters (log level, module mask and destination type) with a single command.
+ *
+ * @param   pBatch             [in]    a pointer to the batch command. only the parameters of its Fields bits 
+ *                                     (LOGGER_BATCH_LOG_LEVEL, LOGGER_BATCH_MODULE_MASK, LOGGER_BATCH_DEST_TYPE) are set.
+ *                                     a batch with an out of range parameter is rejected as a whole
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SetBatchApi(LoggerBatchCmd_t *pBatch)
+{
+    LoggerBatchCmd_t *pBatchBuff = NULL;
+    
+    if(Logger_ValidateBatchCmd(pBatch))
+    {
+        LOG_PRINT(LEVEL_ERROR, "Batch rejected: Fields(%x) Level(%d) DestType(%d)\n", pBatch->Fields, pBatch->LogLevel, pBatch->DestType);
+        return;
+    }
+    
+    pBatchBuff = (LoggerBatchCmd_t *)Logger_CmdBuffAlloc(sizeof(LoggerBatchCmd_t));
+    if(pBatchBuff == NULL)
+    {
+        OSAL_ASSERT(0);
+        return;
+    }
+    OSAL_MemCopy(pBatchBuff, pBatch, sizeof(LoggerBatchCmd_t));
+    Logger_SendGeneralCmd(pBatchBuff, sizeof(LoggerBatchCmd_t), e_LOGGER_CMD_BATCH, 0);
+}
+
 /**
  * <pre>
  * void Logger_SetModeApi(uint8 Mode)
@@ -183,6 +284,7 @@ void Logger_SetModuleMaskApi(uint32 ModuleMask)
  * @param   Mode  [in]    the logger mode to set. currently the possible modes are:
  *                        LOGGER_MODE_TYPE_PUSH - each log message is sent directly over a socket. (currently not supported)
  *                        LOGGER_MODE_TYPE_PULL - each log message is writen to the log file in the panel and sent by command over FTP    
+ *                        LOGGER_MODE_TYPE_PUSH_PULL - each log message is sent over a socket and writen to the log file simultaneously
  *
  * @return none
  *
@@ -206,6 +308,7 @@ void Logger_SetModeApi(uint8 Mode)
  *                        LOGGER_DEST_TYPE_NONE - no destination type
  *                        LOGGER_DEST_TYPE_FLASH - Logs are sent to flash
  *                        LOGGER_DEST_TYPE_SOCKET - Logs are sent to socket
+ *                        LOGGER_DEST_TYPE_FLASH_AND_SOCKET - Logs are sent to flash and socket
  *
  * @return none
  *
@@ -237,7 +340,7 @@ void Logger_SetRemoteDebugServerApi(LoggerSocketConfig_t *pSocket)
     uint8 TaskId = OSAL_GetSelfTaskId();
     OSAL_Msg *pMessage;
     
-    LoggerSocketConfig_t *pSocketBuff = (LoggerSocketConfig_t *)OSAL_HeapAllocBuffer(OSAL_GetSelfTaskId(), sizeof(LoggerSocketConfig_t));
+    LoggerSocketConfig_t *pSocketBuff = (LoggerSocketConfig_t *)Logger_CmdBuffAlloc(sizeof(LoggerSocketConfig_t));
     
     if(pSocketBuff == NULL)
     {
@@ -268,7 +371,7 @@ void Logger_SetRemoteDebugServerApi(LoggerSocketConfig_t *pSocket)
 
 /**
  * <pre>
- * void Logger_UploadLogFileApi(LoggerFtpConfig_t *pFtpConfig,  LoggerSocketConfig_t *pLoggerSocketConfig)
+ * void Logger_UploadLogFileApi(LoggerFtpConfig_t *pFtpConfig,  LoggerSocketConfig_t *pLoggerSocketConfig, LoggerLogFilter_t *pFilter)
  * </pre>
  *  
  * This api upload a log file to the server. 
@@ -276,25 +379,35 @@ void Logger_SetRemoteDebugServerApi(LoggerSocketConfig_t *pSocket)
  * @param   pFtpConfig           [in]       a pointer to Logger ftp server to upload the file to.
  * @param   pLoggerSocketConfig  [in]       a pointer to Logger socket releated to the FTP.
  * NOTE: in case both paramters are NULL the logger will use the default hard coded FTP server configured (see Logger_Config.h) 
+ * NOTE: FTP file size LOGGER_DEF_GET_NEW_FLASH_SIZE_KB uploads only the log written since the last successful upload
+ * @param   pFilter              [in]       Optional. a pointer to log level, task and time filter. only the FLASH sectors that may 
+ *                                          match the filter are uploaded (NULL to upload the whole log file). a filter time range
+ *                                          replaces the FTP file size
  * @return none
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-void Logger_UploadLogFileApi(LoggerFtpConfig_t *pFtpConfig,  LoggerSocketConfig_t *pLoggerSocketConfig)
+void Logger_UploadLogFileApi(LoggerFtpConfig_t *pFtpConfig,  LoggerSocketConfig_t *pLoggerSocketConfig, LoggerLogFilter_t *pFilter)
 {
     uint8 TaskId = OSAL_GetSelfTaskId();
     OSAL_Msg *pMessage;
         
-    LoggerFtpConfig_t *pFtpConfigBuff = (LoggerFtpConfig_t *)OSAL_HeapAllocBuffer(OSAL_GetSelfTaskId(), sizeof(LoggerFtpConfig_t));
-    LoggerSocketConfig_t *pSocketConfigBuff = (LoggerSocketConfig_t *)OSAL_HeapAllocBuffer(OSAL_GetSelfTaskId(), sizeof(LoggerSocketConfig_t));
-    if(pFtpConfigBuff == NULL || pSocketConfigBuff == NULL)
+    LoggerUploadCmd_t *pUploadCmdBuff = (LoggerUploadCmd_t *)Logger_CmdBuffAlloc(sizeof(LoggerUploadCmd_t));
+    LoggerSocketConfig_t *pSocketConfigBuff = (LoggerSocketConfig_t *)Logger_CmdBuffAlloc(sizeof(LoggerSocketConfig_t));
+    if(pUploadCmdBuff == NULL || pSocketConfigBuff == NULL)
     {
         OSAL_ASSERT(0);
         return;
     }
-    OSAL_MemCopy(pFtpConfigBuff, pFtpConfig, sizeof(LoggerFtpConfig_t));
+    OSAL_MemCopy(&pUploadCmdBuff->Ftp, pFtpConfig, sizeof(LoggerFtpConfig_t));
     OSAL_MemCopy(pSocketConfigBuff, pLoggerSocketConfig, sizeof(LoggerSocketConfig_t));
+    
+    pUploadCmdBuff->IsFiltered = (pFilter != NULL);
+    if(pFilter != NULL)
+    {
+        OSAL_MemCopy(&pUploadCmdBuff->Filter, pFilter, sizeof(LoggerLogFilter_t));
+    }
 
     /* build message */
     pMessage               = OSAL_MsgNew();
@@ -304,8 +417,8 @@ void Logger_UploadLogFileApi(LoggerFtpConfig_t *pFtpConfig,  LoggerSocketConfig_
     pMessage->dst          = TASK_APP_LOGGER_MANAGER_ID;
     pMessage->reply        = FALSE;
     pMessage->status       = 0 ;
-    pMessage->pDataIn      = pFtpConfigBuff;
-    pMessage->DataInLen    = sizeof(pFtpConfigBuff);
+    pMessage->pDataIn      = pUploadCmdBuff;
+    pMessage->DataInLen    = sizeof(LoggerUploadCmd_t);
     pMessage-> CntrlBits   = OSAL_MSG_FREE_BY_TARGET;
     /* NOTE: this is not an output buffer. I use this pointer instead of allocating a new buffer to hold both in and output buffers */
     /* I release the buffer in the handling task */
@@ -400,20 +513,85 @@ void Logger_PullDebugLogApi(uint16 FlashSizeKB, LoggerFtpConfig_t *pFtpConfig)
 
 /**
  * <pre>
- * void Logger_DumpDebugLogApi(uint16 FlashSizeKB)
+ * void Logger_DumpDebugLogApi(uint16 FlashSizeKB, LoggerLogFilter_t *pFilter)
  * </pre>
  *  
  * This api dump the last FlashSizeKB size of log file to the RS232 (for debug)
  *
- * @param   FlashSizeKB  [in]       The last file size in KB to dump.
+ * @param   FlashSizeKB  [in]       The last file size in KB to dump (LOGGER_DEF_GET_NEW_FLASH_SIZE_KB dumps the log written since
+ *                                  the last successful upload).
+ * @param   pFilter      [in]       Optional. a pointer to log level, task and time filter. only the FLASH sectors that may 
+ *                                  match the filter are dumped (NULL to dump all). a filter time range replaces FlashSizeKB
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_DumpDebugLogApi(uint16 FlashSizeKB, LoggerLogFilter_t *pFilter)
+{
+    LoggerLogFilter_t *pFilterBuff = NULL;
+    
+    if(pFilter != NULL)
+    {
+        pFilterBuff = (LoggerLogFilter_t *)Logger_CmdBuffAlloc(sizeof(LoggerLogFilter_t));
+        if(pFilterBuff == NULL)
+        {
+            OSAL_ASSERT(0);
+            return;
+        }
+        OSAL_MemCopy(pFilterBuff, pFilter, sizeof(LoggerLogFilter_t));
+    }
+    Logger_SendGeneralCmd(pFilterBuff, pFilterBuff? sizeof(LoggerLogFilter_t): 0, e_LOGGER_CMD_DUMP_DEBUG_LOG, FlashSizeKB);
+}
+
+/**
+ * <pre>
+ * void Logger_DumpTimeRangeApi(LoggerDateAndTime_t *pStartTime, LoggerDateAndTime_t *pEndTime)
+ * </pre>
+ *  
+ * This api dump the log records of a time range to the RS232 (for debug)
+ *
+ * @param   pStartTime   [in]       Optional. a pointer to the range start time (NULL to dump from the oldest record)
+ * @param   pEndTime     [in]       Optional. a pointer to the range end time (NULL to dump up to the newest record)
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_DumpTimeRangeApi(LoggerDateAndTime_t *pStartTime, LoggerDateAndTime_t *pEndTime)
+{
+    LoggerLogFilter_t Filter;
+    
+    Logger_SetTimeRangeFilter(&Filter, pStartTime, pEndTime);
+    
+    /* the time range replaces the dump size */
+    Logger_DumpDebugLogApi(LOGGER_DEF_GET_ALL_FLASH_SIZE_KB, &Filter);
+}
+
+/**
+ * <pre>
+ * void Logger_UploadTimeRangeApi(LoggerFtpConfig_t *pFtpConfig,  LoggerSocketConfig_t *pLoggerSocketConfig, LoggerDateAndTime_t *pStartTime, LoggerDateAndTime_t *pEndTime)
+ * </pre>
+ *  
+ * This api upload the log records of a time range to the server. 
+ *
+ * @param   pFtpConfig           [in]       a pointer to Logger ftp server to upload the file to.
+ * @param   pLoggerSocketConfig  [in]       a pointer to Logger socket releated to the FTP.
+ * NOTE: in case both paramters are NULL the logger will use the default hard coded FTP server configured (see Logger_Config.h) 
+ * @param   pStartTime           [in]       Optional. a pointer to the range start time (NULL to upload from the oldest record)
+ * @param   pEndTime             [in]       Optional. a pointer to the range end time (NULL to upload up to the newest record)
  * @return none
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-void Logger_DumpDebugLogApi(uint16 FlashSizeKB)
+void Logger_UploadTimeRangeApi(LoggerFtpConfig_t *pFtpConfig,  LoggerSocketConfig_t *pLoggerSocketConfig, LoggerDateAndTime_t *pStartTime, LoggerDateAndTime_t *pEndTime)
 {
-    Logger_SendGeneralCmd(NULL, 0, e_LOGGER_CMD_DUMP_DEBUG_LOG, FlashSizeKB);
+    LoggerLogFilter_t Filter;
+    
+    Logger_SetTimeRangeFilter(&Filter, pStartTime, pEndTime);
+    
+    Logger_UploadLogFileApi(pFtpConfig, pLoggerSocketConfig, &Filter);
 }
 
 /**
@@ -437,6 +615,60 @@ void Logger_SendConfigToSrvApi(uint8 ConfigType)
    Logger_SendGeneralCmd(NULL, 0, e_LOGGER_CMD_SEND_CONF_TO_SRV, ConfigType); 
 }
 
+/**
+ * <pre>
+ * void Logger_SendTaskStatsToSrvApi(void)
+ * </pre>
+ *  
+ * This api sends the per task statistics to the server
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SendTaskStatsToSrvApi(void)
+{
+   Logger_SendGeneralCmd(NULL, 0, e_LOGGER_CMD_SEND_TASK_STATS_TO_SRV, 0); 
+}
+
+/**
+ * <pre>
+ * void Logger_SendTopSitesToSrvApi(uint8 NumOfSites, BOOL IsNewWindow)
+ * </pre>
+ *  
+ * This api sends the call sites that wrote the most bytes since the window start to the server
+ *
+ * @param   NumOfSites  [in]       The number of call sites to send (up to LOGGER_DEF_MAX_TOP_SITES)
+ * @param   IsNewWindow [in]       Start a new window once the report was built
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SendTopSitesToSrvApi(uint8 NumOfSites, BOOL IsNewWindow)
+{
+   Logger_SendGeneralCmd(NULL, 0, e_LOGGER_CMD_SEND_TOP_SITES_TO_SRV, NumOfSites | ((IsNewWindow? 1: 0) << 8)); 
+}
+
+/**
+ * <pre>
+ * void Logger_SetTelemetryIntervalApi(uint16 IntervalSec)
+ * </pre>
+ *  
+ * This api sets the interval of the periodic telemetry record to the server
+ *
+ * @param   IntervalSec [in]       The record interval in seconds, 0 stops the telemetry records
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SetTelemetryIntervalApi(uint16 IntervalSec)
+{
+   Logger_SendGeneralCmd(NULL, 0, e_LOGGER_CMD_SET_TELEMETRY_INTERVAL, IntervalSec); 
+}
+
 /**
  * <pre>
  * void Logger_SetConfigFromSrvApi(uint8 ConfigType, void* pConfig)
@@ -463,20 +695,139 @@ void Logger_SetConfigFromSrvApi(uint8 ConfigType, void* pConfig)
     {
         case e_LOGGER_CONF_TYPE_GENERAL:
             Len = sizeof(LoggerGenConfig_t);
-            pInputBuff = OSAL_HeapAllocBuffer(OSAL_GetSelfTaskId(), Len);
+            pInputBuff = Logger_CmdBuffAlloc(Len);
             OSAL_MemCopy(pInputBuff, pConfig, Len);
         break;
         case e_LOGGER_CONF_TYPE_SOCKET:
             Len = sizeof(LoggerSocketConfig_t);
-            pInputBuff = OSAL_HeapAllocBuffer(OSAL_GetSelfTaskId(), Len);
+            pInputBuff = Logger_CmdBuffAlloc(Len);
             OSAL_MemCopy(pInputBuff, pConfig, Len);
         break;
         case e_LOGGER_CONF_TYPE_FTP:
             Len =  sizeof(LoggerFtpConfig_t);
-            pInputBuff = OSAL_HeapAllocBuffer(OSAL_GetSelfTaskId(), Len);
+            pInputBuff = Logger_CmdBuffAlloc(Len);
             OSAL_MemCopy(pInputBuff, pConfig, Len);
         break;
     }
     Logger_SendGeneralCmd(pInputBuff, Len, e_LOGGER_CMD_SET_CONFIG, ConfigType);
 }
 
+/**
+ * <pre>
+ * void Logger_FlashCompletionApi(LOGGER_STATUS Status)
+ * </pre>
+ *  
+ * This api signals the logger task that an asynchronous FLASH operation has ended.
+ * It is passed as the completion routine to ReadFlashDataAsyncCb and EraseFlashSectorAsyncCb. 
+ * It may be called from the FLASH driver completion context, an interrupt or a task: it only queues a message to the
+ * logger task, like the TX timer interrupt wakes up the drain task, and does not use the caller task ID. 
+ *
+ * @param   Status  [in]       The FLASH operation status. LOGGER_STATUS_OK on success or negative value otherwise
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_FlashCompletionApi(LOGGER_STATUS Status)
+{
+    Logger_SendIsrCmd(e_LOGGER_CMD_FLASH_COMPLETION, (uint8)Status); 
+}
+
+/**
+ * <pre>
+ * void Logger_PanicFlushApi(void)
+ * </pre>
+ *  
+ * This api synchronously writes the pending log messages to the FLASH and to the polled RS232 with the interrupts disabled.
+ * It is called directly (not through the logger task) from the crash paths, e.g. the hard fault handler or the assert handler.
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_PanicFlushApi(void)
+{
+    Logger_PanicFlush();
+}
+
+/**
+ * <pre>
+ * LOGGER_STATUS Logger_CrashCaptureApi(LoggerCrashHeader_t *pHeader, uint8 *pStack, uint16 StackLen)
+ * </pre>
+ *  
+ * This api writes a crash capture (the header, a raw stack dump and the last log messages) to the FLASH crash area with 
+ * polled writes and the interrupts disabled. It is called directly (not through the logger task) from the hard fault handler,
+ * before the panic flush. The capture is printed on the next init.
+ *
+ * @param   pHeader     [inout]    the crash capture header filled by the platform (exception frame, fault status, task and time)
+ * @param   pStack      [in]       the faulting task stack pointer
+ * @param   StackLen    [in]       the stack bytes that may be read from pStack
+ * @return LOGGER_STATUS_OK on success or negative value otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+LOGGER_STATUS Logger_CrashCaptureApi(LoggerCrashHeader_t *pHeader, uint8 *pStack, uint16 StackLen)
+{
+    return Logger_CrashCapture(pHeader, pStack, StackLen);
+}
+
+/**
+ * <pre>
+ * void Logger_ResetProbesApi(void)
+ * </pre>
+ *  
+ * This api clears the latency probes histograms. It is called directly (not through the logger task).
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_ResetProbesApi(void)
+{
+    Logger_ResetProbes();
+}
+
+/**
+ * <pre>
+ * void Logger_GetOccupancyApi(LoggerOccupancy_t *pOccupancy)
+ * </pre>
+ *  
+ * This api returns the RX buffers occupancy statistics. It is called directly (not through the logger task).
+ *
+ * @param   pOccupancy  [out]   the RX buffers occupancy statistics
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_GetOccupancyApi(LoggerOccupancy_t *pOccupancy)
+{
+    Logger_GetOccupancy(pOccupancy);
+}
+
+/**
+ * <pre>
+ * uint8 Logger_GetTopSitesApi(LoggerCallSite_t *pTop, uint8 NumOfSites, BOOL IsNewWindow, uint32 *pWindowMS)
+ * </pre>
+ *  
+ * This api returns the call sites that wrote the most bytes since the window start. It is called directly (not through 
+ * the logger task).
+ *
+ * @param   pTop        [out]   the top call sites
+ * @param   NumOfSites  [in]    the maximum number of call sites to return
+ * @param   IsNewWindow [in]    start a new window once the call sites were returned
+ * @param   pWindowMS   [out]   Optional. the window length in ms
+ *
+ * @return the number of call sites returned
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+uint8 Logger_GetTopSitesApi(LoggerCallSite_t *pTop, uint8 NumOfSites, BOOL IsNewWindow, uint32 *pWindowMS)
+{
+    return Logger_GetTopSites(pTop, NumOfSites, IsNewWindow, pWindowMS);
+}
@@ -183,6 +183,10 @@ BOOL Logger_SetRAMGeneralConfig(LoggerGenConfig_t *pGeneralConfig)
         {
             LOGGER_DEF_GEN_CONFIG.DestType = LOGGER_DEST_TYPE_FLASH;            
         }
+        else if(pGeneralConfig->Mode == LOGGER_MODE_TYPE_PUSH_PULL)
+        {
+            LOGGER_DEF_GEN_CONFIG.DestType = LOGGER_DEST_TYPE_FLASH_AND_SOCKET;            
+        }
         else
         {
             LOGGER_DEF_GEN_CONFIG.DestType = LOGGER_DEST_TYPE_NONE;                        
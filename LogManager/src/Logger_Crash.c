@@ -0,0 +1,343 @@
+#include "Logger_Defs.h"
+#include "Logger_Manager.h"
+#include "Logger_Func.h"
+#include "Logger_Utils.h"
+#include "Logger_Crash.h"
+
+                /* ========================================== *
+                 *          D E F I N I T I O N S             *
+                 * ========================================== */
+
+#define CRASH_RX_DISTANCE(P_RX, P_FROM, P_TO)   ((uint16)(((P_TO) - (P_FROM) + ((P_RX)->pTail - (P_RX)->pHead)) % ((P_RX)->pTail - (P_RX)->pHead)))
+#define CRASH_RX_FREE_SIZE(P_RX)                ((uint16)(((P_RX)->pTail - (P_RX)->pHead) - 1 - CRASH_RX_DISTANCE(P_RX, (P_RX)->pRead, (P_RX)->pWrite)))
+#define CRASH_STACK_ADDRESS                     (LOGGER_CONFIG_FLASH_CRASH_ADDRESS + sizeof(LoggerCrashHeader_t))
+#define CRASH_HEADER_CRC_LEN                    (sizeof(LoggerCrashHeader_t) - sizeof(uint32))
+
+                /* ========================================== *
+                 *     P R I V A T E     V A R I A B L E S    *
+                 * ========================================== */
+extern LoggerManager_t gLoggerManager;
+
+                /* ========================================== *
+                 *     P R I V A T E     F U N C T I O N S    *
+                 * ========================================== */
+
+/**
+ * <pre>
+ * static LOGGER_STATUS Logger_CrashWrite(uint32 *pAddress, char *pBuff, uint16 Len)
+ * </pre>
+ *  
+ * this function writes a buffer to the FLASH crash area with polled writes, in FLASH page chunks
+ *
+ * @param   pAddress        [inout]  the FLASH address to write to, advanced by the bytes written
+ * @param   pBuff           [in]     the buffer to write
+ * @param   Len             [in]     the buffer length in bytes
+ *
+ * @return LOGGER_STATUS_OK on success, or negative value otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static LOGGER_STATUS Logger_CrashWrite(INOUT uint32 *pAddress, IN char *pBuff, IN uint16 Len)
+{
+    uint16 Retries = 0;
+    uint16 Chunk;
+    LOGGER_STATUS Status;
+    
+    while(Len)
+    {
+        /* a chunk never crosses a FLASH page */
+        Chunk = LOGGER_DEF_CRASH_WRITE_CHUNK_SIZE - (*pAddress % LOGGER_DEF_CRASH_WRITE_CHUNK_SIZE);
+        Chunk = LOGGER_DEF_MIN(Chunk, Len);
+        
+        Status = gLoggerManager.pCbList->SendFlashDataCb(*pAddress, pBuff, &Chunk);
+        
+        if(Status != LOGGER_STATUS_OK && (Status != LOGGER_STATUS_BUSY || ++Retries > LOGGER_DEF_CRASH_WRITE_RETRIES))
+        {
+            return LOGGER_STATUS_FLASH_WRITE_ERROR;
+        }
+        *pAddress += Chunk;
+        pBuff += Chunk;
+        Len -= Chunk;
+    }
+    return LOGGER_STATUS_OK;
+}
+
+/**
+ * <pre>
+ * static BOOL Logger_CrashLoad(LoggerCrashHeader_t *pHeader)
+ * </pre>
+ *  
+ * this function reads the crash capture header from the FLASH crash area and validates the whole capture
+ *
+ * @param   pHeader         [out]    the crash capture header
+ *
+ * @return TRUE if the crash area holds a valid crash capture, or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static BOOL Logger_CrashLoad(OUT LoggerCrashHeader_t *pHeader)
+{
+    char Chunk[LOGGER_DEF_CRASH_PRINT_CHUNK_SIZE];
+    uint32 Address = CRASH_STACK_ADDRESS;
+    uint32 Crc;
+    uint16 Left;
+    uint16 Len;
+    
+    if(gLoggerManager.pCbList->ReadFlashDataCb(LOGGER_CONFIG_FLASH_CRASH_ADDRESS, (char*)pHeader, sizeof(LoggerCrashHeader_t)) != LOGGER_STATUS_OK ||
+       pHeader->Magic != LOGGER_DEF_CRASH_MAGIC || pHeader->StackLen > LOGGER_CONFIG_CRASH_STACK_DUMP_BYTES || 
+       pHeader->RxLen > LOGGER_CONFIG_CRASH_RX_SNAPSHOT_BYTES)
+    {
+        return FALSE;
+    }
+    Crc = Logger_Crc32(LOGGER_DEF_CRC32_INIT, pHeader, CRASH_HEADER_CRC_LEN);
+    
+    for(Left = pHeader->StackLen + pHeader->RxLen; Left; Left -= Len)
+    {
+        Len = LOGGER_DEF_MIN(Left, sizeof(Chunk));
+        
+        if(gLoggerManager.pCbList->ReadFlashDataCb(Address, Chunk, Len) != LOGGER_STATUS_OK)
+        {
+            return FALSE;
+        }
+        Crc = Logger_Crc32(Crc, Chunk, Len);
+        Address += Len;
+    }
+    return (Crc == pHeader->Crc);
+}
+
+/**
+ * <pre>
+ * static void Logger_CrashPrintWait(uint16 *pWaitMS)
+ * </pre>
+ *  
+ * this function waits for the sinks to free room for the next crash capture record in the ERROR and CRITICAL records buffer,
+ * so a crash capture larger than the buffer is not overwritten while it is printed
+ *
+ * @param   pWaitMS         [inout]  the total time waited so far, up to LOGGER_CONFIG_CRASH_PRINT_TIMEOUT_MS
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_CrashPrintWait(INOUT uint16 *pWaitMS)
+{
+    RXBuffer_t *pRxBuffer = &gLoggerManager.PriorityBuffer;
+    
+    while(CRASH_RX_FREE_SIZE(pRxBuffer) < LOGGER_CONFIG_MAX_RX_MESSAGE_SIZE_BYTES + LOGGER_DEF_LOSS_MARKER_MAX_LEN &&
+          *pWaitMS < LOGGER_CONFIG_CRASH_PRINT_TIMEOUT_MS)
+    {
+        Logger_FlushRxBuffer();
+        OSAL_SuspendTask(LOGGER_CONFIG_OVERRUN_BLOCK_POLL_MS);
+        *pWaitMS += LOGGER_CONFIG_OVERRUN_BLOCK_POLL_MS;
+    }
+}
+
+                /* ========================================== *
+                 *     P U B L I C     F U N C T I O N S      *
+                 * ========================================== */
+
+/**
+ * <pre>
+ * LOGGER_STATUS Logger_CrashCapture(LoggerCrashHeader_t *pHeader, uint8 *pStack, uint16 StackLen)
+ * </pre>
+ *  
+ * this function writes a crash capture to the FLASH crash area: the header (exception frame, fault status and task), 
+ * a raw dump of the faulting task stack and the last LOGGER_CONFIG_CRASH_RX_SNAPSHOT_BYTES of the RX buffer (the log messages
+ * that led to the crash, sent or not). it uses polled FLASH writes with the interrupts disabled, and the header is written
+ * last, so a capture cut by a reset is not taken as valid. a single crash is captured per boot, the crash area is erased 
+ * on the next init once the capture was printed (see Logger_CrashInit).
+ * NOTE: this function is called from the crash paths (Logger_CrashCaptureApi), before the panic flush
+ *
+ * @param   pHeader         [inout]  the crash capture header, the logger sets its boot ID, lengths and CRC
+ * @param   pStack          [in]     the faulting task stack pointer
+ * @param   StackLen        [in]     the stack bytes that may be read from pStack (up to LOGGER_CONFIG_CRASH_STACK_DUMP_BYTES are kept)
+ *
+ * @return LOGGER_STATUS_OK on success, or negative value otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+LOGGER_STATUS Logger_CrashCapture(INOUT LoggerCrashHeader_t *pHeader, IN uint8 *pStack, IN uint16 StackLen)
+{
+    RXBuffer_t *pRxBuffer = &gLoggerManager.RxBuffer;
+    uint32 Address = CRASH_STACK_ADDRESS;
+    uint32 IntState;
+    uint16 Size;
+    uint16 SizeToTail;
+    char *pSnapshot;
+    LOGGER_STATUS Status;
+    
+    /* check working conditions, the crash area holds a capture that was not printed yet */
+    if(gLoggerManager.pCbList == NULL || gLoggerManager.pCbList->SendFlashDataCb == NULL || 
+       gLoggerManager.pCbList->DisableInterruptsCb == NULL || !gLoggerManager.Flags.IsCrashAreaReady)
+    {
+        return LOGGER_STATUS_ERROR;
+    }
+    IntState = gLoggerManager.pCbList->DisableInterruptsCb();
+    
+    gLoggerManager.Flags.IsCrashAreaReady = 0;
+    
+    /* the last log messages end at the write pointer, the bytes before it are kept even if they were sent */
+    Size = pRxBuffer->pTail - pRxBuffer->pHead;
+    
+    pHeader->Magic = LOGGER_DEF_CRASH_MAGIC;
+    pHeader->BootId = (gLoggerManager.pNoInit != NULL)? gLoggerManager.pNoInit->BootId: 0;
+    pHeader->StackLen = (pStack != NULL)? LOGGER_DEF_MIN(StackLen, LOGGER_CONFIG_CRASH_STACK_DUMP_BYTES): 0;
+    pHeader->RxLen = LOGGER_DEF_MIN(LOGGER_CONFIG_CRASH_RX_SNAPSHOT_BYTES, Size - 1);
+    
+    pSnapshot = pRxBuffer->pHead + (pRxBuffer->pWrite - pRxBuffer->pHead + Size - pHeader->RxLen) % Size;
+    SizeToTail = LOGGER_DEF_MIN(pHeader->RxLen, pRxBuffer->pTail - pSnapshot);
+    
+    pHeader->Crc = Logger_Crc32(LOGGER_DEF_CRC32_INIT, pHeader, CRASH_HEADER_CRC_LEN);
+    pHeader->Crc = Logger_Crc32(pHeader->Crc, pStack, pHeader->StackLen);
+    pHeader->Crc = Logger_Crc32(pHeader->Crc, pSnapshot, SizeToTail);
+    pHeader->Crc = Logger_Crc32(pHeader->Crc, pRxBuffer->pHead, pHeader->RxLen - SizeToTail);
+    
+    Status = Logger_CrashWrite(&Address, (char*)pStack, pHeader->StackLen);
+    
+    if(Status == LOGGER_STATUS_OK)
+    {
+        Status = Logger_CrashWrite(&Address, pSnapshot, SizeToTail);
+    }
+    if(Status == LOGGER_STATUS_OK)
+    {
+        Status = Logger_CrashWrite(&Address, pRxBuffer->pHead, pHeader->RxLen - SizeToTail);
+    }
+    /* the header validates the capture, so it is written last */
+    if(Status == LOGGER_STATUS_OK)
+    {
+        Address = LOGGER_CONFIG_FLASH_CRASH_ADDRESS;
+        Status = Logger_CrashWrite(&Address, (char*)pHeader, sizeof(LoggerCrashHeader_t));
+    }
+    gLoggerManager.pCbList->RestoreInterruptsCb(IntState);
+    
+    return Status;
+}
+
+/**
+ * <pre>
+ * BOOL Logger_CrashPrint(void)
+ * </pre>
+ *  
+ * this function prints the crash capture kept in the FLASH crash area (if any) and erases the crash area for the next crash.
+ * every line starts with "CRASH", so the host tool (tools/logger_crash.py) can find it in a log file and symbolise it.
+ * the last log messages before the crash are printed between the "CRASH LOG BEGIN" and "CRASH LOG END" lines.
+ *
+ * @return TRUE if a crash capture was printed, or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+BOOL Logger_CrashPrint(void)
+{
+    LoggerCrashHeader_t Header;
+    uint32 Words[LOGGER_DEF_CRASH_PRINT_CHUNK_SIZE/sizeof(uint32)];
+    char Chunk[LOGGER_DEF_CRASH_PRINT_CHUNK_SIZE*2];
+    uint32 Address = CRASH_STACK_ADDRESS;
+    uint16 WaitMS = 0;
+    uint16 Offset;
+    uint16 Len;
+    uint8 Idx;
+    
+    /* check working conditions */
+    if(gLoggerManager.pCbList == NULL || gLoggerManager.pCbList->ReadFlashDataCb == NULL || !Logger_CrashLoad(&Header))
+    {
+        return FALSE;
+    }
+    Header.TaskName[LOGGER_DEF_CRASH_TASK_NAME_LEN - 1] = 0;
+    
+    LOG_PRINT(LEVEL_ERROR, "\r\n#########################################\r\n");
+    LOG_PRINT(LEVEL_ERROR, "CRASH CAPTURE BOOT %d ON %d/%d/%d %d:%d:%d\r\n", Header.BootId, Header.Time.Day, Header.Time.Month, 
+              Header.Time.Year, Header.Time.Hour, Header.Time.Minute, Header.Time.Second);
+    LOG_PRINT(LEVEL_ERROR, "CRASH TASK %s ID %d CMD 0x%x\r\n", Header.TaskName, Header.TaskId, Header.TaskCmd);
+    LOG_PRINT(LEVEL_ERROR, "CRASH R0 0x%x R1 0x%x R2 0x%x R3 0x%x\r\n", Header.Frame[e_LOGGER_CRASH_REG_R0], 
+              Header.Frame[e_LOGGER_CRASH_REG_R1], Header.Frame[e_LOGGER_CRASH_REG_R2], Header.Frame[e_LOGGER_CRASH_REG_R3]);
+    LOG_PRINT(LEVEL_ERROR, "CRASH R12 0x%x LR 0x%x PC 0x%x XPSR 0x%x\r\n", Header.Frame[e_LOGGER_CRASH_REG_R12], 
+              Header.Frame[e_LOGGER_CRASH_REG_LR], Header.Frame[e_LOGGER_CRASH_REG_PC], Header.Frame[e_LOGGER_CRASH_REG_XPSR]);
+    LOG_PRINT(LEVEL_ERROR, "CRASH CFSR 0x%x HFSR 0x%x MMFAR 0x%x BFAR 0x%x\r\n", Header.Cfsr, Header.Hfsr, Header.Mmfar, Header.Bfar);
+    LOG_PRINT(LEVEL_ERROR, "CRASH SP 0x%x STACK %d LOG %d\r\n", Header.StackAddr, Header.StackLen, Header.RxLen);
+    
+    /* the stack dump, a line of words per chunk */
+    for(Offset = 0; Offset < Header.StackLen; Offset += Len)
+    {
+        Len = LOGGER_DEF_MIN(Header.StackLen - Offset, sizeof(Words));
+        
+        for(Idx = 0; Idx < sizeof(Words)/sizeof(uint32); Idx++)
+        {
+            Words[Idx] = 0;
+        }
+        gLoggerManager.pCbList->ReadFlashDataCb(Address + Offset, (char*)Words, Len);
+        
+        Logger_CrashPrintWait(&WaitMS);
+        LOG_PRINT(LEVEL_ERROR, "CRASH STACK 0x%x: %x %x %x %x %x %x %x %x\r\n", Header.StackAddr + Offset, 
+                  Words[0], Words[1], Words[2], Words[3], Words[4], Words[5], Words[6], Words[7]);
+    }
+    Address += Header.StackLen;
+    
+    /* the last log messages, as they were written to the RX buffer */
+    Logger_CrashPrintWait(&WaitMS);
+    LOG_PRINT(LEVEL_ERROR, "CRASH LOG BEGIN\r\n");
+    
+    for(Offset = 0; Offset < Header.RxLen; Offset += Len)
+    {
+        Len = LOGGER_DEF_MIN(Header.RxLen - Offset, sizeof(Chunk));
+        
+        gLoggerManager.pCbList->ReadFlashDataCb(Address + Offset, Chunk, Len);
+        
+        Logger_CrashPrintWait(&WaitMS);
+        LOG_PRINT(LEVEL_ERROR, "%b", Chunk, Len);
+    }
+    Logger_CrashPrintWait(&WaitMS);
+    LOG_PRINT(LEVEL_ERROR, "\r\nCRASH LOG END\r\n");
+    LOG_PRINT(LEVEL_ERROR, "#########################################\r\n");
+    
+    /* free the crash area for the next crash */
+    if(gLoggerManager.pCbList->EraseFlashSectorCb != NULL)
+    {
+        gLoggerManager.Flags.IsCrashAreaReady = (gLoggerManager.pCbList->EraseFlashSectorCb(LOGGER_CONFIG_FLASH_CRASH_ADDRESS, 1, 
+                                                 gLoggerManager.Config.General.FlashSize) == LOGGER_STATUS_OK);
+    }
+    return TRUE;
+}
+
+/**
+ * <pre>
+ * void Logger_CrashInit(void)
+ * </pre>
+ *  
+ * this function prepares the FLASH crash area on init: a crash capture that was not printed yet (e.g. the fault handler RAM 
+ * record was lost on power down) is printed, and the crash area is erased if it is not blank.
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_CrashInit(void)
+{
+    uint32 FirstWord = LOGGER_DEF_BLANK_NVR_PARAM_32;
+    
+    /* check working conditions */
+    if(gLoggerManager.pCbList->ReadFlashDataCb == NULL || gLoggerManager.pCbList->EraseFlashSectorCb == NULL)
+    {
+        return;
+    }
+    /* the crash was already printed by the fault handler print, and the crash area was erased */
+    if(gLoggerManager.Flags.IsCrashAreaReady || Logger_CrashPrint())
+    {
+        return;
+    }
+    if(gLoggerManager.pCbList->ReadFlashDataCb(LOGGER_CONFIG_FLASH_CRASH_ADDRESS, (char*)&FirstWord, sizeof(FirstWord)) != LOGGER_STATUS_OK)
+    {
+        return;
+    }
+    if(FirstWord != LOGGER_DEF_BLANK_NVR_PARAM_32 &&
+       gLoggerManager.pCbList->EraseFlashSectorCb(LOGGER_CONFIG_FLASH_CRASH_ADDRESS, 1, gLoggerManager.Config.General.FlashSize) != LOGGER_STATUS_OK)
+    {
+        return;
+    }
+    gLoggerManager.Flags.IsCrashAreaReady = 1;
+}
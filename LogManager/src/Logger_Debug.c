@@ -6,12 +6,57 @@
 
 extern LoggerManager_t gLoggerManager;
 
+static const char * const gLoggerProbeStr[e_LOGGER_PROBE_MAX] = {
+    "Printf",
+    "MutexWait",
+    "Parse",
+    "TxIsr",
+    "SinkFlash",
+    "SinkSocket",
+    "SinkUart",
+};
+
+/**
+ * <pre>
+ * static uint8 LoggerDebug_ProbePercentile(const uint32 *pHist, uint32 Cnt, uint8 Percent)
+ * </pre>
+ *
+ * this function returns the log2 histogram bucket the given percentile of the samples falls in
+ *
+ * @param   pHist       [in]    The probe histogram
+ * @param   Cnt         [in]    The number of samples in the histogram
+ * @param   Percent     [in]    The percentile
+ *
+ * @return the bucket, the percentile is below 2^bucket cycles
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static uint8 LoggerDebug_ProbePercentile(const uint32 *pHist, uint32 Cnt, uint8 Percent)
+{
+    uint32 Sum = 0;
+    
+    uint8 Bucket;
+    
+    for(Bucket = 0; Bucket < LOGGER_DEF_PROBE_BUCKETS - 1; Bucket++)
+    {
+        Sum += pHist[Bucket];
+        if(Sum * 100ULL >= Cnt * 1ULL * Percent)
+            break;
+    }
+    return Bucket;
+}
+
 void LoggerDebug_PrintRAMstatus(void)
 {
 #define FLASH_MNG   gLoggerManager.FlashMng
 
     extern char *LoggerStateStr[];
     
+    uint8 Bucket;
+    
+    uint32 DrainWindowUs;
+    
     Printf("\n\nLogger statistics:\n_______________\n\n");
     
     Printf("TxCounter: %d\nRxCnt: %d\nBusyCnt: %d\nLowMemCnt: %d\nRunOverCnt: %d\n\n", 
@@ -19,6 +64,60 @@ void LoggerDebug_PrintRAMstatus(void)
            gLoggerManager.RxBuffer.BusyCnt, gLoggerManager.RxBuffer.LowMemoryCnt, 
            gLoggerManager.RxBuffer.RunOverCnt);
     
+    Printf("FlashSinkDropCnt: %d\nSocketSinkDropCnt: %d\nUartSinkDropCnt: %d\n\n", 
+           gLoggerManager.RxBuffer.SinkDropCnt[e_LOGGER_SINK_FLASH], gLoggerManager.RxBuffer.SinkDropCnt[e_LOGGER_SINK_SOCKET], 
+           gLoggerManager.RxBuffer.SinkDropCnt[e_LOGGER_SINK_UART]);
+    
+    Printf("PriorityTxCounter: %d\nPriorityRxCnt: %d\nPriorityBusyCnt: %d\nPriorityRunOverCnt: %d\n\n", 
+           gLoggerManager.PriorityBuffer.TxCounter, gLoggerManager.PriorityBuffer.RxCounter, 
+           gLoggerManager.PriorityBuffer.BusyCnt, gLoggerManager.PriorityBuffer.RunOverCnt);
+    
+    Printf("LostMsgCnt: %d\nLostBytesCnt: %d\nPriorityLostMsgCnt: %d\nPriorityLostBytesCnt: %d\n\n", 
+           gLoggerManager.RxBuffer.LostMsgCnt, gLoggerManager.RxBuffer.LostBytesCnt, 
+           gLoggerManager.PriorityBuffer.LostMsgCnt, gLoggerManager.PriorityBuffer.LostBytesCnt);
+    
+    Printf("DrainResolution: %d\nWakeupCnt: %d\nIdleWakeupCnt: %d\nBudgetCnt: %d\n", 
+           gLoggerManager.DrainMng.Resolution, gLoggerManager.DrainMng.WakeupCnt, gLoggerManager.DrainMng.IdleWakeupCnt, 
+           gLoggerManager.DrainMng.BudgetCnt);
+    
+    Printf("IsrMaxUs: %d\nDrainMaxUs: %d\nDrainBusyUs: %d\nPanicCnt: %d\n", 
+           gLoggerManager.DrainMng.IsrMaxUs, gLoggerManager.DrainMng.DrainMaxUs, gLoggerManager.DrainMng.DrainBusyUs,
+           gLoggerManager.DrainMng.PanicCnt);
+    
+    if(gLoggerManager.pNoInit != NULL)
+    {
+        Printf("BootId: %d\nIsRecovered: %d\n", gLoggerManager.pNoInit->BootId, gLoggerManager.Flags.IsRecovered);
+    }
+    
+    if(gLoggerManager.pCbList->GetTimeUsCb != NULL && gLoggerManager.DrainMng.DrainStartUs != 0)
+    {
+        DrainWindowUs = gLoggerManager.pCbList->GetTimeUsCb() - gLoggerManager.DrainMng.DrainStartUs;
+        Printf("DrainCpuShare: %d.%02d%%\n", (uint32)(gLoggerManager.DrainMng.DrainBusyUs * 100ULL / (DrainWindowUs + 1)),
+               (uint32)(gLoggerManager.DrainMng.DrainBusyUs * 10000ULL / (DrainWindowUs + 1) % 100));
+    }
+    Printf("LatencyHist(log2 ms):");
+    for(Bucket = 0; Bucket < LOGGER_DEF_DRAIN_LATENCY_BUCKETS; Bucket++)
+    {
+        Printf(" %d", gLoggerManager.DrainMng.LatencyHist[Bucket]);
+    }
+    Printf("\n\n");
+    
+    Printf("CmdCnt: %d\nCmdTaskStartCnt: %d\nCmdPoolAllocCnt: %d\nCmdHeapAllocCnt: %d\nCmdPoolMaxUsed: %d/%d\n", 
+           gLoggerManager.CmdMng.CmdCnt, gLoggerManager.CmdMng.TaskStartCnt, gLoggerManager.CmdMng.PoolAllocCnt,
+           gLoggerManager.CmdMng.HeapAllocCnt, gLoggerManager.CmdMng.MaxUsedCnt, LOGGER_CONFIG_CMD_POOL_SIZE);
+    Printf("CmdLatencyMaxUs: %d\nCmdLatencyAvgUs: %d\n\n", gLoggerManager.CmdMng.LatencyMaxUs, 
+           gLoggerManager.CmdMng.LatencyTotalUs / (gLoggerManager.CmdMng.LatencyCnt + (gLoggerManager.CmdMng.LatencyCnt == 0)));
+    Printf("FilterPublishCnt: %d\nSinkReconfigCnt: %d\nReconfigDrainTimeoutCnt: %d\n\n", gLoggerManager.FilterMng.PublishCnt,
+           gLoggerManager.FilterMng.SinkReconfigCnt, gLoggerManager.FilterMng.DrainTimeoutCnt);
+    
+    LoggerDebug_PrintProbes();
+    
+    LoggerDebug_PrintOccupancy();
+    
+    LoggerDebug_PrintTaskStats();
+    
+    LoggerDebug_PrintTopSites();
+    
     Printf("\n\nPointer Status:\n____________\n\npHead: 0x%p\n",  gLoggerManager.RxBuffer.pHead);
     
     Printf("pTail: 0x%p:\npRead: 0x%p\npWrite: 0x%p\n\n",
@@ -33,6 +132,176 @@ void LoggerDebug_PrintRAMstatus(void)
     Printf("Logger State: %s\n", LoggerStateStr[gLoggerManager.State]);
 }
 
+/**
+ * <pre>
+ * void LoggerDebug_PrintProbes(void)
+ * </pre>
+ *
+ * this function prints the latency probes histograms: every probe number of samples, the log2 bucket of its median and 99th 
+ * percentile, its longest latency and its log2 cycles histogram up to the last used bucket. the histograms are cleared by 
+ * Logger_ResetProbesApi
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void LoggerDebug_PrintProbes(void)
+{
+    const LoggerProbeMng_t *pProbeMng = &gLoggerManager.ProbeMng;
+    
+    uint32 Cnt;
+    
+    uint8 Probe;
+    
+    uint8 Bucket;
+    
+    uint8 LastBucket;
+    
+    if(gLoggerManager.pCbList == NULL || gLoggerManager.pCbList->GetCyclesCb == NULL || !LOGGER_CONFIG_LATENCY_PROBES)
+    {
+        Printf("Latency probes: not supported\n\n");
+        return;
+    }
+    
+    Printf("Latency probes (cycles, reset %d times):\n", pProbeMng->ResetCnt);
+    for(Probe = 0; Probe < e_LOGGER_PROBE_MAX; Probe++)
+    {
+        for(Cnt = 0, LastBucket = 0, Bucket = 0; Bucket < LOGGER_DEF_PROBE_BUCKETS; Bucket++)
+        {
+            Cnt += pProbeMng->Hist[Probe][Bucket];
+            if(pProbeMng->Hist[Probe][Bucket] != 0)
+            {
+                LastBucket = Bucket;
+            }
+        }
+        if(Cnt == 0)
+        {
+            Printf("%s: Cnt: 0\n", gLoggerProbeStr[Probe]);
+            continue;
+        }
+        Printf("%s: Cnt: %d p50<2^%d p99<2^%d Max: %d Hist(log2):", gLoggerProbeStr[Probe], Cnt, 
+               LoggerDebug_ProbePercentile(pProbeMng->Hist[Probe], Cnt, 50), 
+               LoggerDebug_ProbePercentile(pProbeMng->Hist[Probe], Cnt, 99), pProbeMng->MaxCycles[Probe]);
+        for(Bucket = 0; Bucket <= LastBucket; Bucket++)
+        {
+            Printf(" %d", pProbeMng->Hist[Probe][Bucket]);
+        }
+        Printf("\n");
+    }
+    Printf("\n");
+}
+
+/**
+ * <pre>
+ * void LoggerDebug_PrintOccupancy(void)
+ * </pre>
+ *
+ * this function prints the RX buffers occupancy statistics (see Logger_GetOccupancyApi). the peaks since the last read 
+ * are restarted
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void LoggerDebug_PrintOccupancy(void)
+{
+    LoggerOccupancy_t Occupancy;
+    
+    uint8 Idx;
+    
+    Logger_GetOccupancyApi(&Occupancy);
+    
+    Printf("RxPeakUsed: %d/%d\nRxReadPeakUsed: %d\nRxLowMemoryMS: %d\n", Occupancy.Main.PeakUsed, Occupancy.Main.SizeBytes,
+           Occupancy.Main.ReadPeakUsed, Occupancy.Main.LowMemoryMS);
+    Printf("PriorityPeakUsed: %d/%d\nPriorityReadPeakUsed: %d\nPriorityLowMemoryMS: %d\nHighResolutionMS: %d\nIdleMS: %d\n", 
+           Occupancy.Priority.PeakUsed, Occupancy.Priority.SizeBytes, Occupancy.Priority.ReadPeakUsed, 
+           Occupancy.Priority.LowMemoryMS, Occupancy.HighResolutionMS, Occupancy.IdleMS);
+    Printf("RxUsedPerSecond(min/avg/max):");
+    for(Idx = 0; Idx < Occupancy.NumOfSeconds; Idx++)
+    {
+        Printf(" %d/%d/%d", Occupancy.Series[Idx].MinUsed, Occupancy.Series[Idx].AvgUsed, Occupancy.Series[Idx].MaxUsed);
+    }
+    Printf("\n\n");
+}
+
+/**
+ * <pre>
+ * void LoggerDebug_PrintTaskStats(void)
+ * </pre>
+ *
+ * this function prints the per task statistics of every task that printed since the logger init
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void LoggerDebug_PrintTaskStats(void)
+{
+    const LoggerTaskStats_t *pTaskStats;
+    
+    uint8 TaskId;
+    
+    Printf("Task: AcceptedMsgs AcceptedBytes FilteredMsgs OverrunMsgs\n");
+    for(TaskId = 0; TaskId < LOGGER_DEF_MAX_TASKS; TaskId++)
+    {
+        pTaskStats = &gLoggerManager.TaskStats[TaskId];
+        if(pTaskStats->AcceptedMsgs != 0 || pTaskStats->FilteredMsgs != 0 || pTaskStats->OverrunMsgs != 0)
+        {
+            Printf("%d: %d %d %d %d\n", TaskId, pTaskStats->AcceptedMsgs, pTaskStats->AcceptedBytes, pTaskStats->FilteredMsgs,
+                   pTaskStats->OverrunMsgs);
+        }
+    }
+    Printf("\n");
+}
+
+/**
+ * <pre>
+ * void LoggerDebug_PrintTopSites(void)
+ * </pre>
+ *
+ * this function prints the LOGGER_DEF_MAX_TOP_SITES call sites that wrote the most bytes since the window start, with 
+ * their format string. the window is not restarted
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void LoggerDebug_PrintTopSites(void)
+{
+    LoggerCallSite_t Top[LOGGER_DEF_MAX_TOP_SITES];
+    
+    char Fmt[LOGGER_DEF_TOP_SITE_FMT_LEN + 1];
+    
+    uint32 WindowMS;
+    
+    uint8 NumOfSites;
+    
+    uint8 Idx;
+    
+    uint8 Len;
+    
+    NumOfSites = Logger_GetTopSitesApi(Top, LOGGER_DEF_MAX_TOP_SITES, FALSE, &WindowMS);
+    
+    Printf("TopSites in %d ms (Hits Bytes Fmt), Other: %d %d\n", WindowMS, gLoggerManager.CallSiteMng.OtherHits, 
+           gLoggerManager.CallSiteMng.OtherBytes);
+    for(Idx = 0; Idx < NumOfSites; Idx++)
+    {
+        /* the format string is printed without its line end */
+        for(Len = 0; Len < LOGGER_DEF_TOP_SITE_FMT_LEN && Top[Idx].pFmt[Len] != '\0' && Top[Idx].pFmt[Len] != '\r' && 
+            Top[Idx].pFmt[Len] != '\n'; Len++)
+        {
+            Fmt[Len] = Top[Idx].pFmt[Len];
+        }
+        Fmt[Len] = '\0';
+        Printf("%d %d \"%s\"\n", Top[Idx].Hits, Top[Idx].Bytes, Fmt);
+    }
+    Printf("\n");
+}
+
 void LoggerDebug_PrintConfig(void)
 {
 #define GEN_CONFIG      gLoggerManager.Config.General
@@ -10,6 +10,9 @@
 #include "Logger_Defs.h"
 #include "Logger_Manager.h"
 #include "Logger_Func.h"
+#include "Logger_Api.h"
+#include "Logger_Summary.h"
+#include "Logger_Crash.h"
 #include "HW_TIMER_API.h"
 #include "ComManagerInclude.h"
 #include "msme.h"
@@ -30,11 +33,13 @@ static void Logger_SetState(uint8 State)
 
 /**
  * <pre>
- * static void Logger_InitRxBuffer(RXBuffer_t *pRxBuffer)
+ * static void Logger_ResetRxBuffer(RXBuffer_t *pRxBuffer, char *pBuff, uint16 SizeBytes)
  * </pre>
  *  
- * this function initilizes the logger RX buffer to its init values
+ * this function resets an RX buffer pointers, counters and flags to their init values
  * @param   pRxBuffer           [out]    a pointer to the RX buffer data structure, for the function to initialize its values.
+ * @param   pBuff               [in]     the RAM buffer of the RX buffer
+ * @param   SizeBytes           [in]     the RAM buffer size in bytes
  *
  * @return none
  *
@@ -42,25 +47,260 @@ static void Logger_SetState(uint8 State)
  * \ingroup LogManager
 */
 
-static void Logger_InitRxBuffer(OUT RXBuffer_t *pRxBuffer)
+static void Logger_ResetRxBuffer(OUT RXBuffer_t *pRxBuffer, IN char *pBuff, IN uint16 SizeBytes)
 {
-    static char gLoggerMessagesBuffer [LOGGER_CONFIG_DOUBLE_BUFFER_SIZE_BYTES];
+    uint8 SinkId;
     
     /* initialize RX and TX pointers */
-    pRxBuffer->pHead = pRxBuffer->pRead = pRxBuffer->pWrite =  gLoggerMessagesBuffer;
+    pRxBuffer->pHead = pRxBuffer->pRead = pRxBuffer->pWrite =  pBuff;
+    
+    /* a range the drain task is sending is not returned to the reset buffer */
+    pRxBuffer->pDrainHold = NULL;
+    
+    /* every sink starts reading from the buffer head */
+    for(SinkId = 0; SinkId < e_LOGGER_SINK_MAX; SinkId++)
+    {
+        pRxBuffer->pSinkRead[SinkId] = pBuff;
+        pRxBuffer->SinkDropCnt[SinkId] = 0;
+    }
         
     /* intialize tail pointer */
-    pRxBuffer->pTail = pRxBuffer->pHead + LOGGER_CONFIG_DOUBLE_BUFFER_SIZE_BYTES;
-    
-    /* create mutex */
-    OSAL_PortMutexCreate(&pRxBuffer->pMutex);
+    pRxBuffer->pTail = pRxBuffer->pHead + SizeBytes;
     
     /* init counters */
     pRxBuffer->RxCounter =  pRxBuffer->TxCounter = pRxBuffer->BusyCnt =  pRxBuffer->LowMemoryCnt = pRxBuffer->RunOverCnt = 0;
+    pRxBuffer->LostMsgCnt = pRxBuffer->LostBytesCnt = pRxBuffer->PendingLostMsgs = 0;
+    pRxBuffer->PeakUsed = pRxBuffer->ReadPeakUsed = 0;
+    OSAL_MemSet(&pRxBuffer->LowMemoryTime, 0, sizeof(LoggerModeTime_t));
+    
+    /* the telemetry deltas do not go back over the reset */
+    gLoggerManager.TelemetryMng.IsReset = TRUE;
+    
+    /* the buffer has no records */
+    pRxBuffer->Records.Head = pRxBuffer->Records.Tail = 0;
     
     /* init flags */
-    pRxBuffer->Flags.IsLowMemory = pRxBuffer->Flags.IsUrgent = 0;
+    pRxBuffer->Flags.IsLowMemory = pRxBuffer->Flags.IsUrgent = pRxBuffer->Flags.IsFlashCut = 0;
+}
+
+/**
+ * <pre>
+ * static uint32 Logger_NoInitCrc(LoggerNoInitHeader_t *pHeader)
+ * </pre>
+ *  
+ * this function calculates the CRC-32 of the no-init RAM header fields (all the fields before the Crc field)
+ * @param   pHeader             [in]     a pointer to the no-init RAM header
+ *
+ * @return the header CRC-32
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static uint32 Logger_NoInitCrc(IN LoggerNoInitHeader_t *pHeader)
+{
+    return Logger_Crc32(LOGGER_DEF_CRC32_INIT, pHeader, (uint8*)&pHeader->Crc - (uint8*)pHeader);
+}
+
+/**
+ * <pre>
+ * static BOOL Logger_NoInitIsValid(LoggerNoInitHeader_t *pHeader)
+ * </pre>
+ *  
+ * this function checks if the no-init RAM header survived a reset (rather than holding the power up garbage)
+ * @param   pHeader             [in]     a pointer to the no-init RAM header
+ *
+ * @return TRUE if the header and its RX buffers offsets are valid, or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static BOOL Logger_NoInitIsValid(IN LoggerNoInitHeader_t *pHeader)
+{
+    return (pHeader->Magic == LOGGER_DEF_NOINIT_MAGIC && pHeader->Crc == Logger_NoInitCrc(pHeader) &&
+            pHeader->ReadOffset[e_LOGGER_RX_BUFF_MAIN] < LOGGER_CONFIG_DOUBLE_BUFFER_SIZE_BYTES &&
+            pHeader->WriteOffset[e_LOGGER_RX_BUFF_MAIN] < LOGGER_CONFIG_DOUBLE_BUFFER_SIZE_BYTES &&
+            pHeader->ReadOffset[e_LOGGER_RX_BUFF_PRIORITY] < LOGGER_CONFIG_PRIORITY_BUFFER_SIZE_BYTES &&
+            pHeader->WriteOffset[e_LOGGER_RX_BUFF_PRIORITY] < LOGGER_CONFIG_PRIORITY_BUFFER_SIZE_BYTES);
+}
+
+/**
+ * <pre>
+ * static uint8 Logger_BuildRecoveryMarker(char *pMarker, uint32 BootId)
+ * </pre>
+ *  
+ * this function builds the "--- recovered log of boot N ---" record
+ * @param   pMarker             [out]    the record buffer (at least LOGGER_DEF_RECOVERY_MARKER_MAX_LEN bytes)
+ * @param   BootId              [in]     the ID of the boot the log messages were written on
+ *
+ * @return the record length in bytes
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static uint8 Logger_BuildRecoveryMarker(OUT char *pMarker, IN uint32 BootId)
+{
+    static const char PrefixStr[] = "--- recovered log of boot ";
+    static const char SuffixStr[] = " ---\r\n";
+    char Digits[10];
+    uint8 NumOfDigits = 0;
+    uint8 Len = sizeof(PrefixStr) - 1;
+    
+    OSAL_MemCopy(pMarker, (void*)PrefixStr, Len);
+    do
+    {
+        Digits[NumOfDigits++] = '0' + BootId % 10;
+        BootId /= 10;
+    }while(BootId);
+    
+    while(NumOfDigits)
+    {
+        pMarker[Len++] = Digits[--NumOfDigits];
+    }
+    OSAL_MemCopy(pMarker + Len, (void*)SuffixStr, sizeof(SuffixStr) - 1);
+    
+    return Len + sizeof(SuffixStr) - 1;
+}
+
+/**
+ * <pre>
+ * static void Logger_RecoverRxBuffer(RXBuffer_t *pRxBuffer, uint16 ReadOffset, uint16 WriteOffset, uint32 PrevBootId)
+ * </pre>
+ *  
+ * this function keeps the RX buffer log messages that were not sent before the reset, so they are the first to be sent.
+ * the recovered log messages are preceded by a record tagged with the previous boot ID. if the record does not fit,
+ * the oldest log messages are dropped (on a line boundary).
+ * NOTE: the RX buffer must be reset first (see Logger_ResetRxBuffer)
+ * @param   pRxBuffer           [inout]  a pointer to the RX buffer data structure
+ * @param   ReadOffset          [in]     the RX buffer read offset before the reset
+ * @param   WriteOffset         [in]     the RX buffer write offset before the reset
+ * @param   PrevBootId          [in]     the ID of the boot the log messages were written on
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_RecoverRxBuffer(INOUT RXBuffer_t *pRxBuffer, IN uint16 ReadOffset, IN uint16 WriteOffset, IN uint32 PrevBootId)
+{
+    LoggerRxRecordFifo_t *pFifo = &pRxBuffer->Records;
+    char Marker[LOGGER_DEF_RECOVERY_MARKER_MAX_LEN];
+    uint16 Size = pRxBuffer->pTail - pRxBuffer->pHead;
+    uint16 Used = (WriteOffset + Size - ReadOffset) % Size;
+    uint16 NumOfLines = 0;
+    uint16 Idx;
+    uint8 SinkId;
+    uint8 MarkerLen;
+    char Dropped;
+    
+    /* all the log messages were sent before the reset */
+    if(Used == 0)
+    {
+        return;
+    }
+    MarkerLen = Logger_BuildRecoveryMarker(Marker, PrevBootId);
+    
+    /* make room for the record, the buffer keeps one byte free */
+    if(Used + MarkerLen > Size - 1)
+    {
+        do
+        {
+            Dropped = pRxBuffer->pHead[ReadOffset];
+            ReadOffset = (ReadOffset + 1) % Size;
+            pRxBuffer->LostBytesCnt++;
+            Used--;
+        }while(Used > 0 && (Used + MarkerLen > Size - 1 || Dropped != '\n'));
+    }
+    for(Idx = 0; Idx < Used; Idx++)
+    {
+        NumOfLines += (pRxBuffer->pHead[(ReadOffset + Idx) % Size] == '\n');
+    }
+    /* the record is written just before the recovered log messages */
+    ReadOffset = (ReadOffset + Size - MarkerLen) % Size;
+    
+    for(Idx = 0; Idx < MarkerLen; Idx++)
+    {
+        pRxBuffer->pHead[(ReadOffset + Idx) % Size] = Marker[Idx];
+    }
+    pRxBuffer->pRead = pRxBuffer->pHead + ReadOffset;
+    pRxBuffer->pWrite = pRxBuffer->pHead + WriteOffset;
+    
+    for(SinkId = 0; SinkId < e_LOGGER_SINK_MAX; SinkId++)
+    {
+        pRxBuffer->pSinkRead[SinkId] = pRxBuffer->pRead;
+    }
+    /* keep the boundaries of the record and of the recovered log messages */
+    pFifo->Entry[pFifo->Tail].pEnd = pRxBuffer->pHead + (ReadOffset + MarkerLen) % Size;
+    pFifo->Entry[pFifo->Tail].NumOfRecords = 1;
+    pFifo->Tail = (pFifo->Tail + 1) % LOGGER_CONFIG_RX_RECORD_FIFO_SIZE;
+    
+    if(Used > 0)
+    {
+        pFifo->Entry[pFifo->Tail].pEnd = pRxBuffer->pWrite;
+        pFifo->Entry[pFifo->Tail].NumOfRecords = (NumOfLines > 0)? NumOfLines: 1;
+        pFifo->Tail = (pFifo->Tail + 1) % LOGGER_CONFIG_RX_RECORD_FIFO_SIZE;
+    }
+}
+
+/**
+ * <pre>
+ * static void Logger_InitRxBuffer(RXBuffer_t *pRxBuffer, RXBuffer_t *pPriorityBuffer, BOOL IsRecover)
+ * </pre>
+ *  
+ * this function initilizes the logger RX buffers to their init values.
+ * the RX buffers and their header are kept in no-init RAM, so on init after reset the log messages that were not sent 
+ * are recovered if the header is valid.
+ * @param   pRxBuffer           [out]    a pointer to the RX buffer data structure, for the function to initialize its values.
+ * @param   pPriorityBuffer     [out]    a pointer to the ERROR and CRITICAL records RX buffer data structure.
+ * @param   IsRecover           [in]     should the log messages that survived the reset be recovered (FALSE discards them)
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+
+static void Logger_InitRxBuffer(OUT RXBuffer_t *pRxBuffer, OUT RXBuffer_t *pPriorityBuffer, IN BOOL IsRecover)
+{
+    static LOGGER_CONFIG_NO_INIT char gLoggerMessagesBuffer [LOGGER_CONFIG_DOUBLE_BUFFER_SIZE_BYTES];
+    
+    static LOGGER_CONFIG_NO_INIT char gLoggerPriorityMessagesBuffer [LOGGER_CONFIG_PRIORITY_BUFFER_SIZE_BYTES];
+    
+    static LOGGER_CONFIG_NO_INIT LoggerNoInitHeader_t gLoggerNoInitHeader;
+    
+    LoggerNoInitHeader_t *pHeader = &gLoggerNoInitHeader;
+    
+    BOOL IsValid = IsRecover && Logger_NoInitIsValid(pHeader);
+    
+    Logger_ResetRxBuffer(pRxBuffer, gLoggerMessagesBuffer, LOGGER_CONFIG_DOUBLE_BUFFER_SIZE_BYTES);
+    
+    Logger_ResetRxBuffer(pPriorityBuffer, gLoggerPriorityMessagesBuffer, LOGGER_CONFIG_PRIORITY_BUFFER_SIZE_BYTES);
+    
+    if(IsValid)
+    {
+        Logger_RecoverRxBuffer(pRxBuffer, pHeader->ReadOffset[e_LOGGER_RX_BUFF_MAIN], pHeader->WriteOffset[e_LOGGER_RX_BUFF_MAIN], pHeader->BootId);
         
+        Logger_RecoverRxBuffer(pPriorityBuffer, pHeader->ReadOffset[e_LOGGER_RX_BUFF_PRIORITY], pHeader->WriteOffset[e_LOGGER_RX_BUFF_PRIORITY], pHeader->BootId);
+    }
+    gLoggerManager.Flags.IsRecovered = (pRxBuffer->pRead != pRxBuffer->pWrite || pPriorityBuffer->pRead != pPriorityBuffer->pWrite);
+    
+    /* count the boots since the no-init RAM was last lost (power up) */
+    if(IsRecover)
+    {
+        pHeader->BootId = IsValid? pHeader->BootId + 1: 0;
+    }
+    pHeader->Magic = LOGGER_DEF_NOINIT_MAGIC;
+    
+    gLoggerManager.pNoInit = pHeader;
+    
+    Logger_NoInitUpdate();
+    
+    /* create mutex once, both buffers are written under the same mutex */
+    if(pRxBuffer->pMutex == NULL)
+    {
+        OSAL_PortMutexCreate(&pRxBuffer->pMutex);
+    }
+    
+    pPriorityBuffer->pMutex = pRxBuffer->pMutex;
 }
 
 /**
@@ -103,25 +343,86 @@ static void Logger_OpenSocket(IN LoggerSocketConfig_t *pSocketConfig)
 
 /**
  * <pre>
- * static LOGGER_STATUS Logger_EraseFlashSectors(uint32 StartAddress, uint8 NumOfSectors)
+ * static BOOL Logger_IsFlashAsync(void *pAsyncCb)
+ * </pre>
+ *  
+ * this function checks whether a FLASH operation should be driven by asynchronous completions.
+ * completions are delivered as messages to the logger task, so only flows running in the logger task context can use them.
+ * @param   pAsyncCb           [in]    the asynchronous callback of the operation (NULL if the platform does not support it)
+ *
+ * @return TRUE if the operation should be asynchronous, or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static BOOL Logger_IsFlashAsync(IN void *pAsyncCb)
+{
+    return (pAsyncCb != NULL && OSAL_GetSelfTaskId() == TASK_APP_LOGGER_MANAGER_ID);
+}
+
+/**
+ * <pre>
+ * static LOGGER_STATUS Logger_EraseFlashNextSector(void)
+ * </pre>
+ *  
+ * this function queues an asynchronous erase of the next sector of the erase state machine.
+ *
+ * @return LOGGER_STATUS_PENDING if the erase was queued, or negative value otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static LOGGER_STATUS Logger_EraseFlashNextSector(void)
+{
+    if(gLoggerManager.pCbList->EraseFlashSectorAsyncCb(gLoggerManager.EraseMng.NextAddr, gLoggerManager.Config.General.FlashSize, Logger_FlashCompletionApi) != LOGGER_STATUS_OK)
+    {
+        return LOGGER_STATUS_FLASH_ERASE_ERROR;
+    }
+    gLoggerManager.EraseMng.Flags.IsPending = 1;
+    
+    return LOGGER_STATUS_PENDING;
+}
+
+/**
+ * <pre>
+ * static LOGGER_STATUS Logger_EraseFlashSectors(uint32 StartAddress, uint8 NumOfSectors, uint8 Owner)
  * </pre>
  *  
  * this function erases log file sectors.
+ * if the platform supports asynchronous erase, the sectors are erased one by one, every completion queues the next sector
+ * and the owner flow is continued once the last sector was erased (see Logger_HandleEraseCompletion).
  * @param   StartAddress           [in]    the address of the first sector to erase
  * @param   NumOfSectors           [in]    the number of sectors to erase
+ * @param   Owner                  [in]    the flow to continue when an asynchronous erase is done (see LoggerEraseOwner_e)
  *
- * @return LOGGER_STATUS_OK on sucess, or negative value otherwise
+ * @return LOGGER_STATUS_OK on sucess, LOGGER_STATUS_PENDING if the erase is in progress, or negative value otherwise
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-static LOGGER_STATUS Logger_EraseFlashSectors(IN uint32 StartAddress, IN uint8 NumOfSectors)
+static LOGGER_STATUS Logger_EraseFlashSectors(IN uint32 StartAddress, IN uint8 NumOfSectors, IN uint8 Owner)
 {
-    if(gLoggerManager.pCbList->EraseFlashSectorCb != NULL)
+    if(Logger_IsFlashAsync((void*)gLoggerManager.pCbList->EraseFlashSectorAsyncCb))
     {
-        /* this variable is volatile as its a shared memory changed in another task */
-        volatile uint32 StatusCmd;
+        LOGGER_STATUS Status;
+        
+        /* set the erase state machine */
+        gLoggerManager.EraseMng.NextAddr = StartAddress;
+        gLoggerManager.EraseMng.SectorsLeft = NumOfSectors;
+        gLoggerManager.EraseMng.Owner = Owner;
+        *(uint8*)&gLoggerManager.EraseMng.Flags = 0;
+        gLoggerManager.EraseMng.Flags.IsAsync = 1;
         
+        Status = Logger_EraseFlashNextSector();
+        if(Status == LOGGER_STATUS_PENDING)
+        {
+            gLoggerManager.EraseMng.Flags.IsActive = 1;
+        }
+        return Status;
+    }
+    
+    if(gLoggerManager.pCbList->EraseFlashSectorCb != NULL)
+    {
         if(gLoggerManager.pCbList->EraseFlashSectorCb(StartAddress, NumOfSectors, gLoggerManager.Config.General.FlashSize) == LOGGER_STATUS_OK)
         {
             /* on success erase the bit which indicate a flash sector erase is needed */
@@ -168,54 +469,202 @@ static BOOL Logger_ValidateNVRParameters(IN LoggerFLASHManager_t *pFlashMng, IN
 
 /**
  * <pre>
- * static BOOL Logger_FlashMngInitDefault(LoggerFLASHManager_t *pFlashMng, uint16 FlashSize)
+ * static void Logger_SaveUploadProgress(void)
+ * </pre>
+ *  
+ * this function saves the upload job progress in NVR, so an upload that was cut by a reset can be resumed.
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_SaveUploadProgress(void)
+{
+    if(gLoggerManager.pCbList->SaveNVRParamsCb != NULL)
+    {
+        gLoggerManager.pCbList->SaveNVRParamsCb(LOGGER_CONFIG_NVR_UPLOAD_JOB_ADDRESS, &gLoggerManager.UploadJob.Progress, LOGGER_CONFIG_NVR_UPLOAD_JOB_SIZE_BYTES);
+    }
+}
+
+/**
+ * <pre>
+ * static LOGGER_STATUS Logger_FlashMngInitDefault(LoggerFLASHManager_t *pFlashMng, uint16 FlashSize)
  * </pre>
  *  
  * this function initializes the logger flash manager structure and erases the flash sectors.
  * @param   pFlashMng           [out]    a pointer to logger flash manager handle to initialize the default values
  * @param   FlashSizeKb         [in]    the flash size in KB
  *
- * @return TRUE if succeeded erasing flash sectors, or FALSE otherwised
+ * @return LOGGER_STATUS_OK if succeeded erasing flash sectors, LOGGER_STATUS_PENDING if the erase is in progress, or negative value otherwise
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
 
-static BOOL Logger_FlashMngInitDefault(OUT LoggerFLASHManager_t *pFlashMng, IN uint16 FlashSize)
+static LOGGER_STATUS Logger_FlashMngInitDefault(OUT LoggerFLASHManager_t *pFlashMng, IN uint16 FlashSize)
 {
     /* 1. set all values to 0 */
     pFlashMng->Flags.IsNextSectorErased = 0;
+    pFlashMng->Flags.IsSummaryWritten = 0;
     
     pFlashMng->CmdStatus = 0;
     
     /* 2. we need to set all NVR paramters to default value */
     pFlashMng->CurrSectorAddr = pFlashMng->WriteAddr = pFlashMng->ReadAddr = LOGGER_CONFIG_FLASH_START_ADDRESS;
+    pFlashMng->SectorSeq = 0;
+    pFlashMng->LayoutVer = LOGGER_DEF_NVR_LAYOUT_VERSION;
+    
+    /* the server has none of the new log file */
+    gLoggerManager.UploadCursor.SectorSeq = gLoggerManager.UploadCursor.Addr = LOGGER_DEF_BLANK_NVR_PARAM_32;
+    if(gLoggerManager.pCbList->SaveNVRParamsCb != NULL)
+    {
+        gLoggerManager.pCbList->SaveNVRParamsCb(LOGGER_CONFIG_NVR_UPLOAD_CURSOR_ADDRESS, &gLoggerManager.UploadCursor, LOGGER_CONFIG_NVR_UPLOAD_CURSOR_SIZE_BYTES);
+    }
+    /* an upload job that was cut can not be resumed */
+    *(uint8*)&gLoggerManager.UploadJob.Progress.Flags = 0;
+    Logger_SaveUploadProgress();
     
     /* 3. we need to erase all FLASH sectors. */
-    if(Logger_EraseFlashSectors(LOGGER_CONFIG_FLASH_START_ADDRESS, LOGGER_DEF_FLASH_NUM_OF_DEBUG_SECTORS(FlashSize)) == LOGGER_STATUS_OK)
+    return Logger_EraseFlashSectors(LOGGER_CONFIG_FLASH_START_ADDRESS, LOGGER_DEF_FLASH_NUM_OF_DEBUG_SECTORS(FlashSize), e_LOGGER_ERASE_OWNER_INIT_DEFAULT);
+}
+
+/**
+ * <pre>
+ * static LOGGER_STATUS Logger_FlashMngNextSectorErased(uint16 FlashSize)
+ * </pre>
+ *  
+ * this function updates the logger flash manager after the next sector was erased on init.
+ * @param   FlashSizeKb         [in]       the flash size in KB
+ *
+ * @return LOGGER_STATUS_OK on success, or negative value otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static LOGGER_STATUS Logger_FlashMngNextSectorErased(IN uint16 FlashSize)
+{
+    /* calculate the sector that was erased */
+    uint32 NextSectorAddress = LOGGER_DEF_FLASH_NEXT_SECTOR_ADDRESS(FlashSize, gLoggerManager.FlashMng.CurrSectorAddr, LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB);
+    
+     /* if we have just erased the current read address, update it to the next sector */
+    if(gLoggerManager.FlashMng.ReadAddr == NextSectorAddress)
     {
-        return TRUE;
+        /* we have just erased the read section, set the read section to the next section */
+        gLoggerManager.FlashMng.ReadAddr = LOGGER_DEF_FLASH_NEXT_SECTOR_ADDRESS(FlashSize, gLoggerManager.FlashMng.ReadAddr, LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB);
+        
+        /* save the current sector address for next reset */
+        return gLoggerManager.pCbList->SaveNVRParamsCb(LOGGER_CONFIG_NVR_ADDRESS, &gLoggerManager.FlashMng, LOGGER_CONFIG_NVR_SIZE_BYTES);
+    }
+    return LOGGER_STATUS_OK;
+}
+
+/**
+ * <pre>
+ * static void Logger_FlashSkipProgrammed(LoggerFLASHManager_t *pFlashMng)
+ * </pre>
+ *  
+ * this function moves the flash write pointer past the log file bytes that were written after the NVR parameters were saved.
+ * the NVR write address is saved after every flash write, so a reset between the two (or during the NVR save) leaves it behind
+ * the log file end, and the next write would program over the last written bytes. a record may hold blank (0xFF) bytes (%b),
+ * so the log file ends after the last programmed byte. a blank run longer than the longest record is never inside the log
+ * file, so the scan stops there. the blank bytes of the last record are programmed again, which leaves them as they are
+ *
+ * @param   pFlashMng           [inout]    a pointer to logger flash manager handle
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_FlashSkipProgrammed(INOUT LoggerFLASHManager_t *pFlashMng)
+{
+    uint32 SectorEndAddress = LOGGER_DEF_FLASH_SUMMARY_ADDRESS(pFlashMng->CurrSectorAddr);
+    
+    uint32 Address = pFlashMng->WriteAddr;
+    
+    uint32 BlankLen = 0;
+    
+    char Chunk[LOGGER_DEF_FLASH_RECOVER_CHUNK_SIZE];
+    
+    uint16 ChunkLen;
+    
+    uint16 Idx;
+    
+    if(gLoggerManager.pCbList->ReadFlashDataCb == NULL || pFlashMng->WriteAddr < pFlashMng->CurrSectorAddr)
+    {
+        return;
+    }
+    while(Address < SectorEndAddress && BlankLen < LOGGER_CONFIG_MAX_RX_MESSAGE_SIZE_BYTES)
+    {
+        ChunkLen = LOGGER_DEF_MIN(sizeof(Chunk), SectorEndAddress - Address);
+        if(gLoggerManager.pCbList->ReadFlashDataCb(Address, Chunk, ChunkLen) != LOGGER_STATUS_OK)
+        {
+            return;
+        }
+        for(Idx = 0; Idx < ChunkLen; Idx++)
+        {
+            if((uint8)Chunk[Idx] != 0xFF)
+            {
+                pFlashMng->WriteAddr = Address + Idx + 1;
+                BlankLen = 0;
+            }
+            else
+            {
+                BlankLen++;
+            }
+        }
+        Address += ChunkLen;
     }
+}
+
+/**
+ * <pre>
+ * static void Logger_FlashMngMigrate(LoggerFLASHManager_t *pFlashMng)
+ * </pre>
+ *  
+ * this function upgrades the NVR parameters that were saved by an older layout version. the log file is kept, but the old
+ * layout has no sector sequence (the NVR bytes read in its place are not valid), so the sequence starts over and the upload
+ * cursor and the upload job, which are both tied to the sequence, are dropped: the next upload sends the whole log file
+ *
+ * @param   pFlashMng           [inout]    a pointer to logger flash manager handle
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_FlashMngMigrate(INOUT LoggerFLASHManager_t *pFlashMng)
+{
+    pFlashMng->SectorSeq = 0;
+    pFlashMng->LayoutVer = LOGGER_DEF_NVR_LAYOUT_VERSION;
     
-    return FALSE;
+    gLoggerManager.UploadCursor.SectorSeq = gLoggerManager.UploadCursor.Addr = LOGGER_DEF_BLANK_NVR_PARAM_32;
+    *(uint8*)&gLoggerManager.UploadJob.Progress.Flags = 0;
+    if(gLoggerManager.pCbList->SaveNVRParamsCb != NULL)
+    {
+        gLoggerManager.pCbList->SaveNVRParamsCb(LOGGER_CONFIG_NVR_UPLOAD_CURSOR_ADDRESS, &gLoggerManager.UploadCursor, LOGGER_CONFIG_NVR_UPLOAD_CURSOR_SIZE_BYTES);
+        Logger_SaveUploadProgress();
+        gLoggerManager.pCbList->SaveNVRParamsCb(LOGGER_CONFIG_NVR_ADDRESS, pFlashMng, LOGGER_CONFIG_NVR_SIZE_BYTES);
+    }
 }
 
 /**
  * <pre>
- * static BOOL Logger_FlashMngInitFromDB(LoggerFLASHManager_t *pFlashMng, uint16 FlashSize)
+ * static LOGGER_STATUS Logger_FlashMngInitFromDB(LoggerFLASHManager_t *pFlashMng, uint16 FlashSize)
  * </pre>
  *  
  * this function initializes the logger flash manager structure and erase flash sectors.
  * @param   pFlashMng           [inout]    a pointer to logger flash manager handle to initialize input values
  * @param   FlashSizeKb         [in]       the flash size in KB
  *
- * @return TRUE if succeeded erasing flash sectors, or FALSE otherwised
+ * @return LOGGER_STATUS_OK if succeeded erasing flash sectors, LOGGER_STATUS_PENDING if the erase is in progress, or negative value otherwise
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
 
-static BOOL Logger_FlashMngInitFromDB(INOUT LoggerFLASHManager_t *pFlashMng, IN uint16 FlashSize)
+static LOGGER_STATUS Logger_FlashMngInitFromDB(INOUT LoggerFLASHManager_t *pFlashMng, IN uint16 FlashSize)
 {    
     /* we need to validate NVR parameters */
     if(Logger_ValidateNVRParameters(&gLoggerManager.FlashMng, FlashSize) == FALSE)
@@ -224,57 +673,56 @@ static BOOL Logger_FlashMngInitFromDB(INOUT LoggerFLASHManager_t *pFlashMng, IN
         return Logger_FlashMngInitDefault(pFlashMng, FlashSize);
     }
     
+    /* the NVR parameters were saved by an older logger version */
+    if(pFlashMng->LayoutVer != LOGGER_DEF_NVR_LAYOUT_VERSION)
+    {
+        Logger_FlashMngMigrate(pFlashMng);
+    }
+    
+    /* the log file may have been written after the NVR parameters were last saved */
+    Logger_FlashSkipProgrammed(pFlashMng);
+    
     /* we need to check if we have to delete only the next sector */
     if(gLoggerManager.FlashMng.Flags.IsNextSectorErased)
     {
         /* calculate the next sector to erase */
         uint32 NextSectorAddress = LOGGER_DEF_FLASH_NEXT_SECTOR_ADDRESS(FlashSize, gLoggerManager.FlashMng.CurrSectorAddr, LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB);
+        LOGGER_STATUS Status = Logger_EraseFlashSectors(NextSectorAddress, 1, e_LOGGER_ERASE_OWNER_INIT_NEXT_SECTOR);
             
-        if(Logger_EraseFlashSectors(NextSectorAddress, 1) == LOGGER_STATUS_OK)
-        {
-             /* if we have just erased the current read address, update it to the next sector */
-            if(gLoggerManager.FlashMng.ReadAddr == NextSectorAddress)
-            {
-                /* we have just erased the read section, set the read section to the next section */
-                gLoggerManager.FlashMng.ReadAddr = LOGGER_DEF_FLASH_NEXT_SECTOR_ADDRESS(FlashSize, gLoggerManager.FlashMng.ReadAddr, LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB);
-                
-                /* save the current sector address for next reset */
-                if(gLoggerManager.pCbList->SaveNVRParamsCb(LOGGER_CONFIG_NVR_ADDRESS, &gLoggerManager.FlashMng, LOGGER_CONFIG_NVR_SIZE_BYTES) != LOGGER_STATUS_OK)
-                {
-                    return FALSE;
-                }
-                
-            }
-        
-        }
-        else
+        if(Status != LOGGER_STATUS_OK)
         {
-            return FALSE;
+            /* erase is in progress or has failed */
+            return Status;
         }
+        return Logger_FlashMngNextSectorErased(FlashSize);
     }
-    return TRUE;
+    return LOGGER_STATUS_OK;
 }
 
 /**
  * <pre>
- * static void Logger_InitFlash(uint16 FlashSize, BOOL IsFlashReset)
+ * static LOGGER_STATUS Logger_InitFlash(uint16 FlashSize, BOOL IsFlashReset)
  * </pre>
  *  
  * this function initializes the logger flash and erases flash sector if needed
  * @param   FlashSize           [in]    The flash size in KB
  * @param   IsFlashReset        [in]    Is flash sector erases needed.
  *
- * @return none
+ * @return LOGGER_STATUS_OK if the flash is ready, LOGGER_STATUS_PENDING if it will be ready once the erase completes, or negative value otherwise
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-static BOOL Logger_InitFlash(IN uint16 FlashSize, IN BOOL IsFlashReset)
+static LOGGER_STATUS Logger_InitFlash(IN uint16 FlashSize, IN BOOL IsFlashReset)
 {    
+    LOGGER_STATUS Status;
+    
     /* read NVR paramaters */
     if(gLoggerManager.pCbList->ReadNVRParamsCb != NULL)
     {
         gLoggerManager.pCbList->ReadNVRParamsCb(LOGGER_CONFIG_NVR_ADDRESS, &gLoggerManager.FlashMng, LOGGER_CONFIG_NVR_SIZE_BYTES);
+        gLoggerManager.pCbList->ReadNVRParamsCb(LOGGER_CONFIG_NVR_UPLOAD_CURSOR_ADDRESS, &gLoggerManager.UploadCursor, LOGGER_CONFIG_NVR_UPLOAD_CURSOR_SIZE_BYTES);
+        gLoggerManager.pCbList->ReadNVRParamsCb(LOGGER_CONFIG_NVR_UPLOAD_JOB_ADDRESS, &gLoggerManager.UploadJob.Progress, LOGGER_CONFIG_NVR_UPLOAD_JOB_SIZE_BYTES);
         
         /* check FLASH reset conditions */
         if(IsFlashReset || gLoggerManager.FlashMng.CurrSectorAddr == LOGGER_DEF_BLANK_NVR_PARAM_32||
@@ -282,32 +730,113 @@ static BOOL Logger_InitFlash(IN uint16 FlashSize, IN BOOL IsFlashReset)
                            gLoggerManager.FlashMng.ReadAddr == LOGGER_DEF_BLANK_NVR_PARAM_32)
         {
             /* if one of the logger NVR parameters are not valid, or if the user has specifically requested FLASH log erase */
-            if(Logger_FlashMngInitDefault(&gLoggerManager.FlashMng, FlashSize) == FALSE)
-            {
-                OSAL_ASSERT(0);
-                return FALSE;
-            }
+            Status = Logger_FlashMngInitDefault(&gLoggerManager.FlashMng, FlashSize);
         }
         else
         {
             /* otherwise the logger has a valid log file, initilize the flash manager from NVR values and continue writing without erasing old log file */
-            if(Logger_FlashMngInitFromDB(&gLoggerManager.FlashMng, FlashSize) == FALSE)
-            {
-                OSAL_ASSERT(0);
-                return FALSE;
-            }
+            Status = Logger_FlashMngInitFromDB(&gLoggerManager.FlashMng, FlashSize);
+        }
+        if(Status < LOGGER_STATUS_OK)
+        {
+            OSAL_ASSERT(0);
+            return Status;
+        }
+        if(Status == LOGGER_STATUS_OK)
+        {
+            Logger_SummaryInit();
         }
     }
     else
     {
         OSAL_ASSERT(0);
-        return FALSE;
+        return LOGGER_STATUS_ERROR;
     }
-    /* init has passed successfully, logger is now ready to work with flash */
-    return TRUE;
+    /* init has passed successfully, logger is now ready to work with flash (or will be once the erase completes) */
+    return Status;
     //Logger_SetState(e_LOGGER_STATE_READY);
 }
 
+/**
+ * <pre>
+ * static void Logger_InitFlashDone(LOGGER_STATUS Status)
+ * </pre>
+ *  
+ * this function completes the init flow that was waiting for an asynchronous FLASH erase
+ * @param   Status              [in]    The erase status
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_InitFlashDone(IN LOGGER_STATUS Status)
+{
+    if(Status != LOGGER_STATUS_OK)
+    {
+        OSAL_ASSERT(0);
+        return;
+    }
+    Logger_SummaryInit();
+    
+    /* logger is now ready to work with flash */
+    if(gLoggerManager.State == e_LOGGER_STATE_INITIALIZING && gLoggerManager.Config.General.DestType == LOGGER_DEST_TYPE_FLASH)
+    {
+        Logger_SetState(e_LOGGER_STATE_READY);
+    }
+    /* the socket is opened only once the FLASH is ready, the state is set once the socket is opened */
+    else if(gLoggerManager.State == e_LOGGER_STATE_INITIALIZING && gLoggerManager.Config.General.DestType == LOGGER_DEST_TYPE_FLASH_AND_SOCKET)
+    {
+        Logger_OpenSocket(&LOGGER_DEF_SOCKET_CONFIG);
+    }
+}
+
+/**
+ * <pre>
+ * static void Logger_HandleEraseCompletion(LOGGER_STATUS Status)
+ * </pre>
+ *  
+ * this function drives the erase state machine on every asynchronous sector erase completion
+ * @param   Status              [in]    The sector erase status
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_HandleEraseCompletion(IN LOGGER_STATUS Status)
+{
+    LoggerEraseMng_t *pEraseMng = &gLoggerManager.EraseMng;
+    
+    pEraseMng->Flags.IsPending = 0;
+    
+    /* queue the next sector */
+    if(Status == LOGGER_STATUS_OK && --pEraseMng->SectorsLeft > 0)
+    {
+        pEraseMng->NextAddr += (LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB<<10);
+        
+        Status = Logger_EraseFlashNextSector();
+        if(Status == LOGGER_STATUS_PENDING)
+        {
+            return;
+        }
+    }
+    /* erase has ended */
+    pEraseMng->Flags.IsActive = 0;
+    
+    if(Status == LOGGER_STATUS_OK)
+    {
+        /* on success erase the bit which indicate a flash sector erase is needed */
+        gLoggerManager.FlashMng.Flags.IsNextSectorErased = 0;
+        
+        if(pEraseMng->Owner == e_LOGGER_ERASE_OWNER_INIT_NEXT_SECTOR)
+        {
+            Status = Logger_FlashMngNextSectorErased(gLoggerManager.Config.General.FlashSize);
+        }
+    }
+    Logger_InitFlashDone(Status);
+}
+
 /**
  * <pre>
  * static uint32 Logger_GetFlashReadStartAddress(uint32 StartAddr, uint32 EndAddr, uint32 WriteAddr, uint32 ReadAddr, uint32 ReadSizeBytes)
@@ -408,266 +937,1077 @@ static uint32 Logger_GetFlashReadStartAddress(IN uint32 StartAddr, IN uint32 End
     return NewReadAddr;
 }
 
-                /* ========================================== *
-                 *     P U B L I C     F U N C T I O N S      *
-                 * ========================================== */
-
 /**
  * <pre>
- * void Logger_Init(IN LoggerConfig_t *pLoggerConfig, IN uint8 Attr)
+ * static BOOL Logger_IsFlashCursorValid(LoggerUploadCursor_t *pCursor)
  * </pre>
  *  
- * this function initializes the logger feature DB and handles all init 
- * flows such as opening socket to RDS or erasing FLASH 
- *
- * @param   pLoggerConfig      [in]    a pointer to logger configuration
- * @param   Attr               [in]    The logger run time attributes
+ * this function checks whether a FLASH cursor points to the log file. the cursor is not valid if it was never set,
+ * or if its sector was erased since (the sector sequence number tells which generation of the sector the cursor points to).
+ * @param   pCursor        [in]    a pointer to the FLASH cursor
  *
- * @return None
+ * @return TRUE if the cursor is valid, or FALSE otherwise
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-
-void Logger_Init(IN LoggerConfig_t *pLoggerConfig, IN uint8 Attr)
+static BOOL Logger_IsFlashCursorValid(IN LoggerUploadCursor_t *pCursor)
 {
-    extern LoggerCB_t gLoggerCbList;
+    uint32 EndAddress = LOGGER_DEF_FLASH_END_ADDRESS(LOGGER_CONFIG_FLASH_START_ADDRESS, LOGGER_DEF_GEN_CONFIG.FlashSize);
+    uint8 TotalSectors = LOGGER_DEF_FLASH_NUM_OF_DEBUG_SECTORS(LOGGER_DEF_GEN_CONFIG.FlashSize);
+    uint8 CurrIdx = LOGGER_DEF_FLASH_SECTOR_INDEX(gLoggerManager.FlashMng.CurrSectorAddr);
+    uint8 NumOfSectors = (CurrIdx + TotalSectors - LOGGER_DEF_FLASH_SECTOR_INDEX(gLoggerManager.FlashMng.ReadAddr)) % TotalSectors + 1;
     
-    BOOL IsFlashInit = FALSE;    
-    /* sanity check */
-    if(gLoggerManager.State > e_LOGGER_STATE_INITIALIZING)
+    /* the number of sectors that were opened since the cursor sector */
+    uint32 Distance = gLoggerManager.FlashMng.SectorSeq - pCursor->SectorSeq;
+    
+    if(pCursor->Addr < LOGGER_CONFIG_FLASH_START_ADDRESS || pCursor->Addr >= EndAddress)
     {
-        /* logger was already initialized */
-        OSAL_ASSERT(FALSE);
-        return;
+        return FALSE;
     }
-    
-    /* initialize the logger TX flow HW timer and interrupt handler routine */
-    HW_TIMER_Init( 3, 1000, Logger_SendPacketFromInt);
-    
-    /* set logger state */
-    gLoggerManager.State = e_LOGGER_STATE_INITIALIZING;
-    
-    /* init flags */
-    *(uint8*)&gLoggerManager.Flags = 0;
-    
-    /* initialize RX buffer */
-    Logger_InitRxBuffer(&gLoggerManager.RxBuffer);
-    
-    /* init callback list */
-    gLoggerManager.pCbList = &gLoggerCbList;
-    
-    /* int the feature configuration */
-    Logger_SetConfig(pLoggerConfig);
-    
-    /* validate configuration is correct */
-    if(Logger_ValidateGenConfig(&gLoggerManager.Config.General))
+    /* the cursor sector was erased */
+    if(Distance >= NumOfSectors)
     {
-        OSAL_ASSERT(0);
+        return FALSE;
     }
-    
-    /* initialize the FLASH DB and erase log file if attributes erase flas is set */    
-    IsFlashInit = Logger_InitFlash(gLoggerManager.Config.General.FlashSize, Attr & LOGGER_ATTR_ERASE_FLASH_NOW);
-    
-    /* if logger is using socket we need to open it now */
-    if(gLoggerManager.Config.General.IsEnabled)
-    {        
-        
-        switch(gLoggerManager.Config.General.DestType)
-        {
-            /* handle socket opening */
-        case LOGGER_DEST_TYPE_SOCKET:
-            Logger_OpenSocket(&LOGGER_DEF_SOCKET_CONFIG);
-            break;
-            
-            /* handle initializing the flash DB */
-        case LOGGER_DEST_TYPE_FLASH:
-            if(IsFlashInit)
-            {
-                Logger_SetState(e_LOGGER_STATE_READY);
-            }
-            break;
-            /* can be used if only local port is opened */
-        case LOGGER_DEST_TYPE_NONE:
-            Logger_SetState(e_LOGGER_STATE_READY);
-            break;
-            
-            /* error should not get here */
-        default:
-            OSAL_ASSERT(0);
-            break;
-            
-        }//switch
-        
-        /* check if default handler was reached before panel was reboot and handle crash dump */    
-        if(IS_FAULT_HANDLER())
-        {
-            /* reset the fault handler magic number for next reset */
-            RESET_FAULT_HANDLER();
-            
-            /* print crash dump */
-            Logger_PrintFaultHandler();
-        }
-        
+    /* the cursor must point to the sector that was written Distance sectors ago, before the write pointer */
+    if(LOGGER_DEF_FLASH_SECTOR_INDEX(pCursor->Addr) != (CurrIdx + TotalSectors - Distance) % TotalSectors ||
+       (Distance == 0 && pCursor->Addr > gLoggerManager.FlashMng.WriteAddr))
+    {
+        return FALSE;
     }
-    /* Set TX HW timer to normal resolution mode */
-    Logger_SetTxResolution(LOGGER_RESOLUTION_TYPE_LOW);    
+    return TRUE;
 }
 
-
 /**
  * <pre>
- * void Logger_UnInit(void)
+ * static uint32 Logger_GetSectorSeq(uint32 Address)
  * </pre>
  *  
- * this function uninit the logger manager handle.
+ * this function returns the sequence number of a log file sector (the sectors are written one after the other up to the current sector)
+ * @param   Address        [in]    a FLASH address in the log file
  *
- * @return None
+ * @return the sector sequence number
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-void Logger_UnInit(void)
+static uint32 Logger_GetSectorSeq(IN uint32 Address)
 {
-    /* uninit head, tail, read and write pointers */
-    gLoggerManager.RxBuffer.pWrite = gLoggerManager.RxBuffer.pRead = gLoggerManager.RxBuffer.pHead = gLoggerManager.RxBuffer.pTail = NULL;
+    uint8 TotalSectors = LOGGER_DEF_FLASH_NUM_OF_DEBUG_SECTORS(LOGGER_DEF_GEN_CONFIG.FlashSize);
+    uint8 CurrIdx = LOGGER_DEF_FLASH_SECTOR_INDEX(gLoggerManager.FlashMng.CurrSectorAddr);
     
-    /* destroy mutex */
-    if(gLoggerManager.RxBuffer.pMutex != NULL)
-    {
-        OSAL_PortMutexDelete(gLoggerManager.RxBuffer.pMutex);
-    }    
+    return gLoggerManager.FlashMng.SectorSeq - (CurrIdx + TotalSectors - LOGGER_DEF_FLASH_SECTOR_INDEX(Address)) % TotalSectors;
 }
 
 /**
  * <pre>
- * void Logger_SetLogLevel(uint8 LogLevel)
+ * static void Logger_AdvanceFlashCursor(LoggerUploadCursor_t *pCursor, int SizeBytes)
  * </pre>
  *  
- * this function sets the RAM logger log level configuration.
+ * this function moves a FLASH cursor forward along the log file (wrapping around the FLASH segment)
+ * @param   pCursor        [inout]    a pointer to the FLASH cursor
+ * @param   SizeBytes      [in]       the size to move in bytes (less than the FLASH segment size)
  *
- * @param   LogLevel      [in]    the input log level to set.
- *
- * @return None
+ * @return none
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-void Logger_SetLogLevel(uint8 LogLevel)
+static void Logger_AdvanceFlashCursor(INOUT LoggerUploadCursor_t *pCursor, IN int SizeBytes)
 {
-    gLoggerManager.Config.General.LogLevel = LogLevel;
+    uint32 EndAddress = LOGGER_DEF_FLASH_END_ADDRESS(LOGGER_CONFIG_FLASH_START_ADDRESS, LOGGER_DEF_GEN_CONFIG.FlashSize);
+    uint8 TotalSectors = LOGGER_DEF_FLASH_NUM_OF_DEBUG_SECTORS(LOGGER_DEF_GEN_CONFIG.FlashSize);
+    uint32 Address = pCursor->Addr + SizeBytes;
+    
+    if(Address >= EndAddress)
+    {
+        Address -= ((uint32)LOGGER_DEF_GEN_CONFIG.FlashSize<<10);
+    }
+    /* every sector we have moved to was opened after the previous one */
+    pCursor->SectorSeq += (LOGGER_DEF_FLASH_SECTOR_INDEX(Address) + TotalSectors - LOGGER_DEF_FLASH_SECTOR_INDEX(pCursor->Addr)) % TotalSectors;
+    pCursor->Addr = Address;
 }
 
 /**
  * <pre>
- * void Logger_SetModuleMask(uint32 ModuleMask)
+ * static int Logger_GetFlashReadRange(uint16 SizeKB, uint32 *pStartAddr)
  * </pre>
  *  
- * this function sets the RAM logger module mask configuration.
- *
- * @param   ModuleMask      [in]    the input module mask to set.
+ * this function returns the FLASH range of the last SizeKB of the log file.
+ * LOGGER_DEF_GET_NEW_FLASH_SIZE_KB gets the log written since the last successful upload (the whole log file if the
+ * upload cursor is not valid).
+ * @param   SizeKB         [in]     The last log file size in KB
+ * @param   pStartAddr     [out]    The FLASH range start address
  *
- * @return None
+ * @return the FLASH range size in bytes
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-void Logger_SetModuleMask(uint32 ModuleMask)
+static int Logger_GetFlashReadRange(IN uint16 SizeKB, OUT uint32 *pStartAddr)
 {
-    gLoggerManager.Config.General.ModuleMask = ModuleMask;
+    /* Flash end address for calculations */
+    uint32 EndAddress = LOGGER_DEF_FLASH_END_ADDRESS(LOGGER_CONFIG_FLASH_START_ADDRESS, LOGGER_DEF_GEN_CONFIG.FlashSize);
+    
+    /* current FLASH usage of debug log */
+    uint16 FlashUsageKB = LOGGER_DEF_FLASH_USAGE_SIZE_KB(gLoggerManager.FlashMng.ReadAddr, gLoggerManager.FlashMng.WriteAddr, LOGGER_DEF_GEN_CONFIG.FlashSize);
+    
+    int ReadSizeBytes;
+    
+    if(SizeKB == LOGGER_DEF_GET_NEW_FLASH_SIZE_KB && Logger_IsFlashCursorValid(&gLoggerManager.UploadCursor))
+    {
+        uint32 SegmentSize = (uint32)LOGGER_DEF_GEN_CONFIG.FlashSize<<10;
+        
+        *pStartAddr = gLoggerManager.UploadCursor.Addr;
+        return (gLoggerManager.FlashMng.WriteAddr + SegmentSize - gLoggerManager.UploadCursor.Addr) % SegmentSize;
+    }
+    ReadSizeBytes = (SizeKB >= LOGGER_DEF_GET_NEW_FLASH_SIZE_KB || SizeKB >=FlashUsageKB)?
+        LOGGER_DEF_FLASH_USAGE_SIZE_BYTES(gLoggerManager.FlashMng.ReadAddr, gLoggerManager.FlashMng.WriteAddr, LOGGER_DEF_GEN_CONFIG.FlashSize):SizeKB<<10;
+    
+    OSAL_ASSERT(ReadSizeBytes<=LOGGER_DEF_GEN_CONFIG.FlashSize<<10);
+    
+    /* get the flash start address */
+    *pStartAddr = Logger_GetFlashReadStartAddress(LOGGER_CONFIG_FLASH_START_ADDRESS, EndAddress, gLoggerManager.FlashMng.WriteAddr, gLoggerManager.FlashMng.ReadAddr, ReadSizeBytes);
+    
+    return ReadSizeBytes;
 }
 
 /**
  * <pre>
- * void Logger_SwitchOnOff(BOOL IsOn, BOOL IsSaveDB)
+ * static int Logger_GetFlashSendSize(uint32 Address, int ReadSizeBytes, uint8 SectorMask)
  * </pre>
  *  
- * this function switches the logger feature ON and OFF in runtime.
- *
- * @param   IsOn          [in]    Set the feautre ON or OFF.
- * @param   IsSaveDB      [in]    Does the logger feature has new configuration to save in DB.
+ * this function returns the number of log file bytes that are sent from a FLASH range.
+ * the sectors summary records and the sectors that are not in the sector mask are not sent.
+ * @param   Address        [in]    The FLASH range start address
+ * @param   ReadSizeBytes  [in]    The FLASH range size in bytes
+ * @param   SectorMask     [in]    The sectors to send, bit per sector
  *
- * @return None
+ * @return the number of bytes to send
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-void Logger_SwitchOnOff(BOOL IsOn, BOOL IsSaveDB)
+static int Logger_GetFlashSendSize(IN uint32 Address, IN int ReadSizeBytes, IN uint8 SectorMask)
 {
-    /* set the logger manager RAM DB */
-    gLoggerManager.Config.General.IsEnabled = IsOn;
+    uint32 EndAddress = LOGGER_DEF_FLASH_END_ADDRESS(LOGGER_CONFIG_FLASH_START_ADDRESS, gLoggerManager.Config.General.FlashSize);
+    int SendSizeBytes = 0;
     
-    if(!IsOn)
-    {
-        /* in case we turn the logger OFF we need to stop HW timer */
-        HW_TIMER_Stop(3);
-    }
-    else
+    while(ReadSizeBytes > 0)
     {
-        /* turning ON the logger */
-        if(gLoggerManager.Config.General.DestType == LOGGER_DEST_TYPE_FLASH)
+        uint32 SectorAddr = LOGGER_DEF_FLASH_SECTOR_START_ADDRESS(Address);
+        uint32 SectorEndAddr = LOGGER_DEF_FLASH_SUMMARY_ADDRESS(SectorAddr);
+        int Size = LOGGER_DEF_MIN((int)(SectorAddr + (LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB<<10) - Address), ReadSizeBytes);
+        
+        if(Address < SectorEndAddr && (SectorMask & (1<<LOGGER_DEF_FLASH_SECTOR_INDEX(SectorAddr))))
         {
-            /* reset the read and write pointers in FLASH to start from scratch - old data is not valid */
-            gLoggerManager.FlashMng.ReadAddr = gLoggerManager.FlashMng.WriteAddr;
-            /* save in eeprom the new write address for next reset */
-            if(gLoggerManager.pCbList->SaveNVRParamsCb != NULL)
-            {
-                /* save the pointers to NVR to be save for next reboot */
-                gLoggerManager.pCbList->SaveNVRParamsCb(LOGGER_CONFIG_NVR_ADDRESS, &gLoggerManager.FlashMng, LOGGER_CONFIG_NVR_SIZE_BYTES);
-            }            
+            SendSizeBytes += LOGGER_DEF_MIN((int)(SectorEndAddr - Address), Size);
         }
-        /* print start message */
-        Logger_PrintStartMessage();
+        Address += Size;
+        ReadSizeBytes -= Size;
         
-        /* set TX HW timer to normal resolution */ 
-        Logger_SetTxResolution(LOGGER_RESOLUTION_TYPE_LOW);
-    }
-    if(IsSaveDB && gLoggerManager.pCbList->WriteConfigCb != NULL)
-    {
-        /* if there is new configuration save it now */
-        gLoggerManager.pCbList->WriteConfigCb(e_LOGGER_CONF_TYPE_GENERAL, &gLoggerManager.Config.General);
+        if(Address >= EndAddress)
+        {
+            Address = LOGGER_CONFIG_FLASH_START_ADDRESS;
+        }
     }
-        
+    return SendSizeBytes;
 }
 
 /**
  * <pre>
- * BOOL Logger_GetModeOnOff(void)
+ * static BOOL Logger_DumpSkipSector(LoggerDumpMng_t *pDumpMng)
  * </pre>
  *  
- * this function returns the ON\OFF feature mode 
- *
- * @param None
+ * this function skips the rest of the current sector if the dump iterator points to the sector summary record,
+ * or to a sector that is not in the dump sector mask
+ * @param   pDumpMng       [inout]    a pointer to the dump state machine handle
  *
- * @return None
+ * @return TRUE if the iterator was moved, or FALSE if the iterator points to log file data to send
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-BOOL Logger_GetModeOnOff(void)
+static BOOL Logger_DumpSkipSector(INOUT LoggerDumpMng_t *pDumpMng)
 {
-    return gLoggerManager.Config.General.IsEnabled;
+    uint32 SectorAddr = LOGGER_DEF_FLASH_SECTOR_START_ADDRESS(pDumpMng->Iter);
+    int SkipSize;
+    
+    if(pDumpMng->Iter < LOGGER_DEF_FLASH_SUMMARY_ADDRESS(SectorAddr) && (pDumpMng->SectorMask & (1<<LOGGER_DEF_FLASH_SECTOR_INDEX(SectorAddr))))
+    {
+        return FALSE;
+    }
+    SkipSize = LOGGER_DEF_MIN((int)(SectorAddr + (LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB<<10) - pDumpMng->Iter), pDumpMng->ReadSizeBytes);
+    
+    pDumpMng->Iter += SkipSize;
+    pDumpMng->ReadSizeBytes -= SkipSize;
+    
+    if(pDumpMng->Iter >= pDumpMng->EndAddress)
+    {
+        /* wrap arround - we have reached the end of the flash continue from the begining */
+        pDumpMng->Iter = LOGGER_CONFIG_FLASH_START_ADDRESS;
+    }
+    return TRUE;
 }
 
 /**
  * <pre>
- * void Logger_SetTaskState(uint8 State)
+ * static void Logger_DumpReadDone(LoggerDumpMng_t *pDumpMng)
  * </pre>
  *  
- * this function sets logger manager task state
- *
- * @param   State      [in]    Task state to set:
- *                             e_LOGGER_STATE_DOWN              - task state is down
- *                             e_LOGGER_STATE_INITIALIZING      - task is initializing
- *                             e_LOGGER_STATE_OPENING_SOCKET    - task is opening socket
- *                             e_LOGGER_STATE_SENDING_LOG_FILE  - task is sending log file
+ * this function marks the chunk that was read from FLASH as ready to send and advances the FLASH read iterator
+ * @param   pDumpMng       [inout]    a pointer to the dump state machine handle
  *
- * @return None
+ * @return none
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-void Logger_SetTaskState(uint8 State)
+static void Logger_DumpReadDone(INOUT LoggerDumpMng_t *pDumpMng)
+{
+    uint16 FlashReadSize = pDumpMng->ChunkLen[pDumpMng->ReadIdx];
+    
+    pDumpMng->ReadIdx = (pDumpMng->ReadIdx + 1) % LOGGER_CONFIG_DUMP_NUM_OF_CHUNKS;
+    pDumpMng->NumOfReadyChunks++;
+    
+    pDumpMng->Iter += FlashReadSize;        
+    pDumpMng->ReadSizeBytes -= FlashReadSize;
+    
+    if(pDumpMng->Iter >= pDumpMng->EndAddress)
+    {
+        /* make sure we dont read too much */
+        OSAL_ASSERT(pDumpMng->Iter <= pDumpMng->EndAddress);
+        
+        /* wrap arround - we have reached the end of the flash continue from the begining */
+        pDumpMng->Iter = LOGGER_CONFIG_FLASH_START_ADDRESS;
+    }
+}
+
+/**
+ * <pre>
+ * static LOGGER_STATUS Logger_DumpStep(void)
+ * </pre>
+ *  
+ * this function advances the dump pipeline as far as it can without waiting:
+ * chunk N is handed to the sink first and chunk N+1 is read from FLASH while the sink transmits chunk N.
+ * assumptions:
+ *     1. if dump command has arrived the UART is available 
+ *     2. the logger task priority is lower than uart task 
+ *     3. a chunk is owned by the sink only until the send callback returns OK (the sink copies it to its own TX queue)
+ *
+ * @return LOGGER_STATUS_OK when the dump is done, LOGGER_STATUS_PENDING when waiting on a FLASH read completion,
+ *         LOGGER_STATUS_BUSY when the sink is busy and all the chunk buffers are full, or negative value otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static LOGGER_STATUS Logger_DumpStep(void)
+{
+    LoggerDumpMng_t *pDumpMng = &gLoggerManager.DumpMng;
+    
+    while(pDumpMng->ReadSizeBytes > 0 || pDumpMng->NumOfReadyChunks > 0)
+    {
+        LOGGER_STATUS Status = LOGGER_STATUS_OK;
+        
+        /* 1. hand the oldest chunk that was read to the sink */
+        if(pDumpMng->NumOfReadyChunks > 0)
+        {
+            char *pChunk = pDumpMng->pBuff + pDumpMng->SendIdx*LOGGER_CONFIG_DUMP_CHUNK_SIZE_BYTES;
+            
+            if(pDumpMng->DestType == LOGGER_DEST_TYPE_RS232)
+            {
+                Status = gLoggerManager.pCbList->SendUartDataCb(pChunk, pDumpMng->ChunkLen[pDumpMng->SendIdx]);
+            }
+            else
+            {
+                Status = gLoggerManager.pCbList->SendSocketDataCb((uint8*)pChunk, pDumpMng->ChunkLen[pDumpMng->SendIdx], LOGGER_MODE_TYPE_PULL, LOGGER_SOCKET_PRIORITY_LOW);
+            }
+            
+            if(Status == LOGGER_STATUS_OK)
+            {
+                pDumpMng->SendIdx = (pDumpMng->SendIdx + 1) % LOGGER_CONFIG_DUMP_NUM_OF_CHUNKS;
+                pDumpMng->NumOfReadyChunks--;
+                pDumpMng->BusyTimeMS = 0;
+            }
+            else if(Status != LOGGER_STATUS_BUSY)
+            {
+                OSAL_ASSERT(0);
+                return Status;
+            }
+        }
+        
+        /* skip the sectors summary records and the sectors that do not match the dump filter */
+        while(!pDumpMng->Flags.IsPending && pDumpMng->ReadSizeBytes > 0 && Logger_DumpSkipSector(pDumpMng));
+        
+        /* 2. read ahead the next chunk while the sink is transmitting */
+        if(!pDumpMng->Flags.IsPending && pDumpMng->ReadSizeBytes > 0 && pDumpMng->NumOfReadyChunks < LOGGER_CONFIG_DUMP_NUM_OF_CHUNKS)
+        {
+            char *pChunk = pDumpMng->pBuff + pDumpMng->ReadIdx*LOGGER_CONFIG_DUMP_CHUNK_SIZE_BYTES;
+            
+            /* read the minimum of 3 - chunk size, Size left to read, and the size left to read till the sector summary record */ 
+            uint16 FlashReadSize = LOGGER_DEF_MIN3VARS(LOGGER_CONFIG_DUMP_CHUNK_SIZE_BYTES, pDumpMng->ReadSizeBytes, 
+                                                       LOGGER_DEF_FLASH_SUMMARY_ADDRESS(LOGGER_DEF_FLASH_SECTOR_START_ADDRESS(pDumpMng->Iter)) - pDumpMng->Iter);
+            
+            pDumpMng->ChunkLen[pDumpMng->ReadIdx] = FlashReadSize;
+            
+            if(pDumpMng->Flags.IsAsync)
+            {
+                /* the chunk is ready once the completion arrives */
+                if(gLoggerManager.pCbList->ReadFlashDataAsyncCb(pDumpMng->Iter, pChunk, FlashReadSize, Logger_FlashCompletionApi) != LOGGER_STATUS_OK)
+                {
+                    OSAL_ASSERT(0);
+                    return LOGGER_STATUS_FLASH_READ_ERROR;
+                }
+                pDumpMng->Flags.IsPending = 1;
+            }
+            else
+            {
+                if(gLoggerManager.pCbList->ReadFlashDataCb(pDumpMng->Iter, pChunk, FlashReadSize) != LOGGER_STATUS_OK)
+                {
+                    OSAL_ASSERT(0);
+                    return LOGGER_STATUS_FLASH_READ_ERROR;
+                }
+                Logger_DumpReadDone(pDumpMng);
+            }
+        }
+        /* 3. nothing to do until the FLASH read completes */
+        else if(pDumpMng->Flags.IsPending)
+        {
+            return LOGGER_STATUS_PENDING;
+        }
+        /* 4. sink is busy and there is nothing left to read ahead */
+        else if(Status == LOGGER_STATUS_BUSY)
+        {
+            return LOGGER_STATUS_BUSY;
+        }
+    }
+    return LOGGER_STATUS_OK;
+}
+
+/**
+ * <pre>
+ * static BOOL Logger_DumpEnd(LOGGER_STATUS Status)
+ * </pre>
+ *  
+ * this function ends the dump and releases its resources
+ * @param   Status       [in]    The dump status
+ *
+ * @return TRUE if the dump has ended successfully, or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static BOOL Logger_DumpEnd(IN LOGGER_STATUS Status)
+{
+    gLoggerManager.DumpMng.Flags.IsActive = 0;
+    
+    /* change task state */
+    Logger_SetState(e_LOGGER_STATE_READY);
+
+    /* free working buffer */    
+    OSAL_HeapFreeBuff((uint32**)&gLoggerManager.DumpMng.pBuff);
+    
+    return (Status == LOGGER_STATUS_OK);
+}
+
+/**
+ * <pre>
+ * static void Logger_DumpContinue(LOGGER_STATUS Status)
+ * </pre>
+ *  
+ * this function decides how an asynchronous dump continues after a dump step:
+ * wait for the FLASH read completion, retry a busy sink on a timer, or end the dump.
+ * @param   Status       [in]    The dump step status
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_DumpContinue(IN LOGGER_STATUS Status)
+{
+    if(Status == LOGGER_STATUS_PENDING)
+    {
+        /* the FLASH read completion will continue the dump */
+        return;
+    }
+    if(Status == LOGGER_STATUS_BUSY)
+    {
+        if(gLoggerManager.DumpMng.BusyTimeMS < LOGGER_CONFIG_DUMP_SINK_TIMEOUT_MS)
+        {
+            /* back off shortly and retry the sink */
+            OSAL_StartTimer(LOGGER_TIMER_DUMP_RETRY_ID, LOGGER_CONFIG_DUMP_BUSY_BACKOFF_MS, FALSE);
+            gLoggerManager.DumpMng.BusyTimeMS += LOGGER_CONFIG_DUMP_BUSY_BACKOFF_MS;
+            return;
+        }
+        Printf("Dump sink is busy for too long (%d ms)\n", gLoggerManager.DumpMng.BusyTimeMS);
+    }
+    Logger_DumpEnd(Status);
+}
+
+/**
+ * <pre>
+ * static BOOL Logger_DumpStart(uint32 StartAddr, int ReadSizeBytes, uint8 SectorMask, uint8 DestType)
+ * </pre>
+ *  
+ * this function starts dumping a FLASH range of the log file to the destination
+ * @param   StartAddr      [in]    The FLASH address to start reading from
+ * @param   ReadSizeBytes  [in]    The FLASH range size in bytes
+ * @param   SectorMask     [in]    The sectors to send, bit per sector. other sectors are skipped
+ * @param   DestType       [in]    The dump destination type (LOGGER_DEST_TYPE_RS232 or LOGGER_DEST_TYPE_SOCKET)
+ *
+ * @return TRUE if the dump has ended successfully or is in progress, or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static BOOL Logger_DumpStart(IN uint32 StartAddr, IN int ReadSizeBytes, IN uint8 SectorMask, IN uint8 DestType)
+{
+    /* the dump state machine */
+    LoggerDumpMng_t *pDumpMng = &gLoggerManager.DumpMng;
+    
+    LOGGER_STATUS Status;
+
+    /* sanity check */
+    if(ReadSizeBytes<0 || 
+       ((DestType == LOGGER_DEST_TYPE_RS232 && gLoggerManager.pCbList->SendUartDataCb == NULL) || (DestType == LOGGER_DEST_TYPE_SOCKET && gLoggerManager.pCbList->SendSocketDataCb == NULL)))
+    {
+        OSAL_ASSERT(0);
+        return FALSE;
+    }
+    
+    /* singular case FLASH is empty or no sector matches the filter */
+    if(Logger_GetFlashSendSize(StartAddr, ReadSizeBytes, SectorMask) == 0)
+    {
+        Printf("FLASH is empty\n");
+        return FALSE;
+    }
+    /* sanity. check that task is ready */
+    if(gLoggerManager.State != e_LOGGER_STATE_READY || Logger_IsFlashOpActive())
+    {
+        Printf("Task is not ready yet TaskState(%d)\n", gLoggerManager.State);
+        return FALSE;
+    }
+    
+    /* allocate the working buffer to send log file, split into LOGGER_CONFIG_DUMP_NUM_OF_CHUNKS chunks */
+    pDumpMng->pBuff = (char*)OSAL_HeapAllocBuffer(OSAL_GetSelfTaskId(), LOGGER_CONFIG_DUMP_CHUNK_SIZE_BYTES*LOGGER_CONFIG_DUMP_NUM_OF_CHUNKS);
+    
+    if(pDumpMng->pBuff == NULL)
+    {
+        OSAL_ASSERT(0);
+        return FALSE;
+    }
+    
+    /* change task state */
+    Logger_SetState(e_LOGGER_STATE_SENDING_LOG_FILE);
+    
+    /* set the dump state machine */
+    pDumpMng->Iter = StartAddr;
+    pDumpMng->EndAddress = LOGGER_DEF_FLASH_END_ADDRESS(LOGGER_CONFIG_FLASH_START_ADDRESS, gLoggerManager.Config.General.FlashSize);
+    pDumpMng->ReadSizeBytes = ReadSizeBytes;
+    pDumpMng->SectorMask = SectorMask;
+    pDumpMng->DestType = DestType;
+    pDumpMng->SendIdx = pDumpMng->ReadIdx = pDumpMng->NumOfReadyChunks = 0;
+    pDumpMng->BusyTimeMS = 0;
+    *(uint8*)&pDumpMng->Flags = 0;
+    pDumpMng->Flags.IsActive = 1;
+    
+    /* the dump is driven by FLASH read completions only when running in the logger task, 
+       when called from another task context (e.g. the FTP data callback) the dump must end before returning */
+    if(Logger_IsFlashAsync((void*)gLoggerManager.pCbList->ReadFlashDataAsyncCb))
+    {
+        pDumpMng->Flags.IsAsync = 1;
+        
+        Logger_DumpContinue(Logger_DumpStep());
+        
+        return TRUE;
+    }
+    
+    /* synchronous dump, back off only when the sink is busy and all chunk buffers are full */
+    while((Status = Logger_DumpStep()) == LOGGER_STATUS_BUSY)
+    {
+        if(pDumpMng->BusyTimeMS >= LOGGER_CONFIG_DUMP_SINK_TIMEOUT_MS)
+        {
+            Printf("Dump sink is busy for too long (%d ms)\n", pDumpMng->BusyTimeMS);
+            break;
+        }
+        OSAL_SuspendTask(LOGGER_CONFIG_DUMP_BUSY_BACKOFF_MS);
+        pDumpMng->BusyTimeMS += LOGGER_CONFIG_DUMP_BUSY_BACKOFF_MS;
+    }
+    
+    /* return status */
+    return Logger_DumpEnd(Status);
+}
+
+/**
+ * <pre>
+ * static void Logger_SendFtpStatusMsg(uint8 MsgStatus, uint8 Desc)
+ * </pre>
+ *  
+ * this function reports the log file upload status to the server
+ * @param   MsgStatus      [in]    The upload status (see LoggerMsgStatus_e)
+ * @param   Desc           [in]    The status description (see LoggerMsgErrorDesc_e), or the progress in percents
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_SendFtpStatusMsg(IN uint8 MsgStatus, IN uint8 Desc)
+{
+#define MSG_LOGGER_STATUS CodeArgs.LoggerStatusMsg
+    
+    U_CODE_ARGUMENT CodeArgs;
+    DEV_TYPE_t DevType;
+    
+    DevType.s = CONTROL_PANEL_TYPE;
+
+    MSG_LOGGER_STATUS.VerMajor = LOGGER_VERSION[0];
+    MSG_LOGGER_STATUS.VerMinor = LOGGER_VERSION[2];
+
+    MSG_LOGGER_STATUS.Command = e_LOGGER_CONF_TYPE_FTP;
+        
+    MSG_LOGGER_STATUS.Status = MsgStatus;
+    MSG_LOGGER_STATUS.Description = Desc;
+
+    OMM_SendMsg ( OSAL_GetSelfTaskId(), MSME_LOGGER_STATUS_EVENT_MSG, &CodeArgs, DevType, MSME_MSG_2_SPECIFIC_USER,
+                 CONTROL_PANEL_TYPE_ID, OMM_DONT_SEND_COMPLETION_AFTER_SERVER_ACK);
+#undef MSG_LOGGER_STATUS
+}
+
+/**
+ * <pre>
+ * static uint32 Logger_UploadJobParamsCrc(uint16 SizeKB, LoggerLogFilter_t *pFilter)
+ * </pre>
+ *  
+ * this function returns the CRC-32 of the upload job request parameters. the filter fields are added one by one, 
+ * so the filter structure padding is not part of the CRC
+ * @param   SizeKB         [in]    The last log file size in KB to upload
+ * @param   pFilter        [in]    Optional. a pointer to the log filter
+ *
+ * @return the parameters CRC
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static uint32 Logger_UploadJobParamsCrc(IN uint16 SizeKB, IN LoggerLogFilter_t *pFilter)
+{
+    uint32 Crc = Logger_Crc32(LOGGER_DEF_CRC32_INIT, &SizeKB, sizeof(SizeKB));
+    
+    if(pFilter != NULL)
+    {
+        Crc = Logger_Crc32(Crc, &pFilter->MaxLevel, sizeof(pFilter->MaxLevel));
+        Crc = Logger_Crc32(Crc, &pFilter->TaskMask, sizeof(pFilter->TaskMask));
+        Crc = Logger_Crc32(Crc, &pFilter->StartTime, sizeof(pFilter->StartTime));
+        Crc = Logger_Crc32(Crc, &pFilter->EndTime, sizeof(pFilter->EndTime));
+    }
+    return Crc;
+}
+
+/**
+ * <pre>
+ * static BOOL Logger_UploadJobInit(uint16 SizeKB, LoggerLogFilter_t *pFilter)
+ * </pre>
+ *  
+ * this function starts a new upload job: it sets the FLASH range to upload and the time stamp of the part file names
+ * @param   SizeKB         [in]    The last log file size in KB to upload
+ * @param   pFilter        [in]    Optional. a pointer to the log filter
+ *
+ * @return TRUE if the job was started, or FALSE if there is nothing to upload or the time is not available
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static BOOL Logger_UploadJobInit(IN uint16 SizeKB, IN LoggerLogFilter_t *pFilter)
+{
+    LoggerUploadProgress_t *pProgress = &gLoggerManager.UploadJob.Progress;
+    LoggerDateAndTime_t DateAndTime = {0};
+    LoggerUploadCursor_t EndCursor;
+    uint32 StartAddr;
+    int ReadSizeBytes;
+    uint8 SectorMask;
+    char *pItr = pProgress->FileTime;
+    
+    /* the previous job (if any) is dropped */
+    *(uint8*)&pProgress->Flags = 0;
+    
+    /* the log written from now on is left for the next incremental upload. 
+       it is taken before the range, so a record may be sent twice but never skipped */
+    EndCursor.SectorSeq = gLoggerManager.FlashMng.SectorSeq;
+    EndCursor.Addr = gLoggerManager.FlashMng.WriteAddr;
+    
+    ReadSizeBytes = Logger_GetFlashReadRange(SizeKB, &StartAddr);
+    
+    /* send only the sectors that may match the filter */
+    SectorMask = pFilter? Logger_SummaryGetSectorMask(pFilter): LOGGER_DEF_FLASH_ALL_SECTORS_MASK;
+    
+    /* a filter time range replaces the file size, only the records of the time range are sent */
+    pProgress->Flags.IsIncremental = (SizeKB == LOGGER_DEF_GET_NEW_FLASH_SIZE_KB);
+    if(pFilter != NULL && Logger_SummaryFindTimeRange(pFilter, &StartAddr, &ReadSizeBytes))
+    {
+        pProgress->Flags.IsIncremental = 0;
+    }
+    
+    /* singular case FLASH is empty or no sector matches the filter */
+    if(Logger_GetFlashSendSize(StartAddr, ReadSizeBytes, SectorMask) == 0)
+    {
+        Logger_HandleFtpPutReply(OSAL_STATUS_OK, e_LOGGER_MSG_ERROR_DES_NO_FILE_TO_SEND);
+        return FALSE;
+    }
+    if(gLoggerManager.pCbList->GetDateAndTimeCb == NULL)
+    {
+        return FALSE;
+    }
+    /* fill in the file name time stamp */
+    gLoggerManager.pCbList->GetDateAndTimeCb(&DateAndTime);
+    pItr+= num2decstr(DateAndTime.Day, (uint8*)pItr, 2);
+    pItr+= num2decstr(DateAndTime.Month, (uint8*)pItr, 2);
+    pItr+= num2decstr(DateAndTime.Year, (uint8*)pItr, 2);
+    pItr+= num2decstr(DateAndTime.Hour, (uint8*)pItr, 2);
+    num2decstr(DateAndTime.Minute, (uint8*)pItr, 2);
+    
+    pProgress->Next.SectorSeq = Logger_GetSectorSeq(StartAddr);
+    pProgress->Next.Addr = StartAddr;
+    pProgress->EndCursor = EndCursor;
+    pProgress->SizeBytes = pProgress->TotalSizeBytes = ReadSizeBytes;
+    pProgress->SectorMask = SectorMask;
+    pProgress->PartIdx = 0;
+    pProgress->ParamsCrc = Logger_UploadJobParamsCrc(SizeKB, pFilter);
+    pProgress->Flags.IsActive = 1;
+    
+    Logger_SaveUploadProgress();
+    
+    return TRUE;
+}
+
+/**
+ * <pre>
+ * static LOGGER_STATUS Logger_UploadNextPart(void)
+ * </pre>
+ *  
+ * this function uploads the next part file of the upload job. parts without a sector to send are skipped.
+ * once all the parts were stored by the server the job is done, and the upload cursor is advanced for an incremental job.
+ *
+ * @return LOGGER_STATUS_PENDING if a part upload has started, LOGGER_STATUS_OK if the job is done, or negative value otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static LOGGER_STATUS Logger_UploadNextPart(void)
+{
+    LoggerUploadJob_t *pJob = &gLoggerManager.UploadJob;
+    LoggerUploadProgress_t *pProgress = &pJob->Progress;
+    char FileName[LOGGER_CONFIG_FTP_FILE_NAME_LEN];
+    int SendSizeBytes = 0;
+    char *pItr;
+    
+    while(pProgress->SizeBytes > 0)
+    {
+        pJob->PartSizeBytes = LOGGER_DEF_MIN(LOGGER_CONFIG_UPLOAD_PART_SIZE_KB<<10, pProgress->SizeBytes);
+        
+        SendSizeBytes = Logger_GetFlashSendSize(pProgress->Next.Addr, pJob->PartSizeBytes, pProgress->SectorMask);
+        if(SendSizeBytes > 0)
+        {
+            break;
+        }
+        Logger_AdvanceFlashCursor(&pProgress->Next, pJob->PartSizeBytes);
+        pProgress->SizeBytes -= pJob->PartSizeBytes;
+    }
+    if(pProgress->SizeBytes <= 0)
+    {
+        /* the job is done, the server has the log file up to the end of an incremental job */
+        if(pProgress->Flags.IsIncremental)
+        {
+            gLoggerManager.UploadCursor = pProgress->EndCursor;
+            
+            if(gLoggerManager.pCbList->SaveNVRParamsCb != NULL)
+            {
+                gLoggerManager.pCbList->SaveNVRParamsCb(LOGGER_CONFIG_NVR_UPLOAD_CURSOR_ADDRESS, &gLoggerManager.UploadCursor, LOGGER_CONFIG_NVR_UPLOAD_CURSOR_SIZE_BYTES);
+            }
+        }
+        *(uint8*)&pProgress->Flags = 0;
+        Logger_SaveUploadProgress();
+        
+        return LOGGER_STATUS_OK;
+    }
+    if(gLoggerManager.pCbList->GetPanelIdCb == NULL || gLoggerManager.pCbList->SendFtpFileCb == NULL)
+    {
+        return LOGGER_STATUS_SEND_LOG_FILE_FAILED;
+    }
+    /* fill in the part file name */
+    gLoggerManager.pCbList->GetPanelIdCb(FileName);
+    pItr = &FileName[LOGGER_CONFIG_PANEL_ID_SIZE_BYTES - 1];
+    *pItr++ = '_';
+    OSAL_MemCopy(pItr, pProgress->FileTime, LOGGER_DEF_UPLOAD_FILE_TIME_LEN);
+    pItr += LOGGER_DEF_UPLOAD_FILE_TIME_LEN;
+    *pItr++ = '_';
+    pItr+= num2decstr(pProgress->PartIdx, (uint8*)pItr, 2);
+    pItr = OSAL_StrCopy(pItr, ".txt", 5);
+    
+    /* set the range for the FTP data callback to send (see Logger_SendUploadLog) */
+    gLoggerManager.UploadRange.StartAddr = pProgress->Next.Addr;
+    gLoggerManager.UploadRange.SizeBytes = pJob->PartSizeBytes;
+    gLoggerManager.UploadRange.SectorMask = pProgress->SectorMask;
+    gLoggerManager.UploadRange.Flags.IsSet = 1;
+    
+    if(gLoggerManager.pCbList->SendFtpFileCb(&pJob->Socket, &pJob->Ftp, pProgress->Next.Addr, SendSizeBytes, 
+                                             FileName, pItr - FileName) != LOGGER_STATUS_OK)
+    {
+        gLoggerManager.UploadRange.Flags.IsSet = 0;
+        return LOGGER_STATUS_SEND_LOG_FILE_FAILED;
+    }
+    return LOGGER_STATUS_PENDING;
+}
+
+/**
+ * <pre>
+ * static void Logger_UploadPartDone(void)
+ * </pre>
+ *  
+ * this function saves the upload job progress once the server has stored a part file
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_UploadPartDone(void)
+{
+    LoggerUploadJob_t *pJob = &gLoggerManager.UploadJob;
+    
+    Logger_AdvanceFlashCursor(&pJob->Progress.Next, pJob->PartSizeBytes);
+    pJob->Progress.SizeBytes -= pJob->PartSizeBytes;
+    pJob->Progress.PartIdx++;
+    
+    Logger_SaveUploadProgress();
+}
+
+                /* ========================================== *
+                 *     P U B L I C     F U N C T I O N S      *
+                 * ========================================== */
+
+/**
+ * <pre>
+ * void Logger_Init(IN LoggerConfig_t *pLoggerConfig, IN uint8 Attr)
+ * </pre>
+ *  
+ * this function initializes the logger feature DB and handles all init 
+ * flows such as opening socket to RDS or erasing FLASH 
+ *
+ * @param   pLoggerConfig      [in]    a pointer to logger configuration
+ * @param   Attr               [in]    The logger run time attributes
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+
+void Logger_Init(IN LoggerConfig_t *pLoggerConfig, IN uint8 Attr)
+{
+    extern LoggerCB_t gLoggerCbList;
+    
+    LOGGER_STATUS FlashInitStatus;    
+    /* sanity check */
+    if(gLoggerManager.State > e_LOGGER_STATE_INITIALIZING)
+    {
+        /* logger was already initialized */
+        OSAL_ASSERT(FALSE);
+        return;
+    }
+    
+    /* initialize the logger TX flow HW timer and interrupt handler routine */
+    HW_TIMER_Init( 3, 1000, Logger_SendPacketFromInt);
+    
+    /* the TX timer is started by the first log message */
+    gLoggerManager.DrainMng.Resolution = LOGGER_RESOLUTION_TYPE_IDLE;
+    
+    /* the occupancy time series, the high resolution time and the per task statistics are measured from the init */
+    OSAL_MemSet(&gLoggerManager.OccupancyMng, 0, sizeof(LoggerOccupancyMng_t));
+    OSAL_MemSet(gLoggerManager.TaskStats, 0, sizeof(gLoggerManager.TaskStats));
+    OSAL_MemSet(&gLoggerManager.CallSiteMng, 0, sizeof(LoggerCallSiteMng_t));
+    
+    /* set logger state */
+    gLoggerManager.State = e_LOGGER_STATE_INITIALIZING;
+    
+    /* init flags */
+    *(uint8*)&gLoggerManager.Flags = 0;
+    
+    /* initialize RX buffer, the log messages that were not sent before the reset are sent first */
+    Logger_InitRxBuffer(&gLoggerManager.RxBuffer, &gLoggerManager.PriorityBuffer, TRUE);
+    
+    /* init callback list */
+    gLoggerManager.pCbList = &gLoggerCbList;
+    
+    /* the TX timer is idle until the first log message */
+    Logger_ModeTimeUpdate(&gLoggerManager.OccupancyMng.Idle, TRUE);
+    
+    /* int the feature configuration */
+    Logger_SetConfig(pLoggerConfig);
+    
+    /* the printing tasks start filtering with the configuration */
+    Logger_PublishFilter();
+    
+    /* validate configuration is correct */
+    if(Logger_ValidateGenConfig(&gLoggerManager.Config.General))
+    {
+        OSAL_ASSERT(0);
+    }
+    
+    /* initialize the FLASH DB and erase log file if attributes erase flas is set */    
+    FlashInitStatus = Logger_InitFlash(gLoggerManager.Config.General.FlashSize, Attr & LOGGER_ATTR_ERASE_FLASH_NOW);
+    
+    /* if logger is using socket we need to open it now */
+    if(gLoggerManager.Config.General.IsEnabled)
+    {        
+        
+        switch(gLoggerManager.Config.General.DestType)
+        {
+            /* handle socket opening */
+        case LOGGER_DEST_TYPE_SOCKET:
+            Logger_OpenSocket(&LOGGER_DEF_SOCKET_CONFIG);
+            break;
+            
+            /* handle initializing the flash DB */
+        case LOGGER_DEST_TYPE_FLASH:
+            /* if FLASH erase is still in progress the state is set once it completes */
+            if(FlashInitStatus == LOGGER_STATUS_OK)
+            {
+                Logger_SetState(e_LOGGER_STATE_READY);
+            }
+            break;
+            /* handle initializing the flash DB before opening the socket */
+        case LOGGER_DEST_TYPE_FLASH_AND_SOCKET:
+            /* if FLASH erase is still in progress the socket is opened once it completes */
+            if(FlashInitStatus == LOGGER_STATUS_OK)
+            {
+                Logger_OpenSocket(&LOGGER_DEF_SOCKET_CONFIG);
+            }
+            break;
+            /* can be used if only local port is opened */
+        case LOGGER_DEST_TYPE_NONE:
+            Logger_SetState(e_LOGGER_STATE_READY);
+            break;
+            
+            /* error should not get here */
+        default:
+            OSAL_ASSERT(0);
+            break;
+            
+        }//switch
+        
+        /* check if default handler was reached before panel was reboot and handle crash dump */    
+        if(IS_FAULT_HANDLER())
+        {
+            /* reset the fault handler magic number for next reset */
+            RESET_FAULT_HANDLER();
+            
+            /* print crash dump */
+            Logger_PrintFaultHandler();
+        }
+        
+        /* prepare the FLASH crash area for the next crash */
+        Logger_CrashInit();
+    }
+    /* start the TX HW timer if there are log messages to send */
+    Logger_ScheduleDrain();    
+    
+    /* the first telemetry record has the counters since the init */
+    Logger_SetTelemetryInterval(LOGGER_CONFIG_TELEMETRY_INTERVAL_SEC);
+}
+
+
+/**
+ * <pre>
+ * void Logger_UnInit(void)
+ * </pre>
+ *  
+ * this function uninit the logger manager handle.
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_UnInit(void)
+{
+    OSAL_StopTimer(LOGGER_TIMER_TELEMETRY_ID);
+    
+    /* uninit head, tail, read and write pointers */
+    gLoggerManager.RxBuffer.pWrite = gLoggerManager.RxBuffer.pRead = gLoggerManager.RxBuffer.pHead = gLoggerManager.RxBuffer.pTail = NULL;
+    gLoggerManager.PriorityBuffer.pWrite = gLoggerManager.PriorityBuffer.pRead = gLoggerManager.PriorityBuffer.pHead = gLoggerManager.PriorityBuffer.pTail = NULL;
+    
+    /* destroy mutex */
+    if(gLoggerManager.RxBuffer.pMutex != NULL)
+    {
+        OSAL_PortMutexDelete(gLoggerManager.RxBuffer.pMutex);
+        gLoggerManager.RxBuffer.pMutex = gLoggerManager.PriorityBuffer.pMutex = NULL;
+    }    
+}
+
+/**
+ * <pre>
+ * void Logger_PublishFilter(void)
+ * </pre>
+ *  
+ * this function publishes the general configuration fields the printing tasks and the sinks use, as a new filter snapshot.
+ * the snapshot that is not published is rewritten, and then published with a single pointer write, so a printing task 
+ * never sees a partly updated filter. it must be called by the logger task only.
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_PublishFilter(void)
+{
+    LoggerFilterMng_t *pFilterMng = &gLoggerManager.FilterMng;
+    volatile LoggerFilterSnapshot_t *pNext = (pFilterMng->pActive == &pFilterMng->Snapshot[0])? &pFilterMng->Snapshot[1]: &pFilterMng->Snapshot[0];
+    
+    pNext->ModuleMask = LOGGER_DEF_GEN_CONFIG.ModuleMask;
+    pNext->IsEnabled = LOGGER_DEF_GEN_CONFIG.IsEnabled;
+    pNext->IsPrintoutEnabled = LOGGER_DEF_GEN_CONFIG.IsPrintoutEnabled;
+    pNext->LogLevel = LOGGER_DEF_GEN_CONFIG.LogLevel;
+    pNext->DestType = LOGGER_DEF_GEN_CONFIG.DestType;
+    pNext->Attributes = LOGGER_DEF_GEN_CONFIG.Attributes;
+    
+    pFilterMng->pActive = (const LoggerFilterSnapshot_t *)pNext;
+    pFilterMng->PublishCnt++;
+}
+
+/**
+ * <pre>
+ * void Logger_SetLogLevel(uint8 LogLevel)
+ * </pre>
+ *  
+ * this function sets the RAM logger log level configuration.
+ *
+ * @param   LogLevel      [in]    the input log level to set.
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SetLogLevel(uint8 LogLevel)
+{
+    gLoggerManager.Config.General.LogLevel = LogLevel;
+    Logger_PublishFilter();
+}
+
+/**
+ * <pre>
+ * void Logger_SetModuleMask(uint32 ModuleMask)
+ * </pre>
+ *  
+ * this function sets the RAM logger module mask configuration.
+ *
+ * @param   ModuleMask      [in]    the input module mask to set.
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SetModuleMask(uint32 ModuleMask)
+{
+    gLoggerManager.Config.General.ModuleMask = ModuleMask;
+    Logger_PublishFilter();
+}
+
+/**
+ * <pre>
+ * void Logger_SwitchOnOff(BOOL IsOn, BOOL IsSaveDB)
+ * </pre>
+ *  
+ * this function switches the logger feature ON and OFF in runtime.
+ *
+ * @param   IsOn          [in]    Set the feautre ON or OFF.
+ * @param   IsSaveDB      [in]    Does the logger feature has new configuration to save in DB.
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SwitchOnOff(BOOL IsOn, BOOL IsSaveDB)
+{
+    /* set the logger manager RAM DB */
+    gLoggerManager.Config.General.IsEnabled = IsOn;
+    Logger_PublishFilter();
+    
+    if(!IsOn)
+    {
+        /* in case we turn the logger OFF we need to stop HW timer */
+        Logger_SetTxResolution(LOGGER_RESOLUTION_TYPE_IDLE);
+    }
+    else
+    {
+        /* turning ON the logger */
+        if(LOGGER_DEF_IS_DEST_FLASH(gLoggerManager.Config.General.DestType))
+        {
+            /* reset the read and write pointers in FLASH to start from scratch - old data is not valid */
+            gLoggerManager.FlashMng.ReadAddr = gLoggerManager.FlashMng.WriteAddr;
+            /* save in eeprom the new write address for next reset */
+            if(gLoggerManager.pCbList->SaveNVRParamsCb != NULL)
+            {
+                /* save the pointers to NVR to be save for next reboot */
+                gLoggerManager.pCbList->SaveNVRParamsCb(LOGGER_CONFIG_NVR_ADDRESS, &gLoggerManager.FlashMng, LOGGER_CONFIG_NVR_SIZE_BYTES);
+            }            
+        }
+        /* print start message */
+        Logger_PrintStartMessage();
+        
+        /* start the TX HW timer to send the start message */ 
+        Logger_ScheduleDrain();
+    }
+    if(IsSaveDB && gLoggerManager.pCbList->WriteConfigCb != NULL)
+    {
+        /* if there is new configuration save it now */
+        gLoggerManager.pCbList->WriteConfigCb(e_LOGGER_CONF_TYPE_GENERAL, &gLoggerManager.Config.General);
+    }
+        
+}
+
+/**
+ * <pre>
+ * BOOL Logger_GetModeOnOff(void)
+ * </pre>
+ *  
+ * this function returns the ON\OFF feature mode 
+ *
+ * @param None
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+BOOL Logger_GetModeOnOff(void)
+{
+    return gLoggerManager.Config.General.IsEnabled;
+}
+
+/**
+ * <pre>
+ * void Logger_SetTaskState(uint8 State)
+ * </pre>
+ *  
+ * this function sets logger manager task state
+ *
+ * @param   State      [in]    Task state to set:
+ *                             e_LOGGER_STATE_DOWN              - task state is down
+ *                             e_LOGGER_STATE_INITIALIZING      - task is initializing
+ *                             e_LOGGER_STATE_OPENING_SOCKET    - task is opening socket
+ *                             e_LOGGER_STATE_SENDING_LOG_FILE  - task is sending log file
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SetTaskState(uint8 State)
 {
     gLoggerManager.State = State;
 }
@@ -691,18 +2031,107 @@ void Logger_SetMode(uint8 Mode)
     gLoggerManager.Config.General.Mode = Mode;
 }
 
+/**
+ * <pre>
+ * static BOOL Logger_WaitRxBuffersSent(uint16 TimeoutMS)
+ * </pre>
+ *  
+ * this function speeds up the drain task and waits for the sinks of the published filter snapshot to send the RX buffers,
+ * so a destination change does not throw away the buffered log messages.
+ *
+ * @param   TimeoutMS      [in]    the maximum time to wait in ms.
+ *
+ * @return TRUE if the RX buffers were sent, or FALSE on timeout
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static BOOL Logger_WaitRxBuffersSent(uint16 TimeoutMS)
+{
+    uint16 WaitMS = 0;
+    
+    Logger_FlushRxBuffer();
+    while((gLoggerManager.RxBuffer.pRead != gLoggerManager.RxBuffer.pWrite || 
+           gLoggerManager.PriorityBuffer.pRead != gLoggerManager.PriorityBuffer.pWrite) && WaitMS < TimeoutMS)
+    {
+        OSAL_SuspendTask(LOGGER_CONFIG_OVERRUN_BLOCK_POLL_MS);
+        WaitMS += LOGGER_CONFIG_OVERRUN_BLOCK_POLL_MS;
+    }
+    return (WaitMS < TimeoutMS);
+}
+
+/**
+ * <pre>
+ * static void Logger_SwitchSinks(BOOL WasOn, BOOL IsOn, BOOL IsFlashReset)
+ * </pre>
+ *  
+ * this function moves the logger to the sinks of the RAM general configuration (a destination type or FLASH size change): 
+ * the old sinks send the buffered log messages, the new sinks take over the RX buffers, the FLASH is initialized and the 
+ * socket is opened. the RX buffers are not reset, so the log messages the old sinks did not send in time are sent by the 
+ * new sinks, and the loss counters are kept. the new configuration is published when the logger is switched back on.
+ * NOTE: the caller sets the RAM general configuration without publishing it, and checks that no FLASH operation is active
+ *
+ * @param   WasOn           [in]    Was the logger on before the configuration change
+ * @param   IsOn            [in]    Is the logger on by the new configuration
+ * @param   IsFlashReset    [in]    Erase the log file (LOGGER_ATTR_ERASE_FLASH_NOW)
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_SwitchSinks(IN BOOL WasOn, IN BOOL IsOn, IN BOOL IsFlashReset)
+{
+    LOGGER_STATUS FlashInitStatus;
+    
+    uint8 PrevSinksMask = Logger_GetSinksMask();
+    
+    /* the old sinks send the buffered log messages before they are switched */
+    if(WasOn && !Logger_WaitRxBuffersSent(LOGGER_CONFIG_RECONFIG_DRAIN_TIMEOUT_MS))
+    {
+        gLoggerManager.FilterMng.DrainTimeoutCnt++;
+    }
+    gLoggerManager.FilterMng.SinkReconfigCnt++;
+    
+    /* the new sinks are published with the switch off, the drain task sends to them once their read pointers are set */
+    OSAL_PortMutexCapture(gLoggerManager.RxBuffer.pMutex);
+    Logger_SwitchOnOff(FALSE, FALSE);
+    Logger_SwitchRxBuffersSinks(PrevSinksMask);
+    OSAL_PortMutexRelease(gLoggerManager.RxBuffer.pMutex);
+    
+    Logger_SetState(e_LOGGER_STATE_INITIALIZING);
+    
+    FlashInitStatus = Logger_InitFlash(LOGGER_DEF_GEN_CONFIG.FlashSize, IsFlashReset);
+    
+    /* FLASH and socket destination opens the socket once the FLASH erase completes */
+    if(gLoggerManager.Config.General.DestType == LOGGER_DEST_TYPE_SOCKET ||
+       (gLoggerManager.Config.General.DestType == LOGGER_DEST_TYPE_FLASH_AND_SOCKET && FlashInitStatus != LOGGER_STATUS_PENDING))
+    {
+        Logger_OpenSocket(&LOGGER_DEF_SOCKET_CONFIG);                    
+    }
+    /* FLASH destination must wait for the erase to complete before writing */
+    if(FlashInitStatus != LOGGER_STATUS_PENDING || !LOGGER_DEF_IS_DEST_FLASH(gLoggerManager.Config.General.DestType))
+    {
+        Logger_SetState(e_LOGGER_STATE_READY);
+    }
+    
+    Logger_SwitchOnOff(IsOn, FALSE);
+}
+
 /**
  * <pre>
  * void Logger_SetDestinationType(uint8 DestType)
  * </pre>
  *  
- * this function sets logger manager TX destination type configuration in RAM DB. 
+ * this function sets logger manager TX destination type configuration in RAM DB, and moves the logger to the new sinks
+ * (see Logger_SwitchSinks). the destination is kept while a FLASH erase or dump is in progress.
  *
  * @param   DestType      [in]   destination type to set:
  *                               LOGGER_DEST_TYPE_NONE   -  no destination type
  *                               LOGGER_DEST_TYPE_FLASH  -  destination type flash
  *                               LOGGER_DEST_TYPE_SOCKET -  destination type socket
  *                               LOGGER_DEST_TYPE_RS232  -  destination type RS232
+ *                               LOGGER_DEST_TYPE_FLASH_AND_SOCKET - destination type flash and socket
  *
  * @return None
  *
@@ -711,7 +2140,13 @@ void Logger_SetMode(uint8 Mode)
 */
 void Logger_SetDestinationType(uint8 DestType)
 {
+    if(DestType == gLoggerManager.Config.General.DestType || Logger_IsFlashOpActive())
+    {
+        return;
+    }
     gLoggerManager.Config.General.DestType = DestType;
+    
+    Logger_SwitchSinks(gLoggerManager.Config.General.IsEnabled, gLoggerManager.Config.General.IsEnabled, FALSE);
 }
 
 /**
@@ -731,6 +2166,7 @@ void Logger_SetDestinationType(uint8 DestType)
 void Logger_SetPrintoutEnDis(BOOL IsEnabled)
 {
     gLoggerManager.Config.General.IsPrintoutEnabled = IsEnabled;
+    Logger_PublishFilter();
 }
 
 void Logger_SetSocketConfig(LoggerSocketConfig_t *pSocketConfig)
@@ -742,38 +2178,296 @@ void Logger_SetSocketConfig(LoggerSocketConfig_t *pSocketConfig)
         Logger_SetDefaultSocketConfig();
     }
     
-    /* TODO: fill in the user configuration */
+    /* TODO: fill in the user configuration */
+}
+
+/**
+ * <pre>
+ * void Logger_SetTxResolution(uint8 Resolution)
+ * </pre>
+ *  
+ * this function sets the logger TX HW timer resolution. the timer is restarted only when the resolution changes, 
+ * so a burst of log messages does not keep postponing the next TX interrupt.
+ *
+ * @param   Resolution     [in]    LOGGER_RESOLUTION_TYPE_LOW - the configured latency deadline (general config ResolutionMS)
+ *                                 LOGGER_RESOLUTION_TYPE_HIGH - LOGGER_CONFIG_HIGH_RESOLUTION_MS
+ *                                 LOGGER_RESOLUTION_TYPE_IDLE - the timer is stopped
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SetTxResolution(uint8 Resolution)
+{
+    if(gLoggerManager.DrainMng.Resolution == Resolution)
+    {
+        return;
+    }
+    gLoggerManager.DrainMng.Resolution = Resolution;
+    
+    Logger_ModeTimeUpdate(&gLoggerManager.OccupancyMng.HighResolution, LOGGER_RESOLUTION_TYPE_HIGH == Resolution);
+    Logger_ModeTimeUpdate(&gLoggerManager.OccupancyMng.Idle, LOGGER_RESOLUTION_TYPE_IDLE == Resolution);
+    
+    if(LOGGER_RESOLUTION_TYPE_LOW == Resolution)
+    {
+        HW_TIMER_Start (3, LOGGER_DEF_GEN_CONFIG.ResolutionMS, TRUE);    
+        
+    }
+    else if(LOGGER_RESOLUTION_TYPE_HIGH == Resolution)
+    {
+        HW_TIMER_Start (3, LOGGER_CONFIG_HIGH_RESOLUTION_MS, TRUE);
+    }
+    else if(LOGGER_RESOLUTION_TYPE_IDLE == Resolution)
+    {
+        HW_TIMER_Stop(3);
+    }
+    else
+    {
+        OSAL_ASSERT(0);
+    }
+}
+
+/**
+ * <pre>
+ * void Logger_ModeTimeUpdate(LoggerModeTime_t *pMode, BOOL IsActive)
+ * </pre>
+ *  
+ * this function counts the time spent in a logger mode (low memory, high TX resolution, idle). it is called on every mode 
+ * state update, and measures the time only when the mode is entered or exited
+ *
+ * @param   pMode          [inout] The mode time
+ * @param   IsActive       [in]    Is the logger in the mode now
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_ModeTimeUpdate(INOUT LoggerModeTime_t *pMode, IN BOOL IsActive)
+{
+    uint32 NowUs;
+    
+    uint32 SpentUs;
+    
+    if(pMode->IsActive == IsActive || gLoggerManager.pCbList == NULL || gLoggerManager.pCbList->GetTimeUsCb == NULL)
+    {
+        return;
+    }
+    NowUs = gLoggerManager.pCbList->GetTimeUsCb();
+    
+    if(IsActive)
+    {
+        pMode->EnterUs = NowUs;
+    }
+    else
+    {
+        SpentUs = NowUs - pMode->EnterUs + pMode->RemainderUs;
+        pMode->TotalMS += SpentUs / 1000;
+        pMode->RemainderUs = SpentUs % 1000;
+    }
+    pMode->IsActive = IsActive;
+}
+
+/**
+ * <pre>
+ * static uint32 Logger_ModeTimeGetMS(LoggerModeTime_t *pMode, uint32 NowUs)
+ * </pre>
+ *  
+ * this function returns the total time spent in a logger mode, including the time since the mode was entered
+ *
+ * @param   pMode          [in]    The mode time
+ * @param   NowUs          [in]    The current time in us
+ *
+ * @return the total time in the mode in ms
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static uint32 Logger_ModeTimeGetMS(IN LoggerModeTime_t *pMode, IN uint32 NowUs)
+{
+    return pMode->TotalMS + (pMode->IsActive? (NowUs - pMode->EnterUs + pMode->RemainderUs) / 1000: 0);
+}
+
+/**
+ * <pre>
+ * static void Logger_OccupancyPush(uint16 MinUsed, uint16 AvgUsed, uint16 MaxUsed)
+ * </pre>
+ *  
+ * this function adds a second to the RX buffer occupancy time series, the oldest second is overwritten once the series is full
+ *
+ * @param   MinUsed        [in]    The second lowest occupancy in bytes
+ * @param   AvgUsed        [in]    The second average occupancy in bytes
+ * @param   MaxUsed        [in]    The second highest occupancy in bytes
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_OccupancyPush(IN uint16 MinUsed, IN uint16 AvgUsed, IN uint16 MaxUsed)
+{
+    LoggerOccupancyMng_t *pOccupancy = &gLoggerManager.OccupancyMng;
+    
+    LoggerOccupancySample_t *pSample = &pOccupancy->Series[(pOccupancy->Head + pOccupancy->NumOfSeconds) % LOGGER_CONFIG_OCCUPANCY_SERIES_SIZE];
+    
+    pSample->MinUsed = MinUsed;
+    pSample->AvgUsed = AvgUsed;
+    pSample->MaxUsed = MaxUsed;
+    
+    if(pOccupancy->NumOfSeconds < LOGGER_CONFIG_OCCUPANCY_SERIES_SIZE)
+    {
+        pOccupancy->NumOfSeconds++;
+    }
+    else
+    {
+        pOccupancy->Head = (pOccupancy->Head + 1) % LOGGER_CONFIG_OCCUPANCY_SERIES_SIZE;
+    }
+}
+
+/**
+ * <pre>
+ * void Logger_OccupancySample(uint16 Used)
+ * </pre>
+ *  
+ * this function samples the RX double buffer occupancy into the current second of the occupancy time series.
+ * NOTE: this function is called by the drain task on every wake up, under the RX buffer mutex. the drain task is not 
+ *       woken up while the RX buffers are empty, so the seconds with no sample are added as empty seconds. an idle 
+ *       period longer than the series empties the whole series
+ *
+ * @param   Used           [in]    The RX double buffer occupancy in bytes
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_OccupancySample(IN uint16 Used)
+{
+    LoggerOccupancyMng_t *pOccupancy = &gLoggerManager.OccupancyMng;
+    
+    uint32 NowUs;
+    
+    uint32 Seconds;
+    
+    if(Used > gLoggerManager.TelemetryMng.PeakUsed)
+    {
+        gLoggerManager.TelemetryMng.PeakUsed = Used;
+    }
+    if(gLoggerManager.pCbList->GetTimeUsCb == NULL)
+    {
+        return;
+    }
+    NowUs = gLoggerManager.pCbList->GetTimeUsCb();
+    
+    if(pOccupancy->CurCnt == 0 && pOccupancy->NumOfSeconds == 0)
+    {
+        pOccupancy->SecondStartUs = NowUs;
+    }
+    Seconds = (NowUs - pOccupancy->SecondStartUs) / 1000000;
+    
+    if(Seconds > 0)
+    {
+        /* close the current second, and add the seconds the drain task was not woken up in */
+        Logger_OccupancyPush(pOccupancy->CurMin, pOccupancy->CurSum / (pOccupancy->CurCnt + (pOccupancy->CurCnt == 0)), pOccupancy->CurMax);
+        
+        pOccupancy->SecondStartUs += Seconds * 1000000;
+        
+        for(Seconds = LOGGER_DEF_MIN(Seconds - 1, LOGGER_CONFIG_OCCUPANCY_SERIES_SIZE); Seconds > 0; Seconds--)
+        {
+            Logger_OccupancyPush(0, 0, 0);
+        }
+        pOccupancy->CurCnt = 0;
+    }
+    if(pOccupancy->CurCnt == 0)
+    {
+        pOccupancy->CurMin = pOccupancy->CurMax = Used;
+        pOccupancy->CurSum = 0;
+    }
+    if(Used < pOccupancy->CurMin)
+    {
+        pOccupancy->CurMin = Used;
+    }
+    if(Used > pOccupancy->CurMax)
+    {
+        pOccupancy->CurMax = Used;
+    }
+    pOccupancy->CurSum += Used;
+    pOccupancy->CurCnt++;
+}
+
+/**
+ * <pre>
+ * static void Logger_GetBuffOccupancy(RXBuffer_t *pRxBuffer, LoggerBuffOccupancy_t *pBuffOccupancy, uint32 NowUs)
+ * </pre>
+ *  
+ * this function returns an RX buffer occupancy statistics, and starts its next peak since the last read
+ *
+ * @param   pRxBuffer      [inout] The RX buffer
+ * @param   pBuffOccupancy [out]   The RX buffer occupancy statistics
+ * @param   NowUs          [in]    The current time in us
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_GetBuffOccupancy(INOUT RXBuffer_t *pRxBuffer, OUT LoggerBuffOccupancy_t *pBuffOccupancy, IN uint32 NowUs)
+{
+    pBuffOccupancy->SizeBytes = pRxBuffer->pTail - pRxBuffer->pHead;
+    pBuffOccupancy->PeakUsed = pRxBuffer->PeakUsed;
+    pBuffOccupancy->ReadPeakUsed = pRxBuffer->ReadPeakUsed;
+    pBuffOccupancy->LowMemoryMS = Logger_ModeTimeGetMS(&pRxBuffer->LowMemoryTime, NowUs);
+    
+    pRxBuffer->ReadPeakUsed = 0;
 }
 
 /**
  * <pre>
- * void Logger_SetTxResolution(uint8 Resolution)
+ * void Logger_GetOccupancy(LoggerOccupancy_t *pOccupancy)
  * </pre>
  *  
- * this function sets logger manager printout enabled configuration in RAM DB
+ * this function returns the RX buffers occupancy statistics: the peak occupancy since the init and since the last read,
+ * the time spent with low memory, at the high TX resolution and idle, and the RX double buffer occupancy of the last seconds.
+ * the peaks since the last read are restarted
  *
- * @param   IsEnabled      [in]    is prinout enabled.
+ * @param   pOccupancy     [out]   The RX buffers occupancy statistics (all zeros if the logger is not initialized)
  *
  * @return None
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-void Logger_SetTxResolution(uint8 Resolution)
+void Logger_GetOccupancy(OUT LoggerOccupancy_t *pOccupancy)
 {
-    if(LOGGER_RESOLUTION_TYPE_LOW == Resolution)
-    {
-        HW_TIMER_Start (3, LOGGER_CONFIG_LOW_RESOLUTION_MS, TRUE);    
-        
-    }
-    else if(LOGGER_RESOLUTION_TYPE_HIGH)
+    LoggerOccupancyMng_t *pOccupancyMng = &gLoggerManager.OccupancyMng;
+    
+    uint32 NowUs;
+    
+    uint8 Idx;
+    
+    OSAL_MemSet(pOccupancy, 0, sizeof(LoggerOccupancy_t));
+    
+    if(gLoggerManager.RxBuffer.pMutex == NULL || gLoggerManager.pCbList == NULL)
     {
-        HW_TIMER_Start (3, LOGGER_CONFIG_HIGH_RESOLUTION_MS, TRUE);
+        return;
     }
-    else
+    OSAL_PortMutexCapture(gLoggerManager.RxBuffer.pMutex);
+    
+    NowUs = (gLoggerManager.pCbList->GetTimeUsCb != NULL)? gLoggerManager.pCbList->GetTimeUsCb(): 0;
+    
+    Logger_GetBuffOccupancy(&gLoggerManager.RxBuffer, &pOccupancy->Main, NowUs);
+    Logger_GetBuffOccupancy(&gLoggerManager.PriorityBuffer, &pOccupancy->Priority, NowUs);
+    pOccupancy->HighResolutionMS = Logger_ModeTimeGetMS(&pOccupancyMng->HighResolution, NowUs);
+    pOccupancy->IdleMS = Logger_ModeTimeGetMS(&pOccupancyMng->Idle, NowUs);
+    
+    pOccupancy->NumOfSeconds = pOccupancyMng->NumOfSeconds;
+    for(Idx = 0; Idx < pOccupancyMng->NumOfSeconds; Idx++)
     {
-        OSAL_ASSERT(0);
+        pOccupancy->Series[Idx] = pOccupancyMng->Series[(pOccupancyMng->Head + Idx) % LOGGER_CONFIG_OCCUPANCY_SERIES_SIZE];
     }
+    
+    OSAL_PortMutexRelease(gLoggerManager.RxBuffer.pMutex);
 }
 
 void Logger_HandleSocketReply(uint16 Cmd, uint32 Status, uint16 SessionType)
@@ -814,6 +2508,17 @@ void Logger_HandleTimerExpr(IN uint16 TimerType)
             Logger_OpenSocket(&gLoggerManager.Config.Socket);
         break;
         
+        case LOGGER_TIMER_DUMP_RETRY_ID:
+            if(gLoggerManager.DumpMng.Flags.IsActive)
+            {
+                Logger_DumpContinue(Logger_DumpStep());
+            }
+        break;
+        
+        case LOGGER_TIMER_TELEMETRY_ID:
+            Logger_SendTelemetryToSrv();
+        break;
+        
         default:
             OSAL_ASSERT(0);
     }
@@ -878,11 +2583,336 @@ void Logger_SendConfigToSrv(IN uint8 ConfigType)
     
 }
 
+/**
+ * <pre>
+ * void Logger_SendTaskStatsToSrv(void)
+ * </pre>
+ *  
+ * this function sends the per task statistics to the server: for every task ID up to the last one that printed, 
+ * its accepted messages and bytes, filtered out messages and overrun messages (see LoggerTaskStats_t)
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SendTaskStatsToSrv(void)
+{
+    U_CODE_ARGUMENT CodeArgs;
+    DEV_TYPE_t DevType;
+    uint8 NumOfTasks;
+    
+    DevType.s = CONTROL_PANEL_TYPE;
+    
+    for(NumOfTasks = LOGGER_DEF_MAX_TASKS; NumOfTasks > 0; NumOfTasks--)
+    {
+        if(gLoggerManager.TaskStats[NumOfTasks - 1].AcceptedMsgs != 0 || gLoggerManager.TaskStats[NumOfTasks - 1].FilteredMsgs != 0 ||
+           gLoggerManager.TaskStats[NumOfTasks - 1].OverrunMsgs != 0)
+        {
+            break;
+        }
+    }
+    CodeArgs.LoggerTaskStatsMsg.VerMajor = LOGGER_VERSION[0];
+    CodeArgs.LoggerTaskStatsMsg.VerMinor = LOGGER_VERSION[2];
+    CodeArgs.LoggerTaskStatsMsg.NumOfTasks = NumOfTasks;
+    CodeArgs.LoggerTaskStatsMsg.pTaskStats = (uint32 *)gLoggerManager.TaskStats;
+    
+    OMM_SendMsg ( OSAL_GetSelfTaskId(), MSME_LOGGER_TASK_STATS_EVENT_MSG, &CodeArgs, DevType, MSME_MSG_2_SPECIFIC_USER,
+                 CONTROL_PANEL_TYPE_ID, OMM_DONT_SEND_COMPLETION_AFTER_SERVER_ACK);
+}
+
+/**
+ * <pre>
+ * uint8 Logger_GetTopSites(LoggerCallSite_t *pTop, uint8 NumOfSites, BOOL IsNewWindow, uint32 *pWindowMS)
+ * </pre>
+ *  
+ * this function returns the call sites that wrote the most bytes to the RX buffers since the window start, the 
+ * most bytes first. the call sites table is not copied, every top call site is selected by a pass over the table.
+ *
+ * @param   pTop           [out]   The top call sites
+ * @param   NumOfSites     [in]    The maximum number of call sites to return
+ * @param   IsNewWindow    [in]    Clear the call sites table, so a new window starts
+ * @param   pWindowMS      [out]   Optional. The window length in ms (0 without GetTimeUsCb)
+ *
+ * @return the number of call sites returned
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+uint8 Logger_GetTopSites(OUT LoggerCallSite_t *pTop, IN uint8 NumOfSites, IN BOOL IsNewWindow, OUT uint32 *pWindowMS)
+{
+    LoggerCallSiteMng_t *pCallSiteMng = &gLoggerManager.CallSiteMng;
+    
+    uint32 NowUs;
+    
+    uint16 Idx;
+    
+    uint16 BestIdx = 0;
+    
+    uint16 PrevIdx;
+    
+    uint8 Cnt;
+    
+    if(gLoggerManager.RxBuffer.pMutex == NULL || gLoggerManager.pCbList == NULL)
+    {
+        return 0;
+    }
+    OSAL_PortMutexCapture(gLoggerManager.RxBuffer.pMutex);
+    
+    NowUs = (gLoggerManager.pCbList->GetTimeUsCb != NULL)? gLoggerManager.pCbList->GetTimeUsCb(): 0;
+    
+    /* the entries are ordered by their bytes (descending) and then by their index */
+    for(Cnt = 0; Cnt < NumOfSites; Cnt++)
+    {
+        PrevIdx = BestIdx;
+        for(pTop[Cnt].pFmt = NULL, Idx = 0; Idx < LOGGER_DEF_CALL_SITES_SIZE; Idx++)
+        {
+            if(pCallSiteMng->Site[Idx].pFmt == NULL || 
+               (Cnt > 0 && (pCallSiteMng->Site[Idx].Bytes > pTop[Cnt - 1].Bytes || 
+                            (pCallSiteMng->Site[Idx].Bytes == pTop[Cnt - 1].Bytes && Idx <= PrevIdx))))
+            {
+                continue;
+            }
+            if(pTop[Cnt].pFmt == NULL || pCallSiteMng->Site[Idx].Bytes > pTop[Cnt].Bytes)
+            {
+                pTop[Cnt] = pCallSiteMng->Site[Idx];
+                BestIdx = Idx;
+            }
+        }
+        if(pTop[Cnt].pFmt == NULL)
+        {
+            break;
+        }
+    }
+    if(pWindowMS != NULL)
+    {
+        *pWindowMS = (NowUs - pCallSiteMng->WindowStartUs) / 1000;
+    }
+    if(IsNewWindow)
+    {
+        OSAL_MemSet(pCallSiteMng, 0, sizeof(LoggerCallSiteMng_t));
+        pCallSiteMng->WindowStartUs = NowUs;
+    }
+    
+    OSAL_PortMutexRelease(gLoggerManager.RxBuffer.pMutex);
+    
+    return Cnt;
+}
+
+/**
+ * <pre>
+ * void Logger_SendTopSitesToSrv(uint8 NumOfSites, BOOL IsNewWindow)
+ * </pre>
+ *  
+ * this function sends the top talkers call sites report to the server: the call sites that wrote the most bytes 
+ * since the window start, with their format string (up to LOGGER_DEF_TOP_SITE_FMT_LEN characters)
+ *
+ * @param   NumOfSites     [in]    The number of call sites to send (up to LOGGER_DEF_MAX_TOP_SITES)
+ * @param   IsNewWindow    [in]    Start a new window once the report was built
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SendTopSitesToSrv(IN uint8 NumOfSites, IN BOOL IsNewWindow)
+{
+    LoggerCallSite_t Top[LOGGER_DEF_MAX_TOP_SITES];
+    U_CODE_ARGUMENT CodeArgs;
+    DEV_TYPE_t DevType;
+    uint8 Idx;
+    
+    DevType.s = CONTROL_PANEL_TYPE;
+    
+    if(NumOfSites > LOGGER_DEF_MAX_TOP_SITES)
+    {
+        NumOfSites = LOGGER_DEF_MAX_TOP_SITES;
+    }
+    CodeArgs.LoggerTopSitesMsg.VerMajor = LOGGER_VERSION[0];
+    CodeArgs.LoggerTopSitesMsg.VerMinor = LOGGER_VERSION[2];
+    CodeArgs.LoggerTopSitesMsg.NumOfSites = Logger_GetTopSites(Top, NumOfSites, IsNewWindow, &CodeArgs.LoggerTopSitesMsg.WindowMS);
+    
+    for(Idx = 0; Idx < CodeArgs.LoggerTopSitesMsg.NumOfSites; Idx++)
+    {
+        CodeArgs.LoggerTopSitesMsg.Site[Idx].Hits = Top[Idx].Hits;
+        CodeArgs.LoggerTopSitesMsg.Site[Idx].Bytes = Top[Idx].Bytes;
+        CodeArgs.LoggerTopSitesMsg.Site[Idx].FmtLen = OSAL_StrLen((char *)Top[Idx].pFmt, LOGGER_DEF_TOP_SITE_FMT_LEN);
+        CodeArgs.LoggerTopSitesMsg.Site[Idx].pFmt = (char *)Top[Idx].pFmt;
+    }
+    
+    OMM_SendMsg ( OSAL_GetSelfTaskId(), MSME_LOGGER_TOP_SITES_EVENT_MSG, &CodeArgs, DevType, MSME_MSG_2_SPECIFIC_USER,
+                 CONTROL_PANEL_TYPE_ID, OMM_DONT_SEND_COMPLETION_AFTER_SERVER_ACK);
+}
+
+/**
+ * <pre>
+ * uint8 Logger_PutVarint(uint8 *pData, uint32 Value)
+ * </pre>
+ *  
+ * this function writes a telemetry or a structured record value as a varint: 7 bits in every byte, the low bits first, 
+ * the top bit is set in every byte but the last
+ *
+ * @param   pData          [out]   The record position to write to (up to 5 bytes)
+ * @param   Value          [in]    The value to write
+ *
+ * @return the number of bytes written
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+uint8 Logger_PutVarint(OUT uint8 *pData, IN uint32 Value)
+{
+    uint8 Len = 0;
+    
+    while(Value >= 0x80)
+    {
+        pData[Len++] = (uint8)(Value | 0x80);
+        Value >>= 7;
+    }
+    pData[Len++] = (uint8)Value;
+    
+    return Len;
+}
+
+/**
+ * <pre>
+ * void Logger_SetTelemetryInterval(uint16 IntervalSec)
+ * </pre>
+ *  
+ * this function (re)starts the periodic telemetry record timer. the next record is a full record, with the counters 
+ * since the logger init
+ *
+ * @param   IntervalSec    [in]    The record interval in seconds, 0 stops the telemetry records
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SetTelemetryInterval(IN uint16 IntervalSec)
+{
+    LoggerTelemetryMng_t *pTelemetry = &gLoggerManager.TelemetryMng;
+    
+    OSAL_MemSet(pTelemetry, 0, sizeof(LoggerTelemetryMng_t));
+    pTelemetry->IntervalSec = IntervalSec;
+    pTelemetry->LastUs = (gLoggerManager.pCbList != NULL && gLoggerManager.pCbList->GetTimeUsCb != NULL)? gLoggerManager.pCbList->GetTimeUsCb(): 0;
+    
+    OSAL_StopTimer(LOGGER_TIMER_TELEMETRY_ID);
+    if(IntervalSec != 0)
+    {
+        OSAL_StartTimer(LOGGER_TIMER_TELEMETRY_ID, IntervalSec * 1000, TRUE);
+    }
+}
+
+/**
+ * <pre>
+ * void Logger_SendTelemetryToSrv(void)
+ * </pre>
+ *  
+ * this function sends the logger telemetry record to the server, so the panels whose logger is saturating are seen 
+ * before log messages are lost. to keep it small only the counters that changed since the last record are sent, as 
+ * varint deltas. every LOGGER_CONFIG_TELEMETRY_FULL_EVERY records the counters are sent in full (deltas from zero), so 
+ * the server recovers from a lost record (a sequence number gap). a record is also sent in full after the counters were 
+ * reset (the logger init, a probes reset) or went backwards, so the server restarts its 
+ * totals instead of reading a negative delta as a huge one. the record (little endian):
+ *   [0]   LOGGER_DEF_TELEMETRY_FORMAT, LOGGER_DEF_TELEMETRY_FULL_FLAG on a full record
+ *   [1]   the sequence number
+ *   [2-3] the changed counters bitmap, a bit per LoggerTelemetryCounter_e
+ *   a varint of every changed counter, a varint of the time since the last record in ms, the RX double buffer peak 
+ *   usage percent since the last record and the FLASH log file usage percent
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SendTelemetryToSrv(void)
+{
+    LoggerTelemetryMng_t *pTelemetry = &gLoggerManager.TelemetryMng;
+    uint32 Counters[e_LOGGER_TELEMETRY_MAX];
+    uint8 Record[LOGGER_DEF_TELEMETRY_MAX_LEN];
+    U_CODE_ARGUMENT CodeArgs;
+    DEV_TYPE_t DevType;
+    uint32 NowUs;
+    uint32 FlashSizeBytes = LOGGER_DEF_GEN_CONFIG.FlashSize << 10;
+    uint16 ChangedMask = 0;
+    uint16 PeakUsed;
+    BOOL IsFull = (pTelemetry->Seq % LOGGER_CONFIG_TELEMETRY_FULL_EVERY) == 0;
+    uint8 Len = LOGGER_DEF_TELEMETRY_HEADER_LEN;
+    uint8 Idx;
+    
+    if(gLoggerManager.RxBuffer.pMutex == NULL)
+    {
+        return;
+    }
+    DevType.s = CONTROL_PANEL_TYPE;
+    
+    Counters[e_LOGGER_TELEMETRY_RX_MSGS] = gLoggerManager.RxBuffer.RxCounter;
+    Counters[e_LOGGER_TELEMETRY_TX_PACKETS] = gLoggerManager.RxBuffer.TxCounter;
+    Counters[e_LOGGER_TELEMETRY_LOST_MSGS] = gLoggerManager.RxBuffer.LostMsgCnt;
+    Counters[e_LOGGER_TELEMETRY_LOST_BYTES] = gLoggerManager.RxBuffer.LostBytesCnt;
+    Counters[e_LOGGER_TELEMETRY_BUSY] = gLoggerManager.RxBuffer.BusyCnt;
+    Counters[e_LOGGER_TELEMETRY_LOW_MEMORY] = gLoggerManager.RxBuffer.LowMemoryCnt;
+    Counters[e_LOGGER_TELEMETRY_RUN_OVER] = gLoggerManager.RxBuffer.RunOverCnt;
+    Counters[e_LOGGER_TELEMETRY_FLASH_DROPS] = gLoggerManager.RxBuffer.SinkDropCnt[e_LOGGER_SINK_FLASH];
+    Counters[e_LOGGER_TELEMETRY_SOCKET_DROPS] = gLoggerManager.RxBuffer.SinkDropCnt[e_LOGGER_SINK_SOCKET];
+    Counters[e_LOGGER_TELEMETRY_UART_DROPS] = gLoggerManager.RxBuffer.SinkDropCnt[e_LOGGER_SINK_UART];
+    Counters[e_LOGGER_TELEMETRY_PRIORITY_RX_MSGS] = gLoggerManager.PriorityBuffer.RxCounter;
+    Counters[e_LOGGER_TELEMETRY_PRIORITY_LOST_MSGS] = gLoggerManager.PriorityBuffer.LostMsgCnt;
+    Counters[e_LOGGER_TELEMETRY_DRAIN_WAKEUPS] = gLoggerManager.DrainMng.WakeupCnt;
+    Counters[e_LOGGER_TELEMETRY_DRAIN_BUSY_US] = gLoggerManager.DrainMng.DrainBusyUs;
+    
+    /* the peak is sampled by the drain task under the mutex */
+    OSAL_PortMutexCapture(gLoggerManager.RxBuffer.pMutex);
+    PeakUsed = pTelemetry->PeakUsed;
+    pTelemetry->PeakUsed = 0;
+    OSAL_PortMutexRelease(gLoggerManager.RxBuffer.pMutex);
+    
+    NowUs = (gLoggerManager.pCbList->GetTimeUsCb != NULL)? gLoggerManager.pCbList->GetTimeUsCb(): 0;
+    
+    IsFull |= pTelemetry->IsReset;
+    pTelemetry->IsReset = FALSE;
+    for(Idx = 0; Idx < e_LOGGER_TELEMETRY_MAX; Idx++)
+    {
+        IsFull |= (Counters[Idx] < pTelemetry->Last[Idx]);
+    }
+    for(Idx = 0; Idx < e_LOGGER_TELEMETRY_MAX; Idx++)
+    {
+        if(Counters[Idx] != (IsFull? 0: pTelemetry->Last[Idx]))
+        {
+            ChangedMask |= 1 << Idx;
+            Len += Logger_PutVarint(&Record[Len], Counters[Idx] - (IsFull? 0: pTelemetry->Last[Idx]));
+        }
+        pTelemetry->Last[Idx] = Counters[Idx];
+    }
+    Len += Logger_PutVarint(&Record[Len], (NowUs - pTelemetry->LastUs) / 1000);
+    Record[Len++] = (uint8)(PeakUsed * 100 / (gLoggerManager.RxBuffer.pTail - gLoggerManager.RxBuffer.pHead));
+    Record[Len++] = (uint8)((FlashSizeBytes == 0)? 0: 
+                            (LOGGER_DEF_FLASH_USAGE_SIZE_BYTES(gLoggerManager.FlashMng.ReadAddr, gLoggerManager.FlashMng.WriteAddr, 
+                                                               LOGGER_DEF_GEN_CONFIG.FlashSize)) * 100ULL / FlashSizeBytes);
+    
+    Record[0] = LOGGER_DEF_TELEMETRY_FORMAT | (IsFull? LOGGER_DEF_TELEMETRY_FULL_FLAG: 0);
+    Record[1] = pTelemetry->Seq++;
+    Record[2] = (uint8)ChangedMask;
+    Record[3] = (uint8)(ChangedMask >> 8);
+    pTelemetry->LastUs = NowUs;
+    
+    CodeArgs.LoggerTelemetryMsg.VerMajor = LOGGER_VERSION[0];
+    CodeArgs.LoggerTelemetryMsg.VerMinor = LOGGER_VERSION[2];
+    CodeArgs.LoggerTelemetryMsg.Len = Len;
+    CodeArgs.LoggerTelemetryMsg.pRecord = Record;
+    
+    OMM_SendMsg ( OSAL_GetSelfTaskId(), MSME_LOGGER_TELEMETRY_EVENT_MSG, &CodeArgs, DevType, MSME_MSG_2_SPECIFIC_USER,
+                 CONTROL_PANEL_TYPE_ID, OMM_DONT_SEND_COMPLETION_AFTER_SERVER_ACK);
+}
+
 void Logger_HandleServerCmd(void* pDataIn, uint8 Len, uint8 CmdType)
 {
 #define MSG_LOGGER_STATUS CodeArgs.LoggerStatusMsg
-#define OFF     FALSE    
     BOOL IsError;
+    BOOL IsOn;
+    BOOL IsSinkChange;
+    LoggerGenConfig_t PrevConfig;
     U_CODE_ARGUMENT CodeArgs;
     DEV_TYPE_t DevType;
         
@@ -894,32 +2924,39 @@ void Logger_HandleServerCmd(void* pDataIn, uint8 Len, uint8 CmdType)
     switch(CmdType)
     {
         case e_LOGGER_CONF_TYPE_GENERAL:
-            IsError = Logger_ValidateGenConfig((LoggerGenConfig_t *)pDataIn);
+            /* a FLASH erase or dump in progress must end before the FLASH is reinitialized */
+            IsError = Logger_ValidateGenConfig((LoggerGenConfig_t *)pDataIn) || Logger_IsFlashOpActive();
             if(!IsError)
             {
-                Logger_SwitchOnOff(OFF, FALSE);
-                
-                Logger_SetState(e_LOGGER_STATE_INITIALIZING);
-                
                 if(gLoggerManager.pCbList->WriteConfigCb != NULL)
                 {    
                     gLoggerManager.pCbList->WriteConfigCb(e_LOGGER_CONF_TYPE_GENERAL,(LoggerGenConfig_t *)pDataIn);
                 }
-               
-                Logger_InitFlash(LOGGER_DEF_GEN_CONFIG.FlashSize, ((LoggerGenConfig_t *)pDataIn)->Attributes & LOGGER_ATTR_ERASE_FLASH_NOW);
                 
-                BOOL IsOn = Logger_SetRAMGeneralConfig((LoggerGenConfig_t *)pDataIn);
-                                 
-                Logger_InitRxBuffer(&gLoggerManager.RxBuffer);
+                OSAL_MemCopy(&PrevConfig, &LOGGER_DEF_GEN_CONFIG, sizeof(LoggerGenConfig_t));
+                
+                /* the printing tasks and the sinks keep using the published filter snapshot until the next publish */
+                IsOn = Logger_SetRAMGeneralConfig((LoggerGenConfig_t *)pDataIn);
                 
-                if(gLoggerManager.Config.General.DestType == LOGGER_DEST_TYPE_SOCKET)
+                /* switching the logger on opens its destination, as on init */
+                IsSinkChange = (PrevConfig.DestType != LOGGER_DEF_GEN_CONFIG.DestType || PrevConfig.FlashSize != LOGGER_DEF_GEN_CONFIG.FlashSize ||
+                                (((LoggerGenConfig_t *)pDataIn)->Attributes & LOGGER_ATTR_ERASE_FLASH_NOW) || (IsOn && !PrevConfig.IsEnabled));
+                
+                if(!IsSinkChange)
                 {
-                    Logger_OpenSocket(&LOGGER_DEF_SOCKET_CONFIG);                    
+                    /* level, mask or printout change - the RX buffers, their mutex, the FLASH and the socket are kept */
+                    if(IsOn != PrevConfig.IsEnabled)
+                    {
+                        Logger_SwitchOnOff(IsOn, FALSE);
+                    }
+                    else
+                    {
+                        Logger_PublishFilter();
+                    }
+                    break;
                 }
-                Logger_SetState(e_LOGGER_STATE_READY);
                 
-                Logger_SwitchOnOff(IsOn, FALSE);
-
+                Logger_SwitchSinks(PrevConfig.IsEnabled, IsOn, ((LoggerGenConfig_t *)pDataIn)->Attributes & LOGGER_ATTR_ERASE_FLASH_NOW);
             }
         break;
             
@@ -949,14 +2986,75 @@ void Logger_FlushRxBuffer(void)
     Logger_SetTxResolution(LOGGER_RESOLUTION_TYPE_HIGH);
 }
 
-BOOL Logger_SendLogFileToServer(LoggerFtpConfig_t *pLoggerFtpConfig, LoggerSocketConfig_t *pLoggerSocketConfig)
+/**
+ * <pre>
+ * void Logger_NoInitUpdate(void)
+ * </pre>
+ *  
+ * this function saves the RX buffers offsets in the no-init RAM header, so the log messages that were not sent
+ * can be recovered after a reset (see Logger_InitRxBuffer)
+ * NOTE: this function is called under the RX buffer mutex (or with the interrupts disabled) after the RX buffers pointers moved
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_NoInitUpdate(void)
 {
-    uint16 SizeKB;
-    int ReadSizeBytes;
-    uint8 FileNameLen;         
-    char FileName[LOGGER_CONFIG_FTP_FILE_NAME_LEN];    
-    LoggerDateAndTime_t DateAndTime = {0};
-    uint16 FlashUsageKB;
+    LoggerNoInitHeader_t *pHeader = gLoggerManager.pNoInit;
+    
+    if(pHeader == NULL)
+    {
+        return;
+    }
+    /* a read pointer may be left at the buffer tail, which is the buffer head */
+    pHeader->ReadOffset[e_LOGGER_RX_BUFF_MAIN] = (gLoggerManager.RxBuffer.pRead - gLoggerManager.RxBuffer.pHead) % LOGGER_CONFIG_DOUBLE_BUFFER_SIZE_BYTES;
+    pHeader->WriteOffset[e_LOGGER_RX_BUFF_MAIN] = gLoggerManager.RxBuffer.pWrite - gLoggerManager.RxBuffer.pHead;
+    pHeader->ReadOffset[e_LOGGER_RX_BUFF_PRIORITY] = (gLoggerManager.PriorityBuffer.pRead - gLoggerManager.PriorityBuffer.pHead) % LOGGER_CONFIG_PRIORITY_BUFFER_SIZE_BYTES;
+    pHeader->WriteOffset[e_LOGGER_RX_BUFF_PRIORITY] = gLoggerManager.PriorityBuffer.pWrite - gLoggerManager.PriorityBuffer.pHead;
+    
+    pHeader->Crc = Logger_NoInitCrc(pHeader);
+}
+
+/**
+ * <pre>
+ * uint32 Logger_Crc32(uint32 Crc, void *pBuff, uint16 Len)
+ * </pre>
+ *  
+ * this function adds a buffer to a running CRC-32 (reflected 0xEDB88320, no final inversion). it uses a nibble table,
+ * small enough to keep the no-init RAM header update cheap on every log message.
+ *
+ * @param   Crc         [in]    the running CRC (LOGGER_DEF_CRC32_INIT for the first buffer)
+ * @param   pBuff       [in]    the buffer
+ * @param   Len         [in]    the buffer length in bytes
+ *
+ * @return the running CRC
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+uint32 Logger_Crc32(IN uint32 Crc, IN void *pBuff, IN uint16 Len)
+{
+    static const uint32 CrcTable[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    uint8 *pByte = (uint8*)pBuff;
+    
+    while(Len--)
+    {
+        Crc = CrcTable[(Crc ^ *pByte) & 0x0F] ^ (Crc >> 4);
+        Crc = CrcTable[(Crc ^ (*pByte >> 4)) & 0x0F] ^ (Crc >> 4);
+        pByte++;
+    }
+    return Crc;
+}
+
+BOOL Logger_SendLogFileToServer(LoggerFtpConfig_t *pLoggerFtpConfig, LoggerSocketConfig_t *pLoggerSocketConfig, LoggerLogFilter_t *pFilter)
+{
+    LoggerUploadJob_t *pJob = &gLoggerManager.UploadJob;
+    LOGGER_STATUS Status;
     
     /* sanity - both paramters must be set or both can be not set */
     if((pLoggerFtpConfig == NULL && pLoggerSocketConfig != NULL) || (pLoggerSocketConfig == NULL && pLoggerFtpConfig != NULL))
@@ -969,85 +3067,59 @@ BOOL Logger_SendLogFileToServer(LoggerFtpConfig_t *pLoggerFtpConfig, LoggerSocke
         pLoggerFtpConfig = &LOGGER_DEF_FTP_CONFIG;
         pLoggerSocketConfig = &LOGGER_DEF_SOCKET_CONFIG;
     }
-    SizeKB = pLoggerFtpConfig->FileSize;
-    /* current FLASH usage of debug log */
-    FlashUsageKB = LOGGER_DEF_FLASH_USAGE_SIZE_KB(gLoggerManager.FlashMng.ReadAddr, gLoggerManager.FlashMng.WriteAddr, LOGGER_DEF_GEN_CONFIG.FlashSize);
-
-     ReadSizeBytes = (SizeKB == LOGGER_DEF_GET_ALL_FLASH_SIZE_KB || SizeKB >=FlashUsageKB)?
-        LOGGER_DEF_FLASH_USAGE_SIZE_BYTES(gLoggerManager.FlashMng.ReadAddr, gLoggerManager.FlashMng.WriteAddr, LOGGER_DEF_GEN_CONFIG.FlashSize):SizeKB<<10;
-    
-    OSAL_ASSERT(ReadSizeBytes<=LOGGER_DEF_GEN_CONFIG.FlashSize<<10);
-     
-    /* singular case FLASH is empty */
-    if(ReadSizeBytes == 0)
-    {
-        Logger_HandleFtpPutReply(OSAL_STATUS_OK, e_LOGGER_MSG_ERROR_DES_NO_FILE_TO_SEND);
-        return FALSE;
-    }
+    /* the part files are uploaded with the configuration of this attempt */
+    OSAL_MemCopy(&pJob->Ftp, pLoggerFtpConfig, sizeof(LoggerFtpConfig_t));
+    OSAL_MemCopy(&pJob->Socket, pLoggerSocketConfig, sizeof(LoggerSocketConfig_t));
     
-    if(gLoggerManager.pCbList->GetPanelIdCb != NULL)
-    {
-        gLoggerManager.pCbList->GetPanelIdCb(FileName);
-        
-        if(gLoggerManager.pCbList->GetDateAndTimeCb != NULL)
-        {
-            /* fill in the file name */
-            gLoggerManager.pCbList->GetDateAndTimeCb(&DateAndTime);
-            char *pItr = &FileName[LOGGER_CONFIG_PANEL_ID_SIZE_BYTES - 1];
-            *pItr++ = '_';
-            pItr+= num2decstr(DateAndTime.Day, (uint8*)pItr, 2);
-            pItr+= num2decstr(DateAndTime.Month, (uint8*)pItr, 2);
-            pItr+= num2decstr(DateAndTime.Year, (uint8*)pItr, 2);
-            pItr+= num2decstr(DateAndTime.Hour, (uint8*)pItr, 2);
-            pItr+= num2decstr(DateAndTime.Minute, (uint8*)pItr, 2);
-            pItr = OSAL_StrCopy(pItr, ".txt", 5);
-            FileNameLen = pItr - FileName;
-        }
-        else
-        {
-            return FALSE;
-        }
-    
-    }
-    else
+    /* an upload that was cut continues from the last part the server has stored, unless its log was overwritten 
+       or this request asks for another file size or filter */
+    if(!pJob->Progress.Flags.IsActive || !Logger_IsFlashCursorValid(&pJob->Progress.Next) ||
+       pJob->Progress.ParamsCrc != Logger_UploadJobParamsCrc(pLoggerFtpConfig->FileSize, pFilter))
     {
-        return FALSE;
-    }
-    if(gLoggerManager.pCbList->SendFtpFileCb == NULL)
-    {
-        return FALSE;
+        if(!Logger_UploadJobInit(pLoggerFtpConfig->FileSize, pFilter))
+        {
+            return FALSE;
+        }
     }
     /* stop the logger while sending the file */
     Logger_FlushRxBuffer();
     
-    if(gLoggerManager.pCbList->SendFtpFileCb(pLoggerSocketConfig, pLoggerFtpConfig, 
-                                             gLoggerManager.FlashMng.ReadAddr,ReadSizeBytes, 
-                                             FileName, FileNameLen) != LOGGER_STATUS_OK)
-    {
-        return FALSE;
-    }
-    return TRUE;
+    Status = Logger_UploadNextPart();
+    
+    return (Status == LOGGER_STATUS_PENDING);
 }
 
 void Logger_HandleFtpPutReply(uint8 Status, uint8 Desc)
 {
-#define MSG_LOGGER_STATUS CodeArgs.LoggerStatusMsg
-    
-    U_CODE_ARGUMENT CodeArgs;
-    DEV_TYPE_t DevType;
+    LoggerUploadJob_t *pJob = &gLoggerManager.UploadJob;
+    uint8 MsgStatus = (Status == OSAL_STATUS_OK)? e_LOGGER_MSG_STATUS_OK: e_LOGGER_MSG_STATUS_FAIL;
     
-    DevType.s = CONTROL_PANEL_TYPE;
-
-    MSG_LOGGER_STATUS.VerMajor = LOGGER_VERSION[0];
-    MSG_LOGGER_STATUS.VerMinor = LOGGER_VERSION[2];
-
-    MSG_LOGGER_STATUS.Command = e_LOGGER_CONF_TYPE_FTP;
+    /* the server has stored a part file of the upload job, continue with the next part */
+    if(Status == OSAL_STATUS_OK && gLoggerManager.UploadRange.Flags.IsSet && pJob->Progress.Flags.IsActive)
+    {
+        LOGGER_STATUS JobStatus;
         
-    MSG_LOGGER_STATUS.Status = Status == OSAL_STATUS_OK?e_LOGGER_MSG_STATUS_OK:e_LOGGER_MSG_STATUS_FAIL;
-    MSG_LOGGER_STATUS.Description = Desc;
-
-    OMM_SendMsg ( OSAL_GetSelfTaskId(), MSME_LOGGER_STATUS_EVENT_MSG, &CodeArgs, DevType, MSME_MSG_2_SPECIFIC_USER,
-                 CONTROL_PANEL_TYPE_ID, OMM_DONT_SEND_COMPLETION_AFTER_SERVER_ACK);
+        gLoggerManager.UploadRange.Flags.IsSet = 0;
+        Logger_UploadPartDone();
+        
+        JobStatus = Logger_UploadNextPart();
+        if(JobStatus == LOGGER_STATUS_PENDING)
+        {
+            /* report the job progress in percents */
+            Logger_SendFtpStatusMsg(e_LOGGER_MSG_STATUS_IN_PROGRESS, 
+                                    (uint8)((uint32)(pJob->Progress.TotalSizeBytes - pJob->Progress.SizeBytes)*100/pJob->Progress.TotalSizeBytes));
+            return;
+        }
+        if(JobStatus != LOGGER_STATUS_OK)
+        {
+            MsgStatus = e_LOGGER_MSG_STATUS_FAIL;
+        }
+    }
+    /* the upload has ended (a failed job is kept, to be resumed by the next upload) */
+    gLoggerManager.UploadRange.Flags.IsSet = 0;
+    
+    Logger_SendFtpStatusMsg(MsgStatus, Desc);
+    
     Logger_SetTaskState(e_LOGGER_STATE_READY);
 }
 
@@ -1102,6 +3174,13 @@ BOOL Logger_ValidateGenConfig(LoggerGenConfig_t *pLoggerGenConfig)
         IsError = TRUE;
     }
     
+    /* validate destination type */
+    if(pLoggerGenConfig->DestType > LOGGER_DEST_TYPE_MAX_VALUE)
+    {
+        pLoggerGenConfig->DestType = LOGGER_CONFIG_DEFAULT_DESTINATION_TYPE;
+        IsError = TRUE;
+    }
+    
     /* validate resolution */
     if(pLoggerGenConfig->ResolutionMS == 0 || pLoggerGenConfig->ResolutionMS == 0xFFFF)
     {
@@ -1142,6 +3221,41 @@ BOOL Logger_ValidateGenConfig(LoggerGenConfig_t *pLoggerGenConfig)
 
 }
 
+/**
+ * <pre>
+ * BOOL Logger_ValidateBatchCmd(LoggerBatchCmd_t *pBatch)
+ * </pre>
+ *  
+ * this function checks a batch command with the same checks as Logger_ValidateGenConfig. the batch parameters are 
+ * applied to a copy of the RAM general configuration, so the RAM configuration is not changed.
+ *
+ * @param   pBatch      [in]    the batch command. only the parameters of its Fields bits are checked.
+ *
+ * @return TRUE if one of the batch parameters is out of range, FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+BOOL Logger_ValidateBatchCmd(LoggerBatchCmd_t *pBatch)
+{
+    LoggerGenConfig_t Config = LOGGER_DEF_GEN_CONFIG;
+    
+    if(pBatch->Fields & LOGGER_BATCH_LOG_LEVEL)
+    {
+        Config.LogLevel = pBatch->LogLevel;
+    }
+    if(pBatch->Fields & LOGGER_BATCH_MODULE_MASK)
+    {
+        Config.ModuleMask = pBatch->ModuleMask;
+    }
+    if(pBatch->Fields & LOGGER_BATCH_DEST_TYPE)
+    {
+        Config.DestType = pBatch->DestType;
+    }
+    
+    return Logger_ValidateGenConfig(&Config);
+}
+
 BOOL Logger_ValidateTcpConfig(LoggerSocketConfig_t *pLoggerSocketConfig)
 {
     LOG_PRINT(LEVEL_DETAILS, "Socket Conf: Domain(%s) Len(%d) RPort(%d) LPort(%d) Type(%d)\n", 
@@ -1158,128 +3272,315 @@ BOOL Logger_ValidateFtpConfig(LoggerFtpConfig_t *pLoggerFtpConfig)
     return FALSE;    
 }
 
-BOOL Logger_SendDebugLog(uint16 SizeKB, uint8 DestType)
+BOOL Logger_SendDebugLog(uint16 SizeKB, LoggerLogFilter_t *pFilter, uint8 DestType)
 {
-#define ON TRUE
-#define OFF FALSE
-#define READ_CHUNK_SIZE         256
+    uint32 StartAddr;
     
-    /* return value */
-    BOOL RetVal = FALSE;
+    /* get the flash range to send */
+    int ReadSizeBytes = Logger_GetFlashReadRange(SizeKB, &StartAddr);
     
-    /* Iterator to run over FLASH address */
-    uint32 Iter;
-        
-    /* Flash end address for calculations */
-    uint32 EndAddress = LOGGER_DEF_FLASH_END_ADDRESS(LOGGER_CONFIG_FLASH_START_ADDRESS, gLoggerManager.Config.General.FlashSize);
-    
-    /* current FLASH usage of debug log */
-    uint16 FlashUsageKB = LOGGER_DEF_FLASH_USAGE_SIZE_KB(gLoggerManager.FlashMng.ReadAddr, gLoggerManager.FlashMng.WriteAddr, LOGGER_DEF_GEN_CONFIG.FlashSize);
-    
-    int ReadSizeBytes = (SizeKB == LOGGER_DEF_GET_ALL_FLASH_SIZE_KB || SizeKB >=FlashUsageKB)?
-        LOGGER_DEF_FLASH_USAGE_SIZE_BYTES(gLoggerManager.FlashMng.ReadAddr, gLoggerManager.FlashMng.WriteAddr, LOGGER_DEF_GEN_CONFIG.FlashSize):SizeKB<<10;
+    /* send only the sectors that may match the filter */
+    uint8 SectorMask = pFilter? Logger_SummaryGetSectorMask(pFilter): LOGGER_DEF_FLASH_ALL_SECTORS_MASK;
     
-     /* temp buff to read and dump flash log */
-    char *pTempBuff;
-
-    /* sanity check */
-    if(ReadSizeBytes<0 || 
-       ((DestType == LOGGER_DEST_TYPE_RS232 && gLoggerManager.pCbList->SendUartDataCb == NULL) || (DestType == LOGGER_DEST_TYPE_SOCKET && gLoggerManager.pCbList->SendSocketDataCb == NULL)))
+    /* a filter time range replaces the dump size, only the records of the time range are sent */
+    if(pFilter != NULL)
     {
-        OSAL_ASSERT(0);
-        return FALSE;
+        Logger_SummaryFindTimeRange(pFilter, &StartAddr, &ReadSizeBytes);
     }
     
-    /* singular case FLASH is empty */
-    if(ReadSizeBytes == 0)
-    {
-        Printf("FLASH is empty\n");
-        return FALSE;
-    }
-    /* sanity. check that task is ready */
-    if(gLoggerManager.State != e_LOGGER_STATE_READY)
+    return Logger_DumpStart(StartAddr, ReadSizeBytes, SectorMask, DestType);
+}
+
+/**
+ * <pre>
+ * BOOL Logger_SendUploadLog(uint16 SizeKB)
+ * </pre>
+ *  
+ * this function sends the log file that is being uploaded over the FTP socket.
+ * it sends the FLASH range that was set when the upload has started (see Logger_SendLogFileToServer),
+ * or the last SizeKB of the log file if no range was set.
+ *
+ * @param   SizeKB      [in]    The last log file size in KB to send, if no upload range was set
+ *
+ * @return TRUE if the log file was sent, or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+BOOL Logger_SendUploadLog(uint16 SizeKB)
+{
+    LoggerFlashRange_t *pRange = &gLoggerManager.UploadRange;
+    
+    if(pRange->Flags.IsSet)
     {
-        Printf("Task is not ready yet TaskState(%d)\n", gLoggerManager.State);
-        return FALSE;
+        return Logger_DumpStart(pRange->StartAddr, pRange->SizeBytes, pRange->SectorMask, LOGGER_DEST_TYPE_SOCKET);
     }
-    
-    /* change task state */
-    Logger_SetState(e_LOGGER_STATE_SENDING_LOG_FILE);
-    
-    /* allocate the working buffer to send log file */
-    pTempBuff = (char*)OSAL_HeapAllocBuffer(OSAL_GetSelfTaskId(), READ_CHUNK_SIZE);
-    
-    if(pTempBuff == NULL)
+    return Logger_SendDebugLog(SizeKB, NULL, LOGGER_DEST_TYPE_SOCKET);
+}
+
+/**
+ * <pre>
+ * void Logger_HandleFlashCompletion(LOGGER_STATUS Status)
+ * </pre>
+ *  
+ * this function handles an asynchronous FLASH operation completion and drives the state machine that is waiting for it.
+ *
+ * @param   Status      [in]    The FLASH operation status
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_HandleFlashCompletion(LOGGER_STATUS Status)
+{
+    if(gLoggerManager.EraseMng.Flags.IsPending)
     {
-        OSAL_ASSERT(0);
-        return FALSE;
+        Logger_HandleEraseCompletion(Status);
     }
-    
-    /* get the flash start address */
-    Iter = Logger_GetFlashReadStartAddress(LOGGER_CONFIG_FLASH_START_ADDRESS, EndAddress, gLoggerManager.FlashMng.WriteAddr, gLoggerManager.FlashMng.ReadAddr, ReadSizeBytes);
-    /* assumptions:
-       1. if dump command has arrived the UART is available 
-       2. the logger task priority is lower than uart task 
-       3. there is a task suspend between reading from flash to writing to uart */ 
-    while(ReadSizeBytes > 0)
+    else if(gLoggerManager.DumpMng.Flags.IsPending)
     {
-        LOGGER_STATUS Status;
+        gLoggerManager.DumpMng.Flags.IsPending = 0;
         
-        /* read the minimum of 3 - READ_CHUNK_SIZE, Size left to read, and the size left to read at the bottom of the flash */ 
-        uint16 FlashReadSize = LOGGER_DEF_MIN3VARS(READ_CHUNK_SIZE, ReadSizeBytes, EndAddress - Iter);
-        /* 1. read chunks of READ_CHUNK_SIZE bytes from flash */
-        if(gLoggerManager.pCbList->ReadFlashDataCb(Iter, pTempBuff, FlashReadSize) != LOGGER_STATUS_OK)
+        if(Status != LOGGER_STATUS_OK)
         {
             OSAL_ASSERT(0);
-            goto EXIT;
+            Logger_DumpEnd(Status);
+            return;
         }
+        Logger_DumpReadDone(&gLoggerManager.DumpMng);
         
-        if(DestType == LOGGER_DEST_TYPE_RS232)
+        Logger_DumpContinue(Logger_DumpStep());
+    }
+    else
+    {
+        /* sanity - no FLASH operation is waiting for a completion */
+        OSAL_ASSERT(0);
+    }
+}
+
+/**
+ * <pre>
+ * BOOL Logger_IsFlashOpActive(void)
+ * </pre>
+ *  
+ * this function returns whether a FLASH erase or dump state machine is in progress.
+ *
+ * @return TRUE if a FLASH operation is in progress, or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+BOOL Logger_IsFlashOpActive(void)
+{
+    return (gLoggerManager.EraseMng.Flags.IsActive || gLoggerManager.DumpMng.Flags.IsActive);
+}
+
+/**
+ * <pre>
+ * static LoggerCmdSlot_t *Logger_CmdSlotGet(void *pBuff)
+ * </pre>
+ *  
+ * this function returns the command pool slot of a command input buffer.
+ *
+ * @param   pBuff      [in]    the command input buffer.
+ *
+ * @return a pointer to the command pool slot, or NULL if the buffer was allocated from the heap
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static LoggerCmdSlot_t *Logger_CmdSlotGet(void *pBuff)
+{
+    uint8 *pPool = (uint8 *)gLoggerManager.CmdMng.Slot;
+
+    if((uint8 *)pBuff < pPool || (uint8 *)pBuff >= pPool + sizeof(gLoggerManager.CmdMng.Slot))
+    {
+        return NULL;
+    }
+    return &gLoggerManager.CmdMng.Slot[((uint8 *)pBuff - pPool) / sizeof(LoggerCmdSlot_t)];
+}
+
+/**
+ * <pre>
+ * void *Logger_CmdBuffAlloc(uint16 Len)
+ * </pre>
+ *  
+ * this function allocates a command input buffer. the buffer is taken from the static command pool,
+ * and only if the pool is full (or not ready before the logger init) it is allocated from the heap.
+ * it is called by the sending task, and the logger task releases the buffer with Logger_CmdBuffFree.
+ *
+ * @param   Len      [in]    the input buffer length in bytes.
+ *
+ * @return a pointer to the input buffer, or NULL if there is no memory
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void *Logger_CmdBuffAlloc(uint16 Len)
+{
+    LoggerCmdMng_t *pCmdMng = &gLoggerManager.CmdMng;
+    LoggerCmdSlot_t *pSlot = NULL;
+    uint32 IntState;
+    uint8 Idx;
+
+    /* the pool is shared by all the sending tasks, it is locked by disabling the interrupts for the short slots search */
+    if(Len <= sizeof(LoggerCmdPayload_u) && gLoggerManager.pCbList != NULL && gLoggerManager.pCbList->DisableInterruptsCb != NULL)
+    {
+        IntState = gLoggerManager.pCbList->DisableInterruptsCb();
+        for(Idx = 0; Idx < LOGGER_CONFIG_CMD_POOL_SIZE && pSlot == NULL; Idx++)
         {
-            Status = gLoggerManager.pCbList->SendUartDataCb(pTempBuff, FlashReadSize);
+            if(!pCmdMng->Slot[pCmdMng->NextSlot].IsUsed)
+            {
+                pSlot = &pCmdMng->Slot[pCmdMng->NextSlot];
+                pSlot->IsUsed = TRUE;
+                pCmdMng->PoolAllocCnt++;
+                if(++pCmdMng->UsedCnt > pCmdMng->MaxUsedCnt)
+                {
+                    pCmdMng->MaxUsedCnt = pCmdMng->UsedCnt;
+                }
+            }
+            pCmdMng->NextSlot = (pCmdMng->NextSlot + 1) % LOGGER_CONFIG_CMD_POOL_SIZE;
         }
-        else
+        gLoggerManager.pCbList->RestoreInterruptsCb(IntState);
+    }
+
+    if(pSlot == NULL)
+    {
+        /* the heap fallback counter is shared by the sending tasks as well */
+        if(gLoggerManager.pCbList != NULL && gLoggerManager.pCbList->DisableInterruptsCb != NULL)
         {
-            Status = gLoggerManager.pCbList->SendSocketDataCb((uint8*)pTempBuff, FlashReadSize, LOGGER_MODE_TYPE_PULL);
+            IntState = gLoggerManager.pCbList->DisableInterruptsCb();
+            pCmdMng->HeapAllocCnt++;
+            gLoggerManager.pCbList->RestoreInterruptsCb(IntState);
         }
-        if(Status != LOGGER_STATUS_OK)
+        else
         {
-            if(Status == LOGGER_STATUS_BUSY)
-            {
-                goto WAIT;
-            }
-            else
-            {
-                OSAL_ASSERT(0);
-                goto EXIT;
-            }
-            
+            pCmdMng->HeapAllocCnt++;
         }
-        Iter+=FlashReadSize;        
-        ReadSizeBytes -= FlashReadSize;
-        
-        if(Iter >= EndAddress)
+        return OSAL_HeapAllocBuffer(OSAL_GetSelfTaskId(), Len);
+    }
+
+    pSlot->SendUs = (gLoggerManager.pCbList->GetTimeUsCb != NULL)? gLoggerManager.pCbList->GetTimeUsCb(): 0;
+    return &pSlot->Payload;
+}
+
+/**
+ * <pre>
+ * void Logger_CmdBuffFree(void **ppBuff)
+ * </pre>
+ *  
+ * this function releases a command input buffer allocated by Logger_CmdBuffAlloc, back to the command pool or to the heap.
+ *
+ * @param   ppBuff      [inout]    a pointer to the input buffer pointer. it is set to NULL.
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_CmdBuffFree(void **ppBuff)
+{
+    LoggerCmdSlot_t *pSlot = Logger_CmdSlotGet(*ppBuff);
+    uint32 IntState;
+
+    if(pSlot == NULL)
+    {
+        OSAL_HeapFreeBuff((uint32 **)ppBuff);
+        return;
+    }
+
+    /* a pool slot is allocated only when the interrupts can be disabled */
+    IntState = gLoggerManager.pCbList->DisableInterruptsCb();
+    pSlot->IsUsed = FALSE;
+    gLoggerManager.CmdMng.UsedCnt--;
+    gLoggerManager.pCbList->RestoreInterruptsCb(IntState);
+    *ppBuff = NULL;
+}
+
+/**
+ * <pre>
+ * void Logger_CmdDone(OSAL_Msg *pMsg)
+ * </pre>
+ *  
+ * this function ends the handling of a logger task message. it measures the command latency (of the pool commands)
+ * and releases the input buffer if requested by the source task.
+ *
+ * @param   pMsg      [in]    the handled message.
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_CmdDone(OSAL_Msg *pMsg)
+{
+    LoggerCmdMng_t *pCmdMng = &gLoggerManager.CmdMng;
+    LoggerCmdSlot_t *pSlot = Logger_CmdSlotGet(pMsg->pDataIn);
+    uint32 LatencyUs;
+
+    pCmdMng->CmdCnt++;
+    if(pSlot != NULL && pSlot->SendUs != 0 && gLoggerManager.pCbList->GetTimeUsCb != NULL)
+    {
+        LatencyUs = gLoggerManager.pCbList->GetTimeUsCb() - pSlot->SendUs;
+        pCmdMng->LatencyCnt++;
+        pCmdMng->LatencyTotalUs += LatencyUs;
+        if(LatencyUs > pCmdMng->LatencyMaxUs)
         {
-            /* make sure we dont read too much */
-            OSAL_ASSERT(Iter<=EndAddress);
-            
-            /* wrap arround - we have reached the end of the flash continue from the begining */
-            Iter = LOGGER_CONFIG_FLASH_START_ADDRESS;
+            pCmdMng->LatencyMaxUs = LatencyUs;
         }
-WAIT:        
-        OSAL_SuspendTask(10);
     }
-                
-    RetVal = TRUE;
-    
-EXIT:
-    /* change task state */
-    Logger_SetState(e_LOGGER_STATE_READY);
 
-    /* free working buffer */    
-    OSAL_HeapFreeBuff((uint32**)&pTempBuff);
-    
-    /* return status */
-    return RetVal;
+    /* free Data In buffer if requested by source task */
+    if((pMsg->CntrlBits & OSAL_MSG_FREE_BY_TARGET) && pMsg->pDataIn != NULL)
+    {
+        Logger_CmdBuffFree(&pMsg->pDataIn);
+    }
 }
 
+/**
+ * <pre>
+ * void Logger_HandleBatchCmd(LoggerBatchCmd_t *pBatch)
+ * </pre>
+ *  
+ * this function sets the RAM logger run time parameters of a batch command. a destination type change moves the logger 
+ * to the new sinks (see Logger_SwitchSinks), it is kept while a FLASH erase or dump is in progress.
+ * a batch with an out of range parameter is rejected as a whole (see Logger_ValidateBatchCmd).
+ *
+ * @param   pBatch      [in]    the batch command. only the parameters of its Fields bits are set.
+ *
+ * @return None
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_HandleBatchCmd(LoggerBatchCmd_t *pBatch)
+{
+    BOOL IsSinkChange = ((pBatch->Fields & LOGGER_BATCH_DEST_TYPE) && pBatch->DestType != LOGGER_DEF_GEN_CONFIG.DestType && 
+                         !Logger_IsFlashOpActive());
+    
+    if(Logger_ValidateBatchCmd(pBatch))
+    {
+        LOG_PRINT(LEVEL_ERROR, "Batch rejected: Fields(%x) Level(%d) DestType(%d)\n", pBatch->Fields, pBatch->LogLevel, pBatch->DestType);
+        return;
+    }
+    
+    if(pBatch->Fields & LOGGER_BATCH_LOG_LEVEL)
+    {
+        LOGGER_DEF_GEN_CONFIG.LogLevel = pBatch->LogLevel;
+    }
+    if(pBatch->Fields & LOGGER_BATCH_MODULE_MASK)
+    {
+        LOGGER_DEF_GEN_CONFIG.ModuleMask = pBatch->ModuleMask;
+    }
+    if(IsSinkChange)
+    {
+        LOGGER_DEF_GEN_CONFIG.DestType = pBatch->DestType;
+        
+        /* all the batch parameters take effect at once, when the logger is switched back on */
+        Logger_SwitchSinks(LOGGER_DEF_GEN_CONFIG.IsEnabled, LOGGER_DEF_GEN_CONFIG.IsEnabled, FALSE);
+        return;
+    }
+    /* all the batch parameters take effect at once */
+    Logger_PublishFilter();
+}
@@ -0,0 +1,867 @@
+#include "Logger_Defs.h"
+#include "Logger_Manager.h"
+#include "Logger_Func.h"
+#include "Logger_Utils.h"
+#include "Logger_Summary.h"
+
+                /* ========================================== *
+                 *          D E F I N I T I O N S             *
+                 * ========================================== */
+
+#define SUMMARY_SECTOR_ADDRESS(IDX)         (LOGGER_CONFIG_FLASH_START_ADDRESS + ((uint32)(IDX)*(LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB<<10)))
+#define SUMMARY_IS_DATE_EMPTY(P_DATE)       (!((P_DATE)->Year | (P_DATE)->Month | (P_DATE)->Day | (P_DATE)->Hour | (P_DATE)->Minute | (P_DATE)->Second))
+#define SUMMARY_RX_DISTANCE(P_FROM, P_TO)   ((uint16)(((P_TO) - (P_FROM) + LOGGER_CONFIG_DOUBLE_BUFFER_SIZE_BYTES) % LOGGER_CONFIG_DOUBLE_BUFFER_SIZE_BYTES))
+#define SUMMARY_FIFO_NEXT(IDX)              (((IDX) + 1) % LOGGER_CONFIG_SUMMARY_TIME_FIFO_SIZE)
+#define SUMMARY_FIFO_COUNT(P_FIFO)          (((P_FIFO)->Tail + LOGGER_CONFIG_SUMMARY_TIME_FIFO_SIZE - (P_FIFO)->Head) % LOGGER_CONFIG_SUMMARY_TIME_FIFO_SIZE)
+#define SUMMARY_SEARCH_CHUNK_SIZE_BYTES     32
+
+                /* ========================================== *
+                 *     P R I V A T E     V A R I A B L E S    *
+                 * ========================================== */
+extern LoggerManager_t gLoggerManager;
+
+                /* ========================================== *
+                 *     P R I V A T E     F U N C T I O N S    *
+                 * ========================================== */
+
+/**
+ * <pre>
+ * static void Logger_SummaryReset(LoggerSectorSummary_t *pSummary)
+ * </pre>
+ *  
+ * this function resets a summary to an empty summary (a summary of a sector without records)
+ *
+ * @param   pSummary        [out]    a pointer to the summary to reset
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_SummaryReset(OUT LoggerSectorSummary_t *pSummary)
+{
+    uint8 Level;
+    uint8 Block;
+
+    pSummary->Magic = 0;
+    pSummary->StartTime = LOGGER_DEF_SUMMARY_NO_TIME;
+    pSummary->EndTime = 0;
+    pSummary->TaskMask = 0;
+
+    for(Level = 0; Level < LEVEL_MAX_NUM; Level++)
+    {
+        pSummary->LevelCnt[Level] = 0;
+    }
+    /* no block was written yet */
+    for(Block = 0; Block < LOGGER_DEF_SUMMARY_NUM_OF_BLOCKS; Block++)
+    {
+        pSummary->BlockTime[Block] = LOGGER_DEF_SUMMARY_NO_TIME;
+    }
+    *(uint8*)&pSummary->Flags = 0;
+    pSummary->CheckSum = 0;
+}
+
+/**
+ * <pre>
+ * static void Logger_SummaryMerge(LoggerSectorSummary_t *pDst, LoggerSectorSummary_t *pSrc)
+ * </pre>
+ *  
+ * this function adds the records of one summary to another summary
+ *
+ * @param   pDst        [inout]    a pointer to the summary to add the records to
+ * @param   pSrc        [in]       a pointer to the summary to add
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_SummaryMerge(INOUT LoggerSectorSummary_t *pDst, IN LoggerSectorSummary_t *pSrc)
+{
+    uint8 Level;
+
+    /* the source holds records that were not counted */
+    if(pSrc->Flags.IsPartial)
+    {
+        pDst->Flags.IsPartial = 1;
+    }
+    /* nothing to merge */
+    if(pSrc->TaskMask == 0)
+    {
+        return;
+    }
+    if(pSrc->StartTime < pDst->StartTime)
+    {
+        pDst->StartTime = pSrc->StartTime;
+    }
+    if(pSrc->EndTime > pDst->EndTime)
+    {
+        pDst->EndTime = pSrc->EndTime;
+    }
+    pDst->TaskMask |= pSrc->TaskMask;
+
+    for(Level = 0; Level < LEVEL_MAX_NUM; Level++)
+    {
+        /* saturate the counter, a filter only needs to know the level is present */
+        pDst->LevelCnt[Level] = (pDst->LevelCnt[Level] + pSrc->LevelCnt[Level] > 0xFFFF)? 0xFFFF: pDst->LevelCnt[Level] + pSrc->LevelCnt[Level];
+    }
+}
+
+/**
+ * <pre>
+ * static uint8 Logger_SummaryCheckSum(LoggerSectorSummary_t *pSummary)
+ * </pre>
+ *  
+ * this function calculates the checksum of a summary record (all the bytes but the checksum itself)
+ *
+ * @param   pSummary        [in]    a pointer to the summary
+ *
+ * @return the summary checksum
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static uint8 Logger_SummaryCheckSum(IN LoggerSectorSummary_t *pSummary)
+{
+    uint8 *pItr = (uint8*)pSummary;
+    uint8 CheckSum = 0;
+
+    while(pItr < &pSummary->CheckSum)
+    {
+        CheckSum += *pItr++;
+    }
+    return ~CheckSum;
+}
+
+/**
+ * <pre>
+ * static BOOL Logger_SummaryIsMatch(LoggerSectorSummary_t *pSummary, LoggerLogFilter_t *pFilter, uint32 StartTime, uint32 EndTime)
+ * </pre>
+ *  
+ * this function checks whether a sector may hold records that match the filter
+ *
+ * @param   pSummary        [in]    a pointer to the sector summary
+ * @param   pFilter         [in]    a pointer to the log filter
+ * @param   StartTime       [in]    the filter packed start time
+ * @param   EndTime         [in]    the filter packed end time
+ *
+ * @return TRUE if the sector may hold matching records, or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static BOOL Logger_SummaryIsMatch(IN LoggerSectorSummary_t *pSummary, IN LoggerLogFilter_t *pFilter, IN uint32 StartTime, IN uint32 EndTime)
+{
+    uint8 Level;
+
+    /* we dont know what the sector holds */
+    if(pSummary->Flags.IsPartial)
+    {
+        return TRUE;
+    }
+    /* none of the tasks has records in the sector (or the sector is empty) */
+    if((pSummary->TaskMask & pFilter->TaskMask) == 0)
+    {
+        return FALSE;
+    }
+    /* the sector time range does not overlap the filter time range */
+    if(pSummary->StartTime > EndTime || pSummary->EndTime < StartTime)
+    {
+        return FALSE;
+    }
+    for(Level = 0; Level <= pFilter->MaxLevel && Level < LEVEL_MAX_NUM; Level++)
+    {
+        if(pSummary->LevelCnt[Level])
+        {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/**
+ * <pre>
+ * static void Logger_SummaryLoad(uint32 SectorAddr, LoggerSectorSummary_t *pSummary)
+ * </pre>
+ *  
+ * this function reads a closed sector summary record from the sector tail.
+ * a sector without a valid record is marked partial (it may match any filter), unless the sector is empty.
+ *
+ * @param   SectorAddr      [in]     the sector address
+ * @param   pSummary        [out]    a pointer to the summary to load
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_SummaryLoad(IN uint32 SectorAddr, OUT LoggerSectorSummary_t *pSummary)
+{
+    uint32 FirstWord = LOGGER_DEF_BLANK_NVR_PARAM_32;
+
+    if(gLoggerManager.pCbList->ReadFlashDataCb(LOGGER_DEF_FLASH_SUMMARY_ADDRESS(SectorAddr), (char*)pSummary, sizeof(LoggerSectorSummary_t)) == LOGGER_STATUS_OK &&
+       pSummary->Magic == LOGGER_DEF_SUMMARY_MAGIC && pSummary->CheckSum == Logger_SummaryCheckSum(pSummary))
+    {
+        return;
+    }
+    Logger_SummaryReset(pSummary);
+
+    /* an erased sector has no records. otherwise the sector was not closed properly (e.g. power loss) */
+    if(gLoggerManager.pCbList->ReadFlashDataCb(SectorAddr, (char*)&FirstWord, sizeof(FirstWord)) != LOGGER_STATUS_OK ||
+       FirstWord != LOGGER_DEF_BLANK_NVR_PARAM_32)
+    {
+        pSummary->Flags.IsPartial = 1;
+    }
+}
+
+/**
+ * <pre>
+ * static void Logger_SummaryGetSector(uint8 Idx, LoggerSectorSummary_t *pSummary)
+ * </pre>
+ *  
+ * this function returns a copy of a sector summary.
+ * the current sector also holds pending records that were written before the RX buffer was emptied, so they are added to its copy.
+ *
+ * @param   Idx             [in]     the sector index
+ * @param   pSummary        [out]    a pointer to the summary copy
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_SummaryGetSector(IN uint8 Idx, OUT LoggerSectorSummary_t *pSummary)
+{
+    *pSummary = gLoggerManager.SectorSummary[Idx];
+
+    if(Idx == LOGGER_DEF_FLASH_SECTOR_INDEX(gLoggerManager.FlashMng.CurrSectorAddr))
+    {
+        Logger_SummaryMerge(pSummary, &gLoggerManager.PendingSummary);
+    }
+}
+
+/**
+ * <pre>
+ * static uint8 Logger_SummarySearchSector(uint8 OldestIdx, uint8 NumOfSectors, uint32 Time, BOOL IsPartialAfter)
+ * </pre>
+ *  
+ * this function binary searches the log sectors (from the oldest sector to the current sector, wrapping around the FLASH segment)
+ * for the first sector that starts after a given time. the sectors start times grow along the log, a partial sector
+ * start time is unknown and it is taken as after or before the time according to the caller.
+ *
+ * @param   OldestIdx           [in]    the index of the oldest log sector
+ * @param   NumOfSectors        [in]    the number of log sectors
+ * @param   Time                [in]    the packed time to search
+ * @param   IsPartialAfter      [in]    is a partial sector taken as starting after the time
+ *
+ * @return the position of the first sector (counted from the oldest sector) that starts after the time, or NumOfSectors if none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static uint8 Logger_SummarySearchSector(IN uint8 OldestIdx, IN uint8 NumOfSectors, IN uint32 Time, IN BOOL IsPartialAfter)
+{
+    uint8 TotalSectors = LOGGER_DEF_FLASH_NUM_OF_DEBUG_SECTORS(gLoggerManager.Config.General.FlashSize);
+    uint8 Low = 0;
+    uint8 High = NumOfSectors;
+
+    while(Low < High)
+    {
+        uint8 Mid = (Low + High)>>1;
+        LoggerSectorSummary_t Summary;
+        BOOL IsAfter;
+
+        Logger_SummaryGetSector((OldestIdx + Mid) % TotalSectors, &Summary);
+
+        IsAfter = Summary.Flags.IsPartial? IsPartialAfter: (Summary.StartTime > Time);
+        if(IsAfter)
+        {
+            High = Mid;
+        }
+        else
+        {
+            Low = Mid + 1;
+        }
+    }
+    return Low;
+}
+
+/**
+ * <pre>
+ * static uint8 Logger_SummarySearchBlock(LoggerSectorSummary_t *pSummary, uint32 Time)
+ * </pre>
+ *  
+ * this function binary searches a sector for the first block that starts after a given time.
+ * blocks that were not written yet are taken as after any time.
+ *
+ * @param   pSummary        [in]    a pointer to the sector summary
+ * @param   Time            [in]    the packed time to search
+ *
+ * @return the first block that starts after the time, or LOGGER_DEF_SUMMARY_NUM_OF_BLOCKS if none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static uint8 Logger_SummarySearchBlock(IN LoggerSectorSummary_t *pSummary, IN uint32 Time)
+{
+    uint8 Low = 0;
+    uint8 High = LOGGER_DEF_SUMMARY_NUM_OF_BLOCKS;
+
+    while(Low < High)
+    {
+        uint8 Mid = (Low + High)>>1;
+
+        if(pSummary->BlockTime[Mid] > Time)
+        {
+            High = Mid;
+        }
+        else
+        {
+            Low = Mid + 1;
+        }
+    }
+    return Low;
+}
+
+/**
+ * <pre>
+ * static uint32 Logger_SummaryFindRecordStart(uint32 Address, uint32 EndAddress)
+ * </pre>
+ *  
+ * this function reads the FLASH from a given address up to the end of the first record (the first new line)
+ *
+ * @param   Address         [in]    the FLASH address to start from
+ * @param   EndAddress      [in]    the FLASH address to stop at
+ *
+ * @return the address of the next record, or EndAddress if no record ends before it
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static uint32 Logger_SummaryFindRecordStart(IN uint32 Address, IN uint32 EndAddress)
+{
+    char Chunk[SUMMARY_SEARCH_CHUNK_SIZE_BYTES];
+
+    while(Address < EndAddress)
+    {
+        uint16 Len = (EndAddress - Address > SUMMARY_SEARCH_CHUNK_SIZE_BYTES)? SUMMARY_SEARCH_CHUNK_SIZE_BYTES: EndAddress - Address;
+        uint16 Idx;
+
+        if(gLoggerManager.pCbList->ReadFlashDataCb(Address, Chunk, Len) != LOGGER_STATUS_OK)
+        {
+            break;
+        }
+        for(Idx = 0; Idx < Len; Idx++)
+        {
+            if(Chunk[Idx] == '\n')
+            {
+                return Address + Idx + 1;
+            }
+        }
+        Address += Len;
+    }
+    return EndAddress;
+}
+
+                /* ========================================== *
+                 *     P U B L I C     F U N C T I O N S      *
+                 * ========================================== */
+
+/**
+ * <pre>
+ * uint32 Logger_PackDateAndTime(LoggerDateAndTime_t *pDateAndTime)
+ * </pre>
+ *  
+ * this function packs a date and time into a number of seconds that can be compared.
+ * months are taken as 31 days and years modulo 100, so the result fits in 32 bits.
+ *
+ * @param   pDateAndTime        [in]    a pointer to the date and time to pack
+ *
+ * @return the packed date and time
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+uint32 Logger_PackDateAndTime(IN LoggerDateAndTime_t *pDateAndTime)
+{
+    uint32 Packed = (pDateAndTime->Year%100)*12 + (pDateAndTime->Month? pDateAndTime->Month - 1: 0);
+
+    Packed = Packed*31 + (pDateAndTime->Day? pDateAndTime->Day - 1: 0);
+    Packed = Packed*24 + pDateAndTime->Hour;
+    Packed = Packed*60 + pDateAndTime->Minute;
+
+    return Packed*60 + pDateAndTime->Second;
+}
+
+/**
+ * <pre>
+ * void Logger_SummaryInit(void)
+ * </pre>
+ *  
+ * this function initializes the sectors summaries once the logger FLASH is initialized.
+ * closed sectors summaries are read from FLASH. the records of the current sector are unknown after reset,
+ * so the current sector is marked partial unless it is empty.
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SummaryInit(void)
+{
+    uint8 Idx;
+    uint8 NumOfSectors = LOGGER_DEF_FLASH_NUM_OF_DEBUG_SECTORS(gLoggerManager.Config.General.FlashSize);
+    uint8 CurrIdx = LOGGER_DEF_FLASH_SECTOR_INDEX(gLoggerManager.FlashMng.CurrSectorAddr);
+
+    Logger_SummaryReset(&gLoggerManager.PendingSummary);
+    gLoggerManager.RecordTimeFifo.Head = gLoggerManager.RecordTimeFifo.Tail = 0;
+
+    /* the log messages recovered after reset were not counted, the sectors they are written to may match any filter */
+    if(gLoggerManager.Flags.IsRecovered)
+    {
+        gLoggerManager.PendingSummary.Flags.IsPartial = 1;
+    }
+
+    for(Idx = 0; Idx < NumOfSectors; Idx++)
+    {
+        LoggerSectorSummary_t *pSummary = &gLoggerManager.SectorSummary[Idx];
+
+        if(gLoggerManager.pCbList->ReadFlashDataCb == NULL)
+        {
+            /* we cant read the summaries, every sector may match */
+            Logger_SummaryReset(pSummary);
+            pSummary->Flags.IsPartial = 1;
+        }
+        else if(Idx != CurrIdx || gLoggerManager.FlashMng.Flags.IsSummaryWritten)
+        {
+            Logger_SummaryLoad(SUMMARY_SECTOR_ADDRESS(Idx), pSummary);
+        }
+        else
+        {
+            Logger_SummaryReset(pSummary);
+            pSummary->Flags.IsPartial = (gLoggerManager.FlashMng.WriteAddr != gLoggerManager.FlashMng.CurrSectorAddr);
+        }
+    }
+}
+
+/**
+ * <pre>
+ * uint32 Logger_SummaryAddRecord(uint8 Level, uint8 TaskId)
+ * </pre>
+ *  
+ * this function adds a new log record to the pending summary (the records that were not written to FLASH yet).
+ * NOTE: this function is called from Logger_printf under the RX buffer mutex
+ *
+ * @param   Level       [in]    the record log level
+ * @param   TaskId      [in]    the ID of the task that has printed the record
+ *
+ * @return the record packed time (0 if the time is unknown)
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+uint32 Logger_SummaryAddRecord(IN uint8 Level, IN uint8 TaskId)
+{
+    LoggerSectorSummary_t *pPending = &gLoggerManager.PendingSummary;
+    LoggerDateAndTime_t DateAndTime;
+    uint32 Now = 0;
+
+    if(gLoggerManager.pCbList->GetDateAndTimeCb != NULL && gLoggerManager.pCbList->GetDateAndTimeCb(&DateAndTime) == LOGGER_STATUS_OK)
+    {
+        Now = Logger_PackDateAndTime(&DateAndTime);
+        if(Now < pPending->StartTime)
+        {
+            pPending->StartTime = Now;
+        }
+        if(Now > pPending->EndTime)
+        {
+            pPending->EndTime = Now;
+        }
+    }
+    else
+    {
+        /* the record time is unknown, it may match any time range */
+        pPending->StartTime = 0;
+        pPending->EndTime = LOGGER_DEF_SUMMARY_NO_TIME;
+    }
+    pPending->TaskMask |= (1<<TaskId);
+
+    if(Level < LEVEL_MAX_NUM && pPending->LevelCnt[Level] < 0xFFFF)
+    {
+        pPending->LevelCnt[Level]++;
+    }
+    return Now;
+}
+
+/**
+ * <pre>
+ * void Logger_SummaryAddRecordEnd(uint32 Time, char *pEnd)
+ * </pre>
+ *  
+ * this function keeps the time of a new log record until the record is written to FLASH, so the time of the first record
+ * of every FLASH block is known. records with the same time share an entry, and when the FIFO is full the record joins the
+ * newest entry (the entry time is a lower bound of its records times).
+ * NOTE: this function is called from Logger_printf under the RX buffer mutex
+ *
+ * @param   Time        [in]    the record packed time
+ * @param   pEnd        [in]    the RX buffer position after the record
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SummaryAddRecordEnd(IN uint32 Time, IN char *pEnd)
+{
+    LoggerRecordTimeFifo_t *pFifo = &gLoggerManager.RecordTimeFifo;
+    uint8 Count = SUMMARY_FIFO_COUNT(pFifo);
+    uint8 Last = (pFifo->Tail + LOGGER_CONFIG_SUMMARY_TIME_FIFO_SIZE - 1) % LOGGER_CONFIG_SUMMARY_TIME_FIFO_SIZE;
+
+    /* the oldest entry may be released by the drain task, so only a newer entry is extended */
+    if(Count >= 2 && (pFifo->Entry[Last].Time == Time || Count == LOGGER_CONFIG_SUMMARY_TIME_FIFO_SIZE - 1))
+    {
+        pFifo->Entry[Last].pEnd = pEnd;
+        return;
+    }
+    pFifo->Entry[pFifo->Tail].pEnd = pEnd;
+    pFifo->Entry[pFifo->Tail].Time = Time;
+    pFifo->Tail = SUMMARY_FIFO_NEXT(pFifo->Tail);
+}
+
+/**
+ * <pre>
+ * void Logger_SummaryRecordsWritten(uint32 Address, char *pRead, uint16 Size)
+ * </pre>
+ *  
+ * this function updates the times of the FLASH blocks that were written, and releases the times of the records
+ * that were fully written.
+ * NOTE: this function is called from the drain task (see Logger_DrainRxBuffers), under the FLASH sink lock (see Logger_FlashSinkLock)
+ *
+ * @param   Address     [in]    the FLASH address the RX buffer was written to
+ * @param   pRead       [in]    the RX buffer position that was written (NULL if the records times are not kept, the blocks
+ *                                  are then marked as of any time)
+ * @param   Size        [in]    the written size in bytes
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SummaryRecordsWritten(IN uint32 Address, IN char *pRead, IN uint16 Size)
+{
+    LoggerRecordTimeFifo_t *pFifo = &gLoggerManager.RecordTimeFifo;
+    LoggerSectorSummary_t *pSummary = &gLoggerManager.SectorSummary[LOGGER_DEF_FLASH_SECTOR_INDEX(Address)];
+    uint32 SectorAddr = LOGGER_DEF_FLASH_SECTOR_START_ADDRESS(Address);
+    uint8 Block = (Address - SectorAddr)/LOGGER_CONFIG_SUMMARY_BLOCK_SIZE_BYTES;
+    uint8 LastBlock = (Address + Size - 1 - SectorAddr)/LOGGER_CONFIG_SUMMARY_BLOCK_SIZE_BYTES;
+    uint8 Itr = pFifo->Head;
+
+    if(Size == 0)
+    {
+        return;
+    }
+    /* the ERROR and CRITICAL records buffer does not keep the records times */
+    if(pRead == NULL)
+    {
+        for(; Block <= LastBlock; Block++)
+        {
+            if(pSummary->BlockTime[Block] == LOGGER_DEF_SUMMARY_NO_TIME)
+            {
+                pSummary->BlockTime[Block] = 0;
+            }
+        }
+        return;
+    }
+    for(; Block <= LastBlock; Block++)
+    {
+        uint32 BlockAddr = SectorAddr + (uint32)Block*LOGGER_CONFIG_SUMMARY_BLOCK_SIZE_BYTES;
+        uint16 Offset = (BlockAddr > Address)? BlockAddr - Address: 0;
+
+        if(pSummary->BlockTime[Block] != LOGGER_DEF_SUMMARY_NO_TIME)
+        {
+            continue;
+        }
+        /* find the record the block starts with */
+        while(Itr != pFifo->Tail && SUMMARY_RX_DISTANCE(pRead, pFifo->Entry[Itr].pEnd) <= Offset)
+        {
+            Itr = SUMMARY_FIFO_NEXT(Itr);
+        }
+        /* a record without a known time may be of any time */
+        pSummary->BlockTime[Block] = (Itr != pFifo->Tail)? pFifo->Entry[Itr].Time: 0;
+    }
+    /* release the records that were fully written */
+    while(pFifo->Head != pFifo->Tail && SUMMARY_RX_DISTANCE(pRead, pFifo->Entry[pFifo->Head].pEnd) <= Size)
+    {
+        pFifo->Head = SUMMARY_FIFO_NEXT(pFifo->Head);
+    }
+}
+
+/**
+ * <pre>
+ * void Logger_SummaryRecordsSkipped(char *pRead, char *pWrite)
+ * </pre>
+ *  
+ * this function releases the times of the records that were overwritten in the RX buffer before they were written to FLASH.
+ * NOTE: this function is called from Logger_printf (RX buffer overrun) under the RX buffer mutex
+ *
+ * @param   pRead       [in]    the RX buffer position the FLASH is written from
+ * @param   pWrite      [in]    the RX buffer write position
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SummaryRecordsSkipped(IN char *pRead, IN char *pWrite)
+{
+    LoggerRecordTimeFifo_t *pFifo = &gLoggerManager.RecordTimeFifo;
+    uint16 Used = SUMMARY_RX_DISTANCE(pRead, pWrite);
+
+    /* a record that ends outside of the pending RX buffer range was overwritten */
+    while(pFifo->Head != pFifo->Tail && (SUMMARY_RX_DISTANCE(pRead, pFifo->Entry[pFifo->Head].pEnd) == 0 || 
+                                         SUMMARY_RX_DISTANCE(pRead, pFifo->Entry[pFifo->Head].pEnd) > Used))
+    {
+        pFifo->Head = SUMMARY_FIFO_NEXT(pFifo->Head);
+    }
+}
+
+/**
+ * <pre>
+ * void Logger_SummaryMergePending(uint32 SectorAddr)
+ * </pre>
+ *  
+ * this function moves the pending summary into a sector summary, once all the pending records were written to the sector.
+ * NOTE: this function is called from the drain task (see Logger_DrainRxBuffers), under the FLASH sink lock (see Logger_FlashSinkLock)
+ *
+ * @param   SectorAddr      [in]    the address of the sector the records were written to
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SummaryMergePending(IN uint32 SectorAddr)
+{
+    Logger_SummaryMerge(&gLoggerManager.SectorSummary[LOGGER_DEF_FLASH_SECTOR_INDEX(SectorAddr)], &gLoggerManager.PendingSummary);
+
+    Logger_SummaryReset(&gLoggerManager.PendingSummary);
+}
+
+/**
+ * <pre>
+ * LOGGER_STATUS Logger_SummaryClose(uint32 SectorAddr)
+ * </pre>
+ *  
+ * this function finalizes a full sector summary and writes it to the sector tail.
+ * the records that are still pending may have been written to this sector, so they are added to its summary
+ * but kept pending, to be added to the next sector as well. the pending summary is merged under the FLASH sink lock,
+ * the summary is written without it.
+ * NOTE: this function is called from the drain task (see Logger_DrainRxBuffers)
+ *
+ * @param   SectorAddr      [in]    the address of the sector to close
+ *
+ * @return LOGGER_STATUS_OK on success, or negative value otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+LOGGER_STATUS Logger_SummaryClose(IN uint32 SectorAddr)
+{
+    LoggerSectorSummary_t *pSummary = &gLoggerManager.SectorSummary[LOGGER_DEF_FLASH_SECTOR_INDEX(SectorAddr)];
+    uint16 Len = sizeof(LoggerSectorSummary_t);
+    BOOL IsLocked = Logger_FlashSinkLock();
+
+    Logger_SummaryMerge(pSummary, &gLoggerManager.PendingSummary);
+    Logger_FlashSinkUnlock(IsLocked);
+
+    pSummary->Magic = LOGGER_DEF_SUMMARY_MAGIC;
+    pSummary->CheckSum = Logger_SummaryCheckSum(pSummary);
+
+    if(gLoggerManager.pCbList->SendFlashDataCb(LOGGER_DEF_FLASH_SUMMARY_ADDRESS(SectorAddr), (char*)pSummary, &Len) != LOGGER_STATUS_OK ||
+       Len != sizeof(LoggerSectorSummary_t))
+    {
+        return LOGGER_STATUS_FLASH_WRITE_ERROR;
+    }
+    return LOGGER_STATUS_OK;
+}
+
+/**
+ * <pre>
+ * void Logger_SummaryOpen(uint32 SectorAddr)
+ * </pre>
+ *  
+ * this function starts a new summary for a sector that was just erased and is about to be written
+ * NOTE: this function is called from the drain task (see Logger_DrainRxBuffers), under the FLASH sink lock (see Logger_FlashSinkLock)
+ *
+ * @param   SectorAddr      [in]    the address of the new sector
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_SummaryOpen(IN uint32 SectorAddr)
+{
+    LoggerSectorSummary_t *pSummary = &gLoggerManager.SectorSummary[LOGGER_DEF_FLASH_SECTOR_INDEX(SectorAddr)];
+
+    Logger_SummaryReset(pSummary);
+
+    /* the pending records are written to the new sector */
+    Logger_SummaryMerge(pSummary, &gLoggerManager.PendingSummary);
+}
+
+/**
+ * <pre>
+ * uint8 Logger_SummaryGetSectorMask(LoggerLogFilter_t *pFilter)
+ * </pre>
+ *  
+ * this function returns the sectors that may hold records matching the filter.
+ * the filter is applied in sector granularity, a matching sector is sent as a whole.
+ *
+ * @param   pFilter      [in]    a pointer to the log filter
+ *
+ * @return the matching sectors, bit per sector
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+uint8 Logger_SummaryGetSectorMask(IN LoggerLogFilter_t *pFilter)
+{
+    uint8 Idx;
+    uint8 SectorMask = 0;
+    uint8 NumOfSectors = LOGGER_DEF_FLASH_NUM_OF_DEBUG_SECTORS(gLoggerManager.Config.General.FlashSize);
+    uint32 StartTime = SUMMARY_IS_DATE_EMPTY(&pFilter->StartTime)? 0: Logger_PackDateAndTime(&pFilter->StartTime);
+    uint32 EndTime = SUMMARY_IS_DATE_EMPTY(&pFilter->EndTime)? LOGGER_DEF_SUMMARY_NO_TIME: Logger_PackDateAndTime(&pFilter->EndTime);
+
+    for(Idx = 0; Idx < NumOfSectors; Idx++)
+    {
+        LoggerSectorSummary_t Summary;
+
+        Logger_SummaryGetSector(Idx, &Summary);
+
+        if(Logger_SummaryIsMatch(&Summary, pFilter, StartTime, EndTime))
+        {
+            SectorMask |= (1<<Idx);
+        }
+    }
+    return SectorMask;
+}
+
+/**
+ * <pre>
+ * BOOL Logger_SummaryFindTimeRange(LoggerLogFilter_t *pFilter, uint32 *pStartAddr, int *pSizeBytes)
+ * </pre>
+ *  
+ * this function finds the FLASH range that holds the records of the filter time range.
+ * the first sector of the range is found by a binary search over the sectors start times (wrapping around the FLASH segment),
+ * then the first block by a binary search over the sector blocks times, and the range is aligned to the records boundaries.
+ * the sectors and blocks times are lower bounds of their records times, so the range may start a little earlier than the
+ * start time but never misses a record of the time range.
+ *
+ * @param   pFilter         [in]     a pointer to the log filter
+ * @param   pStartAddr      [out]    the range FLASH start address
+ * @param   pSizeBytes      [out]    the range size in bytes (0 if no record is in the time range)
+ *
+ * @return TRUE if the range was set, or FALSE if the filter has no time range
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+BOOL Logger_SummaryFindTimeRange(IN LoggerLogFilter_t *pFilter, OUT uint32 *pStartAddr, OUT int *pSizeBytes)
+{
+    LoggerFLASHManager_t *pFlashMng = &gLoggerManager.FlashMng;
+    uint8 TotalSectors = LOGGER_DEF_FLASH_NUM_OF_DEBUG_SECTORS(gLoggerManager.Config.General.FlashSize);
+    uint32 SegmentSize = (uint32)gLoggerManager.Config.General.FlashSize<<10;
+    uint8 CurrIdx = LOGGER_DEF_FLASH_SECTOR_INDEX(pFlashMng->CurrSectorAddr);
+    uint8 OldestIdx = LOGGER_DEF_FLASH_SECTOR_INDEX(pFlashMng->ReadAddr);
+    uint8 NumOfSectors = (CurrIdx + TotalSectors - OldestIdx) % TotalSectors + 1;
+    BOOL IsAlign = (gLoggerManager.pCbList->ReadFlashDataCb != NULL);
+    uint32 StartAddr = pFlashMng->ReadAddr;
+    uint32 EndAddr = pFlashMng->WriteAddr;
+    uint8 First = 0;
+    uint32 StartPos;
+    uint32 EndPos;
+
+    if(SUMMARY_IS_DATE_EMPTY(&pFilter->StartTime) && SUMMARY_IS_DATE_EMPTY(&pFilter->EndTime))
+    {
+        return FALSE;
+    }
+    if(!SUMMARY_IS_DATE_EMPTY(&pFilter->StartTime))
+    {
+        uint32 StartTime = Logger_PackDateAndTime(&pFilter->StartTime);
+
+        if(StartTime > 0)
+        {
+            LoggerSectorSummary_t Summary;
+            uint8 Idx;
+            uint32 SectorAddr;
+            uint32 DataEndAddr;
+            uint8 Block;
+
+            /* the first record of the range is in the last sector (and block) that starts before the start time */
+            First = Logger_SummarySearchSector(OldestIdx, NumOfSectors, StartTime - 1, TRUE);
+            First = First? First - 1: 0;
+            Idx = (OldestIdx + First) % TotalSectors;
+            SectorAddr = SUMMARY_SECTOR_ADDRESS(Idx);
+            DataEndAddr = (Idx == CurrIdx)? pFlashMng->WriteAddr: LOGGER_DEF_FLASH_SUMMARY_ADDRESS(SectorAddr);
+
+            Logger_SummaryGetSector(Idx, &Summary);
+            Block = Summary.Flags.IsPartial? 0: Logger_SummarySearchBlock(&Summary, StartTime - 1);
+            Block = Block? Block - 1: 0;
+            StartAddr = SectorAddr + (uint32)Block*LOGGER_CONFIG_SUMMARY_BLOCK_SIZE_BYTES;
+
+            /* skip the end of the record that was started before the block */
+            if(StartAddr != pFlashMng->ReadAddr && IsAlign)
+            {
+                StartAddr = Logger_SummaryFindRecordStart(StartAddr, DataEndAddr);
+            }
+        }
+    }
+    if(!SUMMARY_IS_DATE_EMPTY(&pFilter->EndTime))
+    {
+        uint32 EndTime = Logger_PackDateAndTime(&pFilter->EndTime);
+        LoggerSectorSummary_t Summary;
+        uint8 Idx;
+        uint32 SectorAddr;
+        uint32 DataEndAddr;
+        uint8 Block;
+        uint8 Last;
+
+        /* the last record of the range is in the last sector that starts before or at the end time,
+           before the first block that starts after the end time */
+        Last = Logger_SummarySearchSector(OldestIdx, NumOfSectors, EndTime, FALSE);
+        if(Last == 0)
+        {
+            /* the log starts after the end time */
+            *pStartAddr = StartAddr;
+            *pSizeBytes = 0;
+            return TRUE;
+        }
+        Last = (Last - 1 > First)? Last - 1: First;
+        Idx = (OldestIdx + Last) % TotalSectors;
+        SectorAddr = SUMMARY_SECTOR_ADDRESS(Idx);
+        DataEndAddr = (Idx == CurrIdx)? pFlashMng->WriteAddr: LOGGER_DEF_FLASH_SUMMARY_ADDRESS(SectorAddr);
+
+        Logger_SummaryGetSector(Idx, &Summary);
+        Block = Summary.Flags.IsPartial? LOGGER_DEF_SUMMARY_NUM_OF_BLOCKS: Logger_SummarySearchBlock(&Summary, EndTime);
+        EndAddr = SectorAddr + (uint32)Block*LOGGER_CONFIG_SUMMARY_BLOCK_SIZE_BYTES;
+
+        if(EndAddr >= DataEndAddr)
+        {
+            EndAddr = DataEndAddr;
+        }
+        else if(IsAlign)
+        {
+            /* include the end of the record that was started before the block */
+            EndAddr = Logger_SummaryFindRecordStart(EndAddr, DataEndAddr);
+        }
+    }
+    /* the range positions from the oldest log record */
+    StartPos = (StartAddr + SegmentSize - pFlashMng->ReadAddr) % SegmentSize;
+    EndPos = (EndAddr + SegmentSize - pFlashMng->ReadAddr) % SegmentSize;
+
+    *pStartAddr = StartAddr;
+    *pSizeBytes = (EndPos > StartPos)? (int)(EndPos - StartPos): 0;
+
+    return TRUE;
+}
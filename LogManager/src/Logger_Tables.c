@@ -20,6 +20,8 @@ const char * LoggerDestTypeStr[] = {
     "NONE",
     "FLASH",
     "SOCKET",
+    "RS232",
+    "FLASH_SOCKET",
 };
 
 const char * LoggerModeStr[] = {
@@ -27,6 +29,7 @@ const char * LoggerModeStr[] = {
     "PULL",
     "TEST",
     "NONE",
+    "PUSH_PULL",
 };
 
 const char * LoggerSocketTypeStr[] = {
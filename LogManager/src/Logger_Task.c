@@ -2,13 +2,15 @@
  * Author: Joshua Levi
  * Date: 14/01/2020
  * Description: initial implementetion
- * -------------------------------------------------------------------------------------
+ * -------------------------------------------------------------------------------------*/
 
 #include "Logger_Defs.h"
-#include "Logger_Func.h"
 #include "Logger_Manager.h"
+#include "Logger_Func.h"
 #include "DebugTask.h"
 
+extern LoggerManager_t gLoggerManager;
+
                 /* ========================================== *
                  *     P U B L I C     F U N C T I O N S      *
                  * ========================================== */
@@ -24,6 +26,8 @@ OSAL_TASK LogManagerTask( void * pTaskId )
     /* This flag indicates wheather logger manager task should be ended */
     BOOL IsTaskEnd = FALSE;
     
+    gLoggerManager.CmdMng.TaskStartCnt++;
+    
     /* ******************** main while loop for receiving a message ***************** */
     while( !IsTaskEnd)
     {
@@ -92,17 +96,20 @@ OSAL_TASK LogManagerTask( void * pTaskId )
                 
                 /* handle pull log buffer command */
             case e_LOGGER_CMD_UPLOAD_DEBUG_LOG:
-                /* TODO: call FTP task to send the debug log message*/
-                Logger_SendLogFileToServer((LoggerFtpConfig_t *)pRxMsg->pDataIn, (LoggerSocketConfig_t *)pRxMsg->pDataOut);
+            {
+                LoggerUploadCmd_t *pUploadCmd = (LoggerUploadCmd_t *)pRxMsg->pDataIn;
+                
+                Logger_SendLogFileToServer(&pUploadCmd->Ftp, (LoggerSocketConfig_t *)pRxMsg->pDataOut, pUploadCmd->IsFiltered? &pUploadCmd->Filter: NULL);
                 if(pRxMsg->pDataOut)
                 {
-                    OSAL_HeapFreeBuff((uint32**)&pRxMsg->pDataOut);
+                    Logger_CmdBuffFree(&pRxMsg->pDataOut);
                 }
                 break;
+            }
                 
-                /* handle dump log buffer command */
+                /* handle dump log buffer command (the optional log filter is in the input buffer) */
             case e_LOGGER_CMD_DUMP_DEBUG_LOG:
-                Logger_SendDebugLog(pRxMsg->userTag, LOGGER_DEST_TYPE_RS232);
+                Logger_SendDebugLog(pRxMsg->userTag, (LoggerLogFilter_t *)pRxMsg->pDataIn, LOGGER_DEST_TYPE_RS232);
                 break;
                 
             case OSAL_TIMER_MNG_TIMER_EXPIRE_CMD:
@@ -117,19 +124,42 @@ OSAL_TASK LogManagerTask( void * pTaskId )
                 Logger_SendConfigToSrv(pRxMsg->userTag);
                 break;
                 
+            case e_LOGGER_CMD_SEND_TASK_STATS_TO_SRV:
+                Logger_SendTaskStatsToSrv();
+                break;
+                
+            case e_LOGGER_CMD_SEND_TOP_SITES_TO_SRV:
+                Logger_SendTopSitesToSrv(pRxMsg->userTag & 0xFF, (pRxMsg->userTag >> 8) & 1);
+                break;
+                
+            case e_LOGGER_CMD_SET_TELEMETRY_INTERVAL:
+                Logger_SetTelemetryInterval(pRxMsg->userTag);
+                break;
+                
+                /* handle asynchronous FLASH read\erase completion */
+            case e_LOGGER_CMD_FLASH_COMPLETION:
+                Logger_HandleFlashCompletion((LOGGER_STATUS)pRxMsg->userTag);
+                break;
+                
+                /* handle set several run time parameters command */
+            case e_LOGGER_CMD_BATCH:
+                Logger_HandleBatchCmd((LoggerBatchCmd_t *)pRxMsg->pDataIn);
+                break;
+                
                 /* unknown command error */
             default:
                 OSAL_ASSERT(0); 
             }
         }
-        ///Free Data In buffer if requested by source task. 
-        if( (pRxMsg->CntrlBits & OSAL_MSG_FREE_BY_TARGET) && pRxMsg->pDataIn != NULL)
-            OSAL_HeapFreeBuff( (uint32 **)&(pRxMsg->pDataIn) );
+        ///Free Data In buffer if requested by source task (back to the command pool or to the heap). 
+        Logger_CmdDone(pRxMsg);
         
         OSAL_MsgFree(pRxMsg);
     
-        /* added killing logger task after every command has been handled, to release its 512 bytes buffer */
-        IsTaskEnd = TRUE;   
+        /* added killing logger task after every command has been handled, to release its 512 bytes buffer.
+           the task is kept alive while a FLASH state machine is waiting for its completions, or always 
+           with LOGGER_CONFIG_PERSISTENT_CMD_TASK, so back to back commands do not pay the task start and end */
+        IsTaskEnd = !LOGGER_CONFIG_PERSISTENT_CMD_TASK && !Logger_IsFlashOpActive();   
         Dbg_SetTestPoint( TaskId , pRxMsg->cmd , 100 ,0 );
     }//while ( !IsTaskEnd)
     /* kill task */
@@ -140,3 +170,38 @@ OSAL_TASK LogManagerTask( void * pTaskId )
 OSAL_ERROR_HANDLER LogManagerTaskErrorHandler( uint32 ErrorCode )
 {
 }
+
+/* the drain task sends the RX buffers to the sinks. it should have a low priority, 
+   so the sinks I/O does not delay the real time tasks. it is woken up by the logger TX timer interrupt */
+OSAL_TASK LogDrainTask( void * pTaskId )
+{
+    /* Logger drain task ID */
+    uint8 TaskId = OSAL_TASK_EXTRACT_TASK_ID( pTaskId );
+    
+    /* the received message pointer definiton */
+    OSAL_Msg * pRxMsg = NULL;
+    
+    /* ******************** main while loop for receiving a message ***************** */
+    while(TRUE)
+    {
+        /* wait for input osal message */
+        pRxMsg = OSAL_WaitOnMessage( TaskId );
+        
+        switch(pRxMsg->cmd) {
+            
+            /* handle the TX timer wake up */
+        case e_LOGGER_CMD_DRAIN:
+            Logger_DrainRxBuffers();
+            break;
+            
+            /* unknown command error */
+        default:
+            OSAL_ASSERT(0); 
+        }
+        OSAL_MsgFree(pRxMsg);
+    }
+}
+
+OSAL_ERROR_HANDLER LogDrainTaskErrorHandler( uint32 ErrorCode )
+{
+}
@@ -3,11 +3,15 @@
 #include "Logger_Defs.h"
 #include "Logger_Manager.h"
 #include "Logger_Func.h"
+#include "Logger_Summary.h"
 #include "Logger_Release.h"
 #include "RTC_API.h"
 #include "clock.h"
 #include "SSP_SPI_API.h"
 #include "FLASH_API.h"
+#ifdef __ICCARM__
+#include <intrinsics.h>
+#endif
 
                 /* ========================================== *
                  *          D E F I N I T I O N S             *
@@ -16,16 +20,43 @@
 #define CALC_REMAIN_BUFF_SIZE(P_READ, P_WRITE, BUF_SIZE)    ((P_READ>P_WRITE)?(P_READ-P_WRITE):(BUF_SIZE - (P_WRITE - P_READ)))
 #define CALC_BUF_SIZE_TO_READ(P_READ, P_WRITE, P_TAIL)      (P_WRITE>=P_READ)?(P_WRITE - P_READ):(P_TAIL - P_READ)
 
-#define P_BUFF_ITER                                         gLoggerManager.RxBuffer.pWrite
-#define P_BUFF_TAIL                                         gLoggerManager.RxBuffer.pTail
-#define P_BUFF_HEAD                                         gLoggerManager.RxBuffer.pHead
-#define P_BUFF_WRITE                                        gLoggerManager.RxBuffer.pWrite
-#define P_BUFF_READ                                         gLoggerManager.RxBuffer.pRead
+/* the current message is parsed to the staging buffer, and then committed to its RX buffer (see Logger_printf) */
+#define P_BUFF_ITER                                         gLoggerStagingBuffer.pWrite
+#define P_BUFF_TAIL                                         gLoggerStagingBuffer.pTail
+#define P_BUFF_HEAD                                         gLoggerStagingBuffer.pHead
+#define P_BUFF_WRITE                                        gLoggerStagingBuffer.pWrite
+#define P_BUFF_SIZE                                         (P_BUFF_TAIL - P_BUFF_HEAD)
+#define CALC_RX_DISTANCE(P_RX, P_FROM, P_TO)                ((uint16)(((P_TO) - (P_FROM) + ((P_RX)->pTail - (P_RX)->pHead)) % ((P_RX)->pTail - (P_RX)->pHead)))
+#define CALC_RX_FREE_SIZE(P_RX)                             ((uint16)(((P_RX)->pTail - (P_RX)->pHead) - 1 - CALC_RX_DISTANCE(P_RX, (P_RX)->pRead, (P_RX)->pWrite)))
+#define RX_FIFO_NEXT(IDX)                                   (((IDX) + 1) % LOGGER_CONFIG_RX_RECORD_FIFO_SIZE)
+#define IS_RX_READ_DONE(P_RX, P_READ)                       ((P_READ) == (P_RX)->pWrite || ((P_READ) == (P_RX)->pTail && (P_RX)->pWrite == (P_RX)->pHead))
+#define IS_PRIORITY_LEVEL(LEVEL)                            ((LEVEL) == LEVEL_CRITICAL || (LEVEL) == LEVEL_ERROR)
+#define IS_RX_EMPTY(P_RX)                                   ((P_RX)->pRead == (P_RX)->pWrite)
+#define IS_RX_ABOVE_WATERMARK(P_RX)                         (CALC_RX_DISTANCE(P_RX, (P_RX)->pRead, (P_RX)->pWrite) * 100 > \
+                                                             ((P_RX)->pTail - (P_RX)->pHead) * LOGGER_CONFIG_DRAIN_WATERMARK_PERCENT)
 
                 /* ========================================== *
                  *     P R I V A T E     V A R I A B L E S    *
                  * ========================================== */
 extern LoggerManager_t gLoggerManager;
+
+/* the staging buffer holds a single message, one byte more so the message never wraps around */
+static char gLoggerStagingMessage[LOGGER_CONFIG_MAX_RX_MESSAGE_SIZE_BYTES + 1];
+
+static RXBuffer_t gLoggerStagingBuffer;
+
+static const char gLoggerLossMarkerStr[] = " messages lost\r\n";
+
+/* the structured records keys types and names, and events names (see Logger_KvKeys.h) */
+#define LOGGER_KV_KEY(NAME, TYPE, STR)      e_LOGGER_KV_TYPE_##TYPE,
+static const uint8 gLoggerKvKeyType[e_LOGGER_KV_KEY_MAX] = { e_LOGGER_KV_TYPE_UINT, LOGGER_KV_KEYS };
+#undef LOGGER_KV_KEY
+#define LOGGER_KV_KEY(NAME, TYPE, STR)      STR,
+static const char *gLoggerKvKeyStr[e_LOGGER_KV_KEY_MAX] = { "", LOGGER_KV_KEYS };
+#undef LOGGER_KV_KEY
+#define LOGGER_KV_EVENT(NAME, STR)          STR,
+static const char *gLoggerKvEventStr[e_LOGGER_KV_EVENT_MAX] = { LOGGER_KV_EVENTS };
+#undef LOGGER_KV_EVENT
                 /* ========================================== *
                  *     P R I V A T E     F U N C T I O N S    *
                  * ========================================== */
@@ -52,6 +83,7 @@ static inline int mini_itoa(IN int InputNum, OUT char* buff, IN int base, IN int
 {
     int len = 0, i;
     int origNum = InputNum;
+    int sign = 0;
     /* make sure we dont exceed the maximum length */
     if(MaxLen == 0)
         return 0;
@@ -66,16 +98,17 @@ static inline int mini_itoa(IN int InputNum, OUT char* buff, IN int base, IN int
             origNum = -origNum;
             *buff++ = '-';
             MaxLen--;
-            len++;
+            sign = 1;
         }
         
         /* if we exceed the maximum lenght - transform only a part fot the number */
         if(len > MaxLen)
             len = MaxLen;
         
-        /* converts digits from 0 to 9 */
+        /* converts digits from 0 to 9, after the minus sign */
         for(i = len ; i > 0; origNum/=10 , i--)
             buff[i - 1] = (origNum % 10) + '0';
+        len += sign;
     }
     if(base == 16)
     {
@@ -170,7 +203,7 @@ static inline void Logger_ParseAndWriteNumber(IN int InputNum, IN int base, INOU
 
 /**
  * <pre>
- * static inline char *Logger_ParseAndWriteString(char *pStr, int *pMaxSize, uint8 LeftOverSize, char DEL)
+ * static inline const char *Logger_ParseAndWriteString(const char *pStr, int *pMaxSize, uint8 LeftOverSize, char DEL)
  * </pre>
  *  
  * this function writes input string into the cyclic buffer until a delimineter is reached or NULL character is reached or until a maximum size reached.
@@ -186,7 +219,7 @@ static inline void Logger_ParseAndWriteNumber(IN int InputNum, IN int base, INOU
  * \defgroup LogManager
  * \ingroup LogManager
 */
-static inline char *Logger_ParseAndWriteString(IN char *pStr, INOUT int *pMaxSize, IN uint8 LeftOverSize, IN char DEL)
+static inline const char *Logger_ParseAndWriteString(IN const char *pStr, INOUT int *pMaxSize, IN uint8 LeftOverSize, IN char DEL)
 {
     int MaxSize = *pMaxSize;
     
@@ -471,7 +504,144 @@ static inline void Logger_WriteTimeAndDate(INOUT int *pMaxSize, IN uint16 LeftOv
 
 /**
  * <pre>
- * static inline int Logger_ParseAndWriteRxMessage(uint8 level, char *fmt, va_list ap)
+ * static inline uint8 Logger_ProbeBucket(uint32 Cycles)
+ * </pre>
+ *  
+ * this function returns the log2 histogram bucket of a latency: the number of its significant bits
+ *
+ * @param   Cycles       [in]       The latency in cycles
+ *
+ * @return the histogram bucket, LOGGER_DEF_PROBE_BUCKETS - 1 at most
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline uint8 Logger_ProbeBucket(IN uint32 Cycles)
+{
+    uint8 Bucket;
+    
+#if defined(__ICCARM__)
+    Bucket = 32 - __CLZ(Cycles);
+#elif defined(__GNUC__)
+    Bucket = (Cycles == 0)? 0: 32 - __builtin_clz(Cycles);
+#else
+    for(Bucket = 0; Cycles != 0; Bucket++)
+    {
+        Cycles >>= 1;
+    }
+#endif
+    
+    return (Bucket < LOGGER_DEF_PROBE_BUCKETS)? Bucket: LOGGER_DEF_PROBE_BUCKETS - 1;
+}
+
+/**
+ * <pre>
+ * static inline uint32 Logger_ProbeStart(void)
+ * </pre>
+ *  
+ * this function starts a latency probe sample
+ *
+ * @return the platform cycle counter, or 0 if the platform has no GetCyclesCb or the probes are disabled
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline uint32 Logger_ProbeStart(void)
+{
+#if LOGGER_CONFIG_LATENCY_PROBES
+    return (gLoggerManager.pCbList->GetCyclesCb != NULL)? gLoggerManager.pCbList->GetCyclesCb(): 0;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * <pre>
+ * static inline void Logger_ProbeEnd(uint8 Probe, uint32 StartCycles)
+ * </pre>
+ *  
+ * this function ends a latency probe sample and counts it in the probe log2 histogram
+ *
+ * @param   Probe        [in]       The latency probe (LoggerProbe_e)
+ * @param   StartCycles  [in]       The cycle counter returned by Logger_ProbeStart
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline void Logger_ProbeEnd(IN uint8 Probe, IN uint32 StartCycles)
+{
+#if LOGGER_CONFIG_LATENCY_PROBES
+    LoggerProbeMng_t *pProbeMng = &gLoggerManager.ProbeMng;
+    
+    uint32 Cycles;
+    
+    if(gLoggerManager.pCbList->GetCyclesCb == NULL)
+        return;
+    
+    Cycles = gLoggerManager.pCbList->GetCyclesCb() - StartCycles;
+    
+    pProbeMng->Hist[Probe][Logger_ProbeBucket(Cycles)]++;
+    
+    if(Cycles > pProbeMng->MaxCycles[Probe])
+    {
+        pProbeMng->MaxCycles[Probe] = Cycles;
+    }
+#endif
+}
+
+/**
+ * <pre>
+ * static inline void Logger_CallSiteCount(const char *pFmt, uint16 Len)
+ * </pre>
+ *  
+ * this function counts a message in its call site entry of the call sites table. the entry is looked up by linear 
+ * probing from the format string address hash, a new call site takes the first free entry. a call site that finds 
+ * no entry within LOGGER_DEF_CALL_SITE_MAX_PROBES is counted in the other call sites counters.
+ * NOTE: this function is called under the RX buffer mutex
+ *
+ * @param   pFmt         [in]       The call site format string
+ * @param   Len          [in]       The message length in bytes
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline void Logger_CallSiteCount(IN const char *pFmt, IN uint16 Len)
+{
+#if LOGGER_CONFIG_CALL_SITE_STATS
+    LoggerCallSiteMng_t *pCallSiteMng = &gLoggerManager.CallSiteMng;
+    
+    LoggerCallSite_t *pSite;
+    
+    uint32 Key = (uint32)(size_t)pFmt;
+    
+    uint8 Probe;
+    
+    /* Fibonacci hashing, the string addresses low bits are not spread */
+    Key = (Key * 2654435761U) >> (32 - LOGGER_CONFIG_CALL_SITES_BITS);
+    
+    for(Probe = 0; Probe < LOGGER_DEF_CALL_SITE_MAX_PROBES; Probe++)
+    {
+        pSite = &pCallSiteMng->Site[(Key + Probe) & (LOGGER_DEF_CALL_SITES_SIZE - 1)];
+        if(pSite->pFmt == pFmt || pSite->pFmt == NULL)
+        {
+            pSite->pFmt = pFmt;
+            pSite->Hits++;
+            pSite->Bytes += Len;
+            return;
+        }
+    }
+    pCallSiteMng->OtherHits++;
+    pCallSiteMng->OtherBytes += Len;
+#endif
+}
+
+/**
+ * <pre>
+ * static inline int Logger_ParseAndWriteRxMessage(uint8 level, const char *fmt, va_list ap)
  * </pre>
  *  
  * this function parse a customized printf style RX log message and write into into a cyclic buffer
@@ -485,7 +655,7 @@ static inline void Logger_WriteTimeAndDate(INOUT int *pMaxSize, IN uint16 LeftOv
  * \defgroup LogManager
  * \ingroup LogManager
 */
-static inline int Logger_ParseAndWriteRxMessage(IN uint8 level, IN char *fmt, IN va_list ap)
+static inline int Logger_ParseAndWriteRxMessage(IN uint8 level, IN const char *fmt, IN va_list ap)
 {   
     int d, Len;
     char c, *s, *base = P_BUFF_ITER;
@@ -496,16 +666,6 @@ static inline int Logger_ParseAndWriteRxMessage(IN uint8 level, IN char *fmt, IN
     /* in case we have a buffer wrap arround case we need to calculate the left over */    
     uint8 BuffLeftOverSize = LOGGER_CONFIG_MAX_RX_MESSAGE_SIZE_BYTES - MaxSize;
     
-    uint16 RemainBuffSize = CALC_REMAIN_BUFF_SIZE((uint32)P_BUFF_READ, (uint32)P_BUFF_WRITE, (uint32)LOGGER_CONFIG_DOUBLE_BUFFER_SIZE_BYTES);
-    
-    gLoggerManager.RxBuffer.Flags.IsLowMemory = (LOGGER_CONFIG_MAX_RX_MESSAGE_SIZE_BYTES > RemainBuffSize);
-
-    if(gLoggerManager.RxBuffer.Flags.IsLowMemory)
-    {
-        /* update for debug */
-        gLoggerManager.RxBuffer.LowMemoryCnt++;
-        Logger_SetTxResolution(LOGGER_RESOLUTION_TYPE_HIGH);
-    }
     /* start collecting the arguments */
     
     if(MaxSize <= 0)
@@ -546,13 +706,13 @@ static inline int Logger_ParseAndWriteRxMessage(IN uint8 level, IN char *fmt, IN
             
             case 'r':              /* raw data */
                 s = va_arg(ap, char *);
-                d = va_arg(ap, unsigned char);
+                d = (unsigned char)va_arg(ap, int);      /* promoted to int when passed through ... */
                     Logger_ParseAndWriteRawData(s, d, &MaxSize, BuffLeftOverSize);
              break;
              
             case 'b':               /* binary data */
                 s = va_arg(ap, char *);
-                d = va_arg(ap, short);
+                d = (short)va_arg(ap, int);              /* promoted to int when passed through ... */
                 Logger_ParseAndWriteBinBuff((unsigned char *)s, d, &MaxSize, BuffLeftOverSize);
             break;
             
@@ -575,419 +735,2056 @@ static inline int Logger_ParseAndWriteRxMessage(IN uint8 level, IN char *fmt, IN
     /* calculate actual massage length */
     //Len = BuffLeftOverSize == 0 ?(int)(P_BUFF_ITER - base): 
     //    (int)(P_BUFF_TAIL - base + P_BUFF_ITER - P_BUFF_HEAD);
-    Len = (int)(P_BUFF_ITER - base)<0?LOGGER_CONFIG_DOUBLE_BUFFER_SIZE_BYTES + (int)(P_BUFF_ITER - base): (int)(P_BUFF_ITER - base);
+    Len = (int)(P_BUFF_ITER - base)<0?P_BUFF_SIZE + (int)(P_BUFF_ITER - base): (int)(P_BUFF_ITER - base);
 
-        /* check buffer overrun conditions:
-           1. we had a low memory 
-           2. we have more space in the buffer after the write operation */
     OSAL_ASSERT(Len >= 0);
-    if(gLoggerManager.RxBuffer.Flags.IsLowMemory)
-    {
-        
-         uint16 NewRemainBufSize = CALC_REMAIN_BUFF_SIZE((uint32)P_BUFF_READ, (uint32)P_BUFF_WRITE, (uint32)LOGGER_CONFIG_DOUBLE_BUFFER_SIZE_BYTES);
-         
-         if(NewRemainBufSize > RemainBuffSize)
-         {
-             /*mark the special sign for buffer overrun*/
-            *P_BUFF_READ = LOGGER_CONFIG_BUFFER_OVERRUN_MARK_CHAR;
-    
-            /* set the start reading pointer to the new buffer start */
-            P_BUFF_READ = P_BUFF_WRITE + 1;
-            
-            /* update the run over counter for debug */
-            gLoggerManager.RxBuffer.RunOverCnt++;
-         }
-    }
+    
     return Len;
     
 }
 
 /**
  * <pre>
- * static inline LOGGER_STATUS Logger_EraseSector(IN uint32 NextSectorAddress)
+ * static inline void Logger_ReleaseRxRecords(RXBuffer_t *pRxBuffer)
  * </pre>
  *  
- * this function erases a log flash sector
+ * this function releases the boundaries of the records all the sinks have sent
  *
- * @param   NextSectorAddress        [in]    The address of the begining of the sector to erase
+ * @param   pRxBuffer    [inout]    The RX buffer
  *
- * @return LOGGER_STATUS_OK for success or a negative ineger for error
+ * @return none
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-
-static inline LOGGER_STATUS Logger_EraseSector(IN uint32 NextSectorAddress)
+static inline void Logger_ReleaseRxRecords(INOUT RXBuffer_t *pRxBuffer)
 {
+    LoggerRxRecordFifo_t *pFifo = &pRxBuffer->Records;
     
-    /* erase flash sector */
-    if(FLASH_SectorErase(SSP1, 0, NextSectorAddress, FLASH_ATTR_USED_FROM_INTERRUPT, &gLoggerManager.FlashMng.CmdStatus, NULL) != OSAL_STATUS_OK)
+    /* the read pointer is moved by the drain task */
+    char *pRead = pRxBuffer->pRead;
+    
+    uint16 Used = CALC_RX_DISTANCE(pRxBuffer, pRead, pRxBuffer->pWrite);
+    
+    uint16 Distance;
+    
+    while(pFifo->Head != pFifo->Tail)
     {
-        OSAL_ASSERT(0);
-        return LOGGER_STATUS_FLASH_ERASE_ERROR;
-    }        
+        Distance = CALC_RX_DISTANCE(pRxBuffer, pRead, pFifo->Entry[pFifo->Head].pEnd);
         
-    /* if we have just erased the current read address, update it to the next sector */
-    if(gLoggerManager.FlashMng.ReadAddr == NextSectorAddress)
-    {
-        gLoggerManager.FlashMng.ReadAddr = LOGGER_DEF_FLASH_NEXT_SECTOR_ADDRESS(gLoggerManager.Config.General.FlashSize, gLoggerManager.FlashMng.ReadAddr, LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB);
+        /* the record ends after the read pointer, it was not sent yet */
+        if(Distance != 0 && Distance <= Used)
+        {
+            break;
+        }
+        pFifo->Head = RX_FIFO_NEXT(pFifo->Head);
     }
-    
-    return LOGGER_STATUS_OK;
 }
 
 /**
  * <pre>
- * static inline uint16 Logger_FlashGetSizeToWrite(uint32 WriteAddress, uint32 EndAdderss, uint16 SizeNeeded, BOOL IsUrgent)
+ * static inline char *Logger_RxRecordEnd(RXBuffer_t *pRxBuffer, char *pPos)
  * </pre>
  *  
- * this function gets the size of available flash size to write log messages to.
+ * this function finds the end of the record a not sent RX buffer position is in. when the records FIFO was full the 
+ * boundaries of the newest records were not kept, and the next boundary kept is returned
+ * NOTE: this function is called under the RX buffer mutex
  *
- * @param   WriteAddress        [in]    The address in flash of the next message to write to
- * @param   EndAdderss          [in]    The address in flash of the maximum location to write to
- * @param   SizeNeeded          [in]    The input log message size needed in bytes
- * @param   IsUrgent            [in]    The priority of the input log message (1 urgent 0 not urgent)
+ * @param   pRxBuffer    [in]       The RX buffer
+ * @param   pPos         [in]       The position, at or after the RX buffer read pointer
  *
- * @return the available size to write in bytes
+ * @return the record end, pPos if a record ends there
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-static inline uint16 Logger_FlashGetSizeToWrite(IN uint32 WriteAddress, IN uint32 EndAdderss, IN uint16 SizeNeeded, IN BOOL IsUrgent)
+static inline char *Logger_RxRecordEnd(IN RXBuffer_t *pRxBuffer, IN char *pPos)
 {
-    /* default status value FLASH write error failed */
-    uint16 SizeToWrite = SizeNeeded;
-    uint8 LeftOver;
-    uint8 NumOfPages;
+    const LoggerRxRecordFifo_t *pFifo = &pRxBuffer->Records;
     
+    uint16 Distance = CALC_RX_DISTANCE(pRxBuffer, pRxBuffer->pRead, pPos);
     
-    /* for optimization, we write data in page size, unless we have a low memory event */
-    if(WriteAddress + SizeNeeded > EndAdderss)
+    uint8 Idx;
+    
+    for(Idx = pFifo->Head; Idx != pFifo->Tail; Idx = RX_FIFO_NEXT(Idx))
     {
-        SizeToWrite = EndAdderss - WriteAddress;
-        
-    }
-#if 1    
-    else
-    {        
-        if(!IsUrgent)
+        if(CALC_RX_DISTANCE(pRxBuffer, pRxBuffer->pRead, pFifo->Entry[Idx].pEnd) >= Distance)
         {
-            /* if address is aligned */
-            uint8 PageOffset = WriteAddress &0xFF;
-            if(!PageOffset)
-            {
-                /* write only pages */
-                SizeToWrite = SizeNeeded&0xFF00;
-            }
-            else if(PageOffset + SizeNeeded >= 256)
-            {                        
-                LeftOver =  256 - PageOffset;
-                NumOfPages = ((SizeNeeded - LeftOver)&0xFF00)>>8;
-                                               
-                SizeToWrite = (NumOfPages<<8) + LeftOver;
-            }
-            else
-            {    
-                SizeToWrite = 0;
-            }
+            return pFifo->Entry[Idx].pEnd;
         }
     }
-#endif    
-    return SizeToWrite;    
+    return pRxBuffer->pWrite;
 }
 
 /**
  * <pre>
- * static inline uint16 Logger_SendPacketFlash(char *pStr, uint16 StrLen)
+ * static inline void Logger_OverwriteRxRecords(RXBuffer_t *pRxBuffer, uint16 SizeNeeded)
  * </pre>
  *  
- * this function sends the flash an ascii format log messages buffer from RAM  
+ * this function frees RX buffer space by dropping the oldest records (on whole records boundaries), 
+ * and accounts for the lost records and bytes. the sinks that did not send a dropped record move to the next record.
+ * the range the drain task is sending (pDrainHold) is not dropped, so the sink it is sent to is never moved here
  *
- * @param   pStr            [in]    The input log messages RAM buffer to write
- * @param   StrLen          [in]    The input buffer length in bytes
+ * @param   pRxBuffer    [inout]    The RX buffer
+ * @param   SizeNeeded   [in]       The free size needed in bytes
  *
- * @return the size of input buffer writen to flash in bytes
+ * @return none
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-static inline uint16 Logger_SendPacketFlash(IN char *pStr, IN uint16 StrLen)
+static inline void Logger_OverwriteRxRecords(INOUT RXBuffer_t *pRxBuffer, IN uint16 SizeNeeded)
 {
+    LoggerRxRecordFifo_t *pFifo = &pRxBuffer->Records;
     
-    uint32 FlashEndAddress =  LOGGER_DEF_FLASH_END_ADDRESS(LOGGER_CONFIG_FLASH_START_ADDRESS, gLoggerManager.Config.General.FlashSize);
+    LoggerRxRecord_t *pOldest;
     
-    uint16 SizeToWrite = Logger_FlashGetSizeToWrite(gLoggerManager.FlashMng.WriteAddr, FlashEndAddress, StrLen, gLoggerManager.RxBuffer.Flags.IsLowMemory || gLoggerManager.RxBuffer.Flags.IsUrgent);
-
-    if(SizeToWrite == 0)
-    {
-        return 0;
-    }
-    OSAL_ASSERT(SizeToWrite + gLoggerManager.RxBuffer.pRead <= gLoggerManager.RxBuffer.pTail);
-    /* sanity check */
-    if(gLoggerManager.pCbList->SendFlashDataCb != NULL)
+    BOOL IsFlashMoved = FALSE;
+    
+    uint8 SinkId;
+    
+    while(pFifo->Head != pFifo->Tail && CALC_RX_FREE_SIZE(pRxBuffer) < SizeNeeded)
     {
-        if(gLoggerManager.pCbList->SendFlashDataCb(gLoggerManager.FlashMng.WriteAddr, pStr, &SizeToWrite) == LOGGER_STATUS_OK)
+        pOldest = &pFifo->Entry[pFifo->Head];
+        
+        /* the drain task is sending the record without the mutex, its space is freed once it was sent */
+        if(pRxBuffer->pDrainHold != NULL && 
+           CALC_RX_DISTANCE(pRxBuffer, pRxBuffer->pRead, pOldest->pEnd) > CALC_RX_DISTANCE(pRxBuffer, pRxBuffer->pRead, pRxBuffer->pDrainHold))
         {
-            /* we need to prepare the next sector */
-            uint16 CurrentSectorUsageKB = (gLoggerManager.FlashMng.WriteAddr - gLoggerManager.FlashMng.CurrSectorAddr)>>10;
-            /* find the FLASH debug end address */ 
-            
-            if(!gLoggerManager.FlashMng.Flags.IsNextSectorErased)
-            {
-                if(CurrentSectorUsageKB >= FLASH_CONFIG_SECTOR_SIZE_THERSHOLD_KB)
-                {
-                    uint32 NextSectorAddress = LOGGER_DEF_FLASH_NEXT_SECTOR_ADDRESS(gLoggerManager.Config.General.FlashSize, gLoggerManager.FlashMng.CurrSectorAddr, LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB);
-
-                    if(Logger_EraseSector(NextSectorAddress) == LOGGER_STATUS_OK)
-                    {
-                        /* mark that we have erased the next sector */
-                        gLoggerManager.FlashMng.Flags.IsNextSectorErased = 1;
-                    }
-                }
-            }
-            else 
-            {
-                if(gLoggerManager.FlashMng.CmdStatus == 0 && CurrentSectorUsageKB >= LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB)
-                {
-                    gLoggerManager.FlashMng.Flags.IsNextSectorErased = 0;
-                    gLoggerManager.FlashMng.CurrSectorAddr = LOGGER_DEF_FLASH_NEXT_SECTOR_ADDRESS(gLoggerManager.Config.General.FlashSize, gLoggerManager.FlashMng.CurrSectorAddr, LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB);
-                }
-            }
-            /* update the Flash write pointer */
-            gLoggerManager.FlashMng.WriteAddr += SizeToWrite;
-            /* sanity check - flash write pointer should  not be bigger than flash size */
-            
-            if(gLoggerManager.FlashMng.WriteAddr > FlashEndAddress)
-            {
-                OSAL_ASSERT(FALSE);
-            }
-            else if(gLoggerManager.FlashMng.WriteAddr == FlashEndAddress)
-            {
-                /* need to wrap around flash address */
-                gLoggerManager.FlashMng.WriteAddr = LOGGER_CONFIG_FLASH_START_ADDRESS;
-            }
-            /* save in eeprom the new write address for next reset */
-            if(gLoggerManager.pCbList->SaveNVRParamsCb != NULL)
+            break;
+        }
+        pRxBuffer->LostBytesCnt += CALC_RX_DISTANCE(pRxBuffer, pRxBuffer->pRead, pOldest->pEnd);
+        pRxBuffer->LostMsgCnt += pOldest->NumOfRecords;
+        pRxBuffer->PendingLostMsgs += pOldest->NumOfRecords;
+        
+        /* the sinks that did not send the record start from the next record */
+        for(SinkId = 0; SinkId < e_LOGGER_SINK_MAX; SinkId++)
+        {
+            if(CALC_RX_DISTANCE(pRxBuffer, pRxBuffer->pRead, pRxBuffer->pSinkRead[SinkId]) < CALC_RX_DISTANCE(pRxBuffer, pRxBuffer->pRead, pOldest->pEnd))
             {
-                gLoggerManager.pCbList->SaveNVRParamsCb(LOGGER_CONFIG_NVR_ADDRESS, &gLoggerManager.FlashMng, LOGGER_CONFIG_NVR_SIZE_BYTES);
+                pRxBuffer->pSinkRead[SinkId] = pOldest->pEnd;
+                IsFlashMoved |= (SinkId == e_LOGGER_SINK_FLASH);
             }
         }
+        pRxBuffer->pRead = pOldest->pEnd;
+        
+        pFifo->Head = RX_FIFO_NEXT(pFifo->Head);
     }
-    else
+    /* the times of the dropped records will never be written to FLASH (the record times are kept for the main RX buffer only) */
+    if(IsFlashMoved && pRxBuffer == &gLoggerManager.RxBuffer)
     {
-        /* we have configured destination type FLASH but no flash write callback was initiated */
-        OSAL_ASSERT(0);
-        return 0;
+        Logger_SummaryRecordsSkipped(pRxBuffer->pRead, pRxBuffer->pWrite);
+    }
+    /* the rest of a record cut in FLASH was dropped, the FLASH continues from a record boundary */
+    if(IsFlashMoved)
+    {
+        pRxBuffer->Flags.IsFlashCut = 0;
     }
-    
-    return SizeToWrite;
 }
 
 /**
  * <pre>
- * static inline LOGGER_STATUS Logger_SendPacket(char *pStr, int StrLen, BOOL IsPrintoutEnabled, uint8 DestType)
+ * static inline void Logger_WriteRxRecord(RXBuffer_t *pRxBuffer, char *pStr, uint16 Len)
  * </pre>
  *  
- * this function sends an ascii format log messages buffer from RAM, to the configured destination (FLASH, socket, RS232)  
+ * this function copies a record to the RX buffer (the caller makes sure it has the free space) and keeps its boundary.
+ * the write pointer is moved only after the whole record was copied, so the sinks never send a partial record.
  *
- * @param   pStr                    [in]    The input log messages RAM buffer to write
- * @param   StrLen                  [in]    The input buffer length in bytes
- * @param   IsPrintoutEnabled       [in]    Should we send log to RS232 as well (currently we can't send log to more than one destination simultenously,
-                                            but the design it was supposed to be supported)
- * @param   DestType                [in]    The destination type:
- *                                          LOGGER_DEST_TYPE_NONE - no destination type (RS232 can be still enabled)
- *                                          LOGGER_DEST_TYPE_FLASH - destination type is flash (log file in PULL mode)
- *                                          LOGGER_DEST_TYPE_SOCKET - destination type is socket (in PUSH mode)
+ * @param   pRxBuffer    [inout]    The RX buffer
+ * @param   pStr         [in]       The record to copy
+ * @param   Len          [in]       The record length in bytes
  *
- * @return the available size to write in bytes
+ * @return none
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-
-static inline LOGGER_STATUS Logger_SendPacket(IN char *pStr, IN int StrLen, IN BOOL IsPrintoutEnabled, IN uint8 DestType)
+static inline void Logger_WriteRxRecord(INOUT RXBuffer_t *pRxBuffer, IN char *pStr, IN uint16 Len)
 {
+    LoggerRxRecordFifo_t *pFifo = &pRxBuffer->Records;
     
-    LOGGER_STATUS Status = LOGGER_STATUS_OK;
+    uint16 SizeToTail = pRxBuffer->pTail - pRxBuffer->pWrite;
     
-    if(StrLen <= 0)
-    {
-        OSAL_ASSERT(0);
-        return LOGGER_STATUS_ERROR;
-    }
-    /* TODO: need to take care of wrap arround */
-    if(StrLen > LOGGER_CONFIG_MAX_TX_MESSAGE_SIZE_BYTES)
-        StrLen = LOGGER_CONFIG_MAX_TX_MESSAGE_SIZE_BYTES;
-        
-    switch (DestType)
-    {
-        /* do nothing */
-        case LOGGER_DEST_TYPE_NONE:
-        break;
-        
-        /* send to FLASH */
-        case LOGGER_DEST_TYPE_FLASH:
-            if(gLoggerManager.State == e_LOGGER_STATE_READY)
-            {
-                StrLen = Logger_SendPacketFlash(pStr, StrLen);
-            }
-        break;
-        /* send to socket */
-        case LOGGER_DEST_TYPE_SOCKET:
-            if(gLoggerManager.pCbList->SendSocketDataCb != NULL && gLoggerManager.State == e_LOGGER_STATE_READY)
-            {
-                Status  = gLoggerManager.pCbList->SendSocketDataCb((uint8 *)pStr, StrLen, LOGGER_MODE_TYPE_PUSH);
-            }
-        break;
-        
-        default:
-            /* invalid destination type */
-            OSAL_ASSERT(0);
-    }
-    if(IsPrintoutEnabled)
+    uint8 Last = (pFifo->Tail + LOGGER_CONFIG_RX_RECORD_FIFO_SIZE - 1) % LOGGER_CONFIG_RX_RECORD_FIFO_SIZE;
+    
+    if(Len < SizeToTail)
     {
-        /* send the message to uart callback */
-        if(gLoggerManager.pCbList->SendUartDataCb != NULL)
-            Status = gLoggerManager.pCbList->SendUartDataCb(pStr, StrLen);
+        OSAL_MemCopy(pRxBuffer->pWrite, pStr, Len);
+        pRxBuffer->pWrite += Len;
     }
-    if(Status == LOGGER_STATUS_OK && StrLen != 0)
+    else
     {
-        /* update the numbers of TX packets sent */
-        gLoggerManager.RxBuffer.TxCounter++;
-        /* update the RX read pointer */
-        gLoggerManager.RxBuffer.pRead += StrLen;
-        
         /* wrap around case */
-        if(gLoggerManager.RxBuffer.pRead == gLoggerManager.RxBuffer.pTail)
-        {
-            gLoggerManager.RxBuffer.pRead = gLoggerManager.RxBuffer.pHead;
-        }
-
+        OSAL_MemCopy(pRxBuffer->pWrite, pStr, SizeToTail);
+        OSAL_MemCopy(pRxBuffer->pHead, pStr + SizeToTail, Len - SizeToTail);
+        pRxBuffer->pWrite = pRxBuffer->pHead + Len - SizeToTail;
     }
-    else if(Status != LOGGER_STATUS_OK)
+    /* when the FIFO is full the record joins the newest entry */
+    if(RX_FIFO_NEXT(pFifo->Tail) == pFifo->Head)
     {
-        gLoggerManager.RxBuffer.BusyCnt++;
+        pFifo->Entry[Last].pEnd = pRxBuffer->pWrite;
+        pFifo->Entry[Last].NumOfRecords++;
+        return;
     }
-    return Status;
+    pFifo->Entry[pFifo->Tail].pEnd = pRxBuffer->pWrite;
+    pFifo->Entry[pFifo->Tail].NumOfRecords = 1;
+    pFifo->Tail = RX_FIFO_NEXT(pFifo->Tail);
 }
 
-                /* ========================================== *
-                 *     P U B L I C     F U N C T I O N S      *
-                 * ========================================== */
-
 /**
  * <pre>
- * void Logger_printf(uint8 level, char *fmt, ...)
+ * static inline uint8 Logger_BuildLossMarker(char *pMarker, uint32 NumOfMsgs)
  * </pre>
  *  
- * this function is a customized printf log for debug. it's currently support the following parameters:
- *                                  %c - prints an ascii character
- *                                  %s - prints a string (must be null terminated)
- *                                  %d or %i - prints a decimal number
- *                                  %x - prints an hexadecimal number
- *                                  %r - translate (and prints) a binary buffer to an hexadecimal buffer. (must get size as well)
- *                                  %b - prints a binary buffer (without translate to hexa. must get size as well)
- *                                  %T - prints the current date and time in format DD/MM/YY HH:MM:SS
- *                                  
- * @param   level                   [in]    The log level
- * @param   fmt                     [in]    The input string
- * @param   ...                     [in]    a list of printf style arbitrary parameters (must match to the % in the string).
+ * this function builds the "N messages lost" record, it starts with the overrun mark char (LOGGER_CONFIG_BUFFER_OVERRUN_MARK_CHAR)
  *
- * @return none
+ * @param   pMarker      [out]      The record buffer (at least LOGGER_DEF_LOSS_MARKER_MAX_LEN bytes)
+ * @param   NumOfMsgs    [in]       The number of records lost
+ *
+ * @return the record length in bytes
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
-void Logger_printf(uint8 level, char *fmt, ...)
+static inline uint8 Logger_BuildLossMarker(OUT char *pMarker, IN uint32 NumOfMsgs)
 {
-    int Len;
-    
-    va_list ap;
+    char *pItr = pMarker;
     
-    uint8 TaskId = OSAL_GetSelfTaskId();
+    /* the lost records may have ended in the middle of a line */
+    *pItr++ = '\r';
+    *pItr++ = '\n';
+    *pItr++ = LOGGER_CONFIG_BUFFER_OVERRUN_MARK_CHAR;
+    *pItr++ = ' ';
+    pItr += mini_itoa((int)NumOfMsgs, pItr, 10, 10);
+    OSAL_MemCopy(pItr, (void *)gLoggerLossMarkerStr, sizeof(gLoggerLossMarkerStr) - 1);
+    pItr += sizeof(gLoggerLossMarkerStr) - 1;
     
-    /* check the condition to use the logger */
-    if(!LOGGER_DEF_GEN_CONFIG.IsEnabled || (LOGGER_DEF_GEN_CONFIG.LogLevel != LEVEL_CRITICAL && (~LOGGER_DEF_GEN_CONFIG.ModuleMask & (1<<TaskId) || LOGGER_DEF_GEN_CONFIG.LogLevel < level)))
+    return (uint8)(pItr - pMarker);
+}
+
+/**
+ * <pre>
+ * static inline BOOL Logger_CommitRxMessage(RXBuffer_t *pRxBuffer, char *pMsg, uint16 Len, LoggerTaskStats_t *pTaskStats)
+ * </pre>
+ *  
+ * this function copies a parsed log message to the RX buffer, according to the configured overrun policy:
+ *      overwrite the oldest records (default) - the oldest records are dropped on whole records boundaries
+ *      LOGGER_ATTR_OVERRUN_DROP_NEWEST      - the new record is dropped
+ *      LOGGER_ATTR_OVERRUN_BLOCK            - the printing task waited for free space (see Logger_WaitRxBufferSpace), 
+ *                                             the new record is dropped if the wait timed out
+ * the lost records are followed by a "N messages lost" record, so every sink sees where data went missing.
+ *
+ * @param   pRxBuffer    [inout]    The RX buffer
+ * @param   pMsg         [in]       The parsed log message
+ * @param   Len          [in]       The log message length in bytes
+ * @param   pTaskStats   [inout]    The printing task statistics
+ *
+ * @return TRUE if the message was written to the RX buffer, or FALSE if it was dropped
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline BOOL Logger_CommitRxMessage(INOUT RXBuffer_t *pRxBuffer, IN char *pMsg, IN uint16 Len, INOUT LoggerTaskStats_t *pTaskStats)
+{
+    char Marker[LOGGER_DEF_LOSS_MARKER_MAX_LEN];
+    
+    uint16 FreeSize;
+    
+    uint16 Used;
+    
+    Logger_ReleaseRxRecords(pRxBuffer);
+    
+    FreeSize = CALC_RX_FREE_SIZE(pRxBuffer);
+    
+    pRxBuffer->Flags.IsLowMemory = (FreeSize < LOGGER_CONFIG_MAX_RX_MESSAGE_SIZE_BYTES + LOGGER_DEF_LOSS_MARKER_MAX_LEN);
+    
+    if(pRxBuffer->Flags.IsLowMemory != pRxBuffer->LowMemoryTime.IsActive)
+    {
+        Logger_ModeTimeUpdate(&pRxBuffer->LowMemoryTime, pRxBuffer->Flags.IsLowMemory);
+    }
+    if(pRxBuffer->Flags.IsLowMemory)
+    {
+        /* update for debug */
+        pRxBuffer->LowMemoryCnt++;
+        Logger_SetTxResolution(LOGGER_RESOLUTION_TYPE_HIGH);
+    }
+    /* buffer overrun, the lost records marker must fit as well */
+    if(Len + (pRxBuffer->PendingLostMsgs? LOGGER_DEF_LOSS_MARKER_MAX_LEN: 0) > FreeSize)
+    {
+        /* update the run over counter for debug */
+        pRxBuffer->RunOverCnt++;
+        pTaskStats->OverrunMsgs++;
+        
+        if(!(LOGGER_DEF_FILTER.Attributes & (LOGGER_ATTR_OVERRUN_DROP_NEWEST | LOGGER_ATTR_OVERRUN_BLOCK)))
+        {
+            Logger_OverwriteRxRecords(pRxBuffer, Len + LOGGER_DEF_LOSS_MARKER_MAX_LEN);
+        }
+        if(Len + LOGGER_DEF_LOSS_MARKER_MAX_LEN > CALC_RX_FREE_SIZE(pRxBuffer))
+        {
+            pRxBuffer->LostMsgCnt++;
+            pRxBuffer->LostBytesCnt += Len;
+            pRxBuffer->PendingLostMsgs++;
+            return FALSE;
+        }
+    }
+    if(pRxBuffer->PendingLostMsgs)
+    {
+        Logger_WriteRxRecord(pRxBuffer, Marker, Logger_BuildLossMarker(Marker, pRxBuffer->PendingLostMsgs));
+        pRxBuffer->PendingLostMsgs = 0;
+    }
+    Logger_WriteRxRecord(pRxBuffer, pMsg, Len);
+    
+    /* the peak occupancy since the last read is never above the peak since the init */
+    Used = CALC_RX_DISTANCE(pRxBuffer, pRxBuffer->pRead, pRxBuffer->pWrite);
+    if(Used > pRxBuffer->ReadPeakUsed)
+    {
+        pRxBuffer->ReadPeakUsed = Used;
+        if(Used > pRxBuffer->PeakUsed)
+        {
+            pRxBuffer->PeakUsed = Used;
+        }
+    }
+    
+    return TRUE;
+}
+
+/**
+ * <pre>
+ * static inline void Logger_WaitRxBufferSpace(RXBuffer_t *pRxBuffer, uint8 TaskId)
+ * </pre>
+ *  
+ * this function blocks the printing task until the RX buffer has room for the largest log message, or up to 
+ * LOGGER_CONFIG_OVERRUN_BLOCK_TIMEOUT_MS (LOGGER_ATTR_OVERRUN_BLOCK policy).
+ * NOTE: the tasks the socket sink depends on are never blocked
+ *
+ * @param   pRxBuffer    [in]       The RX buffer
+ * @param   TaskId       [in]       The ID of the printing task
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline void Logger_WaitRxBufferSpace(IN RXBuffer_t *pRxBuffer, IN uint8 TaskId)
+{
+    uint16 WaitMS = 0;
+    
+    if(Logger_IsLoopBack(TaskId))
+    {
         return;
+    }
+    while(CALC_RX_FREE_SIZE(pRxBuffer) < LOGGER_CONFIG_MAX_RX_MESSAGE_SIZE_BYTES + LOGGER_DEF_LOSS_MARKER_MAX_LEN &&
+          WaitMS < LOGGER_CONFIG_OVERRUN_BLOCK_TIMEOUT_MS)
+    {
+        Logger_FlushRxBuffer();
+        OSAL_SuspendTask(LOGGER_CONFIG_OVERRUN_BLOCK_POLL_MS);
+        WaitMS += LOGGER_CONFIG_OVERRUN_BLOCK_POLL_MS;
+    }
+}
+
+/**
+ * <pre>
+ * static inline LOGGER_STATUS Logger_EraseSector(IN uint32 NextSectorAddress)
+ * </pre>
+ *  
+ * this function erases a log flash sector
+ *
+ * @param   NextSectorAddress        [in]    The address of the begining of the sector to erase
+ *
+ * @return LOGGER_STATUS_OK for success, LOGGER_STATUS_BUSY if the FLASH command queue is full or a negative ineger for error
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+
+static inline LOGGER_STATUS Logger_EraseSector(IN uint32 NextSectorAddress)
+{
+    uint32 Ret;
+    
+    /* erase flash sector */
+    Ret = FLASH_SectorErase(SSP1, 0, NextSectorAddress, FLASH_ATTR_USED_FROM_INTERRUPT, &gLoggerManager.FlashMng.CmdStatus, NULL);
+    if(Ret == FLASH_TRANSMISSION_QUEUE_FULL)
+    {
+        /* the FLASH driver is busy, the erase is requested again on the next write */
+        return LOGGER_STATUS_BUSY;
+    }
+    if(Ret != OSAL_STATUS_OK)
+    {
+        OSAL_ASSERT(0);
+        return LOGGER_STATUS_FLASH_ERASE_ERROR;
+    }        
+        
+    /* if we have just erased the current read address, update it to the next sector */
+    if(gLoggerManager.FlashMng.ReadAddr == NextSectorAddress)
+    {
+        gLoggerManager.FlashMng.ReadAddr = LOGGER_DEF_FLASH_NEXT_SECTOR_ADDRESS(gLoggerManager.Config.General.FlashSize, gLoggerManager.FlashMng.ReadAddr, LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB);
+    }
+    
+    return LOGGER_STATUS_OK;
+}
+
+/**
+ * <pre>
+ * static inline LOGGER_STATUS Logger_FlashCloseSector(void)
+ * </pre>
+ *  
+ * this function closes the current full log flash sector: it writes the sector summary to the sector tail
+ * and moves the write pointer to the next sector once the next sector is erased.
+ *
+ * @return LOGGER_STATUS_OK if the write pointer was moved to the next sector, LOGGER_STATUS_BUSY if we need to try again later,
+ *         or a negative ineger for error
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline LOGGER_STATUS Logger_FlashCloseSector(void)
+{
+    uint32 NextSectorAddress = LOGGER_DEF_FLASH_NEXT_SECTOR_ADDRESS(gLoggerManager.Config.General.FlashSize, gLoggerManager.FlashMng.CurrSectorAddr, LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB);
+    
+    BOOL IsLocked;
+    
+    /* 1. write the summary of the full sector (only once) */
+    if(!gLoggerManager.FlashMng.Flags.IsSummaryWritten)
+    {
+        if(Logger_SummaryClose(gLoggerManager.FlashMng.CurrSectorAddr) != LOGGER_STATUS_OK)
+        {
+            return LOGGER_STATUS_FLASH_WRITE_ERROR;
+        }
+        gLoggerManager.FlashMng.Flags.IsSummaryWritten = 1;
+    }
+    
+    /* 2. the next sector should have been erased when we have crossed the sector threshold */
+    if(!gLoggerManager.FlashMng.Flags.IsNextSectorErased)
+    {
+        if(Logger_EraseSector(NextSectorAddress) == LOGGER_STATUS_OK)
+        {
+            gLoggerManager.FlashMng.Flags.IsNextSectorErased = 1;
+        }
+        return LOGGER_STATUS_BUSY;
+    }
+    
+    /* 3. wait for the erase to complete */
+    if(gLoggerManager.FlashMng.CmdStatus != 0)
+    {
+        return LOGGER_STATUS_BUSY;
+    }
+    
+    /* move to the next sector */
+    gLoggerManager.FlashMng.Flags.IsNextSectorErased = 0;
+    gLoggerManager.FlashMng.Flags.IsSummaryWritten = 0;
+    gLoggerManager.FlashMng.CurrSectorAddr = gLoggerManager.FlashMng.WriteAddr = NextSectorAddress;
+    gLoggerManager.FlashMng.SectorSeq++;
+    
+    IsLocked = Logger_FlashSinkLock();
+    Logger_SummaryOpen(NextSectorAddress);
+    Logger_FlashSinkUnlock(IsLocked);
+    
+    return LOGGER_STATUS_OK;
+}
+
+/**
+ * <pre>
+ * static inline uint16 Logger_FlashGetSizeToWrite(uint32 WriteAddress, uint32 EndAdderss, uint16 SizeNeeded, BOOL IsUrgent)
+ * </pre>
+ *  
+ * this function gets the size of available flash size to write log messages to.
+ *
+ * @param   WriteAddress        [in]    The address in flash of the next message to write to
+ * @param   EndAdderss          [in]    The address in flash of the maximum location to write to
+ * @param   SizeNeeded          [in]    The input log message size needed in bytes
+ * @param   IsUrgent            [in]    The priority of the input log message (1 urgent 0 not urgent)
+ *
+ * @return the available size to write in bytes
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline uint16 Logger_FlashGetSizeToWrite(IN uint32 WriteAddress, IN uint32 EndAdderss, IN uint16 SizeNeeded, IN BOOL IsUrgent)
+{
+    /* default status value FLASH write error failed */
+    uint16 SizeToWrite = SizeNeeded;
+    uint8 LeftOver;
+    uint8 NumOfPages;
+    
+    
+    /* for optimization, we write data in page size, unless we have a low memory event */
+    if(WriteAddress + SizeNeeded > EndAdderss)
+    {
+        SizeToWrite = EndAdderss - WriteAddress;
+        
+    }
+#if 1    
+    else
+    {        
+        if(!IsUrgent)
+        {
+            /* if address is aligned */
+            uint8 PageOffset = WriteAddress &0xFF;
+            if(!PageOffset)
+            {
+                /* write only pages */
+                SizeToWrite = SizeNeeded&0xFF00;
+            }
+            else if(PageOffset + SizeNeeded >= 256)
+            {                        
+                LeftOver =  256 - PageOffset;
+                NumOfPages = ((SizeNeeded - LeftOver)&0xFF00)>>8;
+                                               
+                SizeToWrite = (NumOfPages<<8) + LeftOver;
+            }
+            else
+            {    
+                SizeToWrite = 0;
+            }
+        }
+    }
+#endif    
+    return SizeToWrite;    
+}
+
+/**
+ * <pre>
+ * static inline uint16 Logger_SendPacketFlash(char *pStr, uint16 StrLen, BOOL IsPriority)
+ * </pre>
+ *  
+ * this function sends the flash an ascii format log messages buffer from RAM. the records of the two RX buffers are not 
+ * mixed in FLASH: a write may end inside a record (a full FLASH page or a busy FLASH), and the other RX buffer is written 
+ * once the rest of the record was written. the rest is written without waiting for a full page while the other RX buffer waits
+ *
+ * @param   pStr            [in]    The input log messages RAM buffer to write
+ * @param   StrLen          [in]    The input buffer length in bytes
+ * @param   IsPriority      [in]    Is the buffer from the ERROR and CRITICAL records RX buffer
+ *
+ * @return the size of input buffer writen to flash in bytes
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline uint16 Logger_SendPacketFlash(IN char *pStr, IN uint16 StrLen, IN BOOL IsPriority)
+{
+    RXBuffer_t *pRxBuffer = IsPriority? &gLoggerManager.PriorityBuffer: &gLoggerManager.RxBuffer;
+    
+    RXBuffer_t *pOtherBuffer = IsPriority? &gLoggerManager.RxBuffer: &gLoggerManager.PriorityBuffer;
+    
+    /* the log messages are written up to the sector summary record */
+    uint32 SectorEndAddress = LOGGER_DEF_FLASH_SUMMARY_ADDRESS(gLoggerManager.FlashMng.CurrSectorAddr);
+    
+    uint16 SizeToWrite;
+    
+    uint16 RecordEndLen;
+    
+    LOGGER_STATUS Status;
+    
+    BOOL IsLocked;
+    
+    BOOL IsWaited;
+    
+    /* the other RX buffer record cut by its last write ends first */
+    if(pOtherBuffer->Flags.IsFlashCut)
+    {
+        return 0;
+    }
+    
+    /* the current sector is full, move to the next sector before writing */
+    if(gLoggerManager.FlashMng.WriteAddr >= SectorEndAddress)
+    {
+        /* the panic flush does not wait for a sector erase */
+        if(gLoggerManager.Flags.IsPanic && (!gLoggerManager.FlashMng.Flags.IsNextSectorErased || gLoggerManager.FlashMng.CmdStatus != 0))
+        {
+            return 0;
+        }
+        if(Logger_FlashCloseSector() != LOGGER_STATUS_OK)
+        {
+            /* keep the log messages in RAM and try again on the next drain */
+            return 0;
+        }
+        SectorEndAddress = LOGGER_DEF_FLASH_SUMMARY_ADDRESS(gLoggerManager.FlashMng.CurrSectorAddr);
+    }
+    
+    /* the other RX buffer waits for the end of the record this RX buffer has cut, only the record end is written */
+    IsWaited = pRxBuffer->Flags.IsFlashCut && !IS_RX_READ_DONE(pOtherBuffer, pOtherBuffer->pSinkRead[e_LOGGER_SINK_FLASH]);
+    if(IsWaited)
+    {
+        IsLocked = Logger_FlashSinkLock();
+        RecordEndLen = CALC_RX_DISTANCE(pRxBuffer, pStr, Logger_RxRecordEnd(pRxBuffer, pStr));
+        Logger_FlashSinkUnlock(IsLocked);
+        
+        if(RecordEndLen > 0 && RecordEndLen < StrLen)
+        {
+            StrLen = RecordEndLen;
+        }
+    }
+    
+    /* ERROR and CRITICAL records are written without waiting for a full FLASH page */
+    SizeToWrite = Logger_FlashGetSizeToWrite(gLoggerManager.FlashMng.WriteAddr, SectorEndAddress, StrLen, 
+                                             IsPriority || IsWaited || pRxBuffer->Flags.IsLowMemory || pRxBuffer->Flags.IsUrgent || 
+                                             gLoggerManager.Flags.IsPanic);
+
+    if(SizeToWrite == 0)
+    {
+        return 0;
+    }
+    OSAL_ASSERT(SizeToWrite + pStr <= pRxBuffer->pTail);
+    /* sanity check */
+    if(gLoggerManager.pCbList->SendFlashDataCb != NULL)
+    {
+        Status = gLoggerManager.pCbList->SendFlashDataCb(gLoggerManager.FlashMng.WriteAddr, pStr, &SizeToWrite);
+        /* a busy FLASH may have written a part of the buffer (SizeToWrite is set to the part written). the part written
+           moves the write pointer like a full write, otherwise the next write would program over it */
+        if(Status == LOGGER_STATUS_OK || (Status == LOGGER_STATUS_BUSY && SizeToWrite > 0))
+        {
+            /* we need to prepare the next sector */
+            uint16 CurrentSectorUsageKB = (gLoggerManager.FlashMng.WriteAddr - gLoggerManager.FlashMng.CurrSectorAddr)>>10;
+            /* find the FLASH debug end address */ 
+            
+            if(!gLoggerManager.FlashMng.Flags.IsNextSectorErased && !gLoggerManager.Flags.IsPanic)
+            {
+                if(CurrentSectorUsageKB >= FLASH_CONFIG_SECTOR_SIZE_THERSHOLD_KB)
+                {
+                    uint32 NextSectorAddress = LOGGER_DEF_FLASH_NEXT_SECTOR_ADDRESS(gLoggerManager.Config.General.FlashSize, gLoggerManager.FlashMng.CurrSectorAddr, LOGGER_CONFIG_FLASH_SECTOR_SIZE_KB);
+
+                    if(Logger_EraseSector(NextSectorAddress) == LOGGER_STATUS_OK)
+                    {
+                        /* mark that we have erased the next sector */
+                        gLoggerManager.FlashMng.Flags.IsNextSectorErased = 1;
+                    }
+                }
+            }
+            /* the records times and the pending summary are shared with the log producers */
+            IsLocked = Logger_FlashSinkLock();
+            
+            /* keep the time of the first record of every FLASH block that was written (the record times are kept for the main RX buffer only) */
+            Logger_SummaryRecordsWritten(gLoggerManager.FlashMng.WriteAddr, IsPriority? NULL: pStr, SizeToWrite);
+            /* update the Flash write pointer */
+            gLoggerManager.FlashMng.WriteAddr += SizeToWrite;
+            /* sanity check - flash write pointer should not pass the sector summary record.
+               the wrap around to the flash start is done when the last sector is closed */
+            if(gLoggerManager.FlashMng.WriteAddr > SectorEndAddress)
+            {
+                OSAL_ASSERT(FALSE);
+            }
+            /* all the pending log messages of both RX buffers are now in the current sector */
+            if(IS_RX_READ_DONE(pRxBuffer, pStr + SizeToWrite) && IS_RX_READ_DONE(pOtherBuffer, pOtherBuffer->pSinkRead[e_LOGGER_SINK_FLASH]))
+            {
+                Logger_SummaryMergePending(gLoggerManager.FlashMng.CurrSectorAddr);
+            }
+            pRxBuffer->Flags.IsFlashCut = (CALC_RX_DISTANCE(pRxBuffer, pStr + SizeToWrite, Logger_RxRecordEnd(pRxBuffer, pStr + SizeToWrite)) != 0);
+            Logger_FlashSinkUnlock(IsLocked);
+            
+            /* save in eeprom the new write address for next reset */
+            if(gLoggerManager.pCbList->SaveNVRParamsCb != NULL)
+            {
+                gLoggerManager.pCbList->SaveNVRParamsCb(LOGGER_CONFIG_NVR_ADDRESS, &gLoggerManager.FlashMng, LOGGER_CONFIG_NVR_SIZE_BYTES);
+            }
+        }
+        else
+        {
+            /* nothing was written, keep the log messages in RAM and try again on the next drain */
+            return 0;
+        }
+    }
+    else
+    {
+        /* we have configured destination type FLASH but no flash write callback was initiated */
+        OSAL_ASSERT(0);
+        return 0;
+    }
+    
+    return SizeToWrite;
+}
+
+/**
+ * <pre>
+ * static BOOL Logger_IsFlashSinkEnabled(void)
+ * </pre>
+ *  
+ * this function returns whether the log messages should be written to FLASH (PULL or PUSH_PULL mode)
+ *
+ * @return TRUE if the FLASH sink is enabled, or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static BOOL Logger_IsFlashSinkEnabled(void)
+{
+    return LOGGER_DEF_IS_DEST_FLASH(LOGGER_DEF_FILTER.DestType);
+}
+
+/**
+ * <pre>
+ * static BOOL Logger_IsSocketSinkEnabled(void)
+ * </pre>
+ *  
+ * this function returns whether the log messages should be sent to the remote debug server (PUSH or PUSH_PULL mode)
+ *
+ * @return TRUE if the socket sink is enabled, or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static BOOL Logger_IsSocketSinkEnabled(void)
+{
+    return LOGGER_DEF_IS_DEST_SOCKET(LOGGER_DEF_FILTER.DestType);
+}
+
+/**
+ * <pre>
+ * static BOOL Logger_IsUartSinkEnabled(void)
+ * </pre>
+ *  
+ * this function returns whether the log messages should be printed out to the RS232
+ *
+ * @return TRUE if the UART sink is enabled, or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static BOOL Logger_IsUartSinkEnabled(void)
+{
+    return LOGGER_DEF_FILTER.IsPrintoutEnabled && gLoggerManager.pCbList->SendUartDataCb != NULL;
+}
+
+/**
+ * <pre>
+ * static LOGGER_STATUS Logger_SendSinkFlash(char *pStr, uint16 *pStrLen, BOOL IsPriority)
+ * </pre>
+ *  
+ * this function writes a log messages buffer to FLASH. 
+ * NOTE: the log messages are dropped while the FLASH is not ready (during init, dump or upload)
+ *
+ * @param   pStr            [in]    The input log messages RAM buffer to write
+ * @param   pStrLen         [inout] The input buffer length in bytes, returns the size written to FLASH
+ * @param   IsPriority      [in]    Is the buffer from the ERROR and CRITICAL records RX buffer
+ *
+ * @return LOGGER_STATUS_OK
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static LOGGER_STATUS Logger_SendSinkFlash(IN char *pStr, INOUT uint16 *pStrLen, IN BOOL IsPriority)
+{
+    /* the FLASH is ready while the socket of PUSH_PULL mode is reopened */
+    if(gLoggerManager.State == e_LOGGER_STATE_READY || gLoggerManager.State == e_LOGGER_STATE_OPENING_SOCKET)
+    {
+        *pStrLen = Logger_SendPacketFlash(pStr, *pStrLen, IsPriority);
+    }
+    else
+    {
+        /* the rest of a record cut in FLASH is dropped too */
+        (IsPriority? &gLoggerManager.PriorityBuffer: &gLoggerManager.RxBuffer)->Flags.IsFlashCut = 0;
+    }
+    return LOGGER_STATUS_OK;
+}
+
+/**
+ * <pre>
+ * static LOGGER_STATUS Logger_SendSinkSocket(char *pStr, uint16 *pStrLen, BOOL IsPriority)
+ * </pre>
+ *  
+ * this function sends a log messages buffer to the remote debug server socket.
+ * NOTE: the log messages are dropped while the socket is not ready
+ *
+ * @param   pStr            [in]    The input log messages RAM buffer to send
+ * @param   pStrLen         [inout] The input buffer length in bytes
+ * @param   IsPriority      [in]    Is the buffer from the ERROR and CRITICAL records RX buffer (sent in high priority)
+ *
+ * @return LOGGER_STATUS_OK on success, or the socket send callback error status
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static LOGGER_STATUS Logger_SendSinkSocket(IN char *pStr, INOUT uint16 *pStrLen, IN BOOL IsPriority)
+{
+    if(gLoggerManager.pCbList->SendSocketDataCb != NULL && gLoggerManager.State == e_LOGGER_STATE_READY)
+    {
+        return gLoggerManager.pCbList->SendSocketDataCb((uint8 *)pStr, *pStrLen, LOGGER_MODE_TYPE_PUSH, 
+                                                        IsPriority? LOGGER_SOCKET_PRIORITY_HIGH: LOGGER_SOCKET_PRIORITY_LOW);
+    }
+    return LOGGER_STATUS_OK;
+}
+
+/**
+ * <pre>
+ * static LOGGER_STATUS Logger_SendSinkUart(char *pStr, uint16 *pStrLen, BOOL IsPriority)
+ * </pre>
+ *  
+ * this function prints out a log messages buffer to the RS232 (using the polled UART write in panic mode).
+ *
+ * @param   pStr            [in]    The input log messages RAM buffer to print
+ * @param   pStrLen         [inout] The input buffer length in bytes
+ * @param   IsPriority      [in]    Is the buffer from the ERROR and CRITICAL records RX buffer (not used)
+ *
+ * @return LOGGER_STATUS_OK on success, or the UART send callback error status
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static LOGGER_STATUS Logger_SendSinkUart(IN char *pStr, INOUT uint16 *pStrLen, IN BOOL IsPriority)
+{
+    /* the UART task does not run while the interrupts are disabled */
+    if(gLoggerManager.Flags.IsPanic)
+    {
+        return gLoggerManager.pCbList->PanicUartWriteCb(pStr, *pStrLen);
+    }
+    return gLoggerManager.pCbList->SendUartDataCb(pStr, *pStrLen);
+}
+
+/* the RX buffer sinks, indexed by LoggerSink_e. the FLASH is written once on every drain pass */
+static const LoggerSink_t gLoggerSinkTable[e_LOGGER_SINK_MAX] = {
+    {Logger_IsFlashSinkEnabled,  Logger_SendSinkFlash,  1, TRUE},
+    {Logger_IsSocketSinkEnabled, Logger_SendSinkSocket, 2, TRUE},
+    {Logger_IsUartSinkEnabled,   Logger_SendSinkUart,   2, FALSE},
+};
+
+/**
+ * <pre>
+ * static inline BOOL Logger_IsPanicSink(uint8 SinkId)
+ * </pre>
+ *  
+ * this function returns whether a sink can be written with the interrupts disabled (panic flush). 
+ * the FLASH is written synchronously, the RS232 needs the polled UART write callback and the socket is never written.
+ *
+ * @param   SinkId          [in]    The sink (see LoggerSink_e)
+ *
+ * @return TRUE if the sink is written on panic flush, or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline BOOL Logger_IsPanicSink(IN uint8 SinkId)
+{
+    return (SinkId == e_LOGGER_SINK_FLASH || (SinkId == e_LOGGER_SINK_UART && gLoggerManager.pCbList->PanicUartWriteCb != NULL));
+}
+
+/**
+ * <pre>
+ * static inline char *Logger_SendPacketToSink(RXBuffer_t *pRxBuffer, uint8 SinkId, char *pRead, char *pWrite, BOOL IsPriority, uint8 MaxChunks, uint16 *pBudget)
+ * </pre>
+ *  
+ * this function sends the RAM log buffer from the sink read pointer up to the write pointer. 
+ * the sink read pointer is advanced only by the size the sink consumed, so a busy sink does not affect the other sinks.
+ * it does not move the RX buffer pointers, so the drain task calls it without the RX buffer mutex
+ *
+ * @param   pRxBuffer       [inout] The RX buffer to send from
+ * @param   SinkId          [in]    The sink to send to (see LoggerSink_e)
+ * @param   pRead           [in]    The sink read pointer to send from
+ * @param   pWrite          [in]    The RX buffer write pointer to send up to
+ * @param   IsPriority      [in]    Is the RX buffer the ERROR and CRITICAL records RX buffer
+ * @param   MaxChunks       [in]    The maximum number of chunks to send
+ * @param   pBudget         [inout] Optional. The maximum bytes to send, returns the budget left (NULL for no limit)
+ *
+ * @return the new sink read pointer
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline char *Logger_SendPacketToSink(INOUT RXBuffer_t *pRxBuffer, IN uint8 SinkId, IN char *pRead, IN char *pWrite, IN BOOL IsPriority, 
+                                            IN uint8 MaxChunks, INOUT uint16 *pBudget)
+{
+    const LoggerSink_t *pSink = &gLoggerSinkTable[SinkId];
+    
+    LOGGER_STATUS Status;
+    
+    uint32 StartCycles;
+    
+    uint16 StrLen;
+    
+    uint8 Chunk;
+    
+    /* send data till the end of buffer, and from the buffer head on wrap around */
+    for(Chunk = 0; Chunk < MaxChunks && pRead != pWrite && (pBudget == NULL || *pBudget > 0); Chunk++)
+    {
+        StrLen = CALC_BUF_SIZE_TO_READ(pRead, pWrite, pRxBuffer->pTail);
+        
+        if(StrLen > LOGGER_CONFIG_MAX_TX_MESSAGE_SIZE_BYTES)
+            StrLen = LOGGER_CONFIG_MAX_TX_MESSAGE_SIZE_BYTES;
+        
+        if(pBudget != NULL && StrLen > *pBudget)
+            StrLen = *pBudget;
+        
+        StartCycles = Logger_ProbeStart();
+        
+        Status = pSink->SendCb(pRead, &StrLen, IsPriority);
+        
+        Logger_ProbeEnd(e_LOGGER_PROBE_SINK_FLASH + SinkId, StartCycles);
+        
+        if(Status != LOGGER_STATUS_OK)
+        {
+            pRxBuffer->BusyCnt++;
+            break;
+        }
+        if(StrLen == 0)
+        {
+            break;
+        }
+        /* update the numbers of TX packets sent */
+        pRxBuffer->TxCounter++;
+        if(pBudget != NULL)
+        {
+            *pBudget -= StrLen;
+        }
+        /* update the sink read pointer */
+        pRead += StrLen;
+        
+        /* wrap around case */
+        if(pRead == pRxBuffer->pTail)
+        {
+            pRead = pRxBuffer->pHead;
+        }
+    }
+    return pRead;
+}
+
+/**
+ * <pre>
+ * static inline BOOL Logger_IsSinkHeld(RXBuffer_t *pRxBuffer, uint8 SinkId)
+ * </pre>
+ *  
+ * this function returns whether the drain task is sending an RX buffer range to a sink without the RX buffer mutex.
+ * the sink read pointer is moved by the drain task once the range was sent
+ *
+ * @param   pRxBuffer       [in]    The RX buffer
+ * @param   SinkId          [in]    The sink (see LoggerSink_e)
+ *
+ * @return TRUE if the sink range is held by the drain task, or FALSE otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline BOOL Logger_IsSinkHeld(IN RXBuffer_t *pRxBuffer, IN uint8 SinkId)
+{
+    return (pRxBuffer->pDrainHold != NULL && (gLoggerManager.DrainMng.InFlightMask & (1<<SinkId)));
+}
+
+/**
+ * <pre>
+ * static inline void Logger_ReclaimRxBuffer(RXBuffer_t *pRxBuffer)
+ * </pre>
+ *  
+ * this function moves the RX buffer read pointer to the slowest sink read pointer.
+ * an optional sink may lag behind the required sinks, but once it lags more than LOGGER_CONFIG_SINK_MAX_LAG_BYTES
+ * it is dropped to the slowest required sink. if no sink is enabled the RX buffer is emptied.
+ * a sink the drain task is sending to holds the RX buffer like a required sink.
+ * NOTE: this function is called under the RX buffer mutex
+ *
+ * @param   pRxBuffer       [inout] The RX buffer to reclaim
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline void Logger_ReclaimRxBuffer(INOUT RXBuffer_t *pRxBuffer)
+{
+    char *pWrite = pRxBuffer->pWrite;
+    
+    char *pRequiredRead = pWrite;
+    
+    uint16 RequiredLag = 0, Lag, MaxLag;
+    
+    uint8 SinkId;
+    
+    /* find the slowest required sink */
+    for(SinkId = 0; SinkId < e_LOGGER_SINK_MAX; SinkId++)
+    {
+        if(gLoggerSinkTable[SinkId].IsEnabledCb() && (gLoggerSinkTable[SinkId].IsRequired || Logger_IsSinkHeld(pRxBuffer, SinkId)))
+        {
+            Lag = CALC_RX_DISTANCE(pRxBuffer, pRxBuffer->pSinkRead[SinkId], pWrite);
+            if(Lag > RequiredLag)
+            {
+                RequiredLag = Lag;
+                pRequiredRead = pRxBuffer->pSinkRead[SinkId];
+            }
+        }
+    }
+    pRxBuffer->pRead = pRequiredRead;
+    MaxLag = RequiredLag;
+    
+    /* the optional sinks hold the RX buffer space up to their maximum lag */
+    for(SinkId = 0; SinkId < e_LOGGER_SINK_MAX; SinkId++)
+    {
+        if(gLoggerSinkTable[SinkId].IsEnabledCb() && !gLoggerSinkTable[SinkId].IsRequired && !Logger_IsSinkHeld(pRxBuffer, SinkId))
+        {
+            Lag = CALC_RX_DISTANCE(pRxBuffer, pRxBuffer->pSinkRead[SinkId], pWrite);
+            if(Lag > RequiredLag && Lag > LOGGER_CONFIG_SINK_MAX_LAG_BYTES)
+            {
+                pRxBuffer->pSinkRead[SinkId] = pRequiredRead;
+                pRxBuffer->SinkDropCnt[SinkId]++;
+            }
+            else if(Lag > MaxLag)
+            {
+                MaxLag = Lag;
+                pRxBuffer->pRead = pRxBuffer->pSinkRead[SinkId];
+            }
+        }
+    }
+}
+
+/**
+ * <pre>
+ * static inline void Logger_PanicSendRxBuffer(RXBuffer_t *pRxBuffer, BOOL IsPriority, uint16 *pPanicBudget)
+ * </pre>
+ *  
+ * this function sends an RX buffer to the sinks that can be written with the interrupts disabled, each from its own read 
+ * pointer, and frees the buffer space all the sinks have sent. a sink the drain task is sending to is left to the drain task.
+ * NOTE: this function is called by the panic flush, under the RX buffer mutex or with the interrupts disabled
+ *
+ * @param   pRxBuffer       [inout] The RX buffer to send
+ * @param   IsPriority      [in]    Is the RX buffer the ERROR and CRITICAL records RX buffer
+ * @param   pPanicBudget    [inout] The bytes left to send to every sink (indexed by LoggerSink_e)
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline void Logger_PanicSendRxBuffer(INOUT RXBuffer_t *pRxBuffer, IN BOOL IsPriority, INOUT uint16 *pPanicBudget)
+{
+    /* the sinks are sent up to the same write pointer */
+    char *pWrite = pRxBuffer->pWrite;
+    
+    uint8 SinkId;
+    
+    /* check working conditions */
+    if(IS_RX_EMPTY(pRxBuffer))
+    {
+        return;
+    }
+    for(SinkId = 0; SinkId < e_LOGGER_SINK_MAX; SinkId++)
+    {
+        /* the FLASH state is shared by both RX buffers, so an in flight sink is skipped on both */
+        if(gLoggerManager.DrainMng.InFlightMask & (1<<SinkId))
+        {
+            continue;
+        }
+        /* a disabled sink does not hold the buffer and starts from the new messages once enabled */
+        if(!gLoggerSinkTable[SinkId].IsEnabledCb())
+        {
+            pRxBuffer->pSinkRead[SinkId] = pWrite;
+            continue;
+        }
+        if(Logger_IsPanicSink(SinkId))
+        {
+            pRxBuffer->pSinkRead[SinkId] = Logger_SendPacketToSink(pRxBuffer, SinkId, pRxBuffer->pSinkRead[SinkId], pWrite, IsPriority, 
+                                                                   0xFF, &pPanicBudget[SinkId]);
+        }
+    }
+    /* free the buffer space all the sinks have sent */
+    Logger_ReclaimRxBuffer(pRxBuffer);
+}
+
+/**
+ * <pre>
+ * static inline uint16 Logger_DrainSink(RXBuffer_t *pRxBuffer, uint8 SinkId, BOOL IsPriority)
+ * </pre>
+ *  
+ * this function sends an RX buffer to a sink from the drain task. the sink range is taken under the RX buffer mutex and 
+ * held (pDrainHold), the sink I/O is done without the mutex, and the sink read pointer is moved under the mutex again.
+ * so the log producers never wait for the sinks I/O, and the overrun path does not free the range while it is sent.
+ *
+ * @param   pRxBuffer       [inout] The RX buffer to send
+ * @param   SinkId          [in]    The sink to send to (see LoggerSink_e)
+ * @param   IsPriority      [in]    Is the RX buffer the ERROR and CRITICAL records RX buffer
+ *
+ * @return the number of bytes sent
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline uint16 Logger_DrainSink(INOUT RXBuffer_t *pRxBuffer, IN uint8 SinkId, IN BOOL IsPriority)
+{
+    LoggerDrainMng_t *pDrain = &gLoggerManager.DrainMng;
+    
+    char *pStart;
+    
+    char *pRead;
+    
+    char *pWrite;
+    
+    OSAL_PortMutexCapture(pRxBuffer->pMutex);
+    
+    /* a disabled sink does not hold the buffer and starts from the new messages once enabled */
+    if(!gLoggerSinkTable[SinkId].IsEnabledCb())
+    {
+        pRxBuffer->pSinkRead[SinkId] = pRxBuffer->pWrite;
+        OSAL_PortMutexRelease(pRxBuffer->pMutex);
+        return 0;
+    }
+    /* the sink is sent up to the write pointer of now, even if new messages are written meanwhile */
+    pStart = pRxBuffer->pSinkRead[SinkId];
+    pWrite = pRxBuffer->pWrite;
+    if(pStart == pWrite)
+    {
+        OSAL_PortMutexRelease(pRxBuffer->pMutex);
+        return 0;
+    }
+    pRxBuffer->pDrainHold = pStart;
+    pDrain->InFlightMask = (1<<SinkId);
+    
+    OSAL_PortMutexRelease(pRxBuffer->pMutex);
+    
+    pRead = Logger_SendPacketToSink(pRxBuffer, SinkId, pStart, pWrite, IsPriority, gLoggerSinkTable[SinkId].MaxChunks, NULL);
+    
+    OSAL_PortMutexCapture(pRxBuffer->pMutex);
+    
+    /* the RX buffer was reset while it was sent (the hold was dropped), the sent range is no longer in the buffer */
+    if(pRxBuffer->pDrainHold == pStart)
+    {
+        pRxBuffer->pSinkRead[SinkId] = pRead;
+    }
+    pRxBuffer->pDrainHold = NULL;
+    pDrain->InFlightMask = 0;
+    
+    OSAL_PortMutexRelease(pRxBuffer->pMutex);
+    
+    return CALC_RX_DISTANCE(pRxBuffer, pStart, pRead);
+}
+
+/**
+ * <pre>
+ * static inline uint16 Logger_DrainRxBuffer(RXBuffer_t *pRxBuffer, BOOL IsPriority)
+ * </pre>
+ *  
+ * this function sends an RX buffer to all the enabled sinks, each from its own read pointer (see Logger_DrainSink), 
+ * and frees the buffer space all the sinks have sent.
+ *
+ * @param   pRxBuffer       [inout] The RX buffer to send
+ * @param   IsPriority      [in]    Is the RX buffer the ERROR and CRITICAL records RX buffer
+ *
+ * @return the largest number of bytes a sink has sent
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline uint16 Logger_DrainRxBuffer(INOUT RXBuffer_t *pRxBuffer, IN BOOL IsPriority)
+{
+    uint16 MaxSent = 0, Sent;
+    
+    uint8 SinkId;
+    
+    for(SinkId = 0; SinkId < e_LOGGER_SINK_MAX; SinkId++)
+    {
+        Sent = Logger_DrainSink(pRxBuffer, SinkId, IsPriority);
+        if(Sent > MaxSent)
+        {
+            MaxSent = Sent;
+        }
+    }
+    /* free the buffer space all the sinks have sent */
+    OSAL_PortMutexCapture(pRxBuffer->pMutex);
+    Logger_ReclaimRxBuffer(pRxBuffer);
+    OSAL_PortMutexRelease(pRxBuffer->pMutex);
+    
+    return MaxSent;
+}
+
+/**
+ * <pre>
+ * static inline uint32 Logger_GetTimeUs(void)
+ * </pre>
+ *  
+ * this function returns the platform free running us counter, used for the drain budget and statistics
+ *
+ * @return the time in us, or 0 if the platform has no GetTimeUsCb
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline uint32 Logger_GetTimeUs(void)
+{
+    return (gLoggerManager.pCbList->GetTimeUsCb != NULL)? gLoggerManager.pCbList->GetTimeUsCb(): 0;
+}
+
+/**
+ * <pre>
+ * static inline void Logger_SignalDrainTask(void)
+ * </pre>
+ *  
+ * this function wakes up the drain task (LogDrainTask) to send the RX buffers to the sinks
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline void Logger_SignalDrainTask(void)
+{
+    OSAL_Msg *pMessage;
+        
+    /* build message */
+    pMessage               = OSAL_MsgNew();
+    pMessage->cmd          = e_LOGGER_CMD_DRAIN;
+    pMessage->src          = TASK_APP_LOGGER_DRAIN_ID;
+    pMessage->origSrc      = TASK_APP_LOGGER_DRAIN_ID;
+    pMessage->dst          = TASK_APP_LOGGER_DRAIN_ID;
+    pMessage->reply        = FALSE;
+    pMessage->status       = 0;
+    pMessage->pDataIn      = NULL;
+    pMessage->DataInLen    = 0;
+    pMessage-> CntrlBits   = 0;
+    pMessage-> pDataOut    = NULL ;
+    pMessage-> DataOutLen  = 0 ;
+    pMessage-> userTag     = 0;
+  
+    /* send message */
+    OSAL_SendMessageToTask(pMessage);
+}
+
+/**
+ * <pre>
+ * static inline BOOL Logger_RecordStart(uint8 level, LoggerRecordCtx_t *pCtx)
+ * </pre>
+ *  
+ * this function starts writing a record (Logger_printf or Logger_kv): it filters the record, waits for the RX buffer 
+ * space by the lossless policy, captures the RX buffer mutex, counts the record in the FLASH sector summary and empties 
+ * the staging buffer. the record is written to the staging buffer first, so the overrun policy knows its exact length
+ *
+ * @param   level        [in]       The record log level
+ * @param   pCtx         [out]      The record context, for Logger_RecordEnd
+ *
+ * @return TRUE if the record is written, FALSE if it is filtered out (the mutex is not captured)
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline BOOL Logger_RecordStart(IN uint8 level, OUT LoggerRecordCtx_t *pCtx)
+{
+    const LoggerFilterSnapshot_t *pFilter;
+    
+    uint32 ProbeCycles;
+    
+    /* the filter snapshot is read once, so the record is filtered by a consistent configuration */
+    pFilter = gLoggerManager.FilterMng.pActive;
+    
+    /* check the condition to use the logger */
+    if(pFilter == NULL)
+        return FALSE;
+    
+    pCtx->TaskId = OSAL_GetSelfTaskId();
+    
+    /* the task statistics entry is written by the task only, so it is updated without locking */
+    pCtx->pTaskStats = &gLoggerManager.TaskStats[LOGGER_DEF_TASK_STATS_IDX(pCtx->TaskId)];
+    
+    if(!pFilter->IsEnabled || (pFilter->LogLevel != LEVEL_CRITICAL && (~pFilter->ModuleMask & (1<<pCtx->TaskId) || pFilter->LogLevel < level)))
+    {
+        pCtx->pTaskStats->FilteredMsgs++;
+        return FALSE;
+    }
+    
+    /* the filtered out records are not sampled */
+    pCtx->StartCycles = Logger_ProbeStart();
+    
+    pCtx->pFilter = pFilter;
+    pCtx->Level = level;
+    pCtx->RecordTime = 0;
+    
+    /* ERROR and CRITICAL records are written to their reserved buffer, so they are never run over by lower levels */
+    pCtx->pRxBuffer = IS_PRIORITY_LEVEL(level)? &gLoggerManager.PriorityBuffer: &gLoggerManager.RxBuffer;
+    
+    /* lossless policy - wait for the sinks to free the RX buffer before taking the mutex */
+    if(pFilter->Attributes & LOGGER_ATTR_OVERRUN_BLOCK)
+    {
+        Logger_WaitRxBufferSpace(pCtx->pRxBuffer, pCtx->TaskId);
+    }
+    
+    /* first lock mutex */
+    ProbeCycles = Logger_ProbeStart();
+
+    OSAL_PortMutexCapture(gLoggerManager.RxBuffer.pMutex);
+
+    Logger_ProbeEnd(e_LOGGER_PROBE_MUTEX_WAIT, ProbeCycles);
+
+    /* count the record in the FLASH sector summary before it reaches the RX buffer */
+    if(LOGGER_DEF_IS_DEST_FLASH(pFilter->DestType))
+    {
+        pCtx->RecordTime = Logger_SummaryAddRecord(level, pCtx->TaskId);
+    }
+
+    gLoggerStagingBuffer.pHead = gLoggerStagingBuffer.pWrite = gLoggerStagingMessage;
+    gLoggerStagingBuffer.pTail = gLoggerStagingMessage + sizeof(gLoggerStagingMessage);
+    
+    return TRUE;
+}
+
+/**
+ * <pre>
+ * static inline void Logger_RecordEnd(LoggerRecordCtx_t *pCtx, const char *pSite, int Len)
+ * </pre>
+ *  
+ * this function commits the staged record to its RX buffer, updates the statistics, schedules the drain and releases 
+ * the RX buffer mutex (see Logger_RecordStart)
+ *
+ * @param   pCtx         [inout]    The record context
+ * @param   pSite        [in]       The record call site (the format string)
+ * @param   Len          [in]       The staged record length in bytes
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline void Logger_RecordEnd(INOUT LoggerRecordCtx_t *pCtx, IN const char *pSite, IN int Len)
+{
+    RXBuffer_t *pRxBuffer = pCtx->pRxBuffer;
+    
+    LoggerTaskStats_t *pTaskStats = pCtx->pTaskStats;
+    
+    if(Len <= 0)
+    {
+        //OSAL_ASSERT(FALSE);
+        goto EXIT;
+    }
+
+    /* update the numbers of Rx debug messages */
+    pRxBuffer->RxCounter++;
+    
+    if(!Logger_CommitRxMessage(pRxBuffer, gLoggerStagingMessage, Len, pTaskStats))
+    {
+        goto EXIT;
+    }
+    pTaskStats->AcceptedMsgs++;
+    pTaskStats->AcceptedBytes += Len;
+    
+    Logger_CallSiteCount(pSite, Len);
+
+    /* keep the record time until the record is written to FLASH */
+    if(LOGGER_DEF_IS_DEST_FLASH(pCtx->pFilter->DestType) && pRxBuffer == &gLoggerManager.RxBuffer)
+    {
+        Logger_SummaryAddRecordEnd(pCtx->RecordTime, pRxBuffer->pWrite);
+    }
+    
+    /* the record survives a reset until it is sent */
+    Logger_NoInitUpdate();
+    
+    /* if log level is critical the record is written synchronously (the system may be about to reset), 
+       and the socket is sent ASAP */
+    if(LEVEL_CRITICAL == pCtx->Level)
+    {
+        Logger_PanicFlush();
+        Logger_FlushRxBuffer();    
+    }
+    else
+    {
+        /* wake up the idle TX timer, or speed it up once the buffer occupancy crossed the watermark */
+        Logger_ScheduleDrain();
+    }
+    
+EXIT:    
+    /* releae mutex */
+    OSAL_PortMutexRelease( gLoggerManager.RxBuffer.pMutex);
+    
+    Logger_ProbeEnd(e_LOGGER_PROBE_PRINTF, pCtx->StartCycles);
+}
+
+/**
+ * <pre>
+ * static inline BOOL Logger_KvAppend(int *pLen, const uint8 *pData, int DataLen)
+ * </pre>
+ *  
+ * this function appends bytes to the binary structured record in the staging buffer, escaped (see LOGGER_DEF_KV_ESCAPE)
+ *
+ * @param   pLen         [inout]    The record length in bytes
+ * @param   pData        [in]       The bytes to append
+ * @param   DataLen      [in]       The number of bytes to append
+ *
+ * @return TRUE if the bytes fit the record, nothing is appended otherwise
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline BOOL Logger_KvAppend(INOUT int *pLen, IN const uint8 *pData, IN int DataLen)
+{
+    uint8 *pRecord = (uint8 *)gLoggerStagingMessage;
+    
+    int Len = *pLen;
+    
+    int Idx;
+    
+    for(Idx = 0; Idx < DataLen; Idx++)
+    {
+        if(Len + LOGGER_DEF_KV_ESCAPED_LEN(pData[Idx]) > LOGGER_DEF_KV_MAX_LEN)
+        {
+            return FALSE;
+        }
+        if(LOGGER_DEF_KV_IS_ESCAPED(pData[Idx]))
+        {
+            pRecord[Len++] = LOGGER_DEF_KV_ESCAPE;
+            pRecord[Len++] = pData[Idx] ^ LOGGER_DEF_KV_ESCAPE_XOR;
+        }
+        else
+        {
+            pRecord[Len++] = pData[Idx];
+        }
+    }
+    *pLen = Len;
+    
+    return TRUE;
+}
+
+/**
+ * <pre>
+ * static inline int Logger_EncodeKvRecord(uint8 level, uint16 EventId, va_list ap)
+ * </pre>
+ *  
+ * this function writes a structured record to the staging buffer in binary: the LOGGER_DEF_KV_MARKER, the length of the 
+ * rest of the record, the level, the event ID (little endian) and the fields, and a line end so the line based readers 
+ * resync after it. a field is its key ID and a zigzag varint (INT), a varint (UINT) or the length and characters (STR). 
+ * the bytes after the marker are escaped, so a line end or 0xFF is never written inside the record
+ *
+ * @param   level        [in]       The record log level
+ * @param   EventId      [in]       The event ID
+ * @param   ap           [in]       The key ID and value pairs, ends with e_LOGGER_KV_KEY_END
+ *
+ * @return the record length in bytes
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline int Logger_EncodeKvRecord(IN uint8 level, IN uint16 EventId, IN va_list ap)
+{
+    uint8 *pRecord = (uint8 *)gLoggerStagingMessage;
+    
+    uint8 Field[1 + 5];
+    
+    /* the marker and room for an escaped length, the length is known at the end */
+    int Len = 3;
+    
+    /* the unescaped length of the rest of the record */
+    int RestLen = 3;
+    
+    int FieldLen;
+    
+    int Room;
+    
+    int Idx;
+    
+    uint32 Value;
+    
+    const char *pStr;
+    
+    uint8 Key;
+    
+    Field[0] = level;
+    Field[1] = (uint8)EventId;
+    Field[2] = (uint8)(EventId >> 8);
+    Logger_KvAppend(&Len, Field, 3);
+    
+    while((Key = (uint8)va_arg(ap, int)) != e_LOGGER_KV_KEY_END && Key < e_LOGGER_KV_KEY_MAX)
+    {
+        if(gLoggerKvKeyType[Key] == e_LOGGER_KV_TYPE_STR)
+        {
+            pStr = va_arg(ap, const char *);
+            
+            /* the key, the length (escaped or not) and at least one character */
+            Room = LOGGER_DEF_KV_MAX_LEN - Len - LOGGER_DEF_KV_ESCAPED_LEN(Key) - 2;
+            if(Room < 1)
+            {
+                break;
+            }
+            for(FieldLen = 0; FieldLen < 0xFF && pStr[FieldLen] != 0 && Room >= LOGGER_DEF_KV_ESCAPED_LEN((uint8)pStr[FieldLen]); FieldLen++)
+            {
+                Room -= LOGGER_DEF_KV_ESCAPED_LEN((uint8)pStr[FieldLen]);
+            }
+            Field[0] = Key;
+            Field[1] = (uint8)FieldLen;
+            Logger_KvAppend(&Len, Field, 2);
+            Logger_KvAppend(&Len, (const uint8 *)pStr, FieldLen);
+            RestLen += 2 + FieldLen;
+            continue;
+        }
+        Value = (uint32)va_arg(ap, int);
+        if(gLoggerKvKeyType[Key] == e_LOGGER_KV_TYPE_INT)
+        {
+            /* zigzag, so the small negative numbers are short too */
+            Value = (Value << 1) ^ (uint32)((int)Value >> 31);
+        }
+        Field[0] = Key;
+        FieldLen = 1 + Logger_PutVarint(&Field[1], Value);
+        if(!Logger_KvAppend(&Len, Field, FieldLen))
+        {
+            break;
+        }
+        RestLen += FieldLen;
+    }
+    pRecord[0] = LOGGER_DEF_KV_MARKER;
+    if(LOGGER_DEF_KV_IS_ESCAPED(RestLen))
+    {
+        pRecord[1] = LOGGER_DEF_KV_ESCAPE;
+        pRecord[2] = (uint8)RestLen ^ LOGGER_DEF_KV_ESCAPE_XOR;
+    }
+    else
+    {
+        /* the rest of the record is moved over the unused length byte */
+        pRecord[1] = (uint8)RestLen;
+        for(Idx = 2; Idx < Len - 1; Idx++)
+        {
+            pRecord[Idx] = pRecord[Idx + 1];
+        }
+        Len--;
+    }
+    pRecord[Len++] = '\n';
+    
+    return Len;
+}
+
+/**
+ * <pre>
+ * static inline int Logger_RenderKvRecord(uint16 EventId, va_list ap)
+ * </pre>
+ *  
+ * this function writes a structured record to the staging buffer as text: the event name and a key=value of every 
+ * field, separated by spaces. the UINT values above the int range are written in hexadecimal
+ *
+ * @param   EventId      [in]       The event ID
+ * @param   ap           [in]       The key ID and value pairs, ends with e_LOGGER_KV_KEY_END
+ *
+ * @return the record length in bytes
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static inline int Logger_RenderKvRecord(IN uint16 EventId, IN va_list ap)
+{
+    /* room for the line end */
+    int MaxSize = LOGGER_CONFIG_MAX_RX_MESSAGE_SIZE_BYTES - 2;
+    
+    int Value;
+    
+    uint8 Key;
+    
+    if(EventId < e_LOGGER_KV_EVENT_MAX)
+    {
+        Logger_ParseAndWriteString(gLoggerKvEventStr[EventId], &MaxSize, 0, 0xFF);
+    }
+    else
+    {
+        Logger_ParseAndWriteNumber(EventId, 10, &MaxSize, 0);
+    }
+    while(MaxSize > 1 && (Key = (uint8)va_arg(ap, int)) != e_LOGGER_KV_KEY_END && Key < e_LOGGER_KV_KEY_MAX)
+    {
+        *P_BUFF_ITER++ = ' ';
+        MaxSize--;
+        Logger_ParseAndWriteString(gLoggerKvKeyStr[Key], &MaxSize, 0, 0xFF);
+        Logger_ParseAndWriteString("=", &MaxSize, 0, 0xFF);
+        if(gLoggerKvKeyType[Key] == e_LOGGER_KV_TYPE_STR)
+        {
+            Logger_ParseAndWriteString(va_arg(ap, char *), &MaxSize, 0, 0xFF);
+            continue;
+        }
+        Value = va_arg(ap, int);
+        
+        /* a number is not split, the staging buffer does not wrap around */
+        if(MaxSize <= LOGGER_DEF_KV_MAX_NUM_TEXT_LEN)
+        {
+            break;
+        }
+        if(gLoggerKvKeyType[Key] == e_LOGGER_KV_TYPE_UINT && Value < 0)
+        {
+            Logger_ParseAndWriteString("0x", &MaxSize, 0, 0xFF);
+            Logger_ParseAndWriteNumber(Value, 16, &MaxSize, 0);
+        }
+        else
+        {
+            Logger_ParseAndWriteNumber(Value, 10, &MaxSize, 0);
+        }
+    }
+    *P_BUFF_ITER++ = '\r';
+    *P_BUFF_ITER++ = '\n';
+    
+    return (int)(P_BUFF_ITER - P_BUFF_HEAD);
+}
+
+                /* ========================================== *
+                 *     P U B L I C     F U N C T I O N S      *
+                 * ========================================== */
+
+/**
+ * <pre>
+ * void Logger_printf(uint8 level, const char *fmt, ...)
+ * </pre>
+ *  
+ * this function is a customized printf log for debug. it's currently support the following parameters:
+ *                                  %c - prints an ascii character
+ *                                  %s - prints a string (must be null terminated)
+ *                                  %d or %i - prints a decimal number
+ *                                  %x - prints an hexadecimal number
+ *                                  %r - translate (and prints) a binary buffer to an hexadecimal buffer. (must get size as well)
+ *                                  %b - prints a binary buffer (without translate to hexa. must get size as well)
+ *                                  %T - prints the current date and time in format DD/MM/YY HH:MM:SS
+ *                                  
+ * @param   level                   [in]    The log level
+ * @param   fmt                     [in]    The input string
+ * @param   ...                     [in]    a list of printf style arbitrary parameters (must match to the % in the string).
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_printf(uint8 level, const char *fmt, ...)
+{
+    int Len;
     
-    /* first lock mutex */
-
-     OSAL_PortMutexCapture(gLoggerManager.RxBuffer.pMutex);
+    va_list ap;
+    
+    LoggerRecordCtx_t Ctx;
+    
+    uint32 ProbeCycles;
+    
+    if(!Logger_RecordStart(level, &Ctx))
+        return;
 
     va_start(ap, fmt);
 
-    /* parse the arguments to string and write it to the ciruclar buffer */
+    /* parse the arguments to string and write it to the staging buffer */
+    ProbeCycles = Logger_ProbeStart();
+    
     Len = Logger_ParseAndWriteRxMessage(level, fmt, ap);
     
+    Logger_ProbeEnd(e_LOGGER_PROBE_PARSE, ProbeCycles);
+    
     va_end(ap);
 
-    if(Len <= 0)
+    Logger_RecordEnd(&Ctx, fmt, Len);
+}
+
+/**
+ * <pre>
+ * void Logger_kv(uint8 level, uint16 EventId, ...)
+ * </pre>
+ *  
+ * this function writes a structured record: an event and a list of typed fields. every field is a key ID (LoggerKvKey_e, 
+ * see Logger_KvKeys.h) followed by its value, the value type is set by the key. the list ends with e_LOGGER_KV_KEY_END 
+ * (the LOG_KV macro adds it). the record is written in binary (see LOGGER_DEF_KV_MARKER), or as key=value text with 
+ * LOGGER_ATTR_KV_TEXT. the fields that do not fit the record, and the fields after an unknown key, are dropped.
+ *                                  
+ * @param   level                   [in]    The log level
+ * @param   EventId                 [in]    The event ID (LoggerKvEvent_e)
+ * @param   ...                     [in]    a list of key ID and value pairs, ends with e_LOGGER_KV_KEY_END
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_kv(uint8 level, uint16 EventId, ...)
+{
+    int Len;
+    
+    va_list ap;
+    
+    LoggerRecordCtx_t Ctx;
+    
+    uint32 ProbeCycles;
+    
+    if(!Logger_RecordStart(level, &Ctx))
+        return;
+    
+    va_start(ap, EventId);
+    
+    ProbeCycles = Logger_ProbeStart();
+    
+    Len = (Ctx.pFilter->Attributes & LOGGER_ATTR_KV_TEXT)? Logger_RenderKvRecord(EventId, ap): Logger_EncodeKvRecord(level, EventId, ap);
+    
+    Logger_ProbeEnd(e_LOGGER_PROBE_PARSE, ProbeCycles);
+    
+    va_end(ap);
+    
+    /* the event is the call site of the top talkers report */
+    Logger_RecordEnd(&Ctx, (EventId < e_LOGGER_KV_EVENT_MAX)? gLoggerKvEventStr[EventId]: "kv", Len);
+}
+
+/**
+ * <pre>
+ * void Logger_SendPacketFromInt(void)
+ * </pre>
+ *  
+ * this function wakes up the drain task to send the RAM log buffers to the sinks (see Logger_DrainRxBuffers). 
+ * it does no sink I/O, so its execution time is short and bounded.
+ * NOTE: this function is called from HW timer interrupt, every ResolutionMS (general configuration) or LOGGER_CONFIG_HIGH_RESOLUTION_MS
+ *       while the RX buffers are above the watermark. the timer is stopped once the RX buffers are empty (see Logger_ScheduleDrain)
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+
+void Logger_SendPacketFromInt(void)
+{
+    LoggerDrainMng_t *pDrain = &gLoggerManager.DrainMng;
+    
+    uint32 StartCycles = Logger_ProbeStart();
+    
+    uint32 StartUs = Logger_GetTimeUs();
+    
+    pDrain->WakeupCnt++;
+    
+    /* the oldest unsent byte has waited (at most) another timer period */
+    pDrain->PendingAgeMS += (pDrain->Resolution == LOGGER_RESOLUTION_TYPE_HIGH)? LOGGER_CONFIG_HIGH_RESOLUTION_MS: LOGGER_DEF_GEN_CONFIG.ResolutionMS;
+    
+    /* a single wake up message is pending at a time */
+    if(!pDrain->IsSignaled)
     {
-        //OSAL_ASSERT(FALSE);
-        goto EXIT;
+        pDrain->IsSignaled = TRUE;
+        Logger_SignalDrainTask();
     }
+    StartUs = Logger_GetTimeUs() - StartUs;
+    
+    if(StartUs > pDrain->IsrMaxUs)
+    {
+        pDrain->IsrMaxUs = StartUs;
+    }
+    
+    Logger_ProbeEnd(e_LOGGER_PROBE_TX_ISR, StartCycles);
+}
 
+/**
+ * <pre>
+ * uint8 Logger_GetSinksMask(void)
+ * </pre>
+ *  
+ * this function returns the sinks enabled by the published filter snapshot
+ *
+ * @return the enabled sinks, bit per sink (LoggerSink_e)
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+uint8 Logger_GetSinksMask(void)
+{
+    uint8 SinksMask = 0;
     
-    /* update the numbers of Rx debug messages */
-    gLoggerManager.RxBuffer.RxCounter++;
+    uint8 SinkId;
     
-    /* if log level is critical we want the logger to printout ASAP */
-    if(LEVEL_CRITICAL == level)
+    for(SinkId = 0; SinkId < e_LOGGER_SINK_MAX; SinkId++)
     {
-        Logger_FlushRxBuffer();    
+        if(gLoggerSinkTable[SinkId].IsEnabledCb())
+        {
+            SinksMask |= (1<<SinkId);
+        }
     }
-    
-EXIT:    
-    /* releae mutex */
-    OSAL_PortMutexRelease( gLoggerManager.RxBuffer.pMutex);
+    return SinksMask;
+}
 
+/**
+ * <pre>
+ * static void Logger_SwitchRxBufferSinks(RXBuffer_t *pRxBuffer, uint8 PrevSinksMask)
+ * </pre>
+ *  
+ * this function moves an RX buffer to the sinks of the published filter snapshot, and keeps the log messages the old
+ * sinks did not send: a removed sink no longer holds the buffer, and a new sink sends from the first whole record that 
+ * was not sent (the read pointer may be in the middle of a record an old sink has cut). a kept sink is not moved.
+ * NOTE: this function is called under the RX buffer mutex
+ *
+ * @param   pRxBuffer       [inout] The RX buffer
+ * @param   PrevSinksMask   [in]    The sinks before the switch, bit per sink (LoggerSink_e)
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+static void Logger_SwitchRxBufferSinks(INOUT RXBuffer_t *pRxBuffer, IN uint8 PrevSinksMask)
+{
+    char *pStart = pRxBuffer->pRead;
+    
+    uint8 SinkId;
+    
+    /* every record ends with a new line */
+    if(!IS_RX_EMPTY(pRxBuffer) && ((pStart == pRxBuffer->pHead)? pRxBuffer->pTail[-1]: pStart[-1]) != '\n')
+    {
+        pStart = Logger_RxRecordEnd(pRxBuffer, pStart);
+    }
+    for(SinkId = 0; SinkId < e_LOGGER_SINK_MAX; SinkId++)
+    {
+        if(!gLoggerSinkTable[SinkId].IsEnabledCb())
+        {
+            pRxBuffer->pSinkRead[SinkId] = pRxBuffer->pWrite;
+        }
+        else if(!(PrevSinksMask & (1<<SinkId)))
+        {
+            pRxBuffer->pSinkRead[SinkId] = pStart;
+        }
+    }
+    /* a record cut by the removed FLASH sink is not waited for */
+    if(!Logger_IsFlashSinkEnabled())
+    {
+        pRxBuffer->Flags.IsFlashCut = 0;
+    }
+    Logger_ReclaimRxBuffer(pRxBuffer);
 }
 
 /**
  * <pre>
- * void Logger_SendPacketFromInt(void)
+ * void Logger_SwitchRxBuffersSinks(uint8 PrevSinksMask)
  * </pre>
  *  
- * this function sends the RAM log buffer to the configured destination (RS232, socket, FLASH).
- * NOTE: this function is called every x ms (configurable parameter LOGGER_CONFIG_DEFAULT_RESOLUTION_MS) from HW timer interrupt.
+ * this function moves both RX buffers to the sinks of the published filter snapshot (a destination change) without 
+ * resetting them: the log messages the old sinks did not send and the RX buffers counters are kept (see 
+ * Logger_SwitchRxBufferSinks)
+ * NOTE: this function is called under the RX buffer mutex, right after the new sinks are published, so the drain task 
+ *       does not send to a new sink before its read pointer is set
+ *
+ * @param   PrevSinksMask   [in]    The sinks before the switch, bit per sink (LoggerSink_e, see Logger_GetSinksMask)
  *
  * @return none
  *
  * \defgroup LogManager
  * \ingroup LogManager
 */
+void Logger_SwitchRxBuffersSinks(IN uint8 PrevSinksMask)
+{
+    Logger_SwitchRxBufferSinks(&gLoggerManager.RxBuffer, PrevSinksMask);
+    Logger_SwitchRxBufferSinks(&gLoggerManager.PriorityBuffer, PrevSinksMask);
+}
 
-void Logger_SendPacketFromInt(void)
+/**
+ * <pre>
+ * void Logger_DrainRxBuffers(void)
+ * </pre>
+ *  
+ * this function sends the RAM log buffers to all the enabled sinks (FLASH, socket, RS232), each from its own read pointer.
+ * the ERROR and CRITICAL records buffer is always drained first. a single wake up sends up to LOGGER_CONFIG_DRAIN_BUDGET_BYTES 
+ * or LOGGER_CONFIG_DRAIN_BUDGET_US, the rest is sent on the next TX timer interrupt.
+ * NOTE: this function is called from the low priority drain task (LogDrainTask). the RX buffer mutex is held only to take 
+ *       and to move the sinks read pointers, never during the sinks I/O, so the log producers do not wait for this task
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_DrainRxBuffers(void)
 {
+    LoggerDrainMng_t *pDrain = &gLoggerManager.DrainMng;
     
-    int BuffToRead = CALC_BUF_SIZE_TO_READ(gLoggerManager.RxBuffer.pRead, gLoggerManager.RxBuffer.pWrite, gLoggerManager.RxBuffer.pTail);
+    RXBuffer_t *pRxBuffer = &gLoggerManager.RxBuffer;
     
-    OSAL_ASSERT(BuffToRead <= LOGGER_CONFIG_DOUBLE_BUFFER_SIZE_BYTES);
-    /* check working conditions */
-    if(!BuffToRead)
+    RXBuffer_t *pPriorityBuffer = &gLoggerManager.PriorityBuffer;
+    
+    uint32 StartUs = Logger_GetTimeUs();
+    
+    uint32 ElapsedUs = 0;
+    
+    uint32 TxCounter = pRxBuffer->TxCounter + pPriorityBuffer->TxCounter;
+    
+    uint32 PassTxCounter;
+    
+    uint16 BytesSent = 0;
+    
+    uint8 Bucket = 0;
+    
+    /* new wake ups are signaled from now on */
+    pDrain->IsSignaled = FALSE;
+    
+    if(pDrain->DrainStartUs == 0)
     {
-        return;
+        pDrain->DrainStartUs = StartUs;
+    }
+    OSAL_PortMutexCapture(pRxBuffer->pMutex);
+    
+    Logger_OccupancySample(CALC_RX_DISTANCE(pRxBuffer, pRxBuffer->pRead, pRxBuffer->pWrite));
+    
+    OSAL_PortMutexRelease(pRxBuffer->pMutex);
+    
+    do
+    {
+        PassTxCounter = pRxBuffer->TxCounter + pPriorityBuffer->TxCounter;
+        
+        /* ERROR and CRITICAL records are sent first, so their latency does not depend on the other records volume */
+        BytesSent += Logger_DrainRxBuffer(pPriorityBuffer, TRUE);
+        
+        BytesSent += Logger_DrainRxBuffer(pRxBuffer, FALSE);
+        
+        ElapsedUs = Logger_GetTimeUs() - StartUs;
+        
+        /* stop once the buffers are empty, the sinks are busy or the budget was used */
+    }while(!(IS_RX_EMPTY(pRxBuffer) && IS_RX_EMPTY(pPriorityBuffer)) && 
+           PassTxCounter != pRxBuffer->TxCounter + pPriorityBuffer->TxCounter &&
+           BytesSent < LOGGER_CONFIG_DRAIN_BUDGET_BYTES && ElapsedUs < LOGGER_CONFIG_DRAIN_BUDGET_US);
+    
+    if(BytesSent >= LOGGER_CONFIG_DRAIN_BUDGET_BYTES || ElapsedUs >= LOGGER_CONFIG_DRAIN_BUDGET_US)
+    {
+        pDrain->BudgetCnt++;
+    }
+    if(TxCounter == pRxBuffer->TxCounter + pPriorityBuffer->TxCounter)
+    {
+        pDrain->IdleWakeupCnt++;
+    }
+    else
+    {
+        /* count the latency of the sent bytes in its log2 ms bucket */
+        while(Bucket < LOGGER_DEF_DRAIN_LATENCY_BUCKETS - 1 && (pDrain->PendingAgeMS >> Bucket))
+        {
+            Bucket++;
+        }
+        pDrain->LatencyHist[Bucket]++;
+    }
+    OSAL_PortMutexCapture(pRxBuffer->pMutex);
+    
+    pRxBuffer->Flags.IsLowMemory = pRxBuffer->Flags.IsUrgent = 0;
+    pPriorityBuffer->Flags.IsLowMemory = 0;
+    Logger_ModeTimeUpdate(&pRxBuffer->LowMemoryTime, FALSE);
+    Logger_ModeTimeUpdate(&pPriorityBuffer->LowMemoryTime, FALSE);
+    
+    /* the sent records are not recovered after a reset */
+    Logger_NoInitUpdate();
+    
+    /* slow down or stop the timer according to what was left in the RX buffers */
+    Logger_ScheduleDrain();
+    
+    OSAL_PortMutexRelease(pRxBuffer->pMutex);
+    
+    pDrain->DrainBusyUs += ElapsedUs;
+    
+    if(ElapsedUs > pDrain->DrainMaxUs)
+    {
+        pDrain->DrainMaxUs = ElapsedUs;
+    }
+}
+
+/**
+ * <pre>
+ * BOOL Logger_FlashSinkLock(void)
+ * </pre>
+ *  
+ * this function protects the FLASH sink state the log producers share (the pending summary and the records times).
+ * the drain task writes the FLASH without the RX buffer mutex, so the mutex is captured here. the panic flush already
+ * holds the mutex (or has the interrupts disabled), and it never writes the FLASH while the drain task does.
+ *
+ * @return TRUE if the mutex was captured, to be passed to Logger_FlashSinkUnlock
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+BOOL Logger_FlashSinkLock(void)
+{
+    if(!(gLoggerManager.DrainMng.InFlightMask & (1<<e_LOGGER_SINK_FLASH)))
+    {
+        return FALSE;
+    }
+    OSAL_PortMutexCapture(gLoggerManager.RxBuffer.pMutex);
+    
+    return TRUE;
+}
+
+/**
+ * <pre>
+ * void Logger_FlashSinkUnlock(BOOL IsLocked)
+ * </pre>
+ *  
+ * this function releases the FLASH sink state protection (see Logger_FlashSinkLock)
+ *
+ * @param   IsLocked        [in]    The value Logger_FlashSinkLock has returned
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_FlashSinkUnlock(BOOL IsLocked)
+{
+    if(IsLocked)
+    {
+        OSAL_PortMutexRelease(gLoggerManager.RxBuffer.pMutex);
     }
-    /* send data till the end of buffer */
-    Logger_SendPacket(gLoggerManager.RxBuffer.pRead, BuffToRead,
-                              LOGGER_DEF_GEN_CONFIG.IsPrintoutEnabled, 
-                              LOGGER_DEF_GEN_CONFIG.DestType);
+}
+
+/**
+ * <pre>
+ * void Logger_ScheduleDrain(void)
+ * </pre>
+ *  
+ * this function sets the TX timer resolution according to the RX buffers occupancy:
+ *      empty                                   - the timer is stopped (no wake ups while nothing is logged)
+ *      above LOGGER_CONFIG_DRAIN_WATERMARK_PERCENT, low memory or urgent - LOGGER_RESOLUTION_TYPE_HIGH
+ *      otherwise                               - LOGGER_RESOLUTION_TYPE_LOW, the latency deadline of the oldest unsent byte
+ * NOTE: this function is called by the log producers and by the drain task, both under the RX buffer mutex. 
+ *       so a message written after the drain task has found the buffers empty restarts the timer itself.
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_ScheduleDrain(void)
+{
+    RXBuffer_t *pRxBuffer = &gLoggerManager.RxBuffer;
+    
+    RXBuffer_t *pPriorityBuffer = &gLoggerManager.PriorityBuffer;
     
-    if(!LOGGER_DEF_IS_RX_BUFFER_EMPTY()&&gLoggerManager.Config.General.DestType != LOGGER_DEST_TYPE_FLASH)
+    if(IS_RX_EMPTY(pRxBuffer) && IS_RX_EMPTY(pPriorityBuffer))
     {
-        BuffToRead = CALC_BUF_SIZE_TO_READ (gLoggerManager.RxBuffer.pRead, gLoggerManager.RxBuffer.pWrite, gLoggerManager.RxBuffer.pTail);
-        /* send data till the end of buffer */
-        Logger_SendPacket(gLoggerManager.RxBuffer.pRead, BuffToRead,
-                              LOGGER_DEF_GEN_CONFIG.IsPrintoutEnabled, 
-                              LOGGER_DEF_GEN_CONFIG.DestType);
+        gLoggerManager.DrainMng.PendingAgeMS = 0;
+        Logger_SetTxResolution(LOGGER_RESOLUTION_TYPE_IDLE);
     }
-    if(gLoggerManager.RxBuffer.Flags.IsLowMemory || gLoggerManager.RxBuffer.Flags.IsUrgent)
+    else if(pRxBuffer->Flags.IsUrgent || pRxBuffer->Flags.IsLowMemory || pPriorityBuffer->Flags.IsLowMemory ||
+            IS_RX_ABOVE_WATERMARK(pRxBuffer) || IS_RX_ABOVE_WATERMARK(pPriorityBuffer))
+    {
+        Logger_SetTxResolution(LOGGER_RESOLUTION_TYPE_HIGH);
+    }
+    else
     {
-        gLoggerManager.RxBuffer.Flags.IsLowMemory = gLoggerManager.RxBuffer.Flags.IsUrgent = 0;
         Logger_SetTxResolution(LOGGER_RESOLUTION_TYPE_LOW);
     }
 }
 
+/**
+ * <pre>
+ * void Logger_PanicFlush(void)
+ * </pre>
+ *  
+ * this function synchronously writes the RX buffers to the FLASH and to the polled RS232 with the interrupts disabled, 
+ * so the last log messages are kept even if the system is about to reset or hang. the ERROR and CRITICAL records buffer
+ * is written first. the socket is sent later by the drain task (if the system survives).
+ * the worst case time is bounded: up to LOGGER_CONFIG_PANIC_MAX_BYTES are written to every sink, and a full FLASH sector 
+ * is closed only if the next sector was already erased.
+ * NOTE: this function is called on CRITICAL records (under the RX buffer mutex) and from the crash paths (Logger_PanicFlushApi)
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_PanicFlush(void)
+{
+    uint16 Budget[e_LOGGER_SINK_MAX];
+    
+    uint32 IntState;
+    
+    uint8 SinkId;
+    
+    /* check working conditions, a crash inside the panic flush does not flush again */
+    if(gLoggerManager.pCbList == NULL || gLoggerManager.pCbList->DisableInterruptsCb == NULL || gLoggerManager.FilterMng.pActive == NULL || 
+       gLoggerManager.Flags.IsPanic)
+    {
+        return;
+    }
+    IntState = gLoggerManager.pCbList->DisableInterruptsCb();
+    
+    gLoggerManager.Flags.IsPanic = 1;
+    gLoggerManager.DrainMng.PanicCnt++;
+    
+    for(SinkId = 0; SinkId < e_LOGGER_SINK_MAX; SinkId++)
+    {
+        Budget[SinkId] = LOGGER_CONFIG_PANIC_MAX_BYTES;
+    }
+    Logger_PanicSendRxBuffer(&gLoggerManager.PriorityBuffer, TRUE, Budget);
+    
+    Logger_PanicSendRxBuffer(&gLoggerManager.RxBuffer, FALSE, Budget);
+    
+    /* the priority records written to FLASH after the end of a record the main RX buffer had cut (see Logger_SendPacketFlash) */
+    Logger_PanicSendRxBuffer(&gLoggerManager.PriorityBuffer, TRUE, Budget);
+    
+    /* the records that did not fit in the budget are recovered after the reset */
+    Logger_NoInitUpdate();
+    
+    gLoggerManager.Flags.IsPanic = 0;
+    
+    gLoggerManager.pCbList->RestoreInterruptsCb(IntState);
+}
+
 /**
  * <pre>
  * BOOL Logger_IsLoopBack(uint8 TaskId)
@@ -1004,7 +2801,7 @@ void Logger_SendPacketFromInt(void)
 BOOL Logger_IsLoopBack(uint8 TaskId)
 {
     
-    return ((LOGGER_DEF_GEN_CONFIG.DestType == LOGGER_DEST_TYPE_SOCKET) && 
+    return (LOGGER_DEF_IS_DEST_SOCKET(LOGGER_DEF_FILTER.DestType) && 
             (TaskId == TASK_MDL_COMM_STM_RX_MNG_ID                     ||             
             TaskId == TASK_MDL_ETH_MANAGER_ID                          ||
             TaskId == TASK_APP_COM_MANAGER_ID));
@@ -1044,6 +2841,32 @@ void Logger_SetTestMode(void)
     gLoggerManager.Config.General.Mode = LOGGER_MODE_TYPE_TEST;
 }
 
+/**
+ * <pre>
+ * void Logger_ResetProbes(void)
+ * </pre>
+ *  
+ * this function clears the latency probes histograms, so they measure from now on. the next telemetry record is a 
+ * full record.
+ * NOTE: a sample that is taken while the histograms are cleared may be kept
+ *
+ * @return none
+ *
+ * \defgroup LogManager
+ * \ingroup LogManager
+*/
+void Logger_ResetProbes(void)
+{
+    LoggerProbeMng_t *pProbeMng = &gLoggerManager.ProbeMng;
+    
+    uint32 ResetCnt = pProbeMng->ResetCnt;
+    
+    OSAL_MemSet(pProbeMng, 0, sizeof(LoggerProbeMng_t));
+    
+    pProbeMng->ResetCnt = ResetCnt + 1;
+    gLoggerManager.TelemetryMng.IsReset = TRUE;
+}
+
 /**
  * <pre>
  * uint16 Logger_GetMaxBuffSize(void)
@@ -1097,5 +2920,5 @@ BOOL Logger_IsInit(void)
 
 BOOL Logger_UploadLogFile(uint16 SizeKB)
 {
-    return Logger_SendDebugLog(SizeKB, LOGGER_DEST_TYPE_SOCKET);
+    return Logger_SendUploadLog(SizeKB);
 }
@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+"""Compare two logger benchmark results (logger_host_bench JSON output).
+
+Every run of the new results is matched by name to the base results. A run regresses when its
+p99 or p99.9 write latency grew, or its accepted throughput dropped, by more than the threshold,
+or when it loses records the base run did not lose. Runs that miss the README targets
+(write_target_ok, throughput_target_ok) are listed as well.
+
+usage: logger_bench.py [-t 20] base.json new.json
+exit status: 0 - no regression, 1 - regression or missed target
+"""
+
+import argparse
+import json
+import sys
+
+
+def load_runs(path):
+    with open(path) as f:
+        results = json.load(f)
+    return results, {run["name"]: run for run in results["runs"]}
+
+
+def compare_run(base, new, threshold):
+    """Return the regressions of a single run, as printable strings."""
+    regressions = []
+    for key in ("p99", "p99_9"):
+        before, after = base["latency_ns"][key], new["latency_ns"][key]
+        if after > before * (1 + threshold / 100.0):
+            regressions.append("%s latency %.1f -> %.1f us" % (key, before / 1000.0, after / 1000.0))
+    before, after = base["accepted_kbps"], new["accepted_kbps"]
+    if after < before * (1 - threshold / 100.0):
+        regressions.append("accepted %.1f -> %.1f Kbps" % (before, after))
+    before, after = base["drops"]["lost_msgs"], new["drops"]["lost_msgs"]
+    if before == 0 and after > 0:
+        regressions.append("lost 0 -> %d messages" % after)
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two logger benchmark results.")
+    parser.add_argument("-t", "--threshold", type=float, default=20.0,
+                        help="the allowed latency growth and throughput drop in percent (default 20)")
+    parser.add_argument("base", help="the base results (the previous firmware version)")
+    parser.add_argument("new", help="the new results")
+    args = parser.parse_args()
+
+    base_results, base_runs = load_runs(args.base)
+    new_results, new_runs = load_runs(args.new)
+    print("base %s, new %s" % (base_results["logger_version"], new_results["logger_version"]))
+
+    failed = False
+    for name, run in new_runs.items():
+        problems = []
+        if name in base_runs:
+            problems += compare_run(base_runs[name], run, args.threshold)
+        if not run["write_target_ok"]:
+            problems.append("misses the %d us write target" % new_results["targets"]["write_us"])
+        if not run["throughput_target_ok"]:
+            problems.append("loses records within the %d Kbps design load" % new_results["targets"]["kbps"])
+        for problem in problems:
+            print("%-14s %s" % (name, problem))
+        failed = failed or bool(problems)
+
+    if not failed:
+        print("no regression")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""Symbolise the logger crash capture found in a log file.
+
+The logger prints the FLASH crash capture on the first init after a crash (see Logger_CrashPrint),
+as lines that start with "CRASH". This tool finds the last capture in a log file (FTP upload, dump
+or RS232 capture), decodes the fault status registers, and symbolises PC, LR and the stack words
+that look like Thumb return addresses with addr2line and the firmware ELF file.
+
+usage: logger_crash.py [-e firmware.out] [--addr2line arm-none-eabi-addr2line] log.txt
+"""
+
+import argparse
+import re
+import subprocess
+import sys
+
+CFSR_BITS = {
+    0: "IACCVIOL instruction access violation",
+    1: "DACCVIOL data access violation",
+    3: "MUNSTKERR unstacking error (MPU)",
+    4: "MSTKERR stacking error (MPU)",
+    7: "MMARVALID MMFAR holds the faulting address",
+    8: "IBUSERR instruction bus error",
+    9: "PRECISERR precise data bus error",
+    10: "IMPRECISERR imprecise data bus error",
+    11: "UNSTKERR unstacking error (bus)",
+    12: "STKERR stacking error (bus)",
+    15: "BFARVALID BFAR holds the faulting address",
+    16: "UNDEFINSTR undefined instruction",
+    17: "INVSTATE invalid EPSR state (e.g. ARM mode branch)",
+    18: "INVPC invalid EXC_RETURN",
+    19: "NOCP no coprocessor",
+    24: "UNALIGNED unaligned access",
+    25: "DIVBYZERO divide by zero",
+}
+
+HFSR_BITS = {
+    1: "VECTTBL vector table read fault",
+    30: "FORCED escalated configurable fault",
+    31: "DEBUGEVT debug event",
+}
+
+CODE_END = 0x20000000   # words below the SRAM base may be code addresses
+
+
+def parse_capture(lines):
+    """Return the fields, the stack words and the log lines of the last crash capture."""
+    capture = None
+    in_log = False
+    for line in lines:
+        pos = line.find("CRASH ")
+        if in_log:
+            if pos >= 0 and line[pos:].startswith("CRASH LOG END"):
+                in_log = False
+            else:
+                capture["log"].append(line)
+            continue
+        if pos < 0:
+            continue
+        text = line[pos:].strip()
+        if text.startswith("CRASH CAPTURE"):
+            capture = {"fields": {}, "stack": [], "log": [], "title": text}
+        elif capture is None:
+            continue
+        elif text.startswith("CRASH LOG BEGIN"):
+            in_log = True
+        elif text.startswith("CRASH STACK"):
+            addr, words = text[len("CRASH STACK "):].split(":", 1)
+            base = int(addr, 16)
+            for idx, word in enumerate(words.split()):
+                capture["stack"].append((base + idx * 4, int(word, 16)))
+        elif text.startswith("CRASH TASK"):
+            capture["fields"]["TASK"] = text[len("CRASH TASK "):]
+        else:
+            tokens = text.split()[1:]
+            for name, value in zip(tokens[0::2], tokens[1::2]):
+                capture["fields"][name] = int(value, 16) if value.startswith("0x") else int(value)
+    return capture
+
+
+def symbolise(elf, addr2line, addrs):
+    """Return {address: 'function file:line'} for the addresses addr2line resolves."""
+    if not elf or not addrs:
+        return {}
+    cmd = [addr2line, "-f", "-C", "-e", elf] + ["0x%x" % (a & ~1) for a in addrs]
+    try:
+        out = subprocess.run(cmd, check=True, capture_output=True, text=True).stdout.splitlines()
+    except (OSError, subprocess.CalledProcessError) as err:
+        sys.stderr.write("addr2line failed: %s\n" % err)
+        return {}
+    result = {}
+    for addr, func, loc in zip(addrs, out[0::2], out[1::2]):
+        if func != "??":
+            result[addr] = "%s %s" % (func, loc)
+    return result
+
+
+def decode_bits(value, names):
+    return [desc for bit, desc in sorted(names.items()) if value & (1 << bit)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="symbolise the logger crash capture found in a log file")
+    parser.add_argument("log", help="the log file holding the CRASH lines")
+    parser.add_argument("-e", "--elf", help="the firmware ELF file (IAR .out) the crash happened on")
+    parser.add_argument("--addr2line", default="arm-none-eabi-addr2line", help="the addr2line tool to use")
+    args = parser.parse_args()
+
+    with open(args.log, encoding="latin-1") as log:
+        capture = parse_capture(log.read().splitlines())
+    if capture is None:
+        print("no crash capture found")
+        return 1
+
+    fields = capture["fields"]
+    candidates = [w for _, w in capture["stack"] if w < CODE_END and w & 1]
+    symbols = symbolise(args.elf, args.addr2line,
+                        [fields[r] for r in ("PC", "LR") if r in fields] + candidates)
+
+    print(capture["title"])
+    print("task: %s" % fields.get("TASK", "?"))
+    for reg in ("R0", "R1", "R2", "R3", "R12", "LR", "PC", "XPSR", "SP"):
+        if reg in fields:
+            print("%-5s 0x%08x  %s" % (reg, fields[reg], symbols.get(fields[reg], "")))
+    for reg, names in (("CFSR", CFSR_BITS), ("HFSR", HFSR_BITS)):
+        if reg in fields:
+            print("%-5s 0x%08x  %s" % (reg, fields[reg], ", ".join(decode_bits(fields[reg], names))))
+    if fields.get("CFSR", 0) & (1 << 7):
+        print("MMFAR 0x%08x" % fields["MMFAR"])
+    if fields.get("CFSR", 0) & (1 << 15):
+        print("BFAR  0x%08x" % fields["BFAR"])
+
+    print("\nbacktrace (stack words that resolve to code, innermost first):")
+    for addr, word in capture["stack"]:
+        if word in symbols:
+            print("  [0x%08x] 0x%08x  %s" % (addr, word, symbols[word]))
+
+    print("\nlast log messages:")
+    for line in capture["log"]:
+        print("  " + line)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""Decode and filter the logger structured records.
+
+Logger_kv writes the structured records in binary (see LOGGER_DEF_KV_MARKER): the marker (0x1E), the
+length of the rest of the record, the level, the event ID (little endian), the fields and a line end.
+A field is its key ID and a zigzag varint (INT), a varint (UINT) or the length and characters (STR).
+After the marker every line end, 0xFF, marker and escape byte is written as the escape byte (0x1B)
+and the byte XOR 0x20, so a record never holds a line end. The length counts the unescaped bytes.
+This tool finds the records in any capture of the log stream (a FLASH image or dump, an FTP upload,
+a socket capture) and prints the records that match the filters as key=value text or JSON lines.
+The key and event names are read from Logger_KvKeys.h, so the filters use no string parsing of the
+log text.
+
+usage: logger_kv.py [--keys Logger_KvKeys.h] [--event NAME] [--where KEY=VALUE ...] [--json] capture.bin
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+MARKER = 0x1E
+ESCAPE = 0x1B
+ESCAPE_XOR = 0x20
+HEADER_LEN = 5
+LEVELS = ["", "CRITICAL", "ERROR", "WARNING", "INFO", "DETAILS", "FLOW"]
+DEFAULT_KEYS = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "ext", "Logger_KvKeys.h")
+
+
+def read_keys(path):
+    """Read the keys ([(name, type)], ID 0 is the list end) and the event names from Logger_KvKeys.h."""
+    with open(path) as header:
+        text = header.read()
+    keys = [("", "UINT")] + re.findall(r'LOGGER_KV_KEY\(\s*\w+\s*,\s*(\w+)\s*,\s*"([^"]*)"\s*\)', text)
+    keys = [keys[0]] + [(name, kind) for kind, name in keys[1:]]
+    events = re.findall(r'LOGGER_KV_EVENT\(\s*\w+\s*,\s*"([^"]*)"\s*\)', text)
+    return keys, events
+
+
+def get_varint(data, pos, end):
+    value = 0
+    shift = 0
+    while pos < end and shift < 35:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if byte < 0x80:
+            return value, pos
+    raise ValueError("bad varint")
+
+
+def unescape(data):
+    """Unescape the record bytes between the marker and the line end."""
+    record = bytearray()
+    pos = 0
+    while pos < len(data):
+        byte = data[pos]
+        if byte == MARKER:
+            raise ValueError("marker inside the record")
+        if byte == ESCAPE:
+            if pos + 1 == len(data):
+                raise ValueError("bad escape")
+            pos += 1
+            byte = data[pos] ^ ESCAPE_XOR
+        record.append(byte)
+        pos += 1
+    return bytes(record)
+
+
+def decode(data, pos, keys, events):
+    """Decode the record at pos to (level, event, {key: value}, line end offset), raises ValueError if it is not a valid record."""
+    line_end = data.find(b"\n", pos + 1)
+    if line_end < 0:
+        raise ValueError("no line end")
+    data = unescape(data[pos + 1:line_end])
+    end = len(data)
+    if end < HEADER_LEN - 1 or data[0] != end - 1:
+        raise ValueError("bad length")
+    level = data[1]
+    event_id = data[2] | (data[3] << 8)
+    if not 0 < level < len(LEVELS) or event_id >= len(events):
+        raise ValueError("bad header")
+    fields = {}
+    pos = HEADER_LEN - 1
+    while pos < end:
+        key = data[pos]
+        if not 0 < key < len(keys):
+            raise ValueError("bad key")
+        name, kind = keys[key]
+        if kind == "STR":
+            length = data[pos + 1]
+            if pos + 2 + length > end:
+                raise ValueError("bad string")
+            fields[name] = data[pos + 2:pos + 2 + length].decode("latin-1")
+            pos += 2 + length
+            continue
+        value, pos = get_varint(data, pos + 1, end)
+        fields[name] = (value >> 1) ^ -(value & 1) if kind == "INT" else value
+    return LEVELS[level], events[event_id], fields, line_end
+
+
+def parse_where(where, keys):
+    """Parse the KEY=VALUE filters, the values of the INT and UINT keys are compared as numbers."""
+    kinds = dict(keys)
+    filters = {}
+    for item in where:
+        name, _, value = item.partition("=")
+        if name not in kinds:
+            raise SystemExit("unknown key %s" % name)
+        filters[name] = value if kinds[name] == "STR" else int(value, 0)
+    return filters
+
+
+def main():
+    parser = argparse.ArgumentParser(description="decode and filter the logger structured records")
+    parser.add_argument("capture", help="the log stream capture (FLASH image, dump, upload or socket capture)")
+    parser.add_argument("--keys", default=DEFAULT_KEYS, help="the keys and events header (Logger_KvKeys.h)")
+    parser.add_argument("--event", help="print the records of this event only")
+    parser.add_argument("--where", action="append", default=[], metavar="KEY=VALUE", help="print the records with this field value only")
+    parser.add_argument("--json", action="store_true", help="print the records as JSON lines")
+    args = parser.parse_args()
+
+    keys, events = read_keys(args.keys)
+    filters = parse_where(args.where, keys)
+    with open(args.capture, "rb") as capture:
+        data = capture.read()
+
+    pos = data.find(MARKER)
+    while 0 <= pos < len(data) - HEADER_LEN:
+        try:
+            level, event, fields, line_end = decode(data, pos, keys, events)
+        except (ValueError, IndexError):
+            pos = data.find(MARKER, pos + 1)
+            continue
+        if (args.event is None or event == args.event) and all(fields.get(k) == v for k, v in filters.items()):
+            if args.json:
+                print(json.dumps(dict(offset=pos, level=level, event=event, **fields)))
+            else:
+                print("%08x %-8s %s %s" % (pos, level, event, " ".join("%s=%s" % item for item in fields.items())))
+        pos = data.find(MARKER, line_end)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
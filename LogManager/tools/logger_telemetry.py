@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""Decode the logger telemetry records.
+
+The logger sends a telemetry record to the server every LOGGER_CONFIG_TELEMETRY_INTERVAL_SEC
+(MSME_LOGGER_TELEMETRY_EVENT_MSG, see Logger_SendTelemetryToSrv). Only the counters that changed
+are sent, as varint deltas, and every LOGGER_CONFIG_TELEMETRY_FULL_EVERY records the counters are
+sent in full. This tool reads the records as hex strings (one per line, e.g. the "OMM: logger
+telemetry" lines of the host demo), rebuilds the counters and prints the rates of every interval.
+The deltas after a lost record (a sequence number gap) are skipped up to the next full record.
+A full record restarts the totals: the logger also sends one after its counters were reset (the
+logger init, a probes reset), so a full record has no rates, only the totals.
+
+usage: logger_telemetry.py [records.txt]   (the standard input by default)
+"""
+
+import argparse
+import re
+import sys
+
+FORMAT = 1
+FULL_FLAG = 0x80
+
+# LoggerTelemetryCounter_e order
+COUNTERS = [
+    "RxMsgs", "TxPackets", "LostMsgs", "LostBytes", "Busy", "LowMemory", "RunOver",
+    "FlashDrops", "SocketDrops", "UartDrops", "PriorityRxMsgs", "PriorityLostMsgs",
+    "DrainWakeups", "DrainBusyUs",
+]
+
+
+def get_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if byte < 0x80:
+            return value, pos
+
+
+def decode(data):
+    """Decode a single record to (is_full, seq, {counter: delta}, elapsed_ms, rx_peak_percent, flash_percent)."""
+    if data[0] & 0x7F != FORMAT:
+        raise ValueError("unknown telemetry format %d" % (data[0] & 0x7F))
+    mask = data[2] | (data[3] << 8)
+    pos = 4
+    deltas = {}
+    for idx, name in enumerate(COUNTERS):
+        if mask & (1 << idx):
+            deltas[name], pos = get_varint(data, pos)
+    elapsed_ms, pos = get_varint(data, pos)
+    return bool(data[0] & FULL_FLAG), data[1], deltas, elapsed_ms, data[pos], data[pos + 1]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="decode the logger telemetry records")
+    parser.add_argument("records", nargs="?", help="the file holding the hex records (the standard input by default)")
+    args = parser.parse_args()
+
+    lines = open(args.records).read().splitlines() if args.records else sys.stdin.read().splitlines()
+    counters = None
+    next_seq = None
+    for line in lines:
+        match = re.search(r"telemetry ([0-9a-fA-F]+)\s*$", line) or re.match(r"\s*([0-9a-fA-F]+)\s*$", line)
+        if match is None:
+            continue
+        is_full, seq, deltas, elapsed_ms, rx_peak, flash = decode(bytes.fromhex(match.group(1)))
+        if next_seq is not None and seq != next_seq:
+            print("seq %3d: %d records lost, waiting for a full record" % (seq, (seq - next_seq) % 256))
+            counters = None
+        next_seq = (seq + 1) % 256
+        if is_full:
+            counters = dict(dict.fromkeys(COUNTERS, 0), **deltas)
+            rates = "%8s msgs/s %5s lost %4s busy | drain %5s%%" % ("-", "-", "-", "-")
+        elif counters is None:
+            continue
+        else:
+            for name, delta in deltas.items():
+                counters[name] = (counters[name] + delta) & 0xFFFFFFFF
+            seconds = max(elapsed_ms, 1) / 1000.0
+            rates = "%8.1f msgs/s %5d lost %4d busy | drain %5.1f%%" % (
+                deltas.get("RxMsgs", 0) / seconds, deltas.get("LostMsgs", 0), deltas.get("Busy", 0),
+                deltas.get("DrainBusyUs", 0) / 10.0 / max(elapsed_ms, 1))
+        print("seq %3d%s %6d ms | RX peak %3d%% FLASH %3d%% | %s |%s" % (
+            seq, " full" if is_full else "     ", elapsed_ms, rx_peak, flash, rates,
+            " ".join("%s=%d" % (name, counters[name]) for name in COUNTERS if counters[name])))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())